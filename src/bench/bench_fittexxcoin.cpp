@@ -80,6 +80,12 @@ static void SetupBenchArgs() {
                   "default: %d). Currently only affects the CCheckQueue_RealBlock_32MB* benches.",
                   DEFAULT_SCRIPTCHECK_THREADS),
         ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
+    gArgs.AddArg(
+        "-parengine=<engine>",
+        strprintf("Select the script verification queue implementation (legacy or workstealing, default: %s). "
+                  "Currently only affects the CCheckQueue_RealBlock_32MB* benches.",
+                  GetCheckQueueEngineName(DEFAULT_SCRIPTCHECK_ENGINE)),
+        ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
 }
 
 int main(int argc, char **argv) {
@@ -101,6 +107,11 @@ int main(int argc, char **argv) {
     std::string scaling_str = gArgs.GetArg("-scaling", DEFAULT_BENCH_SCALING);
     bool is_list_only = gArgs.GetBoolArg("-list", false);
 
+    if (gArgs.IsArgSet("-parengine") && !GetCheckQueueEngineFromName(gArgs.GetArg("-parengine", ""))) {
+        fprintf(stderr, "Unknown -parengine value: %s\n", gArgs.GetArg("-parengine", "").c_str());
+        return EXIT_FAILURE;
+    }
+
     double scaling_factor;
     if (!ParseDouble(scaling_str, &scaling_factor)) {
         fprintf(stderr, "Error parsing scaling factor as double: %s\n",
@@ -0,0 +1,96 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <amount.h>
+#include <bench/bench.h>
+#include <config.h>
+#include <miner.h>
+#include <primitives/transaction.h>
+#include <random.h>
+#include <script/script.h>
+#include <test/setup_common.h>
+#include <txmempool.h>
+#include <validation.h>
+
+#include <memory>
+#include <vector>
+
+/** A transaction of ~200 bytes, spending an output of txPrev or a made-up one. */
+static CTransactionRef MakeTx(FastRandomContext &rng, const CTransactionRef &txPrev) {
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vin[0].prevout = txPrev ? COutPoint(txPrev->GetId(), 0) : COutPoint(TxId(rng.rand256()), 0);
+    tx.vin[0].scriptSig = CScript() << std::vector<uint8_t>(100, 0x01);
+    tx.vout.resize(1);
+    tx.vout[0].nValue = 10 * COIN;
+    tx.vout[0].scriptPubKey = CScript() << OP_DUP << OP_HASH160 << rng.randbytes(20) << OP_EQUALVERIFY
+                                        << OP_CHECKSIG;
+    return MakeTransactionRef(tx);
+}
+
+/**
+ * The time getblocktemplate takes to assemble a template from a mempool of
+ * mempoolSize transactions, one in five of which spends another, while one
+ * transaction enters the mempool between two templates.
+ */
+static void BlockTemplate(benchmark::State &state, size_t mempoolSize, bool incremental) {
+    const Config &config = GetConfig();
+    const CScript scriptPubKey = CScript() << OP_TRUE;
+    FastRandomContext rng(true);
+    TestMemPoolEntryHelper entry;
+
+    const auto AddTx = [&](const CTransactionRef &txPrev) {
+        const CTransactionRef tx = MakeTx(rng, txPrev);
+        LOCK2(cs_main, g_mempool.cs);
+        g_mempool.addUnchecked(entry.Fee(int64_t(1000 + rng.randrange(1000)) * SATOSHI).FromTx(tx));
+        return tx;
+    };
+
+    std::unique_ptr<IncrementalBlockAssembler> assembler;
+    if (incremental) {
+        assembler = std::make_unique<IncrementalBlockAssembler>(config, g_mempool);
+    }
+    CTransactionRef txPrev;
+    for (size_t i = 0; i < mempoolSize; ++i) {
+        txPrev = AddTx(rng.randrange(5) == 0 ? txPrev : nullptr);
+    }
+
+    BENCHMARK_LOOP {
+        AddTx(nullptr);
+        const std::unique_ptr<CBlockTemplate> pblocktemplate =
+            incremental ? assembler->CreateNewBlock(scriptPubKey, 0., false)
+                        : BlockAssembler(config, g_mempool).CreateNewBlock(scriptPubKey, 0., false);
+        assert(pblocktemplate->block.vtx.size() > 1);
+    }
+
+    assembler.reset();
+    LOCK2(cs_main, g_mempool.cs);
+    g_mempool.clear();
+}
+
+static void BlockTemplate_1000(benchmark::State &state) {
+    BlockTemplate(state, 1000, false);
+}
+static void BlockTemplate_1000_Incremental(benchmark::State &state) {
+    BlockTemplate(state, 1000, true);
+}
+static void BlockTemplate_10000(benchmark::State &state) {
+    BlockTemplate(state, 10000, false);
+}
+static void BlockTemplate_10000_Incremental(benchmark::State &state) {
+    BlockTemplate(state, 10000, true);
+}
+static void BlockTemplate_100000(benchmark::State &state) {
+    BlockTemplate(state, 100000, false);
+}
+static void BlockTemplate_100000_Incremental(benchmark::State &state) {
+    BlockTemplate(state, 100000, true);
+}
+
+BENCHMARK(BlockTemplate_1000, 100);
+BENCHMARK(BlockTemplate_1000_Incremental, 100);
+BENCHMARK(BlockTemplate_10000, 10);
+BENCHMARK(BlockTemplate_10000_Incremental, 10);
+BENCHMARK(BlockTemplate_100000, 1);
+BENCHMARK(BlockTemplate_100000_Incremental, 1);
@@ -8,8 +8,10 @@
 #include <consensus/tx_verify.h>
 #include <consensus/validation.h>
 #include <policy/policy.h>
+#include <random.h>
 #include <wallet/crypter.h>
 
+#include <unordered_map>
 #include <vector>
 
 // FIXME: Dedup with SetupDummyInputs in test/transaction_tests.cpp.
@@ -129,5 +131,74 @@ static void CheckTxInputs(benchmark::State &state) {
     }
 }
 
+// The std::unordered_map CCoinsMap used to be, for comparison.
+using UnorderedCoinsMap = std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher>;
+
+static std::vector<COutPoint> RandomOutpoints(size_t n) {
+    FastRandomContext rng(true);
+    std::vector<COutPoint> outpoints;
+    outpoints.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        outpoints.emplace_back(TxId(rng.rand256()), rng.randrange(4));
+    }
+    return outpoints;
+}
+
+// Random lookups, half of which miss, in a map of 1M coins: a large enough
+// cache that most lookups miss the CPU caches, as with a full dbcache.
+template <typename Map>
+static void CoinsMapLookup(benchmark::State &state) {
+    constexpr size_t nCoins = 1 << 20;
+    const auto outpoints = RandomOutpoints(2 * nCoins);
+    Map map;
+    for (size_t i = 0; i < nCoins; ++i) {
+        map.try_emplace(outpoints[2 * i]);
+    }
+
+    size_t i = 0, found = 0;
+    BENCHMARK_LOOP {
+        for (int n = 0; n < 1000; ++n) {
+            found += map.find(outpoints[i++ % outpoints.size()]) != map.end();
+        }
+    }
+    assert(found <= i / 2 + 1);
+}
+
+// Fill a map with 100k coins and empty it again while iterating, as a cache
+// flush does. The fill and the per-coin memory are also what grows the cache
+// against -dbcache: for this map, memusage::DynamicUsage() reports roughly
+// 115 bytes per coin (before the scripts), against 142 for UnorderedCoinsMap.
+template <typename Map>
+static void CoinsMapFillAndFlush(benchmark::State &state) {
+    const auto outpoints = RandomOutpoints(100000);
+    BENCHMARK_LOOP {
+        Map map;
+        for (const COutPoint &outpoint : outpoints) {
+            map.try_emplace(outpoint).first->second.flags = CCoinsCacheEntry::DIRTY;
+        }
+        size_t usage = memusage::DynamicUsage(map);
+        for (auto it = map.begin(); it != map.end(); it = map.erase(it)) {
+        }
+        benchmark::NoOptimize(usage);
+    }
+}
+
+static void CCoinsMapLookup(benchmark::State &state) {
+    CoinsMapLookup<CCoinsMap>(state);
+}
+static void UnorderedCoinsMapLookup(benchmark::State &state) {
+    CoinsMapLookup<UnorderedCoinsMap>(state);
+}
+static void CCoinsMapFillAndFlush(benchmark::State &state) {
+    CoinsMapFillAndFlush<CCoinsMap>(state);
+}
+static void UnorderedCoinsMapFillAndFlush(benchmark::State &state) {
+    CoinsMapFillAndFlush<UnorderedCoinsMap>(state);
+}
+
 BENCHMARK(CCoinsCaching, 170 * 1000);
 BENCHMARK(CheckTxInputs, 1000);
+BENCHMARK(CCoinsMapLookup, 20 * 1000);
+BENCHMARK(UnorderedCoinsMapLookup, 10 * 1000);
+BENCHMARK(CCoinsMapFillAndFlush, 50);
+BENCHMARK(UnorderedCoinsMapFillAndFlush, 30);
@@ -6,6 +6,7 @@
 #include <bench/bench.h>
 #include <bench/data.h>
 #include <checkqueue.h>
+#include <crypto/sha256.h>
 #include <logging.h>
 #include <policy/policy.h>
 #include <prevector.h>
@@ -13,11 +14,13 @@
 #include <random.h>
 #include <script/sigcache.h>
 #include <streams.h>
+#include <uint256.h>
 #include <util/defer.h>
 #include <util/system.h>
 #include <validation.h>
 
 #include <limits>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -27,7 +30,7 @@ static constexpr size_t QUEUE_BATCH_SIZE = 128; // this is the parameter normall
 // This Benchmark tests the CheckQueue with a slightly realistic workload, where
 // checks all contain a prevector that is indirect 50% of the time and there is
 // a little bit of work done between calls to Add.
-static void CCheckQueueSpeedPrevectorJob(benchmark::State &state) {
+static void CCheckQueueSpeedPrevector(CheckQueueEngine engine, benchmark::State &state) {
     static constexpr int MIN_CORES = 2;
     static constexpr size_t BATCHES = 101;
     static constexpr size_t BATCH_SIZE = 30;
@@ -41,12 +44,12 @@ static void CCheckQueueSpeedPrevectorJob(benchmark::State &state) {
         bool operator()() { return true; }
         void swap(PrevectorJob &x) { p.swap(x.p); };
     };
-    CCheckQueue<PrevectorJob> queue{QUEUE_BATCH_SIZE};
-    queue.StartWorkerThreads(std::max(MIN_CORES, GetNumCores()) - 1);
+    auto queue = MakeCheckQueue<PrevectorJob>(engine, QUEUE_BATCH_SIZE);
+    queue->StartWorkerThreads(std::max(MIN_CORES, GetNumCores()) - 1);
     BENCHMARK_LOOP {
         // Make insecure_rand here so that each iteration is identical.
         FastRandomContext insecure_rand(true);
-        CCheckQueueControl<PrevectorJob> control(&queue);
+        CCheckQueueControl<PrevectorJob> control(queue.get());
         std::vector<std::vector<PrevectorJob>> vBatches(BATCHES);
         for (auto &vChecks : vBatches) {
             vChecks.reserve(BATCH_SIZE);
@@ -59,9 +62,86 @@ static void CCheckQueueSpeedPrevectorJob(benchmark::State &state) {
         // for clarity
         control.Wait();
     }
-    queue.StopWorkerThreads();
+    queue->StopWorkerThreads();
+}
+
+static void CCheckQueueSpeedPrevectorJob(benchmark::State &state) {
+    CCheckQueueSpeedPrevector(CheckQueueEngine::LEGACY, state);
+}
+static void CCheckQueueSpeedPrevectorJob_WorkStealing(benchmark::State &state) {
+    CCheckQueueSpeedPrevector(CheckQueueEngine::WORKSTEALING, state);
+}
+
+// A check that does a fixed amount of CPU work (roughly what verifying a
+// signature costs, scaled down), so that the per-thread throughput is limited
+// by the queue itself rather than by memory bandwidth.
+struct HashJob {
+    uint256 seed;
+    HashJob() = default;
+    explicit HashJob(FastRandomContext &insecure_rand) : seed(insecure_rand.rand256()) {}
+    bool operator()() {
+        uint256 h = seed;
+        for (int i = 0; i < 16; ++i) {
+            CSHA256().Write(h.begin(), h.size()).Finalize(h.begin());
+        }
+        benchmark::NoOptimize(h);
+        return true;
+    }
+    void swap(HashJob &x) { std::swap(seed, x.seed); }
+};
+
+// Feed a block's worth of small per-transaction batches through the queue with
+// the given number of threads (including the master), like ConnectBlock does.
+static void CCheckQueueScaling(CheckQueueEngine engine, int nThreads, benchmark::State &state) {
+    static constexpr size_t TXS = 4000;
+    static constexpr size_t MAX_INPUTS_PER_TX = 4;
+
+    FastRandomContext insecure_rand(true);
+    std::vector<std::vector<HashJob>> vChecksPerTx(TXS);
+    for (auto &vChecks : vChecksPerTx) {
+        vChecks.resize(1 + insecure_rand.randrange(MAX_INPUTS_PER_TX), HashJob(insecure_rand));
+    }
+
+    auto queue = MakeCheckQueue<HashJob>(engine, QUEUE_BATCH_SIZE);
+    queue->StartWorkerThreads(nThreads - 1);
+    Defer d([&queue]{
+        queue->StopWorkerThreads();
+    });
+    std::vector<std::vector<HashJob>> vChecksPerTxCopy;
+    BENCHMARK_LOOP {
+        vChecksPerTxCopy = vChecksPerTx;
+        CCheckQueueControl<HashJob> control(queue.get());
+        for (auto &vChecks : vChecksPerTxCopy) {
+            control.Add(vChecks);
+        }
+        const bool result = control.Wait();
+        assert(result);
+    }
 }
 
+// Register one CCheckQueue_Scaling_<engine>_<n>T benchmark per engine for
+// n = 1, 2, 4, ... up to the number of cores, so that running with
+// -filter=CCheckQueue_Scaling yields a scaling curve for each engine.
+static const struct CCheckQueueScalingBenchmarks {
+    std::vector<std::unique_ptr<benchmark::BenchRunner>> runners;
+    CCheckQueueScalingBenchmarks() {
+        const int nCores = std::max(GetNumCores(), 1);
+        std::vector<int> vThreads;
+        for (int n = 1; n < nCores; n *= 2) {
+            vThreads.push_back(n);
+        }
+        vThreads.push_back(nCores);
+        for (const auto engine : {CheckQueueEngine::LEGACY, CheckQueueEngine::WORKSTEALING}) {
+            for (const int n : vThreads) {
+                runners.push_back(std::make_unique<benchmark::BenchRunner>(
+                    strprintf("CCheckQueue_Scaling_%s_%02dT", GetCheckQueueEngineName(engine), n),
+                    [engine, n](benchmark::State &state) { CCheckQueueScaling(engine, n, state); },
+                    20));
+            }
+        }
+    }
+} g_checkqueue_scaling_benchmarks;
+
 static void CCheckQueue_RealData32MB(bool cacheSigs, benchmark::State &state) {
     // This 32MB block has 166943 non-coinbase txins
     const CBlock block = []{
@@ -116,16 +196,20 @@ static void CCheckQueue_RealData32MB(bool cacheSigs, benchmark::State &state) {
     std::vector<PerIterContext> iterContext(state.m_num_iters + 1, PerIterContext{vChecksPerTx});
 
     // Step 3: Setup threads for our CCheckQueue
-    CCheckQueue<CScriptCheck> queue{QUEUE_BATCH_SIZE};
+    const auto engine = GetCheckQueueEngineFromName(
+        gArgs.GetArg("-parengine", GetCheckQueueEngineName(DEFAULT_SCRIPTCHECK_ENGINE)));
+    assert(engine); // validated in main()
+    auto queue = MakeCheckQueue<CScriptCheck>(*engine, QUEUE_BATCH_SIZE);
     int nThreads = gArgs.GetArg("-par", DEFAULT_SCRIPTCHECK_THREADS);
     const int nCores = std::max(GetNumCores(), 1);
     if (!nThreads) nThreads = nCores;
     else if (nThreads < 0) nThreads = std::max(1, nCores + nThreads); // negative means leave n cores free
-    LogPrintf("%s: Using %d thread%s for signature verification\n", __func__, nThreads, nThreads != 1 ? "s" : "");
+    LogPrintf("%s: Using %d thread%s for signature verification (%s engine)\n", __func__, nThreads,
+              nThreads != 1 ? "s" : "", GetCheckQueueEngineName(*engine));
     --nThreads; // account for the fact that this main thread also does processing in .Wait() below
-    queue.StartWorkerThreads(nThreads);
+    queue->StartWorkerThreads(nThreads);
     Defer d([&queue]{
-        queue.StopWorkerThreads();
+        queue->StopWorkerThreads();
     });
 
     // And finally: Run the benchmark
@@ -134,7 +218,7 @@ static void CCheckQueue_RealData32MB(bool cacheSigs, benchmark::State &state) {
     BENCHMARK_LOOP {
         assert(iterNum < iterContext.size());
         auto & vChecksPerTxCopy = iterContext[iterNum++].vChecksPerTxCopy;
-        CCheckQueueControl<CScriptCheck> control(&queue);
+        CCheckQueueControl<CScriptCheck> control(queue.get());
         // we emulate how the code in validation.cpp calls Add() on a per-tx basis, sometimes passing in an
         // empty vector
         for (auto & vChecks: vChecksPerTxCopy)
@@ -163,5 +247,6 @@ static void CCheckQueue_RealBlock_32MB_WithCacheStore(benchmark::State &state) {
 }
 
 BENCHMARK(CCheckQueueSpeedPrevectorJob, 1400);
+BENCHMARK(CCheckQueueSpeedPrevectorJob_WorkStealing, 1400);
 BENCHMARK(CCheckQueue_RealBlock_32MB_NoCacheStore, 5);
 BENCHMARK(CCheckQueue_RealBlock_32MB_WithCacheStore, 5);
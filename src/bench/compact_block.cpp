@@ -0,0 +1,79 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <amount.h>
+#include <bench/bench.h>
+#include <blockencodings.h>
+#include <config.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <random.h>
+#include <script/script.h>
+#include <test/setup_common.h>
+#include <txmempool.h>
+#include <validation.h>
+
+#include <cassert>
+#include <vector>
+
+/**
+ * The time PartiallyDownloadedBlock::InitData() takes to find the blockSize
+ * transactions of a compact block among the mempoolSize ones of the mempool.
+ */
+static void CompactBlockReconstruct(benchmark::State &state, size_t mempoolSize, size_t blockSize) {
+    const Config &config = GetConfig();
+    FastRandomContext rng(true);
+    TestMemPoolEntryHelper entry;
+    CTxMemPool pool;
+
+    CBlock block;
+    // A null header makes for an invalid compact block.
+    block.nBits = 0x207fffff;
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vout.resize(1);
+    coinbase.vout[0].nValue = 50 * COIN;
+    block.vtx.push_back(MakeTransactionRef(coinbase));
+    for (size_t i = 0; i < mempoolSize; ++i) {
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vin[0].prevout = COutPoint(TxId(rng.rand256()), 0);
+        tx.vin[0].scriptSig = CScript() << std::vector<uint8_t>(100, 0x01);
+        tx.vout.resize(1);
+        tx.vout[0].nValue = 10 * COIN;
+        tx.vout[0].scriptPubKey = CScript() << OP_DUP << OP_HASH160 << rng.randbytes(20) << OP_EQUALVERIFY
+                                            << OP_CHECKSIG;
+        const CTransactionRef txRef = MakeTransactionRef(tx);
+        LOCK2(cs_main, pool.cs);
+        pool.addUnchecked(entry.FromTx(txRef));
+        if (i < blockSize) {
+            block.vtx.push_back(txRef);
+        }
+    }
+    const CBlockHeaderAndShortTxIDs cmpctblock(block);
+
+    BENCHMARK_LOOP {
+        PartiallyDownloadedBlock partialBlock(config, &pool);
+        const ReadStatus status = partialBlock.InitData(cmpctblock, {});
+        assert(status == READ_STATUS_OK);
+        assert(partialBlock.IsTxAvailable(blockSize));
+    }
+
+    LOCK2(cs_main, pool.cs);
+    pool.clear();
+}
+
+static void CompactBlockReconstruct_1000_10000(benchmark::State &state) {
+    CompactBlockReconstruct(state, 10000, 1000);
+}
+static void CompactBlockReconstruct_10000_100000(benchmark::State &state) {
+    CompactBlockReconstruct(state, 100000, 10000);
+}
+static void CompactBlockReconstruct_30000_300000(benchmark::State &state) {
+    CompactBlockReconstruct(state, 300000, 30000);
+}
+
+BENCHMARK(CompactBlockReconstruct_1000_10000, 100);
+BENCHMARK(CompactBlockReconstruct_10000_100000, 10);
+BENCHMARK(CompactBlockReconstruct_30000_300000, 5);
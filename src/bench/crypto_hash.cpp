@@ -16,8 +16,10 @@
 #include <uint256.h>
 #include <util/time.h>
 
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <vector>
 
 /* Number of bytes to hash per iteration */
 static const uint64_t BUFFER_SIZE = 1000 * 1000;
@@ -85,6 +87,16 @@ static void SipHash_32b(benchmark::State &state) {
     }
 }
 
+static void SipHash_32b_Batch_1024(benchmark::State &state) {
+    std::vector<uint256> vals(1024);
+    std::vector<uint64_t> hashes(vals.size());
+    uint64_t k1 = 0;
+    BENCHMARK_LOOP {
+        SipHashUint256Batch(0, ++k1, vals.data(), hashes.data(), vals.size());
+        std::memcpy(vals[0].begin(), &hashes.back(), sizeof(hashes.back()));
+    }
+}
+
 static void FastRandom_32bit(benchmark::State &state) {
     FastRandomContext rng(true);
     BENCHMARK_LOOP {
@@ -107,6 +119,7 @@ BENCHMARK(SHA3_256_1M, 250);
 
 BENCHMARK(SHA256_32b, 4700 * 1000);
 BENCHMARK(SipHash_32b, 40 * 1000 * 1000);
+BENCHMARK(SipHash_32b_Batch_1024, 40 * 1000);
 BENCHMARK(SHA256D64_1024, 7400);
 BENCHMARK(FastRandom_32bit, 110 * 1000 * 1000);
 BENCHMARK(FastRandom_1bit, 440 * 1000 * 1000);
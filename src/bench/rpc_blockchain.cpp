@@ -13,10 +13,11 @@
 #include <streams.h>
 #include <consensus/validation.h>
 #include <rpc/blockchain.h>
+#include <rpc/server.h>
 
 #include <univalue.h>
 
-static void RPCBlockVerbose(const std::vector<uint8_t> &data, benchmark::State &state) {
+static CBlock ReadBlock(const std::vector<uint8_t> &data) {
     SelectParams(CBaseChainParams::MAIN);
 
     CDataStream stream(data, SER_NETWORK, PROTOCOL_VERSION);
@@ -25,23 +26,54 @@ static void RPCBlockVerbose(const std::vector<uint8_t> &data, benchmark::State &
 
     CBlock block;
     stream >> block;
+    return block;
+}
+
+/** A block with the transactions of block 413567, repeated to make it ~32MB. */
+static CBlock MakeLargeBlock() {
+    CBlock block = ReadBlock(benchmark::data::Get_block413567());
+    const std::vector<CTransactionRef> vtx = block.vtx;
+    for (int i = 1; i < 32; ++i) {
+        block.vtx.insert(block.vtx.end(), vtx.begin() + 1, vtx.end());
+    }
+    return block;
+}
 
+static void RPCBlockVerbose(const CBlock &block, int worker_threads, benchmark::State &state) {
     CBlockIndex blockindex;
     const auto blockHash = block.GetHash();
     blockindex.phashBlock = &blockHash;
     blockindex.nBits = block.nBits;
 
+    g_rpc_worker_pool.Start(worker_threads);
     BENCHMARK_LOOP {
         (void)blockToJSON(GetConfig(), block, &blockindex, &blockindex, TxVerbosity::SHOW_DETAILS);
     }
+    g_rpc_worker_pool.Stop();
 }
 
 static void RPCBlockVerbose_1MB(benchmark::State &state) {
-    RPCBlockVerbose(benchmark::data::Get_block413567(), state);
+    RPCBlockVerbose(ReadBlock(benchmark::data::Get_block413567()), 0, state);
+}
+static void RPCBlockVerbose_1MB_Parallel(benchmark::State &state) {
+    RPCBlockVerbose(ReadBlock(benchmark::data::Get_block413567()), DEFAULT_RPC_WORKER_THREADS, state);
 }
 static void RPCBlockVerbose_32MB(benchmark::State &state) {
-    RPCBlockVerbose(benchmark::data::Get_block556034(), state);
+    RPCBlockVerbose(ReadBlock(benchmark::data::Get_block556034()), 0, state);
+}
+static void RPCBlockVerbose_32MB_Parallel(benchmark::State &state) {
+    RPCBlockVerbose(ReadBlock(benchmark::data::Get_block556034()), DEFAULT_RPC_WORKER_THREADS, state);
+}
+static void RPCBlockVerbose_32MB_Dense(benchmark::State &state) {
+    RPCBlockVerbose(MakeLargeBlock(), 0, state);
+}
+static void RPCBlockVerbose_32MB_Dense_Parallel(benchmark::State &state) {
+    RPCBlockVerbose(MakeLargeBlock(), DEFAULT_RPC_WORKER_THREADS, state);
 }
 
 BENCHMARK(RPCBlockVerbose_1MB, 23);
+BENCHMARK(RPCBlockVerbose_1MB_Parallel, 23);
 BENCHMARK(RPCBlockVerbose_32MB, 1);
+BENCHMARK(RPCBlockVerbose_32MB_Parallel, 1);
+BENCHMARK(RPCBlockVerbose_32MB_Dense, 1);
+BENCHMARK(RPCBlockVerbose_32MB_Dense_Parallel, 1);
@@ -23,20 +23,23 @@ static void AddTx(const CTransactionRef &tx, const Amount &fee,
 
 static void RPCMempoolVerbose(benchmark::State &state) {
     CTxMemPool pool;
-    LOCK2(cs_main, pool.cs);
 
     constexpr size_t nTx = 1000;
 
-    for (size_t i = 0; i < nTx; ++i) {
-        Amount const value = int64_t(i) * COIN;
-        CMutableTransaction tx = CMutableTransaction();
-        tx.vin.resize(1);
-        tx.vin[0].scriptSig = CScript() << OP_1;
-        tx.vout.resize(1);
-        tx.vout[0].scriptPubKey = CScript() << OP_1 << OP_EQUAL;
-        tx.vout[0].nValue = value;
-        const CTransactionRef tx_r{MakeTransactionRef(tx)};
-        AddTx(tx_r, value, pool);
+    {
+        // Not held for MempoolToJSON(), which takes the snapshot lock first.
+        LOCK2(cs_main, pool.cs);
+        for (size_t i = 0; i < nTx; ++i) {
+            Amount const value = int64_t(i) * COIN;
+            CMutableTransaction tx = CMutableTransaction();
+            tx.vin.resize(1);
+            tx.vin[0].scriptSig = CScript() << OP_1;
+            tx.vout.resize(1);
+            tx.vout[0].scriptPubKey = CScript() << OP_1 << OP_EQUAL;
+            tx.vout[0].nValue = value;
+            const CTransactionRef tx_r{MakeTransactionRef(tx)};
+            AddTx(tx_r, value, pool);
+        }
     }
 
     BENCHMARK_LOOP {
@@ -44,10 +47,7 @@ static void RPCMempoolVerbose(benchmark::State &state) {
     }
 }
 
-static void RPCMempoolVerbose_10k(benchmark::State &state) {
-    CTxMemPool pool;
-    LOCK2(cs_main, pool.cs);
-
+static void AddTxs_10k(CTxMemPool &pool) EXCLUSIVE_LOCKS_REQUIRED(cs_main, pool.cs) {
     constexpr size_t nTx = 10000;
     constexpr size_t nIns = 10;
     constexpr size_t nOuts = 10;
@@ -67,11 +67,35 @@ static void RPCMempoolVerbose_10k(benchmark::State &state) {
         const CTransactionRef tx_r{MakeTransactionRef(tx)};
         AddTx(tx_r, /* fee */ int64_t(i) * COIN, pool);
     }
+}
+
+static void RPCMempoolVerbose_10k(benchmark::State &state) {
+    CTxMemPool pool;
+    {
+        LOCK2(cs_main, pool.cs);
+        AddTxs_10k(pool);
+    }
 
     BENCHMARK_LOOP {
         (void)MempoolToJSON(pool, /*verbose*/ true);
     }
 }
 
+/** The time to make the snapshot for a verbose dump after an entry changed. */
+static void RPCMempoolSnapshot_10k(benchmark::State &state) {
+    CTxMemPool pool;
+    {
+        LOCK2(cs_main, pool.cs);
+        AddTxs_10k(pool);
+    }
+    const TxId txid = pool.GetSnapshot()->entries.front().tx->GetId();
+
+    BENCHMARK_LOOP {
+        pool.PrioritiseTransaction(txid, SATOSHI);
+        (void)pool.GetSnapshot();
+    }
+}
+
 BENCHMARK(RPCMempoolVerbose, 112);
 BENCHMARK(RPCMempoolVerbose_10k, 10);
+BENCHMARK(RPCMempoolSnapshot_10k, 10);
@@ -0,0 +1,102 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <config.h>
+#include <hash.h>
+#include <net.h>
+#include <netmessagemaker.h>
+#include <protocol.h>
+#include <streams.h>
+#include <util/system.h>
+#include <version.h>
+
+#include <test/util.h>
+
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+#ifndef WIN32
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * The time one SocketHandler() call takes to receive a ping from one peer,
+ * while numIdle other peers have nothing to say.
+ */
+static void SocketEvents(benchmark::State &state, SocketEventsMode mode, int numIdle) {
+    const Config &config = GetConfig();
+    assert(RaiseFileDescriptorLimit(2 * numIdle + 100) >= 2 * numIdle + 100);
+
+    CConnmanTest connman(config, 0x1337, 0x1337);
+    CConnman::Options options;
+    options.socketEventsMode = mode;
+    options.nReceiveFloodSize = 10 * 1000 * 1000;
+    connman.Init(options);
+
+    std::vector<int> peerSockets;
+    CNode *pnodeActive = nullptr;
+    for (int i = 0; i <= numIdle; ++i) {
+        int sockets[2];
+        assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+        CNode *pnode = new CNode(i, NODE_NETWORK, 0, sockets[0], CAddress(), i, i, CAddress(), "", true);
+        connman.AddNode(*pnode);
+        peerSockets.push_back(sockets[1]);
+        if (!pnodeActive) {
+            pnodeActive = pnode;
+        }
+    }
+
+    CSerializedNetMsg msg = CNetMsgMaker(INIT_PROTO_VERSION).Make(NetMsgType::PING, uint64_t(0));
+    CMessageHeader hdr(config.GetChainParams().NetMagic(), msg.m_type.c_str(), msg.data.size());
+    const uint256 hash = Hash(msg.data);
+    std::memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
+    CDataStream ping(SER_NETWORK, INIT_PROTO_VERSION);
+    ping << hdr;
+    ping.write(reinterpret_cast<const char *>(msg.data.data()), msg.data.size());
+
+    BENCHMARK_LOOP {
+        assert(write(peerSockets[0], ping.data(), ping.size()) == ssize_t(ping.size()));
+        connman.SocketHandler();
+        LOCK(pnodeActive->cs_vProcessMsg);
+        assert(pnodeActive->vProcessMsg.size() == 1);
+        pnodeActive->vProcessMsg.clear();
+        pnodeActive->nProcessQueueSize = 0;
+    }
+
+    connman.ClearNodes();
+    for (const int socket : peerSockets) {
+        close(socket);
+    }
+}
+
+#ifdef USE_EPOLL
+static void SocketEvents_EPoll_100(benchmark::State &state) {
+    SocketEvents(state, SocketEventsMode::EPoll, 100);
+}
+static void SocketEvents_EPoll_1000(benchmark::State &state) {
+    SocketEvents(state, SocketEventsMode::EPoll, 1000);
+}
+BENCHMARK(SocketEvents_EPoll_100, 5000);
+BENCHMARK(SocketEvents_EPoll_1000, 1000);
+#endif
+
+#ifdef USE_POLL
+static void SocketEvents_Poll_100(benchmark::State &state) {
+    SocketEvents(state, SocketEventsMode::Poll, 100);
+}
+static void SocketEvents_Poll_1000(benchmark::State &state) {
+    SocketEvents(state, SocketEventsMode::Poll, 1000);
+}
+BENCHMARK(SocketEvents_Poll_100, 5000);
+BENCHMARK(SocketEvents_Poll_1000, 1000);
+#else
+static void SocketEvents_Select_100(benchmark::State &state) {
+    SocketEvents(state, SocketEventsMode::Select, 100);
+}
+BENCHMARK(SocketEvents_Select_100, 5000);
+#endif
+
+#endif // WIN32
@@ -3,6 +3,8 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <bench/bench.h>
+#include <bench/data.h>
+#include <util/strencodings.h>
 #include <util/string.h>
 
 #include <algorithm>
@@ -70,6 +72,50 @@ void String_Split_300_20(benchmark::State &state) { DoBench(state, 300, 20); }
 void String_Split_1000_0(benchmark::State &state) { DoBench(state, 1000, 0); }
 void String_Split_1000_5(benchmark::State &state) { DoBench(state, 1000, 5); }
 void String_Split_1000_100(benchmark::State &state) { DoBench(state, 1000, 100); }
+
+// The hex benches encode and decode a whole block (of 999,887 bytes) or a
+// typical transaction's worth (226 bytes) of it: MB/s is that size divided by
+// the time per iteration.
+const std::vector<uint8_t> &HexBenchBlock() {
+    HexAutoDetect();
+    return benchmark::data::Get_block413567();
+}
+
+void HexStr_Block(benchmark::State &state) {
+    const auto &block = HexBenchBlock();
+    BENCHMARK_LOOP {
+        benchmark::NoOptimize(HexStr(block));
+    }
+}
+
+// The byte at a time implementation, for comparison.
+void HexStr_Block_Bytewise(benchmark::State &state) {
+    const auto &block = HexBenchBlock();
+    BENCHMARK_LOOP {
+        benchmark::NoOptimize(HexStr(block.begin(), block.end()));
+    }
+}
+
+void HexStr_Tx(benchmark::State &state) {
+    const Span<const uint8_t> tx = Span{HexBenchBlock()}.first(226);
+    BENCHMARK_LOOP {
+        benchmark::NoOptimize(HexStr(tx));
+    }
+}
+
+void ParseHex_Block(benchmark::State &state) {
+    const std::string hex = HexStr(HexBenchBlock());
+    BENCHMARK_LOOP {
+        benchmark::NoOptimize(ParseHex(hex));
+    }
+}
+
+void ParseHex_Tx(benchmark::State &state) {
+    const std::string hex = HexStr(Span{HexBenchBlock()}.first(226));
+    BENCHMARK_LOOP {
+        benchmark::NoOptimize(ParseHex(hex));
+    }
+}
 } // namespace
 
 BENCHMARK(String_Split_5_0, 1200000);
@@ -96,3 +142,9 @@ BENCHMARK(String_Split_300_20, 400000);
 BENCHMARK(String_Split_1000_0, 200000);
 BENCHMARK(String_Split_1000_5, 200000);
 BENCHMARK(String_Split_1000_100, 200000);
+
+BENCHMARK(HexStr_Block, 1000);
+BENCHMARK(HexStr_Block_Bytewise, 500);
+BENCHMARK(HexStr_Tx, 2000000);
+BENCHMARK(ParseHex_Block, 500);
+BENCHMARK(ParseHex_Tx, 1000000);
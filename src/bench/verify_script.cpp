@@ -7,7 +7,9 @@
 #include <bench/data.h>
 #include <chainparams.h>
 #include <coins.h>
+#include <hash.h>
 #include <key.h>
+#include <pubkey.h>
 #if defined(HAVE_CONSENSUS_LIB)
 #include <script/fittexxcoinconsensus.h>
 #endif
@@ -143,6 +145,53 @@ static void VerifyBlockScripts(bool reallyCheckSigs,
     }
 }
 
+// Verify a set of independent Schnorr signatures, either one at a time or
+// as a single batch (as ConnectBlock's script-check workers do).
+static void VerifySchnorrSigs(bool batched, size_t nSigs, benchmark::State &state) {
+    std::vector<SchnorrSigCheck> checks(nSigs);
+    for (size_t i = 0; i < nSigs; ++i) {
+        CKey key;
+        key.MakeNewKey(true);
+        checks[i].pubkey = key.GetPubKey();
+        checks[i].hash = SerializeHash(uint64_t(i));
+        std::vector<uint8_t> vchSig;
+        if (!key.SignSchnorr(checks[i].hash, vchSig) || vchSig.size() != checks[i].sig.size()) {
+            throw std::runtime_error("Schnorr signing failed");
+        }
+        std::copy(vchSig.begin(), vchSig.end(), checks[i].sig.begin());
+    }
+
+    BENCHMARK_LOOP {
+        bool ok = true;
+        if (batched) {
+            ok = CPubKey::VerifySchnorrBatch(checks);
+        } else {
+            for (const auto &check : checks) {
+                ok &= check.pubkey.VerifySchnorr(check.hash, {check.sig.begin(), check.sig.end()});
+            }
+        }
+        if (!ok) {
+            throw std::runtime_error("Schnorr verification failed");
+        }
+    }
+}
+
+static void VerifySchnorrSigs_Single_64(benchmark::State &state) {
+    VerifySchnorrSigs(false, 64, state);
+}
+
+static void VerifySchnorrSigs_Batch_64(benchmark::State &state) {
+    VerifySchnorrSigs(true, 64, state);
+}
+
+static void VerifySchnorrSigs_Single_1024(benchmark::State &state) {
+    VerifySchnorrSigs(false, 1024, state);
+}
+
+static void VerifySchnorrSigs_Batch_1024(benchmark::State &state) {
+    VerifySchnorrSigs(true, 1024, state);
+}
+
 static const uint32_t flags_413567 = SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_DERSIG | SCRIPT_VERIFY_CHECKLOCKTIMEVERIFY;
 static const uint32_t flags_556034 = flags_413567 | SCRIPT_VERIFY_CHECKSEQUENCEVERIFY | SCRIPT_VERIFY_STRICTENC
                                      | SCRIPT_ENABLE_SIGHASH_FORKID | SCRIPT_VERIFY_LOW_S | SCRIPT_VERIFY_NULLFAIL;
@@ -170,6 +219,11 @@ static void VerifyScripts_SigsChecks_Block556034(benchmark::State &state) {
 
 BENCHMARK(VerifyNestedIfScript, 100);
 
+BENCHMARK(VerifySchnorrSigs_Single_64, 20);
+BENCHMARK(VerifySchnorrSigs_Batch_64, 20);
+BENCHMARK(VerifySchnorrSigs_Single_1024, 2);
+BENCHMARK(VerifySchnorrSigs_Batch_1024, 2);
+
 // These benchmarks just test the script VM itself, without doing real sigchecks
 BENCHMARK(VerifyScripts_Block413567, 60);
 BENCHMARK(VerifyScripts_Block556034, 3);
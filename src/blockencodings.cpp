@@ -17,7 +17,8 @@
 #include <util/system.h>
 #include <validation.h>
 
-#include <unordered_map>
+#include <limits>
+#include <vector>
 
 CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock &block)
     : nonce(GetRand(std::numeric_limits<uint64_t>::max())),
@@ -49,6 +50,96 @@ uint64_t CBlockHeaderAndShortTxIDs::GetShortID(const TxHash &txhash) const {
     return SipHashUint256(shorttxidk0, shorttxidk1, txhash) & 0xffffffffffffL;
 }
 
+void CBlockHeaderAndShortTxIDs::GetShortIDs(const uint256 *txhashes, uint64_t *out, size_t count) const {
+    SipHashUint256Batch(shorttxidk0, shorttxidk1, txhashes, out, count);
+    for (size_t i = 0; i < count; ++i) {
+        out[i] &= 0xffffffffffffL;
+    }
+}
+
+namespace {
+/**
+ * Map from the short IDs of a compact block to the positions of their
+ * transactions, with open addressing and linear probing.
+ *
+ * Short IDs are uniformly distributed, so their low bits directly give the
+ * slot to start from, and the table is kept at most half full: looking up the
+ * short ID of a mempool transaction which is not in the block, by far the most
+ * common case, mostly touches one or two slots.
+ */
+class ShortIdTable {
+    static constexpr uint64_t EMPTY = std::numeric_limits<uint64_t>::max();
+
+    struct Slot {
+        uint64_t shortid = EMPTY;
+        uint32_t index = 0;
+    };
+
+    std::vector<Slot> slots;
+    size_t mask;
+
+public:
+    /**
+     * Well-formed cmpctblock messages have uniformly distributed short IDs,
+     * so a run of occupied slots longer than this, which is vanishingly
+     * unlikely in a table at most half full, can be safely treated as
+     * READ_STATUS_FAILED.
+     */
+    static constexpr size_t MAX_PROBES = 256;
+
+    explicit ShortIdTable(size_t count) {
+        size_t size = 4;
+        while (size < 2 * count) {
+            size *= 2;
+        }
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    /**
+     * Returns false if the short ID is already in the table, or if too many
+     * slots had to be probed.
+     */
+    bool Insert(uint64_t shortid, uint32_t index) {
+        for (size_t i = shortid & mask, probes = 0; probes < MAX_PROBES; i = (i + 1) & mask, ++probes) {
+            Slot &slot = slots[i];
+            if (slot.shortid == EMPTY) {
+                slot.shortid = shortid;
+                slot.index = index;
+                return true;
+            }
+            if (slot.shortid == shortid) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Sets index to the position of the transaction with the short ID, or to
+     * nullptr if it is not in the table. Returns false if too many slots had
+     * to be probed.
+     */
+    bool Find(uint64_t shortid, const uint32_t *&index) const {
+        for (size_t i = shortid & mask, probes = 0; probes < MAX_PROBES; i = (i + 1) & mask, ++probes) {
+            const Slot &slot = slots[i];
+            if (slot.shortid == shortid) {
+                index = &slot.index;
+                return true;
+            }
+            if (slot.shortid == EMPTY) {
+                index = nullptr;
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+//! The number of mempool transactions whose short IDs are computed at once.
+constexpr size_t SHORTID_BATCH_SIZE = 64;
+} // namespace
+
 ReadStatus PartiallyDownloadedBlock::InitData(
     const CBlockHeaderAndShortTxIDs &cmpctblock,
     const std::vector<std::pair<TxHash, CTransactionRef>> &extra_txns) {
@@ -95,80 +186,85 @@ ReadStatus PartiallyDownloadedBlock::InitData(
     // (or don't). Because well-formed cmpctblock messages will have a
     // (relatively) uniform distribution of short IDs, any highly-uneven
     // distribution of elements can be safely treated as a READ_STATUS_FAILED.
-    std::unordered_map<uint64_t, uint32_t> shorttxids(
-        cmpctblock.shorttxids.size());
+    const size_t shorttxids_count = cmpctblock.shorttxids.size();
+    ShortIdTable shorttxids(shorttxids_count);
     uint32_t index_offset = 0;
-    for (size_t i = 0; i < cmpctblock.shorttxids.size(); i++) {
+    for (size_t i = 0; i < shorttxids_count; i++) {
         while (txns_available[i + index_offset]) {
             index_offset++;
         }
 
-        shorttxids[cmpctblock.shorttxids[i]] = i + index_offset;
-        // To determine the chance that the number of entries in a bucket
-        // exceeds N, we use the fact that the number of elements in a single
-        // bucket is binomially distributed (with n = the number of shorttxids
-        // S, and p = 1 / the number of buckets), that in the worst case the
-        // number of buckets is equal to S (due to std::unordered_map having a
-        // default load factor of 1.0), and that the chance for any bucket to
-        // exceed N elements is at most buckets * (the chance that any given
-        // bucket is above N elements). Thus: P(max_elements_per_bucket > N) <=
-        // S * (1 - cdf(binomial(n=S,p=1/S), N)). If we assume blocks of up to
-        // 16000, allowing 12 elements per bucket should only fail once per ~1
-        // million block transfers (per peer and connection).
-        if (shorttxids.bucket_size(
-                shorttxids.bucket(cmpctblock.shorttxids[i])) > 12) {
+        // TODO: in the shortid-collision case, we should instead request both
+        // transactions which collided. Falling back to full-block-request here
+        // is overkill.
+        if (!shorttxids.Insert(cmpctblock.shorttxids[i], i + index_offset)) {
+            // Short ID collision, or uneven distribution
             return READ_STATUS_FAILED;
         }
     }
 
-    // TODO: in the shortid-collision case, we should instead request both
-    // transactions which collided. Falling back to full-block-request here is
-    // overkill.
-    if (shorttxids.size() != cmpctblock.shorttxids.size()) {
-        // Short ID collision
-        return READ_STATUS_FAILED;
-    }
-
     std::vector<bool> have_txn(txns_available.size());
     {
         LOCK(pool->cs);
-        for (auto &entry : pool->GetIndex()) {
-            uint64_t shortid = cmpctblock.GetShortID(entry.GetTx().GetHash());
-            std::unordered_map<uint64_t, uint32_t>::iterator idit =
-                shorttxids.find(shortid);
-            if (idit != shorttxids.end()) {
-                if (!have_txn[idit->second]) {
-                    txns_available[idit->second] = entry.GetSharedTx();
-                    have_txn[idit->second] = true;
-                    mempool_count++;
-                } else {
-                    // If we find two mempool txn that match the short id, just
-                    // request it. This should be rare enough that the extra
-                    // bandwidth doesn't matter, but eating a round-trip due to
-                    // FillBlock failure would be annoying.
-                    if (txns_available[idit->second]) {
-                        txns_available[idit->second].reset();
-                        mempool_count--;
+        // The short IDs are computed a batch of transactions at a time, which
+        // lets several of them be hashed at once.
+        const CTxMemPoolEntry *entries[SHORTID_BATCH_SIZE];
+        uint256 txhashes[SHORTID_BATCH_SIZE];
+        uint64_t shortids[SHORTID_BATCH_SIZE];
+        const auto &index = pool->GetIndex();
+        auto it = index.begin();
+        while (it != index.end() && mempool_count != shorttxids_count) {
+            size_t count = 0;
+            for (; it != index.end() && count < SHORTID_BATCH_SIZE; ++it, ++count) {
+                entries[count] = &*it;
+                txhashes[count] = it->GetTx().GetHash();
+            }
+            cmpctblock.GetShortIDs(txhashes, shortids, count);
+
+            for (size_t i = 0; i < count; ++i) {
+                const uint32_t *idit;
+                if (!shorttxids.Find(shortids[i], idit)) {
+                    // Uneven distribution of the short IDs
+                    return READ_STATUS_FAILED;
+                }
+                if (idit) {
+                    if (!have_txn[*idit]) {
+                        txns_available[*idit] = entries[i]->GetSharedTx();
+                        have_txn[*idit] = true;
+                        mempool_count++;
+                    } else {
+                        // If we find two mempool txn that match the short id,
+                        // just request it. This should be rare enough that the
+                        // extra bandwidth doesn't matter, but eating a
+                        // round-trip due to FillBlock failure would be
+                        // annoying.
+                        if (txns_available[*idit]) {
+                            txns_available[*idit].reset();
+                            mempool_count--;
+                        }
                     }
                 }
-            }
-            // Though ideally we'd continue scanning for the
-            // two-txn-match-shortid case, the performance win of an early exit
-            // here is too good to pass up and worth the extra risk.
-            if (mempool_count == shorttxids.size()) {
-                break;
+                // Though ideally we'd continue scanning for the
+                // two-txn-match-shortid case, the performance win of an early
+                // exit here is too good to pass up and worth the extra risk.
+                if (mempool_count == shorttxids_count) {
+                    break;
+                }
             }
         }
     }
 
     for (auto &extra_txn : extra_txns) {
         uint64_t shortid = cmpctblock.GetShortID(extra_txn.first);
-        std::unordered_map<uint64_t, uint32_t>::iterator idit =
-            shorttxids.find(shortid);
-        if (idit != shorttxids.end()) {
-            if (!have_txn[idit->second]) {
-                txns_available[idit->second] = extra_txn.second;
-                have_txn[idit->second] = true;
+        const uint32_t *idit;
+        if (!shorttxids.Find(shortid, idit)) {
+            // Uneven distribution of the short IDs
+            return READ_STATUS_FAILED;
+        }
+        if (idit) {
+            if (!have_txn[*idit]) {
+                txns_available[*idit] = extra_txn.second;
+                have_txn[*idit] = true;
                 mempool_count++;
                 extra_count++;
             } else {
@@ -178,10 +274,10 @@ ReadStatus PartiallyDownloadedBlock::InitData(
                 // FillBlock failure would be annoying. Note that we don't want
                 // duplication between extra_txns and mempool to trigger this
                 // case, so we compare hashes first.
-                if (txns_available[idit->second] &&
-                    txns_available[idit->second]->GetHash() !=
+                if (txns_available[*idit] &&
+                    txns_available[*idit]->GetHash() !=
                         extra_txn.second->GetHash()) {
-                    txns_available[idit->second].reset();
+                    txns_available[*idit].reset();
                     mempool_count--;
                     extra_count--;
                 }
@@ -191,7 +287,7 @@ ReadStatus PartiallyDownloadedBlock::InitData(
         // Though ideally we'd continue scanning for the two-txn-match-shortid
         // case, the performance win of an early exit here is too good to pass
         // up and worth the extra risk.
-        if (mempool_count == shorttxids.size()) {
+        if (mempool_count == shorttxids_count) {
             break;
         }
     }
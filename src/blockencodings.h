@@ -117,6 +117,8 @@ public:
     CBlockHeaderAndShortTxIDs(const CBlock &block);
 
     uint64_t GetShortID(const TxHash &txhash) const;
+    //! out[i] = GetShortID(txhashes[i]) for i in [0, count).
+    void GetShortIDs(const uint256 *txhashes, uint64_t *out, size_t count) const;
 
     size_t BlockTxCount() const {
         return shorttxids.size() + prefilledtxn.size();
@@ -13,6 +13,7 @@
 #include <util/saltedhashers.h>
 
 #include <cstdint>
+#include <set>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -97,6 +98,12 @@ const std::string &BlockFilterTypeName(BlockFilterType filter_type);
 bool BlockFilterTypeByName(const std::string &name,
                            BlockFilterType &filter_type);
 
+/** Get a list of known filter types. */
+const std::set<BlockFilterType> &AllBlockFilterTypes();
+
+/** Get a comma-separated list of known filter type names. */
+const std::string &ListBlockFilterTypes();
+
 /**
  * Complete block filter struct as defined in BIP 157. Serialization matches
  * payload of "cfilter" messages.
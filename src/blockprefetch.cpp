@@ -0,0 +1,180 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockprefetch.h>
+
+#include <chain.h>
+#include <tinyformat.h>
+#include <util/threadnames.h>
+
+#include <algorithm>
+#include <cassert>
+
+CBlockPrefetcher::CBlockPrefetcher(ReadBlockFn readBlockIn)
+    : readBlock(std::move(readBlockIn)) {}
+
+CBlockPrefetcher::~CBlockPrefetcher() {
+    Stop();
+}
+
+void CBlockPrefetcher::Start(int threads_num, int depth) {
+    assert(m_worker_threads.empty());
+    if (threads_num <= 0 || depth <= 0) {
+        return;
+    }
+    WITH_LOCK(m_mutex, m_request_stop = false);
+    m_worker_threads.reserve(threads_num);
+    for (int n = 0; n < threads_num; ++n) {
+        m_worker_threads.emplace_back([this, n]() {
+            util::ThreadRename(strprintf("blkprefetch.%i", n));
+            WorkerLoop();
+        });
+    }
+    // Only schedule work once there are workers to do it.
+    WITH_LOCK(m_mutex, m_depth = depth);
+}
+
+void CBlockPrefetcher::Stop() {
+    {
+        LOCK(m_mutex);
+        m_request_stop = true;
+        m_depth = 0;
+    }
+    m_work_cv.notify_all();
+    m_ready_cv.notify_all();
+    for (std::thread &t : m_worker_threads) {
+        t.join();
+    }
+    m_worker_threads.clear();
+    Clear();
+}
+
+void CBlockPrefetcher::Clear() {
+    LOCK(m_mutex);
+    m_entries.clear();
+    m_ready_cv.notify_all();
+}
+
+void CBlockPrefetcher::Schedule(const CBlockIndex *pindexTip,
+                                const CBlockIndex *pindexTarget) {
+    LOCK(m_mutex);
+    if (m_depth <= 0 || !pindexTarget) {
+        return;
+    }
+    const int tipHeight = pindexTip ? pindexTip->nHeight : -1;
+
+    // Forget the blocks that are already connected or no longer on the way
+    // to pindexTarget (after a reorg or when the target changed). Workers
+    // reading one of those drop the result.
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        const int height = it->first;
+        if (height <= tipHeight || height > pindexTarget->nHeight ||
+            pindexTarget->GetAncestor(height) != it->second.pindex) {
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    bool queued = false;
+    const int lastHeight = std::min(tipHeight + m_depth, pindexTarget->nHeight);
+    for (int height = tipHeight + 1; height <= lastHeight; ++height) {
+        if (m_entries.count(height)) {
+            continue;
+        }
+        const CBlockIndex *pindex = pindexTarget->GetAncestor(height);
+        if (!pindex->nStatus.hasData()) {
+            // Blocks are connected in order, so there is no point in reading
+            // past a block we do not have yet.
+            break;
+        }
+        m_entries.emplace(height, Entry{pindex, pindex->GetBlockHash(),
+                                        pindex->GetBlockPos(), m_next_id++,
+                                        State::QUEUED, nullptr});
+        queued = true;
+    }
+    if (queued) {
+        m_work_cv.notify_all();
+    }
+}
+
+std::shared_ptr<const CBlock>
+CBlockPrefetcher::Take(const CBlockIndex *pindex) {
+    WAIT_LOCK(m_mutex, lock);
+    auto it = m_entries.find(pindex->nHeight);
+    if (it == m_entries.end() || it->second.pindex != pindex) {
+        ++m_misses;
+        return nullptr;
+    }
+    if (it->second.state == State::READING) {
+        const uint64_t id = it->second.id;
+        m_ready_cv.wait(lock, [&] {
+            it = m_entries.find(pindex->nHeight);
+            return it == m_entries.end() || it->second.id != id ||
+                   it->second.state != State::READING;
+        });
+        if (it == m_entries.end() || it->second.id != id) {
+            ++m_misses;
+            return nullptr;
+        }
+    }
+    // A queued block is not waited for: reading it right away is faster than
+    // waiting for a worker to pick it up.
+    std::shared_ptr<const CBlock> block;
+    if (it->second.state == State::READY) {
+        block = std::move(it->second.block);
+        ++m_hits;
+    } else {
+        ++m_misses;
+    }
+    m_entries.erase(it);
+    return block;
+}
+
+void CBlockPrefetcher::WorkerLoop() {
+    WAIT_LOCK(m_mutex, lock);
+    while (true) {
+        // Always read the lowest scheduled block first, as it is the one
+        // ConnectTip needs next.
+        auto it = m_entries.begin();
+        for (; it != m_entries.end(); ++it) {
+            if (it->second.state == State::QUEUED) {
+                break;
+            }
+        }
+        if (m_request_stop) {
+            return;
+        }
+        if (it == m_entries.end()) {
+            m_work_cv.wait(lock);
+            continue;
+        }
+
+        Entry &entry = it->second;
+        entry.state = State::READING;
+        const int height = it->first;
+        const uint64_t id = entry.id;
+        const FlatFilePos pos = entry.pos;
+        const BlockHash hash = entry.hash;
+
+        auto block = std::make_shared<CBlock>();
+        bool ok;
+        {
+            REVERSE_LOCK(lock);
+            ok = readBlock(*block, pos) && block->GetHash() == hash;
+        }
+
+        // The entry may have been dropped (and even replaced) meanwhile.
+        it = m_entries.find(height);
+        if (it != m_entries.end() && it->second.id == id) {
+            if (ok) {
+                it->second.state = State::READY;
+                it->second.block = std::move(block);
+            } else {
+                it->second.state = State::FAILED;
+            }
+        }
+        m_ready_cv.notify_all();
+    }
+}
@@ -0,0 +1,102 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <flatfile.h>
+#include <primitives/block.h>
+#include <sync.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class CBlockIndex;
+
+/** Default for -blockprefetch, the number of blocks read ahead of the tip */
+static constexpr int DEFAULT_BLOCK_PREFETCH = 8;
+/** Maximum for -blockprefetch */
+static constexpr int MAX_BLOCK_PREFETCH = 256;
+/** Number of threads reading and deserializing blocks ahead of the tip */
+static constexpr int BLOCK_PREFETCH_THREADS = 2;
+
+/**
+ * Reads and deserializes the next few blocks of the chain being connected on
+ * background threads, so that ConnectTip finds them already parsed instead of
+ * reading them from disk while holding cs_main.
+ *
+ * Schedule() and Take() are called by the validation code with cs_main held;
+ * the worker threads only ever touch the block position and hash captured by
+ * Schedule(), never the block index itself.
+ */
+class CBlockPrefetcher {
+public:
+    using ReadBlockFn = std::function<bool(CBlock &block, const FlatFilePos &pos)>;
+
+    explicit CBlockPrefetcher(ReadBlockFn readBlockIn);
+    ~CBlockPrefetcher();
+
+    //! Start threads_num worker threads keeping up to depth blocks ahead.
+    void Start(int threads_num, int depth);
+    //! Stop the worker threads and drop all the prefetched blocks.
+    void Stop();
+    //! Drop all the prefetched blocks (e.g. when the block index is unloaded).
+    void Clear();
+
+    /**
+     * Prefetch the blocks following pindexTip on the way to pindexTarget, and
+     * forget about blocks that are no longer ahead of pindexTip on that path.
+     * Does nothing if the worker threads are not running.
+     */
+    void Schedule(const CBlockIndex *pindexTip, const CBlockIndex *pindexTarget);
+
+    /**
+     * Return the block for pindex if it was prefetched, waiting for it if it
+     * is being read right now. Returns nullptr if the block was not scheduled
+     * (or not picked up by a worker yet, or failed to read), in which case the
+     * caller should read it itself.
+     */
+    std::shared_ptr<const CBlock> Take(const CBlockIndex *pindex);
+
+    //! Blocks served by Take(), and Take() calls that found nothing usable.
+    uint64_t GetHits() const { return WITH_LOCK(m_mutex, return m_hits); }
+    uint64_t GetMisses() const { return WITH_LOCK(m_mutex, return m_misses); }
+
+private:
+    enum class State { QUEUED, READING, READY, FAILED };
+
+    struct Entry {
+        //! Only used for lookups by Take(), never dereferenced by workers.
+        const CBlockIndex *pindex;
+        BlockHash hash;
+        FlatFilePos pos;
+        //! Distinguishes an entry from a later one at the same height.
+        uint64_t id;
+        State state;
+        std::shared_ptr<const CBlock> block;
+    };
+
+    const ReadBlockFn readBlock;
+
+    mutable Mutex m_mutex;
+    //! Signalled when an entry is queued or when stopping.
+    std::condition_variable m_work_cv;
+    //! Signalled when an entry finished reading.
+    std::condition_variable m_ready_cv;
+    //! Scheduled blocks, keyed by height.
+    std::map<int, Entry> m_entries GUARDED_BY(m_mutex);
+    uint64_t m_next_id GUARDED_BY(m_mutex){0};
+    int m_depth GUARDED_BY(m_mutex){0};
+    bool m_request_stop GUARDED_BY(m_mutex){false};
+    uint64_t m_hits GUARDED_BY(m_mutex){0};
+    uint64_t m_misses GUARDED_BY(m_mutex){0};
+
+    std::vector<std::thread> m_worker_threads;
+
+    void WorkerLoop();
+};
@@ -39,6 +39,10 @@ private:
     // Mask used to check for parked blocks.
     static const uint32_t PARKED_MASK = PARKED_FLAG | PARKED_PARENT_FLAG;
 
+    // The block was neither downloaded nor validated: it is below the base of
+    // a UTXO snapshot the chainstate was loaded from.
+    static const uint32_t ASSUMED_VALID_FLAG = 0x200;
+
 public:
     explicit constexpr BlockStatus() : status(0) {}
 
@@ -86,6 +90,12 @@ public:
                            (parkedParent ? PARKED_PARENT_FLAG : 0));
     }
 
+    bool isAssumedValid() const { return status & ASSUMED_VALID_FLAG; }
+    BlockStatus withAssumedValid(bool assumedValid = true) const {
+        return BlockStatus((status & ~ASSUMED_VALID_FLAG) |
+                           (assumedValid ? ASSUMED_VALID_FLAG : 0));
+    }
+
     /**
      * Check whether this block index entry is valid up to the passed validity
      * level.
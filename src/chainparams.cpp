@@ -619,8 +619,35 @@ public:
         // valid.
         consensus.defaultAssumeValid = BlockHash();
 
+        // All upgrades up to upgrade8 are active from the genesis block on
+        // regtest; the later ones activate at their upstream upgrade dates.
+
         // UAHF is always enabled on regtest.
-        
+        consensus.uahfHeight = 0;
+
+        // November 13, 2017 hard fork is always on on regtest.
+        consensus.daaHeight = 0;
+
+        // November 15, 2018 hard fork is always on on regtest.
+        consensus.magneticAnomalyHeight = 0;
+
+        // November 15, 2019 protocol upgrade
+        consensus.gravitonHeight = 0;
+
+        // May 15, 2020 12:00:00 UTC protocol upgrade
+        consensus.phononHeight = 0;
+
+        // Nov 15, 2020 12:00:00 UTC protocol upgrade
+        consensus.axionActivationTime = 1605441600;
+
+        // May 15, 2022 12:00:00 UTC protocol upgrade
+        consensus.upgrade8Height = 0;
+
+        // May 15, 2023 12:00:00 UTC protocol upgrade
+        consensus.upgrade9ActivationTime = 1684152000;
+
+        // May 15, 2024 12:00:00 UTC protocol upgrade
+        consensus.upgrade10ActivationTime = 1715774400;
 
         // Default limit for block size (in bytes)
         consensus.nDefaultExcessiveBlockSize = DEFAULT_EXCESSIVE_BLOCK_SIZE;
@@ -643,7 +670,16 @@ public:
         m_assumed_blockchain_size = 0;
         m_assumed_chain_state_size = 0;
 
-        
+        // The time, nonce and bits of the upstream regtest genesis block: with
+        // the 0x207fffff target, nonce 2 is a valid proof of work. Its
+        // coinbase is the one of mainnet (same message, output script and
+        // reward), so its merkle root is mainnet's too.
+        genesis = CreateGenesisBlock(1296688602, 2, 0x207fffff, 1, 25 * COIN);
+        consensus.hashGenesisBlock = genesis.GetHash();
+        assert(consensus.hashGenesisBlock ==
+               uint256S("2790576f25af81cd6a357e4c98e9545f6579830824270e5bbaa086fe7f4255aa"));
+        assert(genesis.hashMerkleRoot ==
+               uint256S("b1b8ae17a227ed0861f25859ecd0ccb28b974a2e7c6b948d7470fa1dfde5eb9a"));
 
         //! Regtest mode doesn't have any fixed seeds.
         vFixedSeeds.clear();
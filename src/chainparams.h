@@ -50,6 +50,17 @@ struct CCheckpointData {
     MapCheckpoints mapCheckpoints;
 };
 
+/**
+ * The UTXO set commitment of a block, as returned by dumputxoset, which is
+ * trusted for -loadutxoset snapshots of that block.
+ */
+struct AssumeutxoData {
+    BlockHash base_hash;
+    uint256 commitment;
+};
+
+typedef std::map<int, AssumeutxoData> MapAssumeutxo;
+
 /**
  * Holds various statistics on transactions within a chain. Used to estimate
  * verification progress during chain sync.
@@ -116,6 +127,7 @@ public:
     const std::vector<SeedSpec6> &FixedSeeds() const { return vFixedSeeds; }
     const CCheckpointData &Checkpoints() const { return checkpointData; }
     const ChainTxData &TxData() const { return chainTxData; }
+    const MapAssumeutxo &Assumeutxo() const { return m_assumeutxo_data; }
 
 protected:
     CChainParams() {}
@@ -138,6 +150,7 @@ protected:
     bool m_is_test_chain;
     CCheckpointData checkpointData;
     ChainTxData chainTxData;
+    MapAssumeutxo m_assumeutxo_data;
 };
 
 /**
@@ -10,10 +10,96 @@
 #include <util/threadnames.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 template <typename T> class CCheckQueueControl;
 
+namespace checkqueue_detail {
+//! Whether T can evaluate several checks at once with a static
+//! `bool T::RunBatch(std::vector<T> &)` (e.g. to batch signature verification).
+template <typename T, typename = void> struct HasRunBatch : std::false_type {};
+template <typename T>
+struct HasRunBatch<T, std::void_t<decltype(T::RunBatch(std::declval<std::vector<T> &>()))>>
+    : std::true_type {};
+
+//! Evaluate a worker's batch of checks, unless a check already failed.
+template <typename T> bool RunChecks(std::vector<T> &vChecks, bool fOk) {
+    if (!fOk) {
+        return false;
+    }
+    if constexpr (HasRunBatch<T>::value) {
+        return T::RunBatch(vChecks);
+    } else {
+        for (T &check : vChecks) {
+            if (!check()) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+} // namespace checkqueue_detail
+
+/** The script-check queue implementations that can be selected with -parengine */
+enum class CheckQueueEngine {
+    //! CCheckQueue: a single mutex-protected queue shared by all workers
+    LEGACY,
+    //! CWorkStealingCheckQueue: per-worker rings with work stealing
+    WORKSTEALING,
+};
+
+inline const char *GetCheckQueueEngineName(CheckQueueEngine engine) {
+    switch (engine) {
+        case CheckQueueEngine::LEGACY: return "legacy";
+        case CheckQueueEngine::WORKSTEALING: return "workstealing";
+    }
+    assert(false);
+    return "";
+}
+
+inline std::optional<CheckQueueEngine> GetCheckQueueEngineFromName(const std::string &name) {
+    for (const auto engine : {CheckQueueEngine::LEGACY, CheckQueueEngine::WORKSTEALING}) {
+        if (name == GetCheckQueueEngineName(engine)) {
+            return engine;
+        }
+    }
+    return std::nullopt;
+}
+
+/**
+ * Common interface of the check queue implementations, so that
+ * CCheckQueueControl (and thus ConnectBlock) does not need to know which
+ * engine is in use.
+ */
+template <typename T> class CCheckQueueBase {
+public:
+    //! Mutex to ensure only one concurrent CCheckQueueControl
+    Mutex m_control_mutex;
+
+    virtual ~CCheckQueueBase() = default;
+
+    //! Create a pool of new worker threads.
+    virtual void StartWorkerThreads(int threads_num) = 0;
+
+    //! Wait until execution finishes, and return whether all evaluations were
+    //! successful.
+    virtual bool Wait() = 0;
+
+    //! Add a batch of checks to the queue. The checks are moved out of
+    //! vChecks, which is left in a valid but unspecified state.
+    virtual void Add(std::vector<T> &vChecks) = 0;
+
+    //! Stop all of the worker threads.
+    virtual void StopWorkerThreads() = 0;
+};
+
 /**
  * Queue for verifications that have to be performed.
  * The verifications are represented by a type T, which must provide an
@@ -24,7 +110,7 @@ template <typename T> class CCheckQueueControl;
  * done adding work, it temporarily joins the worker pool as an N'th worker,
  * until all jobs are done.
  */
-template <typename T> class CCheckQueue {
+template <typename T> class CCheckQueue final : public CCheckQueueBase<T> {
 private:
     //! Mutex to protect the inner state
     Mutex m_mutex;
@@ -126,25 +212,18 @@ private:
                 fOk = fAllOk;
             }
             // execute work
-            for (T &check : vChecks) {
-                if (fOk) {
-                    fOk = check();
-                }
-            }
+            fOk = checkqueue_detail::RunChecks(vChecks, fOk);
             vChecks.clear();
         } while (true);
     }
 
 public:
-    //! Mutex to ensure only one concurrent CCheckQueueControl
-    Mutex m_control_mutex;
-
     //! Create a new check queue
     explicit CCheckQueue(unsigned int nBatchSizeIn)
         : nBatchSize(nBatchSizeIn) {}
 
     //! Create a pool of new worker threads.
-    void StartWorkerThreads(const int threads_num)
+    void StartWorkerThreads(const int threads_num) override
     {
         {
              LOCK(m_mutex);
@@ -163,10 +242,10 @@ public:
 
     //! Wait until execution finishes, and return whether all evaluations were
     //! successful.
-    bool Wait() { return Loop(true /* master thread */); }
+    bool Wait() override { return Loop(true /* master thread */); }
 
     //! Add a batch of checks to the queue
-    void Add(std::vector<T> &vChecks) {
+    void Add(std::vector<T> &vChecks) override {
         LOCK(m_mutex);
         for (T &check : vChecks) {
             queue.push_back(T());
@@ -181,7 +260,7 @@ public:
     }
 
     //! Stop all of the worker threads.
-    void StopWorkerThreads()
+    void StopWorkerThreads() override
     {
         WITH_LOCK(m_mutex, m_request_stop = true);
         m_worker_cv.notify_all();
@@ -192,23 +271,298 @@ public:
         WITH_LOCK(m_mutex, m_request_stop = false);
     }
 
-    ~CCheckQueue() { assert(m_worker_threads.empty()); }
+    ~CCheckQueue() override { assert(m_worker_threads.empty()); }
 };
 
+/**
+ * Work-stealing alternative to CCheckQueue.
+ *
+ * Every participant (the master, with index 0, and each worker thread) owns a
+ * bounded ring of check batches. The master spreads the batches passed to
+ * Add() over all rings in round-robin order without taking a lock, and each
+ * participant drains its own ring first before stealing from the others. The
+ * rings are single-producer (the master) / multi-consumer, so the only
+ * contended operation is a compare-and-swap on a ring's head.
+ *
+ * The mutex is only used to park threads that ran out of work: Add() takes it
+ * solely when at least one worker is asleep, and the master takes it once per
+ * Wait() if it has to wait for batches still in flight on other threads.
+ */
+template <typename T>
+class CWorkStealingCheckQueue final : public CCheckQueueBase<T> {
+private:
+    //! A unit of work: a run of checks executed in order by one thread
+    struct Batch {
+        std::vector<T> checks;
+    };
+
+    //! Bounded single-producer/multi-consumer ring of batches
+    class BatchRing {
+        static constexpr uint64_t CAPACITY = 1024;
+        static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+        std::array<std::atomic<Batch *>, CAPACITY> m_slots{};
+        //! Index of the next slot to consume, advanced by any thread via CAS
+        alignas(64) std::atomic<uint64_t> m_head{0};
+        //! Index of the next slot to fill, only ever written by the master
+        alignas(64) std::atomic<uint64_t> m_tail{0};
+
+    public:
+        //! Append a batch (master only). Returns false if the ring is full.
+        bool Push(Batch *batch) {
+            const uint64_t tail = m_tail.load(std::memory_order_relaxed);
+            // Acquire pairs with the consumer's CAS so that a slot is never
+            // overwritten before its previous value has been read.
+            if (tail - m_head.load(std::memory_order_acquire) >= CAPACITY) {
+                return false;
+            }
+            m_slots[tail & (CAPACITY - 1)].store(batch, std::memory_order_relaxed);
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        //! Take the oldest batch, or return nullptr if the ring is empty.
+        Batch *Pop() {
+            uint64_t head = m_head.load(std::memory_order_acquire);
+            while (head < m_tail.load(std::memory_order_acquire)) {
+                // If the producer has since reused this slot, head has moved
+                // on and the CAS below fails, discarding the stale read.
+                Batch *batch = m_slots[head & (CAPACITY - 1)].load(std::memory_order_relaxed);
+                if (m_head.compare_exchange_weak(head, head + 1, std::memory_order_acq_rel,
+                                                 std::memory_order_acquire)) {
+                    return batch;
+                }
+            }
+            return nullptr;
+        }
+
+        bool Empty() const {
+            return m_head.load(std::memory_order_acquire) >= m_tail.load(std::memory_order_acquire);
+        }
+    };
+
+    //! Mutex used only to park and wake idle threads
+    Mutex m_mutex;
+
+    //! Worker threads block on this when out of work
+    std::condition_variable m_worker_cv;
+
+    //! Master thread blocks on this while the last batches are in flight
+    std::condition_variable m_master_cv;
+
+    //! One ring per participant; index 0 belongs to the master. Only resized
+    //! while no worker threads are running.
+    std::vector<std::unique_ptr<BatchRing>> m_rings;
+
+    //! Ring that receives the next batch in Add() (master only)
+    size_t m_next_ring{0};
+
+    //! Number of batches added but not yet fully processed and destroyed
+    std::atomic<uint64_t> m_todo{0};
+
+    //! The temporary evaluation result
+    std::atomic<bool> m_all_ok{true};
+
+    //! Number of worker threads currently parked on m_worker_cv
+    std::atomic<int> m_num_sleeping{0};
+
+    //! The maximum number of checks in one batch
+    const unsigned int nBatchSize;
+
+    std::vector<std::thread> m_worker_threads;
+    bool m_request_stop GUARDED_BY(m_mutex){false};
+
+    bool HasWork() const {
+        for (const auto &ring : m_rings) {
+            if (!ring->Empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //! Pop from our own ring first, then try to steal from the others.
+    Batch *Steal(size_t self) {
+        const size_t n = m_rings.size();
+        for (size_t i = 0; i < n; ++i) {
+            if (Batch *batch = m_rings[(self + i) % n]->Pop()) {
+                return batch;
+            }
+        }
+        return nullptr;
+    }
+
+    void Run(Batch *batch) {
+        // Skip the work once any check has failed, but still destroy the
+        // checks, as the result is already known.
+        const bool fOk = checkqueue_detail::RunChecks(
+            batch->checks, m_all_ok.load(std::memory_order_relaxed));
+        if (!fOk) {
+            m_all_ok.store(false, std::memory_order_relaxed);
+        }
+        // Destroy the checks before the batch is accounted as done, so that
+        // Wait() never returns while checks are still alive.
+        delete batch;
+        if (m_todo.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            LOCK(m_mutex);
+            m_master_cv.notify_one();
+        }
+    }
+
+    void Publish(Batch *batch) {
+        m_todo.fetch_add(1, std::memory_order_relaxed);
+        const size_t n = m_rings.size();
+        for (size_t i = 0; i < n; ++i) {
+            BatchRing &ring = *m_rings[m_next_ring];
+            m_next_ring = (m_next_ring + 1) % n;
+            if (ring.Push(batch)) {
+                return;
+            }
+        }
+        // All rings are full: the workers are saturated, so just do the work
+        // here instead of waiting for room.
+        Run(batch);
+    }
+
+    void WorkerLoop(size_t self) {
+        while (true) {
+            if (Batch *batch = Steal(self)) {
+                Run(batch);
+                continue;
+            }
+            WAIT_LOCK(m_mutex, lock);
+            m_num_sleeping.fetch_add(1);
+            // Pairs with the fence in Add(): either Add() sees us sleeping
+            // and notifies, or we see the batches it published.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            while (!m_request_stop && !HasWork()) {
+                m_worker_cv.wait(lock);
+            }
+            m_num_sleeping.fetch_sub(1);
+            if (m_request_stop) {
+                return;
+            }
+        }
+    }
+
+public:
+    //! Create a new check queue
+    explicit CWorkStealingCheckQueue(unsigned int nBatchSizeIn)
+        : nBatchSize(std::max(1U, nBatchSizeIn)) {
+        // The master's ring, which also allows using the queue without any
+        // worker threads.
+        m_rings.push_back(std::make_unique<BatchRing>());
+    }
+
+    //! Create a pool of new worker threads.
+    void StartWorkerThreads(const int threads_num) override {
+        assert(m_worker_threads.empty());
+        assert(m_todo.load() == 0);
+        m_all_ok = true;
+        m_next_ring = 0;
+        m_rings.resize(1);
+        for (int n = 0; n < threads_num; ++n) {
+            m_rings.push_back(std::make_unique<BatchRing>());
+        }
+        for (int n = 0; n < threads_num; ++n) {
+            m_worker_threads.emplace_back([this, n]() {
+                util::ThreadRename(strprintf("scriptch.%i", n));
+                WorkerLoop(n + 1);
+            });
+        }
+    }
+
+    //! Wait until execution finishes, and return whether all evaluations were
+    //! successful.
+    bool Wait() override {
+        while (true) {
+            if (Batch *batch = Steal(0)) {
+                Run(batch);
+                continue;
+            }
+            // The master is the only producer, so once all rings are empty
+            // the remaining batches are in flight on worker threads.
+            WAIT_LOCK(m_mutex, lock);
+            while (m_todo.load(std::memory_order_acquire) != 0) {
+                m_master_cv.wait(lock);
+            }
+            break;
+        }
+        // return the current status and reset it for new work later
+        return m_all_ok.exchange(true);
+    }
+
+    //! Add a batch of checks to the queue. Must only be called by the master.
+    void Add(std::vector<T> &vChecks) override {
+        if (vChecks.empty()) {
+            return;
+        }
+        if (vChecks.size() <= nBatchSize) {
+            // Common case: take over the caller's vector without copying.
+            Publish(new Batch{std::move(vChecks)});
+            vChecks.clear();
+        } else {
+            for (size_t begin = 0; begin < vChecks.size(); begin += nBatchSize) {
+                const size_t end = std::min<size_t>(begin + nBatchSize, vChecks.size());
+                auto batch = std::make_unique<Batch>();
+                batch->checks.resize(end - begin);
+                for (size_t i = begin; i < end; ++i) {
+                    batch->checks[i - begin].swap(vChecks[i]);
+                }
+                Publish(batch.release());
+            }
+        }
+        // Pairs with the fence in WorkerLoop().
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_num_sleeping.load(std::memory_order_relaxed) > 0) {
+            LOCK(m_mutex);
+            m_worker_cv.notify_all();
+        }
+    }
+
+    //! Stop all of the worker threads.
+    void StopWorkerThreads() override {
+        WITH_LOCK(m_mutex, m_request_stop = true);
+        m_worker_cv.notify_all();
+        for (std::thread &t : m_worker_threads) {
+            t.join();
+        }
+        m_worker_threads.clear();
+        m_rings.resize(1);
+        m_next_ring = 0;
+        WITH_LOCK(m_mutex, m_request_stop = false);
+    }
+
+    ~CWorkStealingCheckQueue() override { assert(m_worker_threads.empty()); }
+};
+
+/** Create a check queue using the given engine */
+template <typename T>
+std::unique_ptr<CCheckQueueBase<T>> MakeCheckQueue(CheckQueueEngine engine, unsigned int nBatchSize) {
+    switch (engine) {
+        case CheckQueueEngine::LEGACY:
+            return std::make_unique<CCheckQueue<T>>(nBatchSize);
+        case CheckQueueEngine::WORKSTEALING:
+            return std::make_unique<CWorkStealingCheckQueue<T>>(nBatchSize);
+    }
+    assert(false);
+    return nullptr;
+}
+
 /**
  * RAII-style controller object for a CCheckQueue that guarantees the passed
  * queue is finished before continuing.
  */
 template <typename T> class CCheckQueueControl {
 private:
-    CCheckQueue<T> *const pqueue;
+    CCheckQueueBase<T> *const pqueue;
     bool fDone;
 
 public:
     CCheckQueueControl() = delete;
     CCheckQueueControl(const CCheckQueueControl &) = delete;
     CCheckQueueControl &operator=(const CCheckQueueControl &) = delete;
-    explicit CCheckQueueControl(CCheckQueue<T> *const pqueueIn)
+    explicit CCheckQueueControl(CCheckQueueBase<T> *const pqueueIn)
         : pqueue(pqueueIn), fDone(false) {
         // passed queue is supposed to be unused, or nullptr
         if (pqueue != nullptr) {
@@ -8,6 +8,7 @@
 
 #include <compressor.h>
 #include <core_memusage.h>
+#include <flatnodemap.h>
 #include <memusage.h>
 #include <primitives/blockhash.h>
 #include <serialize.h>
@@ -91,8 +92,7 @@ struct CCoinsCacheEntry {
         : coin(std::move(coinIn)), flags(0) {}
 };
 
-typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher>
-    CCoinsMap;
+typedef flatnodemap<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> CCoinsMap;
 
 /** Cursor for iterating over CoinsView state */
 class CCoinsViewCursor {
@@ -210,6 +210,12 @@ public:
      */
     bool HaveCoinInCache(const COutPoint &outpoint) const;
 
+    /**
+     * Check if this cache has an entry for the given outpoint, including one
+     * for a spent coin. If not, the backing CCoinsView is authoritative for it.
+     */
+    bool HaveEntryInCache(const COutPoint &outpoint) const;
+
     /**
      * Return a reference to Coin in the cache, or a pruned one if not found.
      * This is more efficient than GetCoin.
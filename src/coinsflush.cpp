@@ -0,0 +1,137 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <coinsflush.h>
+
+#include <logging.h>
+#include <txdb.h>
+#include <util/threadnames.h>
+#include <util/time.h>
+
+#include <cassert>
+#include <exception>
+
+CCoinsViewFlusher::CCoinsViewFlusher(CCoinsViewDB *dbIn)
+    : CCoinsViewBacked(dbIn), db(dbIn) {}
+
+CCoinsViewFlusher::~CCoinsViewFlusher() {
+    Stop();
+}
+
+void CCoinsViewFlusher::Start() {
+    assert(!m_thread.joinable());
+    WITH_LOCK(m_mutex, m_request_stop = false);
+    m_thread = std::thread([this]() {
+        util::ThreadRename("coinsflush");
+        ThreadFlush();
+    });
+}
+
+void CCoinsViewFlusher::Stop() {
+    if (!m_thread.joinable()) {
+        return;
+    }
+    // Let the write in progress complete; the database would recover from
+    // an interrupted one, but only by replaying blocks at the next start.
+    WaitForWrite();
+    WITH_LOCK(m_mutex, m_request_stop = true);
+    m_cv.notify_all();
+    m_thread.join();
+}
+
+void CCoinsViewFlusher::ThreadFlush() {
+    WAIT_LOCK(m_mutex, lock);
+    while (true) {
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_request_stop || m_writing; });
+        if (m_request_stop) {
+            return;
+        }
+        bool ok;
+        {
+            REVERSE_LOCK(lock);
+            const int64_t nStart = GetTimeMicros();
+            try {
+                ok = db->WriteCoins(m_frozen, m_frozen_block);
+            } catch (const std::exception &e) {
+                LogPrintf("Error writing to coin database: %s\n", e.what());
+                ok = false;
+            }
+            LogPrint(BCLog::COINDB, "Wrote %u coins to the coin database in the background in %.2fms\n",
+                     m_frozen.size(), (GetTimeMicros() - nStart) * 0.001);
+        }
+        m_write_ok = ok;
+        m_writing = false;
+        m_cv.notify_all();
+    }
+}
+
+void CCoinsViewFlusher::WaitForWrite() const {
+    WAIT_LOCK(m_mutex, lock);
+    m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return !m_writing; });
+}
+
+bool CCoinsViewFlusher::IsWriteComplete() const {
+    LOCK(m_mutex);
+    return !m_writing;
+}
+
+bool CCoinsViewFlusher::Wait() {
+    WaitForWrite();
+    if (!IsFlushing()) {
+        return true;
+    }
+    m_frozen.clear();
+    m_frozen_block = BlockHash();
+    LOCK(m_mutex);
+    const bool ok = m_write_ok;
+    m_write_ok = true;
+    return ok;
+}
+
+bool CCoinsViewFlusher::GetCoin(const COutPoint &outpoint, Coin &coin) const {
+    const auto it = m_frozen.find(outpoint);
+    if (it == m_frozen.end()) {
+        return base->GetCoin(outpoint, coin);
+    }
+    if (it->second.coin.IsSpent()) {
+        return false;
+    }
+    coin = it->second.coin;
+    return true;
+}
+
+bool CCoinsViewFlusher::HaveCoin(const COutPoint &outpoint) const {
+    const auto it = m_frozen.find(outpoint);
+    if (it == m_frozen.end()) {
+        return base->HaveCoin(outpoint);
+    }
+    return !it->second.coin.IsSpent();
+}
+
+BlockHash CCoinsViewFlusher::GetBestBlock() const {
+    return IsFlushing() ? m_frozen_block : base->GetBestBlock();
+}
+
+bool CCoinsViewFlusher::BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) {
+    if (!Wait()) {
+        return false;
+    }
+    if (!m_thread.joinable()) {
+        return base->BatchWrite(mapCoins, hashBlock);
+    }
+    // Like the other views, leave mapCoins empty. Entries that are not dirty
+    // are kept too, as lookups may still be made for them meanwhile.
+    m_frozen.swap(mapCoins);
+    m_frozen_block = hashBlock;
+    WITH_LOCK(m_mutex, m_writing = true);
+    m_cv.notify_all();
+    return true;
+}
+
+CCoinsViewCursor *CCoinsViewFlusher::Cursor(bool snapshot) const {
+    // The cursor iterates over the database, which is complete once the
+    // snapshot is written.
+    WaitForWrite();
+    return base->Cursor(snapshot);
+}
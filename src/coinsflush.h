@@ -0,0 +1,79 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <coins.h>
+#include <primitives/blockhash.h>
+#include <sync.h>
+
+#include <condition_variable>
+#include <thread>
+
+class CCoinsViewDB;
+
+/** Default for -backgroundflush */
+static constexpr bool DEFAULT_BACKGROUND_FLUSH = true;
+
+/**
+ * A layer between pcoinsTip and the coins database that writes the coins
+ * flushed to it to the database on a background thread.
+ *
+ * When started, BatchWrite() takes over the flushed entries as a frozen
+ * snapshot and returns right away, so that the caller does not wait for the
+ * database. The snapshot is written by CCoinsViewDB::WriteCoins(), in batches
+ * of -dbbatchsize and with the usual DB_HEAD_BLOCKS marker, so an interrupted
+ * write is recovered from by ReplayBlocks() as before. Until the write is
+ * complete, lookups are answered from the snapshot first.
+ *
+ * Only one snapshot is written at a time: BatchWrite() waits for the previous
+ * one to be written before taking a new one. Wait() must be called before the
+ * database is needed to be up to date on its own.
+ *
+ * Like the other views, this one is not thread-safe, except that lookups may
+ * be made from several threads at once, as with CCoinsViewDB.
+ */
+class CCoinsViewFlusher final : public CCoinsViewBacked {
+public:
+    explicit CCoinsViewFlusher(CCoinsViewDB *dbIn);
+    ~CCoinsViewFlusher();
+
+    void Start();
+    void Stop();
+
+    bool GetCoin(const COutPoint &outpoint, Coin &coin) const override;
+    bool HaveCoin(const COutPoint &outpoint) const override;
+    BlockHash GetBestBlock() const override;
+    bool BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) override;
+    CCoinsViewCursor *Cursor(bool snapshot = false) const override;
+
+    //! Whether a snapshot is being written, or was written but not released.
+    bool IsFlushing() const { return !m_frozen_block.IsNull(); }
+    //! Whether the writing of the snapshot is complete (or there is none).
+    bool IsWriteComplete() const;
+
+    /**
+     * Wait until the snapshot is written, and release it. Returns false if
+     * writing it failed.
+     */
+    bool Wait();
+
+private:
+    CCoinsViewDB *db;
+
+    //! The snapshot, only modified while no write is in progress.
+    CCoinsMap m_frozen;
+    BlockHash m_frozen_block;
+
+    mutable Mutex m_mutex;
+    mutable std::condition_variable m_cv;
+    bool m_writing GUARDED_BY(m_mutex){false};
+    bool m_write_ok GUARDED_BY(m_mutex){true};
+    bool m_request_stop GUARDED_BY(m_mutex){false};
+
+    std::thread m_thread;
+
+    void ThreadFlush();
+    void WaitForWrite() const;
+};
@@ -0,0 +1,171 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <coinsprefetch.h>
+
+#include <primitives/block.h>
+#include <tinyformat.h>
+#include <util/threadnames.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <unordered_set>
+
+void CCoinsViewPrefetched::Stage(const COutPoint &outpoint, std::optional<Coin> &&coin) {
+    coins.emplace(outpoint, std::move(coin));
+}
+
+bool CCoinsViewPrefetched::GetCoin(const COutPoint &outpoint, Coin &coin) const {
+    const auto it = coins.find(outpoint);
+    if (it == coins.end()) {
+        ++nMisses;
+        return base->GetCoin(outpoint, coin);
+    }
+    ++nHits;
+    if (!it->second) {
+        return false;
+    }
+    coin = *it->second;
+    return true;
+}
+
+bool CCoinsViewPrefetched::HaveCoin(const COutPoint &outpoint) const {
+    Coin coin;
+    return GetCoin(outpoint, coin);
+}
+
+/** The lookups of one Fetch() call, shared by all the threads working on it. */
+struct CCoinsPrefetcher::Job {
+    //! Lookups are claimed by the threads this many at a time.
+    static constexpr size_t CHUNK_SIZE = 16;
+
+    enum class Result : uint8_t { FAILED, FOUND, MISSING };
+
+    const CCoinsView &db;
+    const std::vector<COutPoint> &outpoints;
+    std::vector<Coin> coins;
+    std::vector<Result> results;
+    std::atomic<size_t> next{0};
+
+    Job(const CCoinsView &dbIn, const std::vector<COutPoint> &outpointsIn)
+        : db(dbIn), outpoints(outpointsIn), coins(outpointsIn.size()),
+          results(outpointsIn.size(), Result::FAILED) {}
+};
+
+CCoinsPrefetcher::~CCoinsPrefetcher() {
+    Stop();
+}
+
+void CCoinsPrefetcher::Start(int threads_num) {
+    assert(m_worker_threads.empty());
+    WITH_LOCK(m_mutex, m_request_stop = false);
+    m_worker_threads.reserve(threads_num);
+    for (int n = 0; n < threads_num; ++n) {
+        m_worker_threads.emplace_back([this, n]() {
+            util::ThreadRename(strprintf("coinprefetch.%i", n));
+            WorkerLoop();
+        });
+    }
+}
+
+void CCoinsPrefetcher::Stop() {
+    WITH_LOCK(m_mutex, m_request_stop = true);
+    m_work_cv.notify_all();
+    for (std::thread &t : m_worker_threads) {
+        t.join();
+    }
+    m_worker_threads.clear();
+}
+
+void CCoinsPrefetcher::Work(Job &job) {
+    const size_t n = job.outpoints.size();
+    for (size_t begin; (begin = job.next.fetch_add(Job::CHUNK_SIZE)) < n;) {
+        const size_t end = std::min(begin + Job::CHUNK_SIZE, n);
+        for (size_t i = begin; i < end; ++i) {
+            try {
+                job.results[i] = job.db.GetCoin(job.outpoints[i], job.coins[i]) ? Job::Result::FOUND : Job::Result::MISSING;
+            } catch (const std::exception &) {
+                job.results[i] = Job::Result::FAILED;
+            }
+        }
+    }
+}
+
+void CCoinsPrefetcher::WorkerLoop() {
+    uint64_t last_job_id = 0;
+    WAIT_LOCK(m_mutex, lock);
+    while (true) {
+        m_work_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+            return m_request_stop || (m_job && m_job_id != last_job_id);
+        });
+        if (m_request_stop) {
+            return;
+        }
+        last_job_id = m_job_id;
+        Job &job = *m_job;
+        ++m_busy;
+        {
+            REVERSE_LOCK(lock);
+            Work(job);
+        }
+        if (--m_busy == 0) {
+            m_done_cv.notify_one();
+        }
+    }
+}
+
+void CCoinsPrefetcher::Fetch(const CCoinsView &db, const std::vector<COutPoint> &outpoints,
+                             CCoinsViewPrefetched &staging) {
+    Job job(db, outpoints);
+    {
+        LOCK(m_mutex);
+        m_job = &job;
+        ++m_job_id;
+    }
+    m_work_cv.notify_all();
+    Work(job);
+    {
+        // All the lookups have been claimed; wait for the workers still
+        // finishing theirs, and make sure no late worker joins.
+        WAIT_LOCK(m_mutex, lock);
+        m_done_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_busy == 0; });
+        m_job = nullptr;
+    }
+
+    for (size_t i = 0; i < outpoints.size(); ++i) {
+        switch (job.results[i]) {
+            case Job::Result::FOUND:
+                staging.Stage(outpoints[i], std::move(job.coins[i]));
+                break;
+            case Job::Result::MISSING:
+                staging.Stage(outpoints[i], std::nullopt);
+                break;
+            case Job::Result::FAILED:
+                break;
+        }
+    }
+}
+
+std::vector<COutPoint> CCoinsPrefetcher::GetUncachedOutpoints(const CBlock &block,
+                                                              const CCoinsViewCache &cache) {
+    std::unordered_set<TxId, SaltedTxIdHasher> created;
+    created.reserve(block.vtx.size());
+    for (const auto &tx : block.vtx) {
+        created.insert(tx->GetId());
+    }
+
+    std::vector<COutPoint> outpoints;
+    for (const auto &tx : block.vtx) {
+        if (tx->IsCoinBase()) {
+            continue;
+        }
+        for (const CTxIn &txin : tx->vin) {
+            if (!created.count(txin.prevout.GetTxId()) && !cache.HaveEntryInCache(txin.prevout)) {
+                outpoints.push_back(txin.prevout);
+            }
+        }
+    }
+    return outpoints;
+}
@@ -0,0 +1,104 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <coins.h>
+#include <primitives/transaction.h>
+#include <sync.h>
+#include <util/saltedhashers.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class CBlock;
+
+/** Default for -prefetchcoins, the number of threads warming coins before ConnectBlock */
+static constexpr int DEFAULT_COINS_PREFETCH_THREADS = 4;
+/** Maximum for -prefetchcoins */
+static constexpr int MAX_COINS_PREFETCH_THREADS = 64;
+/** Below this many uncached inputs, a block's coins are not worth fetching in parallel */
+static constexpr size_t COINS_PREFETCH_MIN_OUTPOINTS = 32;
+
+/**
+ * A staging layer holding coins fetched ahead of time from the database, to be
+ * placed between a block's CCoinsViewCache and pcoinsTip while connecting it.
+ *
+ * Only coins that are not in the cache above the database are staged, so the
+ * database answer is the current one. Lookups for other coins, as well as
+ * writes, go to the backing view.
+ */
+class CCoinsViewPrefetched : public CCoinsViewBacked {
+    //! Staged coins; std::nullopt records that the coin does not exist.
+    std::unordered_map<COutPoint, std::optional<Coin>, SaltedOutpointHasher> coins;
+    mutable uint64_t nHits = 0;
+    mutable uint64_t nMisses = 0;
+
+public:
+    explicit CCoinsViewPrefetched(CCoinsView *viewIn) : CCoinsViewBacked(viewIn) {}
+
+    void Stage(const COutPoint &outpoint, std::optional<Coin> &&coin);
+
+    bool GetCoin(const COutPoint &outpoint, Coin &coin) const override;
+    bool HaveCoin(const COutPoint &outpoint) const override;
+
+    size_t GetStagedCount() const { return coins.size(); }
+    //! Lookups answered by the staged coins, and lookups passed to the backing view.
+    uint64_t GetHits() const { return nHits; }
+    uint64_t GetMisses() const { return nMisses; }
+};
+
+/**
+ * Fetches coins from a thread-safe CCoinsView (the database) in parallel on a
+ * pool of worker threads, so that the lookups of a block whose inputs are not
+ * cached do not run one after another inside ConnectBlock.
+ */
+class CCoinsPrefetcher {
+public:
+    CCoinsPrefetcher() = default;
+    ~CCoinsPrefetcher();
+
+    void Start(int threads_num);
+    void Stop();
+
+    bool IsActive() const { return !m_worker_threads.empty(); }
+
+    /**
+     * Look up outpoints in db, using the worker threads and the calling
+     * thread, and stage the results in staging. Outpoints whose lookup throws
+     * are not staged, so that the error surfaces on the regular path.
+     */
+    void Fetch(const CCoinsView &db, const std::vector<COutPoint> &outpoints,
+               CCoinsViewPrefetched &staging);
+
+    /**
+     * Collect the outpoints spent by block that are neither created by the
+     * block itself nor have an entry in cache. A spent entry counts: the
+     * database would still return the coin.
+     */
+    static std::vector<COutPoint> GetUncachedOutpoints(const CBlock &block,
+                                                       const CCoinsViewCache &cache);
+
+private:
+    struct Job;
+
+    Mutex m_mutex;
+    std::condition_variable m_work_cv;
+    std::condition_variable m_done_cv;
+    Job *m_job GUARDED_BY(m_mutex){nullptr};
+    //! Incremented for each job, so that a worker joins each job only once.
+    uint64_t m_job_id GUARDED_BY(m_mutex){0};
+    //! Number of workers currently working on m_job.
+    int m_busy GUARDED_BY(m_mutex){0};
+    bool m_request_stop GUARDED_BY(m_mutex){false};
+
+    std::vector<std::thread> m_worker_threads;
+
+    void WorkerLoop();
+    static void Work(Job &job);
+};
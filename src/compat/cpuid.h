@@ -10,6 +10,8 @@
 
 #include <cpuid.h>
 
+#include <cstdint>
+
 // We can't use cpuid.h's __get_cpuid as it does not support subleafs.
 void static inline GetCPUID(uint32_t leaf, uint32_t subleaf, uint32_t &a,
                             uint32_t &b, uint32_t &c, uint32_t &d) {
@@ -22,4 +24,26 @@ void static inline GetCPUID(uint32_t leaf, uint32_t subleaf, uint32_t &a,
 #endif
 }
 
+/** Check whether the OS has enabled AVX registers. */
+bool static inline AVXEnabled() {
+    uint32_t a, d;
+    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+    return (a & 6) == 6;
+}
+
+/** Check whether the CPU supports AVX2, and the OS has enabled it. */
+bool static inline HaveAVX2() {
+    uint32_t eax, ebx, ecx, edx;
+    GetCPUID(0, 0, eax, ebx, ecx, edx);
+    const uint32_t max_leaf = eax;
+    GetCPUID(1, 0, eax, ebx, ecx, edx);
+    const bool have_xsave = (ecx >> 27) & 1;
+    const bool have_avx = (ecx >> 28) & 1;
+    if (max_leaf < 7 || !have_xsave || !have_avx || !AVXEnabled()) {
+        return false;
+    }
+    GetCPUID(7, 0, eax, ebx, ecx, edx);
+    return (ebx >> 5) & 1;
+}
+
 #endif // defined(__x86_64__) || defined(__amd64__) || defined(__i386__)
@@ -732,16 +732,6 @@ bool SelfTest() {
 
     return true;
 }
-
-#if defined(USE_ASM) &&                                                        \
-    (defined(__x86_64__) || defined(__amd64__) || defined(__i386__))
-/** Check whether the OS has enabled AVX registers. */
-bool AVXEnabled() {
-    uint32_t a, d;
-    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
-    return (a & 6) == 6;
-}
-#endif
 } // namespace
 
 std::string SHA256AutoDetect() {
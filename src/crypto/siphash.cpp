@@ -4,6 +4,12 @@
 
 #include <crypto/siphash.h>
 
+#include <compat/cpuid.h>
+
+namespace siphash_avx2 {
+void SipHashUint256_4way(uint64_t k0, uint64_t k1, const uint256 *vals, uint64_t *out);
+}
+
 #define ROTL(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
 
 #define SIPROUND                                                               \
@@ -174,3 +180,21 @@ uint64_t SipHashUint256Extra(uint64_t k0, uint64_t k1, const uint256 &val, uint3
     SIPROUND;
     return v0 ^ v1 ^ v2 ^ v3;
 }
+
+#if defined(ENABLE_AVX2) && !defined(BUILD_FITTEXXCOIN_INTERNAL) && defined(USE_ASM) && defined(HAVE_GETCPUID)
+#define SIPHASH_AVX2
+#endif
+
+void SipHashUint256Batch(uint64_t k0, uint64_t k1, const uint256 *vals, uint64_t *out, size_t count) noexcept {
+#ifdef SIPHASH_AVX2
+    static const bool have_avx2 = HaveAVX2();
+    if (have_avx2) {
+        for (; count >= 4; count -= 4, vals += 4, out += 4) {
+            siphash_avx2::SipHashUint256_4way(k0, k1, vals, out);
+        }
+    }
+#endif
+    for (; count > 0; --count) {
+        *out++ = SipHashUint256(k0, k1, *vals++);
+    }
+}
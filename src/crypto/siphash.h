@@ -6,6 +6,7 @@
 
 #include <uint256.h>
 
+#include <cstddef>
 #include <cstdint>
 
 /** SipHash-2-4 */
@@ -44,3 +45,9 @@ public:
  */
 uint64_t SipHashUint256(uint64_t k0, uint64_t k1, const uint256 &val) noexcept;
 uint64_t SipHashUint256Extra(uint64_t k0, uint64_t k1, const uint256 &val, uint32_t extra) noexcept;
+
+/**
+ * out[i] = SipHashUint256(k0, k1, vals[i]) for i in [0, count), computing
+ * four hashes at a time when the CPU supports AVX2.
+ */
+void SipHashUint256Batch(uint64_t k0, uint64_t k1, const uint256 *vals, uint64_t *out, size_t count) noexcept;
@@ -0,0 +1,76 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX2
+
+#include <cstdint>
+#include <immintrin.h>
+
+#include <uint256.h>
+
+namespace siphash_avx2 {
+namespace {
+
+    __m256i inline K(uint64_t x) { return _mm256_set1_epi64x(int64_t(x)); }
+    __m256i inline Add(__m256i x, __m256i y) { return _mm256_add_epi64(x, y); }
+    __m256i inline Xor(__m256i x, __m256i y) { return _mm256_xor_si256(x, y); }
+    template <int b> __m256i inline Rotl(__m256i x) {
+        return _mm256_or_si256(_mm256_slli_epi64(x, b), _mm256_srli_epi64(x, 64 - b));
+    }
+    template <> __m256i inline Rotl<32>(__m256i x) {
+        return _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1));
+    }
+
+    void inline SipRound(__m256i &v0, __m256i &v1, __m256i &v2, __m256i &v3) {
+        v0 = Add(v0, v1);
+        v1 = Rotl<13>(v1);
+        v1 = Xor(v1, v0);
+        v0 = Rotl<32>(v0);
+        v2 = Add(v2, v3);
+        v3 = Rotl<16>(v3);
+        v3 = Xor(v3, v2);
+        v0 = Add(v0, v3);
+        v3 = Rotl<21>(v3);
+        v3 = Xor(v3, v0);
+        v2 = Add(v2, v1);
+        v1 = Rotl<17>(v1);
+        v1 = Xor(v1, v2);
+        v2 = Rotl<32>(v2);
+    }
+
+    void inline Compress(__m256i &v0, __m256i &v1, __m256i &v2, __m256i &v3, __m256i d) {
+        v3 = Xor(v3, d);
+        SipRound(v0, v1, v2, v3);
+        SipRound(v0, v1, v2, v3);
+        v0 = Xor(v0, d);
+    }
+
+    __m256i inline Word(const uint256 *vals, int pos) {
+        return _mm256_set_epi64x(int64_t(vals[3].GetUint64(pos)), int64_t(vals[2].GetUint64(pos)),
+                                 int64_t(vals[1].GetUint64(pos)), int64_t(vals[0].GetUint64(pos)));
+    }
+
+} // namespace
+
+void SipHashUint256_4way(uint64_t k0, uint64_t k1, const uint256 *vals, uint64_t *out) {
+    __m256i v0 = K(0x736f6d6570736575ULL ^ k0);
+    __m256i v1 = K(0x646f72616e646f6dULL ^ k1);
+    __m256i v2 = K(0x6c7967656e657261ULL ^ k0);
+    __m256i v3 = K(0x7465646279746573ULL ^ k1);
+
+    for (int pos = 0; pos < 4; ++pos) {
+        Compress(v0, v1, v2, v3, Word(vals, pos));
+    }
+    Compress(v0, v1, v2, v3, K(uint64_t(4) << 59));
+    v2 = Xor(v2, K(0xFF));
+    SipRound(v0, v1, v2, v3);
+    SipRound(v0, v1, v2, v3);
+    SipRound(v0, v1, v2, v3);
+    SipRound(v0, v1, v2, v3);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), Xor(Xor(v0, v1), Xor(v2, v3)));
+}
+
+} // namespace siphash_avx2
+
+#endif
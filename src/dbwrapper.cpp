@@ -15,6 +15,7 @@
 #include <memenv.h>
 
 #include <algorithm>
+#include <cassert>
 #include <cstdint>
 #include <memory>
 
@@ -186,6 +187,26 @@ CDBWrapper::~CDBWrapper() {
     options.env = nullptr;
 }
 
+void CDBBatch::Append(const CDBBatch &other) {
+    assert(&parent == &other.parent);
+
+    class Appender : public leveldb::WriteBatch::Handler {
+        leveldb::WriteBatch &batch;
+
+    public:
+        explicit Appender(leveldb::WriteBatch &batchIn) : batch(batchIn) {}
+        void Put(const leveldb::Slice &key,
+                 const leveldb::Slice &value) override {
+            batch.Put(key, value);
+        }
+        void Delete(const leveldb::Slice &key) override { batch.Delete(key); }
+    } appender(batch);
+    // The changes are already serialized and obfuscated for parent.
+    const leveldb::Status status = other.batch.Iterate(&appender);
+    dbwrapper_private::HandleError(status);
+    size_estimate += other.size_estimate;
+}
+
 bool CDBWrapper::WriteBatch(CDBBatch &batch, bool fSync) {
     const bool log_memory = LogAcceptCategory(BCLog::LEVELDB);
     double mem_before = 0;
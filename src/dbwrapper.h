@@ -113,6 +113,12 @@ public:
         ssKey.clear();
     }
 
+    /**
+     * Queue the changes of other, a batch for the same CDBWrapper, after
+     * those of this batch.
+     */
+    void Append(const CDBBatch &other);
+
     size_t SizeEstimate() const { return size_estimate; }
 };
 
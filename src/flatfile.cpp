@@ -9,8 +9,16 @@
 #include <tinyformat.h>
 #include <util/system.h>
 
+#include <algorithm>
 #include <stdexcept>
 
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 FlatFileSeq::FlatFileSeq(fs::path dir, const char *prefix, size_t chunk_size)
     : m_dir(std::move(dir)), m_prefix(prefix), m_chunk_size(chunk_size) {
     if (chunk_size == 0) {
@@ -97,3 +105,99 @@ bool FlatFileSeq::Flush(const FlatFilePos &pos, bool finalize) {
     fclose(file);
     return true;
 }
+
+std::shared_ptr<const MappedFlatFile>
+MappedFlatFile::Open(const fs::path &path) {
+#ifdef WIN32
+    return nullptr;
+#else
+    const int fd = ::open(path.string().c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return nullptr;
+    }
+    struct stat st;
+    void *data = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    // The mapping does not need the descriptor.
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+    return std::shared_ptr<const MappedFlatFile>(new MappedFlatFile(
+        static_cast<const uint8_t *>(data), size_t(st.st_size)));
+#endif
+}
+
+MappedFlatFile::~MappedFlatFile() {
+#ifndef WIN32
+    ::munmap(const_cast<uint8_t *>(m_data), m_size);
+#endif
+}
+
+std::shared_ptr<const MappedFlatFile>
+FlatFileMapCache::Get(const FlatFileSeq &seq, const FlatFilePos &pos,
+                      size_t size) {
+    if (pos.IsNull()) {
+        return nullptr;
+    }
+    const auto covers = [&](const MappedFlatFile &file) {
+        const size_t file_size = file.Data().size();
+        return pos.nPos <= file_size && size <= file_size - pos.nPos;
+    };
+
+    LOCK(m_mutex);
+    if (m_max_files == 0) {
+        return nullptr;
+    }
+    auto it = std::find_if(m_files.begin(), m_files.end(), [&](const auto &entry) {
+        return entry.first == pos.nFile;
+    });
+    if (it != m_files.end()) {
+        if (covers(*it->second)) {
+            m_files.splice(m_files.begin(), m_files, it);
+            return it->second;
+        }
+        // The file may have grown since it was mapped.
+        m_files.erase(it);
+    }
+
+    auto file = MappedFlatFile::Open(seq.FileName(pos));
+    if (!file) {
+        return nullptr;
+    }
+    m_files.emplace_front(pos.nFile, file);
+    while (m_files.size() > m_max_files) {
+        m_files.pop_back();
+    }
+    return covers(*file) ? file : nullptr;
+}
+
+void FlatFileMapCache::Remove(int nFile) {
+    LOCK(m_mutex);
+    m_files.remove_if([&](const auto &entry) { return entry.first == nFile; });
+}
+
+void FlatFileMapCache::Clear() {
+    LOCK(m_mutex);
+    m_files.clear();
+}
+
+void FlatFileMapCache::SetMaxFiles(size_t max_files) {
+    LOCK(m_mutex);
+    m_max_files = max_files;
+    while (m_files.size() > m_max_files) {
+        m_files.pop_back();
+    }
+}
+
+size_t FlatFileMapCache::GetMaxFiles() const {
+    LOCK(m_mutex);
+    return m_max_files;
+}
+
+size_t FlatFileMapCache::size() const {
+    LOCK(m_mutex);
+    return m_files.size();
+}
@@ -8,8 +8,14 @@
 
 #include <fs.h>
 #include <serialize.h>
+#include <span.h>
+#include <sync.h>
 
+#include <cstdint>
+#include <list>
+#include <memory>
 #include <string>
+#include <utility>
 
 struct FlatFilePos {
     int nFile;
@@ -90,3 +96,74 @@ public:
      */
     bool Flush(const FlatFilePos &pos, bool finalize = false);
 };
+
+/**
+ * A read-only memory mapping of a flat file, as large as the file was when it
+ * was mapped. Data appended to the file later, in the pre-allocated space, is
+ * visible through the mapping as long as it is within that size.
+ */
+class MappedFlatFile {
+private:
+    const uint8_t *const m_data;
+    const size_t m_size;
+
+    MappedFlatFile(const uint8_t *data, size_t size)
+        : m_data(data), m_size(size) {}
+
+public:
+    /**
+     * Map the file at the given path. Returns nullptr if it can't be mapped,
+     * which is always the case on Windows.
+     */
+    static std::shared_ptr<const MappedFlatFile> Open(const fs::path &path);
+
+    ~MappedFlatFile();
+    MappedFlatFile(const MappedFlatFile &) = delete;
+    MappedFlatFile &operator=(const MappedFlatFile &) = delete;
+
+    Span<const uint8_t> Data() const { return {m_data, m_size}; }
+};
+
+/**
+ * A bounded cache of memory mappings of the files of a FlatFileSeq, evicting
+ * the least recently used one, so that reading from the files does not open,
+ * seek, read and close them each time.
+ *
+ * Mappings are shared with the callers, so they remain valid for as long as
+ * these hold on to them, even once evicted or removed.
+ */
+class FlatFileMapCache {
+private:
+    mutable Mutex m_mutex;
+    size_t m_max_files GUARDED_BY(m_mutex);
+    //! The most recently used first.
+    std::list<std::pair<int, std::shared_ptr<const MappedFlatFile>>>
+        m_files GUARDED_BY(m_mutex);
+
+public:
+    explicit FlatFileMapCache(size_t max_files) : m_max_files(max_files) {}
+
+    /**
+     * Get a mapping of the file at the given position which covers the size
+     * bytes from there, mapping the file again if it has grown since it was
+     * mapped. Returns nullptr if the file can't be mapped or is too small, or
+     * if no files are to be mapped, in which case it should be read as usual.
+     */
+    std::shared_ptr<const MappedFlatFile> Get(const FlatFileSeq &seq,
+                                              const FlatFilePos &pos,
+                                              size_t size);
+
+    /** Forget the mapping of a file, before it is truncated or removed. */
+    void Remove(int nFile);
+
+    /**
+     * Forget the mappings of all the files, whose numbers may then refer to
+     * other files (such as after the block index is unloaded).
+     */
+    void Clear();
+
+    /** Set the number of files to keep mapped, 0 to map none. */
+    void SetMaxFiles(size_t max_files);
+    size_t GetMaxFiles() const;
+    size_t size() const;
+};
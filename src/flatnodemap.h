@@ -0,0 +1,390 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <memusage.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Hash map with open addressing, for large maps of small keys and values.
+ *
+ * The table is an array of 8-byte slots, each holding a fragment of the hash
+ * of its key and the index of its node, with linear probing and Robin Hood
+ * ordering so that it may be filled up to 7/8 of its size. The nodes
+ * themselves are allocated 64 at a time in chunks that never move, and freed
+ * nodes are reused. Compared to std::unordered_map this saves a heap
+ * allocation, a bucket pointer, a next pointer and a cached hash per element,
+ * and most lookups only touch one slot and one node.
+ *
+ * Like std::unordered_map (and unlike maps that store their elements in the
+ * table), pointers, references and iterators to elements stay valid until
+ * the element is erased. Iteration follows the order of the nodes, which is
+ * not affected by erasing other elements, so erase(iterator) may be used
+ * while iterating.
+ *
+ * Only the subset of the std::unordered_map interface used in the codebase is
+ * provided.
+ */
+template <typename K, typename T, typename Hash, typename Equal = std::equal_to<K>>
+class flatnodemap {
+public:
+    typedef K key_type;
+    typedef T mapped_type;
+    typedef std::pair<const K, T> value_type;
+    typedef size_t size_type;
+
+private:
+    static constexpr uint32_t CHUNK_SIZE = 64;
+    static constexpr uint32_t NO_NODE = std::numeric_limits<uint32_t>::max();
+
+    struct Chunk {
+        //! Bit i is set if node i is constructed.
+        uint64_t used = 0;
+        alignas(value_type) unsigned char storage[CHUNK_SIZE][sizeof(value_type)];
+
+        value_type *Node(uint32_t i) {
+            return std::launder(reinterpret_cast<value_type *>(storage[i]));
+        }
+    };
+
+    /**
+     * A slot is 0 if empty, and otherwise holds the node index plus one in
+     * its high 32 bits and the low 32 bits of the key hash in its low 32
+     * bits. The slot a key is looked up from is given by the hash bits, so
+     * that the table can be grown without hashing the keys again.
+     */
+    std::vector<uint64_t> slots;
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    std::vector<uint32_t> freeNodes;
+    //! Number of nodes handed out so far: the nodes past it are unused.
+    uint32_t nodesEnd = 0;
+    size_type nElements = 0;
+    Hash hasher;
+    Equal equal;
+
+    static uint32_t SlotHash(uint64_t slot) { return uint32_t(slot); }
+    static uint32_t SlotNode(uint64_t slot) { return uint32_t(slot >> 32) - 1; }
+    static uint64_t MakeSlot(uint32_t hash, uint32_t node) {
+        return (uint64_t(node + 1) << 32) | hash;
+    }
+
+    //! The low bits, as the hashers return a size_t which may be 32-bit.
+    uint32_t KeyHash(const K &key) const { return uint32_t(hasher(key)); }
+    size_t Mask() const { return slots.size() - 1; }
+
+    value_type *Node(uint32_t node) const {
+        return chunks[node / CHUNK_SIZE]->Node(node % CHUNK_SIZE);
+    }
+
+    //! First used node from node on, or NO_NODE.
+    uint32_t NextUsed(uint32_t node) const {
+        while (node < nodesEnd) {
+            const uint64_t used = chunks[node / CHUNK_SIZE]->used >> (node % CHUNK_SIZE);
+            if (used) {
+                const uint32_t next = node + __builtin_ctzll(used);
+                return next < nodesEnd ? next : NO_NODE;
+            }
+            node = (node / CHUNK_SIZE + 1) * CHUNK_SIZE;
+        }
+        return NO_NODE;
+    }
+
+    //! Distance of the (non-empty) slot at pos from the one it hashes to.
+    size_t Distance(uint64_t slot, size_t pos) const {
+        return (pos - SlotHash(slot)) & Mask();
+    }
+
+    /**
+     * Look up key. Returns the slot holding it and true, or the slot it would
+     * be inserted at and false. The elements of a probe sequence are ordered
+     * by distance, so the search stops at the first element closer to its
+     * own slot than key would be.
+     */
+    std::pair<size_t, bool> FindSlot(const K &key, uint32_t hash) const {
+        const size_t mask = Mask();
+        size_t pos = hash & mask;
+        for (size_t dist = 0;; ++dist, pos = (pos + 1) & mask) {
+            const uint64_t slot = slots[pos];
+            if (slot == 0 || Distance(slot, pos) < dist) {
+                return {pos, false};
+            }
+            if (SlotHash(slot) == hash && equal(Node(SlotNode(slot))->first, key)) {
+                return {pos, true};
+            }
+        }
+    }
+
+    //! Put slot at pos, moving the following elements of the sequence down.
+    void InsertSlot(size_t pos, uint64_t slot) {
+        const size_t mask = Mask();
+        while (slots[pos] != 0) {
+            std::swap(slot, slots[pos]);
+            do {
+                pos = (pos + 1) & mask;
+            } while (slots[pos] != 0 && Distance(slots[pos], pos) >= Distance(slot, pos));
+        }
+        slots[pos] = slot;
+    }
+
+    void Rehash(size_t nSlots) {
+        std::vector<uint64_t> old(nSlots, 0);
+        old.swap(slots);
+        const size_t mask = Mask();
+        for (const uint64_t slot : old) {
+            if (slot == 0) {
+                continue;
+            }
+            size_t pos = SlotHash(slot) & mask;
+            while (slots[pos] != 0 && Distance(slots[pos], pos) >= Distance(slot, pos)) {
+                pos = (pos + 1) & mask;
+            }
+            InsertSlot(pos, slot);
+        }
+    }
+
+    //! Grow the table, if needed, to hold n elements at a load of 7/8 at most.
+    void Reserve(size_type n) {
+        size_t nSlots = slots.empty() ? 16 : slots.size();
+        while (n > nSlots / 8 * 7) {
+            nSlots *= 2;
+        }
+        if (nSlots != slots.size()) {
+            Rehash(nSlots);
+        }
+    }
+
+    template <typename ValueArgs>
+    std::pair<uint32_t, bool> EmplaceNode(const K &key, ValueArgs &&args) {
+        Reserve(nElements + 1);
+        const uint32_t hash = KeyHash(key);
+        const auto [pos, found] = FindSlot(key, hash);
+        if (found) {
+            return {SlotNode(slots[pos]), false};
+        }
+
+        uint32_t node;
+        if (!freeNodes.empty()) {
+            node = freeNodes.back();
+        } else {
+            assert(nodesEnd < NO_NODE - 1);
+            node = nodesEnd;
+            if (node / CHUNK_SIZE == chunks.size()) {
+                // Not value-initialized: the storage is left uninitialized.
+                chunks.emplace_back(new Chunk);
+            }
+        }
+        new (Node(node)) value_type(std::piecewise_construct,
+                                    std::forward_as_tuple(key),
+                                    std::forward<ValueArgs>(args));
+        if (!freeNodes.empty()) {
+            freeNodes.pop_back();
+        } else {
+            ++nodesEnd;
+        }
+        chunks[node / CHUNK_SIZE]->used |= uint64_t(1) << (node % CHUNK_SIZE);
+        InsertSlot(pos, MakeSlot(hash, node));
+        ++nElements;
+        return {node, true};
+    }
+
+    void EraseNode(uint32_t node) {
+        value_type *value = Node(node);
+        const size_t mask = Mask();
+        size_t pos = KeyHash(value->first) & mask;
+        while (SlotNode(slots[pos]) != node) {
+            pos = (pos + 1) & mask;
+        }
+        // Move the following elements of the sequence up, so that no tombstone
+        // is needed.
+        for (size_t next = (pos + 1) & mask; slots[next] != 0 && Distance(slots[next], next) > 0;
+             next = (next + 1) & mask) {
+            slots[pos] = slots[next];
+            pos = next;
+        }
+        slots[pos] = 0;
+
+        value->~value_type();
+        chunks[node / CHUNK_SIZE]->used &= ~(uint64_t(1) << (node % CHUNK_SIZE));
+        freeNodes.push_back(node);
+        --nElements;
+    }
+
+    void DestroyNodes() {
+        if (!std::is_trivially_destructible_v<value_type>) {
+            for (uint32_t node = NextUsed(0); node != NO_NODE; node = NextUsed(node + 1)) {
+                Node(node)->~value_type();
+            }
+        }
+    }
+
+    template <bool Const> class iterator_impl {
+        friend class flatnodemap;
+        typedef std::conditional_t<Const, const flatnodemap, flatnodemap> map_type;
+        map_type *map = nullptr;
+        uint32_t node = NO_NODE;
+
+        iterator_impl(map_type *mapIn, uint32_t nodeIn) : map(mapIn), node(nodeIn) {}
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef typename flatnodemap::value_type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef std::conditional_t<Const, const value_type *, value_type *> pointer;
+        typedef std::conditional_t<Const, const value_type &, value_type &> reference;
+
+        iterator_impl() = default;
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        iterator_impl(const iterator_impl<false> &it) : map(it.map), node(it.node) {}
+
+        reference operator*() const { return *map->Node(node); }
+        pointer operator->() const { return map->Node(node); }
+        iterator_impl &operator++() {
+            node = map->NextUsed(node + 1);
+            return *this;
+        }
+        iterator_impl operator++(int) {
+            iterator_impl copy = *this;
+            ++*this;
+            return copy;
+        }
+        // Iterators only compare their node, so that end() stays valid.
+        friend bool operator==(const iterator_impl &a, const iterator_impl &b) { return a.node == b.node; }
+        friend bool operator!=(const iterator_impl &a, const iterator_impl &b) { return a.node != b.node; }
+
+        friend class iterator_impl<true>;
+    };
+
+public:
+    typedef iterator_impl<false> iterator;
+    typedef iterator_impl<true> const_iterator;
+
+    flatnodemap() = default;
+    flatnodemap(flatnodemap &&other) noexcept { swap(other); }
+    flatnodemap(const flatnodemap &other) : hasher(other.hasher), equal(other.equal) {
+        reserve(other.size());
+        for (const value_type &value : other) {
+            emplace(value.first, value.second);
+        }
+    }
+    flatnodemap &operator=(flatnodemap other) noexcept {
+        swap(other);
+        return *this;
+    }
+    ~flatnodemap() { DestroyNodes(); }
+
+    void swap(flatnodemap &other) noexcept {
+        std::swap(slots, other.slots);
+        std::swap(chunks, other.chunks);
+        std::swap(freeNodes, other.freeNodes);
+        std::swap(nodesEnd, other.nodesEnd);
+        std::swap(nElements, other.nElements);
+        std::swap(hasher, other.hasher);
+        std::swap(equal, other.equal);
+    }
+
+    iterator begin() { return {this, NextUsed(0)}; }
+    iterator end() { return {this, NO_NODE}; }
+    const_iterator begin() const { return {this, NextUsed(0)}; }
+    const_iterator end() const { return {this, NO_NODE}; }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    bool empty() const { return nElements == 0; }
+    size_type size() const { return nElements; }
+    //! Number of slots of the table.
+    size_type bucket_count() const { return slots.size(); }
+    //! Slot the lookup of key starts from.
+    size_type bucket(const K &key) const { return KeyHash(key) & Mask(); }
+
+    iterator find(const K &key) {
+        if (nElements == 0) {
+            return end();
+        }
+        const auto [pos, found] = FindSlot(key, KeyHash(key));
+        return {this, found ? SlotNode(slots[pos]) : NO_NODE};
+    }
+    const_iterator find(const K &key) const {
+        return const_cast<flatnodemap *>(this)->find(key);
+    }
+    size_type count(const K &key) const { return find(key) != end(); }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const K &key, Args &&...args) {
+        const auto [node, inserted] = EmplaceNode(key, std::forward_as_tuple(std::forward<Args>(args)...));
+        return {iterator(this, node), inserted};
+    }
+    template <typename KeyArgs, typename ValueArgs>
+    std::pair<iterator, bool> emplace(std::piecewise_construct_t, KeyArgs &&keyArgs, ValueArgs &&valueArgs) {
+        const K key = std::make_from_tuple<K>(std::forward<KeyArgs>(keyArgs));
+        const auto [node, inserted] = EmplaceNode(key, std::forward<ValueArgs>(valueArgs));
+        return {iterator(this, node), inserted};
+    }
+    template <typename V>
+    std::pair<iterator, bool> emplace(const K &key, V &&value) {
+        return try_emplace(key, std::forward<V>(value));
+    }
+    std::pair<iterator, bool> insert(const value_type &value) {
+        return try_emplace(value.first, value.second);
+    }
+    T &operator[](const K &key) { return try_emplace(key).first->second; }
+
+    //! Erase the element at it, and return an iterator to the next one.
+    iterator erase(const_iterator it) {
+        const uint32_t node = it.node;
+        EraseNode(node);
+        return {this, NextUsed(node + 1)};
+    }
+    iterator erase(iterator it) { return erase(const_iterator(it)); }
+    size_type erase(const K &key) {
+        const iterator it = find(key);
+        if (it == end()) {
+            return 0;
+        }
+        erase(it);
+        return 1;
+    }
+
+    //! Remove all the elements, and release the memory.
+    void clear() {
+        DestroyNodes();
+        slots = decltype(slots)();
+        chunks = decltype(chunks)();
+        freeNodes = decltype(freeNodes)();
+        nodesEnd = 0;
+        nElements = 0;
+    }
+
+    void reserve(size_type n) {
+        Reserve(n);
+    }
+
+    size_t DynamicMemoryUsage() const {
+        return memusage::MallocUsage(sizeof(uint64_t) * slots.capacity()) +
+               memusage::MallocUsage(sizeof(void *) * chunks.capacity()) +
+               memusage::MallocUsage(sizeof(Chunk)) * chunks.size() +
+               memusage::MallocUsage(sizeof(uint32_t) * freeNodes.capacity());
+    }
+};
+
+namespace memusage {
+
+template <typename K, typename T, typename Hash, typename Equal>
+inline size_t DynamicUsage(const flatnodemap<K, T, Hash, Equal> &m) {
+    return m.DynamicMemoryUsage();
+}
+
+} // namespace memusage
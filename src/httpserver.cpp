@@ -37,12 +37,14 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <algorithm>
 #include <csignal>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <deque>
 #include <memory>
+#include <new>
 
 /** Maximum size of http request (request line + headers) */
 static const size_t MAX_HEADERS_SIZE = 8192;
@@ -637,35 +639,93 @@ void HTTPRequest::WriteReply(int nStatus, const std::string &strReply) {
     if (ShutdownRequested()) {
         WriteHeader("Connection", "close");
     }
+    TraceReply(nStatus, strReply);
 
-    // If HTTPTRACE is enabled, log what we are replying with
-    if (LogAcceptCategory(BCLog::HTTPTRACE)) {
-        const auto headersVec = GetAllOutputHeaders();
-        bool isBinary = false;
-        const std::string headers = Join(headersVec, "\n", [&isBinary] (const auto &nvp) {
-            const auto & [name, value] = nvp;
-            // Set the isBinary flag if we are outputting binary (this is for REST .bin output mode)
-            if (!isBinary && name == "Content-Type" && value == "application/octet-stream") isBinary = true;
-            return strprintf("%s: %s", nvp.first, nvp.second);
-        });
-        const char *content_desc = "";
-        std::string hexStrReply;
-        if (isBinary) {
-            // If we are outputting binary (REST .bin mode), we will encode the data as hex first,
-            // to keep log files tidy.
-            content_desc = " (binary data, hex encoded)";
-            hexStrReply = HexStr(strReply);
+    struct evbuffer *evb = evhttp_request_get_output_buffer(req);
+    assert(evb);
+    evbuffer_add(evb, strReply.data(), strReply.size());
+    SendReply(nStatus);
+}
+
+void HTTPRequest::WriteReply(int nStatus, Span<const uint8_t> data, std::shared_ptr<const void> owner) {
+    assert(!replySent && req);
+    if (ShutdownRequested()) {
+        WriteHeader("Connection", "close");
+    }
+    TraceReply(nStatus, Span{reinterpret_cast<const char *>(data.data()), data.size()});
+
+    struct evbuffer *evb = evhttp_request_get_output_buffer(req);
+    assert(evb);
+    if (!data.empty()) {
+        // The owner is released by libevent once the data has been sent.
+        auto *holder = new std::shared_ptr<const void>(std::move(owner));
+        const auto cleanup = [](const void *, size_t, void *extra) {
+            delete static_cast<std::shared_ptr<const void> *>(extra);
+        };
+        if (evbuffer_add_reference(evb, data.data(), data.size(), cleanup, holder) != 0) {
+            delete holder;
+            throw std::bad_alloc();
         }
-        const std::string &content = isBinary ? hexStrReply : strReply;
-        LogPrintf("<httptrace> Writing reply to %s, status: %d, headers: %u, content: %u bytes\n"
-                  "--- HEADERS ---\n%s\n--- CONTENT%s ---\n%s\n",
-                  GetPeer().ToString(), nStatus, headersVec.size(), strReply.size(), headers, content_desc, content);
+    }
+    SendReply(nStatus);
+}
+
+void HTTPRequest::WriteReplyHex(int nStatus, Span<const uint8_t> data, const std::string &suffix) {
+    assert(!replySent && req);
+    if (ShutdownRequested()) {
+        WriteHeader("Connection", "close");
+    }
+    if (LogAcceptCategory(BCLog::HTTPTRACE)) {
+        TraceReply(nStatus, HexStr(data) + suffix);
     }
 
-    // Send event to main http thread to send reply message
     struct evbuffer *evb = evhttp_request_get_output_buffer(req);
     assert(evb);
-    evbuffer_add(evb, strReply.data(), strReply.size());
+    static constexpr size_t CHUNK_SIZE = 1 << 16;
+    for (size_t pos = 0; pos < data.size(); pos += CHUNK_SIZE) {
+        const auto chunk = data.subspan(pos, std::min(CHUNK_SIZE, data.size() - pos));
+        evbuffer_iovec vec;
+        if (evbuffer_reserve_space(evb, chunk.size() * 2, &vec, 1) != 1) {
+            throw std::bad_alloc();
+        }
+        HexEncode(chunk, static_cast<char *>(vec.iov_base));
+        vec.iov_len = chunk.size() * 2;
+        evbuffer_commit_space(evb, &vec, 1);
+    }
+    evbuffer_add(evb, suffix.data(), suffix.size());
+    SendReply(nStatus);
+}
+
+void HTTPRequest::TraceReply(int nStatus, Span<const char> content) const {
+    // If HTTPTRACE is enabled, log what we are replying with
+    if (!LogAcceptCategory(BCLog::HTTPTRACE)) {
+        return;
+    }
+    const auto headersVec = GetAllOutputHeaders();
+    bool isBinary = false;
+    const std::string headers = Join(headersVec, "\n", [&isBinary] (const auto &nvp) {
+        const auto & [name, value] = nvp;
+        // Set the isBinary flag if we are outputting binary (this is for REST .bin output mode)
+        if (!isBinary && name == "Content-Type" && value == "application/octet-stream") isBinary = true;
+        return strprintf("%s: %s", nvp.first, nvp.second);
+    });
+    const char *content_desc = "";
+    std::string contentStr;
+    if (isBinary) {
+        // If we are outputting binary (REST .bin mode), we will encode the data as hex first,
+        // to keep log files tidy.
+        content_desc = " (binary data, hex encoded)";
+        contentStr = HexStr(content);
+    } else {
+        contentStr.assign(content.begin(), content.end());
+    }
+    LogPrintf("<httptrace> Writing reply to %s, status: %d, headers: %u, content: %u bytes\n"
+              "--- HEADERS ---\n%s\n--- CONTENT%s ---\n%s\n",
+              GetPeer().ToString(), nStatus, headersVec.size(), content.size(), headers, content_desc, contentStr);
+}
+
+void HTTPRequest::SendReply(int nStatus) {
+    // Send event to main http thread to send reply message
     auto req_copy = req;
     HTTPEvent *ev = new HTTPEvent(eventBase, true, [req_copy, nStatus] {
         evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
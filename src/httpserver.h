@@ -5,8 +5,11 @@
 
 #pragma once
 
+#include <span.h>
+
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
@@ -145,8 +148,29 @@ public:
      */
     void WriteReply(int nStatus, const std::string &strReply = "");
 
+    /**
+     * Write HTTP reply with data as the body, without copying it: the data is
+     * sent by reference, and owner is held on to until it has been sent.
+     *
+     * @note Same restrictions as above.
+     */
+    void WriteReply(int nStatus, Span<const uint8_t> data, std::shared_ptr<const void> owner);
+
+    /**
+     * Write HTTP reply with the hexadecimal encoding of data, followed by
+     * suffix, as the body. The data is encoded piece by piece into the output
+     * buffer, with no other copy of the encoding made.
+     *
+     * @note Same restrictions as above.
+     */
+    void WriteReplyHex(int nStatus, Span<const uint8_t> data, const std::string &suffix = "");
+
 private:
     std::vector<NameValuePair> GetAllHeaders(bool input) const;
+    //! Log the reply if HTTPTRACE is enabled.
+    void TraceReply(int nStatus, Span<const char> content) const;
+    //! Give the request back to the main thread to send the reply.
+    void SendReply(int nStatus);
 };
 
 /** Event handler closure */
@@ -14,10 +14,24 @@
 #include <validation.h>
 #include <warnings.h>
 
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <vector>
+
 constexpr char DB_BEST_BLOCK = 'B';
 
-constexpr int64_t SYNC_LOG_INTERVAL = 30;           // seconds
-constexpr int64_t SYNC_LOCATOR_WRITE_INTERVAL = 30; // seconds
+constexpr int64_t SYNC_LOG_INTERVAL = 30; // seconds
+
+/** The maximum number of blocks read and prepared at once while catching up */
+constexpr size_t SYNC_BATCH_MAX_BLOCKS = 64;
+/**
+ * The number of transactions past which no more blocks are added to a batch,
+ * which bounds the memory used by the blocks being read and prepared.
+ */
+constexpr size_t SYNC_BATCH_MAX_TXS = 50000;
+/** The maximum number of threads of the sync pool, besides the sync thread */
+constexpr int MAX_SYNC_THREADS = 8;
 
 template <typename... Args>
 static void FatalError(const char *fmt, const Args &... args) {
@@ -61,6 +75,12 @@ bool BaseIndex::Init() {
     LOCK(cs_main);
     if (locator.IsNull()) {
         m_best_block_index = nullptr;
+    } else if (const CBlockIndex *pindex =
+                   LookupBlockIndex(locator.vHave.front())) {
+        // Start from the block the index was written up to, even if it is no
+        // longer on the active chain, so that the sync thread sees the fork and
+        // rewinds the entries of the stale blocks.
+        m_best_block_index = pindex;
     } else {
         m_best_block_index = FindForkInGlobalIndex(::ChainActive(), locator);
     }
@@ -89,10 +109,13 @@ void BaseIndex::ThreadSync() {
     if (!m_synced) {
         auto &consensus_params = GetConfig().GetChainParams().GetConsensus();
 
+        m_sync_pool.Start(std::clamp(GetNumCores() - 1, 0, MAX_SYNC_THREADS));
+
         int64_t last_log_time = 0;
-        int64_t last_locator_write_time = 0;
+        std::vector<const CBlockIndex *> pindexes;
         while (true) {
             if (m_interrupt) {
+                m_sync_pool.Stop();
                 m_best_block_index = pindex;
                 // No need to handle errors in Commit. If it fails, the error
                 // will be already be logged. The best way to recover is to
@@ -102,17 +125,100 @@ void BaseIndex::ThreadSync() {
                 return;
             }
 
+            pindexes.clear();
+            const CBlockIndex *pindex_fork;
             {
                 LOCK(cs_main);
                 const CBlockIndex *pindex_next = NextSyncBlock(pindex);
                 if (!pindex_next) {
+                    m_sync_pool.Stop();
                     m_best_block_index = pindex;
                     m_synced = true;
                     // No need to handle errors in Commit. See rationale above.
                     Commit();
                     break;
                 }
-                pindex = pindex_next;
+                pindex_fork = pindex_next->pprev;
+                // Take the blocks following it on the active chain, as many
+                // as fit in the batch.
+                size_t n_txs = 0;
+                for (; pindex_next && pindexes.size() < SYNC_BATCH_MAX_BLOCKS &&
+                       (pindexes.empty() || n_txs < SYNC_BATCH_MAX_TXS);
+                     pindex_next = ::ChainActive().Next(pindex_next)) {
+                    pindexes.push_back(pindex_next);
+                    n_txs += pindex_next->nTx;
+                }
+            }
+
+            // Rewinding reads the blocks left from disk, so it is done without
+            // holding cs_main, like the reads of the batch.
+            if (pindex_fork != pindex) {
+                m_best_block_index = pindex;
+                if (!Rewind(pindex, pindex_fork)) {
+                    m_sync_pool.Stop();
+                    FatalError("%s: Failed to rewind index %s to a previous "
+                               "chain tip",
+                               __func__, GetName());
+                    return;
+                }
+                pindex = pindex_fork;
+            }
+
+            // Read the blocks and prepare their entries concurrently.
+            std::vector<CBlock> blocks(pindexes.size());
+            std::vector<std::unique_ptr<PreparedBlock>> prepared_blocks(
+                pindexes.size());
+            std::vector<char> read(pindexes.size(), false);
+            std::vector<char> prepared(pindexes.size(), false);
+            m_sync_pool.ForEach(pindexes.size(), [&](size_t i) {
+                if (m_interrupt) {
+                    return;
+                }
+                read[i] =
+                    ReadBlockFromDisk(blocks[i], pindexes[i], consensus_params);
+                if (read[i]) {
+                    prepared_blocks[i] = NewPreparedBlock();
+                    prepared[i] = PrepareBlock(blocks[i], pindexes[i],
+                                               *prepared_blocks[i]);
+                }
+            });
+
+            // Write them in order, in a single batch which also advances the
+            // best block past them.
+            CDBBatch batch(GetDB());
+            const CBlockIndex *pindex_written = pindex;
+            for (size_t i = 0; i < pindexes.size() && !m_interrupt; ++i) {
+                if (!read[i]) {
+                    m_sync_pool.Stop();
+                    FatalError("%s: Failed to read block %s from disk",
+                               __func__,
+                               pindexes[i]->GetBlockHash().ToString());
+                    return;
+                }
+                if (!prepared[i] ||
+                    !WritePreparedBlock(blocks[i], pindexes[i],
+                                        *prepared_blocks[i], batch)) {
+                    m_sync_pool.Stop();
+                    FatalError("%s: Failed to write block %s to index "
+                               "database",
+                               __func__,
+                               pindexes[i]->GetBlockHash().ToString());
+                    return;
+                }
+                pindex_written = pindexes[i];
+                prepared_blocks[i].reset();
+            }
+            if (pindex_written != pindex) {
+                if (!Commit(batch, pindex_written)) {
+                    m_sync_pool.Stop();
+                    FatalError("%s: Failed to write blocks up to %s to index "
+                               "database",
+                               __func__,
+                               pindex_written->GetBlockHash().ToString());
+                    return;
+                }
+                m_best_block_index = pindex_written;
+                pindex = pindex_written;
             }
 
             int64_t current_time = GetTime();
@@ -121,26 +227,6 @@ void BaseIndex::ThreadSync() {
                           GetName(), pindex->nHeight);
                 last_log_time = current_time;
             }
-
-            if (last_locator_write_time + SYNC_LOCATOR_WRITE_INTERVAL <
-                current_time) {
-                m_best_block_index = pindex;
-                last_locator_write_time = current_time;
-                // No need to handle errors in Commit. See rationale above.
-                Commit();
-            }
-
-            CBlock block;
-            if (!ReadBlockFromDisk(block, pindex, consensus_params)) {
-                FatalError("%s: Failed to read block %s from disk", __func__,
-                           pindex->GetBlockHash().ToString());
-                return;
-            }
-            if (!WriteBlock(block, pindex)) {
-                FatalError("%s: Failed to write block %s to index database",
-                           __func__, pindex->GetBlockHash().ToString());
-                return;
-            }
         }
     }
 
@@ -151,9 +237,36 @@ void BaseIndex::ThreadSync() {
     }
 }
 
+std::unique_ptr<BaseIndex::PreparedBlock> BaseIndex::NewPreparedBlock() const {
+    return std::make_unique<PreparedBlock>(GetDB());
+}
+
+bool BaseIndex::WritePreparedBlock(const CBlock &block,
+                                   const CBlockIndex *pindex,
+                                   PreparedBlock &prepared, CDBBatch &batch) {
+    batch.Append(prepared.batch);
+    return WriteBlock(block, pindex, prepared, batch);
+}
+
 bool BaseIndex::Commit() {
     CDBBatch batch(GetDB());
-    if (!CommitInternal(batch) || !GetDB().WriteBatch(batch)) {
+    return Commit(batch);
+}
+
+bool BaseIndex::Commit(CDBBatch &batch) {
+    return Commit(batch, m_best_block_index.load());
+}
+
+bool BaseIndex::Commit(CDBBatch &batch, const CBlockIndex *best_block) {
+    if (!CommitInternal(batch)) {
+        return error("%s: Failed to commit latest %s state", __func__,
+                     GetName());
+    }
+    {
+        LOCK(cs_main);
+        GetDB().WriteBestBlock(batch, ::ChainActive().GetLocator(best_block));
+    }
+    if (!GetDB().WriteBatch(batch)) {
         return error("%s: Failed to commit latest %s state", __func__,
                      GetName());
     }
@@ -161,9 +274,28 @@ bool BaseIndex::Commit() {
 }
 
 bool BaseIndex::CommitInternal(CDBBatch &batch) {
-    LOCK(cs_main);
-    GetDB().WriteBestBlock(batch,
-                           ::ChainActive().GetLocator(m_best_block_index));
+    return true;
+}
+
+bool BaseIndex::Rewind(const CBlockIndex *current_tip,
+                       const CBlockIndex *new_tip) {
+    CDBBatch batch(GetDB());
+    return CommitRewind(current_tip, new_tip, batch);
+}
+
+bool BaseIndex::CommitRewind(const CBlockIndex *current_tip,
+                             const CBlockIndex *new_tip, CDBBatch &batch) {
+    assert(current_tip == m_best_block_index);
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    // In the case of a reorg, ensure persisted block locator is not stale.
+    m_best_block_index = new_tip;
+    if (!Commit(batch)) {
+        // If commit fails, revert the best block index to avoid corruption.
+        m_best_block_index = current_tip;
+        return false;
+    }
+
     return true;
 }
 
@@ -198,15 +330,31 @@ void BaseIndex::BlockConnected(
                       best_block_index->GetBlockHash().ToString());
             return;
         }
+        if (best_block_index != pindex->pprev &&
+            !Rewind(best_block_index, pindex->pprev)) {
+            FatalError("%s: Failed to rewind index %s to a previous chain tip",
+                       __func__, GetName());
+            return;
+        }
     }
 
-    if (WriteBlock(*block, pindex)) {
-        m_best_block_index = pindex;
-    } else {
+    // The entries of the block are written along with the new best block,
+    // which only becomes the best block once they are, so that
+    // BlockUntilSyncedToCurrentChain does not return before.
+    const std::unique_ptr<PreparedBlock> prepared = NewPreparedBlock();
+    CDBBatch batch(GetDB());
+    if (!PrepareBlock(*block, pindex, *prepared) ||
+        !WritePreparedBlock(*block, pindex, *prepared, batch)) {
+        FatalError("%s: Failed to write block %s to index", __func__,
+                   pindex->GetBlockHash().ToString());
+        return;
+    }
+    if (!Commit(batch, pindex)) {
         FatalError("%s: Failed to write block %s to index", __func__,
                    pindex->GetBlockHash().ToString());
         return;
     }
+    m_best_block_index = pindex;
 }
 
 void BaseIndex::ChainStateFlushed(const CBlockLocator &locator) {
@@ -10,8 +10,11 @@
 #include <primitives/transaction.h>
 #include <threadinterrupt.h>
 #include <uint256.h>
+#include <util/threadpool.h>
 #include <validationinterface.h>
 
+#include <memory>
+
 class CBlockIndex;
 
 /**
@@ -33,6 +36,16 @@ protected:
         void WriteBestBlock(CDBBatch &batch, const CBlockLocator &locator);
     };
 
+    /// What PrepareBlock makes of a block for WriteBlock. Indexes that prepare
+    /// more than database entries derive from it (see NewPreparedBlock).
+    struct PreparedBlock {
+        explicit PreparedBlock(const CDBWrapper &db) : batch(db) {}
+        virtual ~PreparedBlock() {}
+
+        /// The index entries that only depend on the block.
+        CDBBatch batch;
+    };
+
 private:
     /// Whether the index is in sync with the main chain. The flag is flipped
     /// from false to true once, after which point this starts processing
@@ -45,13 +58,25 @@ private:
     std::thread m_thread_sync;
     CThreadInterrupt m_interrupt;
 
+    /// Reads the blocks and prepares their entries ahead of m_thread_sync
+    /// while the index catches up. Stopped once the index is in sync.
+    ThreadPool m_sync_pool{"indexsync"};
+
     /// Sync the index with the block index starting from the current best
     /// block. Intended to be run in its own thread, m_thread_sync, and can be
     /// interrupted with m_interrupt. Once the index gets in sync, the m_synced
     /// flag is set and the BlockConnected ValidationInterface callback takes
     /// over and the sync thread exits.
+    ///
+    /// The blocks are handled a batch at a time: they are read and prepared
+    /// (see PrepareBlock) on m_sync_pool, then written in order, in a single
+    /// database write which also advances the best block.
     void ThreadSync();
 
+    /// Add to batch the entries of a block prepared in prepared.
+    bool WritePreparedBlock(const CBlock &block, const CBlockIndex *pindex,
+                            PreparedBlock &prepared, CDBBatch &batch);
+
     /// Write the current index state (eg. chain block locator and
     /// subclass-specific items) to disk.
     ///
@@ -64,6 +89,13 @@ private:
     /// else it could end up getting corrupted.
     bool Commit();
 
+    /// Commit the index state along with the entries queued in batch.
+    bool Commit(CDBBatch &batch);
+
+    /// Likewise, with best_block as the block the index is in sync with,
+    /// which may be ahead of m_best_block_index until the write is done.
+    bool Commit(CDBBatch &batch, const CBlockIndex *best_block);
+
 protected:
     void
     BlockConnected(const std::shared_ptr<const CBlock> &block,
@@ -75,15 +107,47 @@ protected:
     /// Initialize internal state from the database and block index.
     virtual bool Init();
 
-    /// Write update index entries for a newly connected block.
-    virtual bool WriteBlock(const CBlock &block, const CBlockIndex *pindex) {
+    /// Make the object PrepareBlock fills for WriteBlock.
+    virtual std::unique_ptr<PreparedBlock> NewPreparedBlock() const;
+
+    /// Add to prepared.batch the index entries of a newly connected block that
+    /// only depend on the block and its undo data, and to the rest of prepared
+    /// what WriteBlock needs of it. While the index catches up, this is called
+    /// for several blocks at once from the threads of the sync pool, so it must
+    /// not read the index database or other mutable state, nor change it.
+    virtual bool PrepareBlock(const CBlock &block, const CBlockIndex *pindex,
+                              PreparedBlock &prepared) const {
+        return true;
+    }
+
+    /// Add to batch the index entries of a newly connected block that depend
+    /// on the entries of the blocks before it. Called for the blocks in order,
+    /// with what PrepareBlock made of them. The entries of several blocks are
+    /// queued in batch before it is written along with the new best block
+    /// (see CommitInternal), so the entries of the blocks before this one may
+    /// not be in the database yet.
+    virtual bool WriteBlock(const CBlock &block, const CBlockIndex *pindex,
+                            PreparedBlock &prepared, CDBBatch &batch) {
         return true;
     }
 
     /// Virtual method called internally by Commit that can be overridden to
-    /// atomically commit more index state.
+    /// atomically commit more index state, along with the block locator.
     virtual bool CommitInternal(CDBBatch &batch);
 
+    /// Rewind index to an earlier chain tip during a chain reorg. The tip must
+    /// be an ancestor of the current best block. Indexes whose entries depend
+    /// on the blocks before them override this to undo the entries of the
+    /// blocks being rewound, and then call it to write the new best block.
+    virtual bool Rewind(const CBlockIndex *current_tip,
+                        const CBlockIndex *new_tip);
+
+    /// Write the new best block of a rewind along with the entries queued in
+    /// batch, which undo those of the blocks being rewound, so that they are
+    /// removed all at once. For the overrides of Rewind.
+    bool CommitRewind(const CBlockIndex *current_tip,
+                      const CBlockIndex *new_tip, CDBBatch &batch);
+
     virtual DB &GetDB() const = 0;
 
     /// Get the name of the index for display in logs.
@@ -0,0 +1,131 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <blockfilter.h>
+#include <flatfile.h>
+#include <index/base.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+class CBlockIndex;
+
+/** Default for -blockfilterindex */
+static const char *const DEFAULT_BLOCKFILTERINDEX = "0";
+/** Default for -peerblockfilters */
+static constexpr bool DEFAULT_PEERBLOCKFILTERS = false;
+
+/** Interval between compact filter checkpoints. See BIP 157. */
+static constexpr int CFCHECKPT_INTERVAL = 1000;
+
+/**
+ * BlockFilterIndex is used to store and retrieve block filters, hashes, and
+ * headers for a range of blocks by height. An index is constructed for each
+ * supported filter type with its own database (ie. filter data for different
+ * types are stored in separate databases).
+ *
+ * The filters themselves are stored in flat files (indexes/blockfilter/<type>/
+ * fltr?????.dat) and referenced by the LevelDB entries, which keeps the
+ * database values small and of constant size. The entries of the blocks of the
+ * active chain are keyed by height. When a block is replaced at its height by
+ * a reorganization, its entry is moved to a key by block hash, so that the
+ * filters of stale blocks can still be served.
+ */
+class BlockFilterIndex final : public BaseIndex {
+private:
+    BlockFilterType m_filter_type;
+    std::string m_name;
+    std::unique_ptr<BaseIndex::DB> m_db;
+
+    FlatFilePos m_next_filter_pos;
+    std::unique_ptr<FlatFileSeq> m_filter_fileseq;
+
+    /// The block and filter header of the last filter written.
+    std::pair<BlockHash, uint256> m_last_header;
+
+    /// A block prepared with its filter. A filter only depends on its own
+    /// block, so the filters of several blocks are built at once while the
+    /// index catches up.
+    struct PreparedFilter : PreparedBlock {
+        using PreparedBlock::PreparedBlock;
+
+        BlockFilter filter;
+    };
+
+    bool ReadFilterFromDisk(const FlatFilePos &pos, BlockFilter &filter) const;
+    size_t WriteFilterToDisk(FlatFilePos &pos, const BlockFilter &filter);
+
+protected:
+    bool Init() override;
+
+    bool CommitInternal(CDBBatch &batch) override;
+
+    std::unique_ptr<PreparedBlock> NewPreparedBlock() const override;
+
+    bool PrepareBlock(const CBlock &block, const CBlockIndex *pindex,
+                      PreparedBlock &prepared) const override;
+
+    bool WriteBlock(const CBlock &block, const CBlockIndex *pindex,
+                    PreparedBlock &prepared, CDBBatch &batch) override;
+
+    BaseIndex::DB &GetDB() const override { return *m_db; }
+
+    const char *GetName() const override { return m_name.c_str(); }
+
+public:
+    /** Constructs the index, which becomes available to be queried. */
+    explicit BlockFilterIndex(BlockFilterType filter_type, size_t n_cache_size,
+                              bool f_memory = false, bool f_wipe = false);
+
+    BlockFilterType GetFilterType() const { return m_filter_type; }
+
+    /** Get a single filter by block. */
+    bool LookupFilter(const CBlockIndex *block_index,
+                      BlockFilter &filter_out) const;
+
+    /** Get a single filter header by block. */
+    bool LookupFilterHeader(const CBlockIndex *block_index,
+                            uint256 &header_out) const;
+
+    /** Get a range of filters between two heights on a chain. */
+    bool LookupFilterRange(int start_height, const CBlockIndex *stop_index,
+                           std::vector<BlockFilter> &filters_out) const;
+
+    /** Get a range of filter hashes between two heights on a chain. */
+    bool LookupFilterHashRange(int start_height, const CBlockIndex *stop_index,
+                               std::vector<uint256> &hashes_out) const;
+};
+
+/**
+ * Get a block filter index by type. Returns nullptr if index has not been
+ * initialized or was already destroyed.
+ */
+BlockFilterIndex *GetBlockFilterIndex(BlockFilterType filter_type);
+
+/** Iterate over all running block filter indexes, invoking fn on each. */
+void ForEachBlockFilterIndex(const std::function<void(BlockFilterIndex &)> &fn);
+
+/**
+ * Initialize a block filter index for the given type if one does not already
+ * exist. Returns true if a new index is created and false if one has already
+ * been initialized.
+ */
+bool InitBlockFilterIndex(BlockFilterType filter_type, size_t n_cache_size,
+                          bool f_memory = false, bool f_wipe = false);
+
+/**
+ * Destroy the block filter index with the given type. Returns false if no such
+ * index exists. This just releases the allocated memory and closes the
+ * database connection, it does not delete the index data.
+ */
+bool DestroyBlockFilterIndex(BlockFilterType filter_type);
+
+/** Destroy all open block filter indexes. */
+void DestroyAllBlockFilterIndexes();
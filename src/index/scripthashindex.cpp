@@ -0,0 +1,304 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/scripthashindex.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <config.h>
+#include <crypto/sha256.h>
+#include <dbwrapper.h>
+#include <script/script.h>
+#include <undo.h>
+#include <util/system.h>
+#include <validation.h>
+
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+constexpr char DB_HISTORY = 'h';
+constexpr char DB_UNSPENT = 'u';
+
+std::unique_ptr<ScriptHashIndex> g_scripthashindex;
+
+uint256 ScriptHash(const CScript &script) {
+    uint256 hash;
+    CSHA256().Write(script.data(), script.size()).Finalize(hash.begin());
+    return hash;
+}
+
+namespace {
+
+/**
+ * Key of the entry of a transaction in the history of a script. The height is
+ * big-endian so that the history is read in the order of the chain.
+ */
+struct HistoryKey {
+    uint256 scripthash;
+    int height;
+    TxId txid;
+
+    HistoryKey(const uint256 &scripthash_in, int height_in,
+               const TxId &txid_in)
+        : scripthash(scripthash_in), height(height_in), txid(txid_in) {}
+
+    template <typename Stream> void Serialize(Stream &s) const {
+        ser_writedata8(s, DB_HISTORY);
+        s << scripthash;
+        ser_writedata32be(s, height);
+        s << txid;
+    }
+
+    template <typename Stream> void Unserialize(Stream &s) {
+        if (ser_readdata8(s) != DB_HISTORY) {
+            throw std::ios_base::failure(
+                "Invalid format for script hash index DB history key");
+        }
+        s >> scripthash;
+        height = ser_readdata32be(s);
+        s >> txid;
+    }
+};
+
+struct HistoryValue {
+    std::vector<uint32_t> funded;
+    std::vector<COutPoint> spent;
+
+    SERIALIZE_METHODS(HistoryValue, obj) {
+        READWRITE(Using<VectorFormatter<VarIntFormatter<VarIntMode::DEFAULT>>>(
+                      obj.funded),
+                  obj.spent);
+    }
+};
+
+/** Key of an unspent output of a script, with the height it was created at. */
+struct UnspentKey {
+    uint256 scripthash;
+    int height;
+    COutPoint outpoint;
+
+    UnspentKey(const uint256 &scripthash_in, int height_in,
+               const COutPoint &outpoint_in)
+        : scripthash(scripthash_in), height(height_in), outpoint(outpoint_in) {}
+
+    template <typename Stream> void Serialize(Stream &s) const {
+        ser_writedata8(s, DB_UNSPENT);
+        s << scripthash;
+        ser_writedata32be(s, height);
+        s << outpoint.GetTxId();
+        ser_writedata32be(s, outpoint.GetN());
+    }
+
+    template <typename Stream> void Unserialize(Stream &s) {
+        if (ser_readdata8(s) != DB_UNSPENT) {
+            throw std::ios_base::failure(
+                "Invalid format for script hash index DB unspent key");
+        }
+        s >> scripthash;
+        height = ser_readdata32be(s);
+        TxId txid;
+        s >> txid;
+        outpoint = COutPoint(txid, ser_readdata32be(s));
+    }
+};
+
+/** The output as stored: the script is already known from the key. */
+CTxOut WithoutScript(const CTxOut &txout) {
+    return CTxOut(txout.nValue, CScript(), txout.tokenDataPtr);
+}
+
+/**
+ * Add the entries of the block at height to batch when connecting it, or
+ * remove them when disconnecting it.
+ */
+void ApplyBlock(CDBBatch &batch, const CBlock &block,
+                const CBlockUndo &block_undo, int height, bool connect) {
+    std::map<std::pair<uint256, TxId>, HistoryValue> history;
+
+    const auto applyCreated = [&] {
+        for (const CTransactionRef &tx : block.vtx) {
+            for (uint32_t n = 0; n < tx->vout.size(); ++n) {
+                const CTxOut &txout = tx->vout[n];
+                if (txout.scriptPubKey.IsUnspendable()) {
+                    continue;
+                }
+                const uint256 scripthash = ScriptHash(txout.scriptPubKey);
+                history[{scripthash, tx->GetId()}].funded.push_back(n);
+                const UnspentKey key(scripthash, height,
+                                     COutPoint(tx->GetId(), n));
+                if (connect) {
+                    batch.Write(key, WithoutScript(txout));
+                } else {
+                    batch.Erase(key);
+                }
+            }
+        }
+    };
+
+    const auto applySpent = [&] {
+        for (size_t i = 1; i < block.vtx.size(); ++i) {
+            const CTransaction &tx = *block.vtx[i];
+            const CTxUndo &tx_undo = block_undo.vtxundo[i - 1];
+            for (size_t j = 0; j < tx.vin.size(); ++j) {
+                const COutPoint &prevout = tx.vin[j].prevout;
+                const Coin &coin = tx_undo.vprevout[j];
+                const uint256 scripthash =
+                    ScriptHash(coin.GetTxOut().scriptPubKey);
+                history[{scripthash, tx.GetId()}].spent.push_back(prevout);
+                const UnspentKey key(scripthash, coin.GetHeight(), prevout);
+                if (connect) {
+                    batch.Erase(key);
+                } else {
+                    batch.Write(key, WithoutScript(coin.GetTxOut()));
+                }
+            }
+        }
+    };
+
+    // A transaction may spend the outputs of a transaction after it in the
+    // block. The created outputs are added before the spent ones are removed,
+    // and the spent outputs restored before the created ones are removed, so
+    // that those both created and spent by the block end up absent.
+    if (connect) {
+        applyCreated();
+        applySpent();
+    } else {
+        applySpent();
+        applyCreated();
+    }
+
+    for (const auto &[key, value] : history) {
+        const HistoryKey history_key(key.first, height, key.second);
+        if (connect) {
+            batch.Write(history_key, value);
+        } else {
+            batch.Erase(history_key);
+        }
+    }
+}
+
+/** Read the block at pindex and its undo data. */
+bool ReadBlockAndUndo(const CBlockIndex *pindex, CBlock &block,
+                      CBlockUndo &block_undo) {
+    if (!ReadBlockFromDisk(block, pindex,
+                           GetConfig().GetChainParams().GetConsensus())) {
+        return error("%s: Failed to read block %s from disk", __func__,
+                     pindex->GetBlockHash().ToString());
+    }
+    if (!UndoReadFromDisk(block_undo, pindex)) {
+        return error("%s: Failed to read undo data of block %s from disk",
+                     __func__, pindex->GetBlockHash().ToString());
+    }
+    return true;
+}
+
+} // namespace
+
+/**
+ * Access to the script hash index database (indexes/scripthash/)
+ */
+class ScriptHashIndex::DB : public BaseIndex::DB {
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false,
+                bool f_wipe = false);
+};
+
+ScriptHashIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex::DB(GetDataDir() / "indexes" / "scripthash", n_cache_size,
+                    f_memory, f_wipe) {}
+
+ScriptHashIndex::ScriptHashIndex(size_t n_cache_size, bool f_memory,
+                                 bool f_wipe)
+    : m_db(std::make_unique<ScriptHashIndex::DB>(n_cache_size, f_memory,
+                                                 f_wipe)) {}
+
+ScriptHashIndex::~ScriptHashIndex() {}
+
+bool ScriptHashIndex::PrepareBlock(const CBlock &block,
+                                   const CBlockIndex *pindex,
+                                   PreparedBlock &prepared) const {
+    // Exclude genesis block transaction because outputs are not spendable.
+    if (pindex->nHeight == 0) {
+        return true;
+    }
+
+    CBlockUndo block_undo;
+    if (!UndoReadFromDisk(block_undo, pindex)) {
+        return error("%s: Failed to read undo data of block %s from disk",
+                     __func__, pindex->GetBlockHash().ToString());
+    }
+
+    ApplyBlock(prepared.batch, block, block_undo, pindex->nHeight, true);
+    return true;
+}
+
+bool ScriptHashIndex::Rewind(const CBlockIndex *current_tip,
+                             const CBlockIndex *new_tip) {
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    // All the blocks are removed, tip first, and the fork point written as
+    // the best block, in a single batch: an interrupted rewind must not leave
+    // some blocks removed but still covered by the best block.
+    CDBBatch batch(*m_db);
+    for (const CBlockIndex *pindex = current_tip;
+         pindex != new_tip && pindex->nHeight > 0; pindex = pindex->pprev) {
+        CBlock block;
+        CBlockUndo block_undo;
+        if (!ReadBlockAndUndo(pindex, block, block_undo)) {
+            return false;
+        }
+        ApplyBlock(batch, block, block_undo, pindex->nHeight, false);
+    }
+
+    return CommitRewind(current_tip, new_tip, batch);
+}
+
+BaseIndex::DB &ScriptHashIndex::GetDB() const {
+    return *m_db;
+}
+
+bool ScriptHashIndex::FindHistory(const uint256 &scripthash, int from_height,
+                                  std::vector<HistoryEntry> &history) const {
+    history.clear();
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+    HistoryKey key(scripthash, std::max(from_height, 0), TxId());
+    for (db_it->Seek(key); db_it->Valid(); db_it->Next()) {
+        if (!db_it->GetKey(key) || key.scripthash != scripthash) {
+            break;
+        }
+        HistoryValue value;
+        if (!db_it->GetValue(value)) {
+            return error("%s: Cannot read the history of script hash %s",
+                         __func__, scripthash.ToString());
+        }
+        HistoryEntry &entry = history.emplace_back();
+        entry.height = key.height;
+        entry.txid = key.txid;
+        entry.funded = std::move(value.funded);
+        entry.spent = std::move(value.spent);
+    }
+    return true;
+}
+
+bool ScriptHashIndex::FindUnspent(const uint256 &scripthash,
+                                  std::vector<Unspent> &unspent) const {
+    unspent.clear();
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+    UnspentKey key(scripthash, 0, COutPoint());
+    for (db_it->Seek(key); db_it->Valid(); db_it->Next()) {
+        if (!db_it->GetKey(key) || key.scripthash != scripthash) {
+            break;
+        }
+        Unspent &entry = unspent.emplace_back();
+        entry.height = key.height;
+        entry.outpoint = key.outpoint;
+        if (!db_it->GetValue(entry.txout)) {
+            return error("%s: Cannot read the unspent outputs of script hash "
+                         "%s",
+                         __func__, scripthash.ToString());
+        }
+    }
+    return true;
+}
@@ -0,0 +1,98 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <index/base.h>
+#include <primitives/transaction.h>
+#include <serialize.h>
+#include <uint256.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class CScript;
+
+/** Default for -scripthashindex */
+static constexpr bool DEFAULT_SCRIPTHASHINDEX = false;
+
+/**
+ * The hash by which an output script is indexed: the SHA256 of the script, as
+ * in the Electrum protocol. Its hex form (uint256::GetHex()) is the one used by
+ * Electrum clients.
+ */
+uint256 ScriptHash(const CScript &script);
+
+/**
+ * ScriptHashIndex is used to look up the history, the balance and the unspent
+ * outputs of an output script, by script hash. It records:
+ *  - for every transaction funding or spending outputs of a script, the
+ *    outputs it funds and the outpoints it spends, by (script hash, height,
+ *    txid);
+ *  - the unspent outputs of every script, by (script hash, height, outpoint).
+ *
+ * The keys start with the script hash, so that the entries of a script are
+ * read with a single seek, and LevelDB's prefix compression of neighbouring
+ * keys keeps them compact. The outputs of the genesis block and the
+ * unspendable outputs are not indexed, as they are not part of the UTXO set.
+ */
+class ScriptHashIndex final : public BaseIndex {
+public:
+    /** A transaction funding or spending outputs of a script. */
+    struct HistoryEntry {
+        int height = 0;
+        TxId txid;
+        //! The indexes of the outputs of the transaction paying to the script.
+        std::vector<uint32_t> funded;
+        //! The outpoints of the script spent by the transaction.
+        std::vector<COutPoint> spent;
+    };
+
+    /** An unspent output of a script. */
+    struct Unspent {
+        int height = 0;
+        COutPoint outpoint;
+        //! The amount and the tokens of the output, without its script.
+        CTxOut txout;
+    };
+
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+protected:
+    bool PrepareBlock(const CBlock &block, const CBlockIndex *pindex,
+                      PreparedBlock &prepared) const override;
+
+    bool Rewind(const CBlockIndex *current_tip,
+                const CBlockIndex *new_tip) override;
+
+    BaseIndex::DB &GetDB() const override;
+
+    const char *GetName() const override { return "scripthashindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit ScriptHashIndex(size_t n_cache_size, bool f_memory = false,
+                             bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an
+    // incomplete type.
+    virtual ~ScriptHashIndex() override;
+
+    /// Look up the transactions funding or spending outputs of a script, from
+    /// the given height, in the order of the chain.
+    bool FindHistory(const uint256 &scripthash, int from_height,
+                     std::vector<HistoryEntry> &history) const;
+
+    /// Look up the unspent outputs of a script, in the order of the chain.
+    bool FindUnspent(const uint256 &scripthash,
+                     std::vector<Unspent> &unspent) const;
+};
+
+/// The global script hash index. May be null.
+extern std::unique_ptr<ScriptHashIndex> g_scripthashindex;
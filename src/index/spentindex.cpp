@@ -0,0 +1,171 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/spentindex.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <config.h>
+#include <dbwrapper.h>
+#include <util/system.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+#include <stdexcept>
+
+constexpr char DB_SPENT = 'p';
+
+std::unique_ptr<SpentIndex> g_spentindex;
+
+namespace {
+
+/**
+ * Key of a spent outpoint. The output index is big-endian so that the outputs
+ * of a transaction are next to each other in order.
+ */
+struct SpentKey {
+    COutPoint outpoint;
+
+    explicit SpentKey(const COutPoint &outpoint_in) : outpoint(outpoint_in) {}
+
+    template <typename Stream> void Serialize(Stream &s) const {
+        ser_writedata8(s, DB_SPENT);
+        s << outpoint.GetTxId();
+        ser_writedata32be(s, outpoint.GetN());
+    }
+
+    template <typename Stream> void Unserialize(Stream &s) {
+        if (ser_readdata8(s) != DB_SPENT) {
+            throw std::ios_base::failure(
+                "Invalid format for spent index DB key");
+        }
+        TxId txid;
+        s >> txid;
+        outpoint = COutPoint(txid, ser_readdata32be(s));
+    }
+};
+
+struct SpentValue {
+    TxId txid;
+    uint32_t input_index = 0;
+    uint32_t height = 0;
+
+    SERIALIZE_METHODS(SpentValue, obj) {
+        READWRITE(obj.txid, VARINT(obj.input_index), VARINT(obj.height));
+    }
+};
+
+} // namespace
+
+/**
+ * Access to the spent index database (indexes/spent/)
+ */
+class SpentIndex::DB : public BaseIndex::DB {
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false,
+                bool f_wipe = false);
+};
+
+SpentIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex::DB(GetDataDir() / "indexes" / "spent", n_cache_size, f_memory,
+                    f_wipe) {}
+
+SpentIndex::SpentIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : m_db(std::make_unique<SpentIndex::DB>(n_cache_size, f_memory, f_wipe)) {}
+
+SpentIndex::~SpentIndex() {}
+
+bool SpentIndex::PrepareBlock(const CBlock &block, const CBlockIndex *pindex,
+                              PreparedBlock &prepared) const {
+    SpentValue value;
+    value.height = pindex->nHeight;
+    // Skip the coinbase, which spends no outpoint.
+    for (size_t i = 1; i < block.vtx.size(); ++i) {
+        const CTransaction &tx = *block.vtx[i];
+        value.txid = tx.GetId();
+        for (uint32_t n = 0; n < tx.vin.size(); ++n) {
+            value.input_index = n;
+            prepared.batch.Write(SpentKey(tx.vin[n].prevout), value);
+        }
+    }
+    return true;
+}
+
+bool SpentIndex::Rewind(const CBlockIndex *current_tip,
+                        const CBlockIndex *new_tip) {
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    // The outpoints spent by the disconnected blocks are unspent again. The
+    // blocks alone tell which they are: no undo data is needed. They are all
+    // erased, and the fork point written as the best block, in a single
+    // batch, so that an interrupted rewind leaves no block half removed.
+    const Consensus::Params &consensus_params =
+        GetConfig().GetChainParams().GetConsensus();
+    CDBBatch batch(*m_db);
+    for (const CBlockIndex *pindex = current_tip; pindex != new_tip;
+         pindex = pindex->pprev) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindex, consensus_params)) {
+            return error("%s: Failed to read block %s from disk", __func__,
+                         pindex->GetBlockHash().ToString());
+        }
+        for (size_t i = 1; i < block.vtx.size(); ++i) {
+            for (const CTxIn &txin : block.vtx[i]->vin) {
+                batch.Erase(SpentKey(txin.prevout));
+            }
+        }
+    }
+
+    return CommitRewind(current_tip, new_tip, batch);
+}
+
+BaseIndex::DB &SpentIndex::GetDB() const {
+    return *m_db;
+}
+
+bool SpentIndex::FindSpentInfo(const COutPoint &outpoint,
+                               SpentInfo &info) const {
+    SpentValue value;
+    if (!m_db->Read(SpentKey(outpoint), value)) {
+        return false;
+    }
+    info.txid = value.txid;
+    info.input_index = value.input_index;
+    info.height = value.height;
+    return true;
+}
+
+bool SpentIndex::FindSpentInfo(
+    const std::vector<COutPoint> &outpoints,
+    std::vector<std::optional<SpentInfo>> &infos) const {
+    infos.assign(outpoints.size(), std::nullopt);
+
+    // Visit the outpoints in key order, so that the seeks of the iterator only
+    // move forward and neighbouring outpoints share the blocks they read.
+    std::vector<size_t> order(outpoints.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&outpoints](size_t a, size_t b) {
+        return outpoints[a] < outpoints[b];
+    });
+
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+    for (const size_t i : order) {
+        const COutPoint &outpoint = outpoints[i];
+        db_it->Seek(SpentKey(outpoint));
+        SpentKey key(outpoint);
+        if (!db_it->Valid() || !db_it->GetKey(key) ||
+            key.outpoint != outpoint) {
+            continue;
+        }
+        SpentValue value;
+        if (!db_it->GetValue(value)) {
+            return error("%s: Cannot read the spent index entry of %s",
+                         __func__, outpoint.ToString());
+        }
+        infos[i] = SpentInfo{value.txid, value.input_index, int(value.height)};
+    }
+    return true;
+}
@@ -0,0 +1,71 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <index/base.h>
+#include <primitives/transaction.h>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+/** Default for -spentindex */
+static constexpr bool DEFAULT_SPENTINDEX = false;
+
+/**
+ * SpentIndex is used to look up the transaction of the active chain spending
+ * an outpoint. It records, for every outpoint spent by a block, the spending
+ * transaction, the index of its input spending the outpoint and the height of
+ * the block.
+ */
+class SpentIndex final : public BaseIndex {
+public:
+    /** Where an outpoint is spent. */
+    struct SpentInfo {
+        TxId txid;
+        uint32_t input_index = 0;
+        int height = 0;
+    };
+
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+protected:
+    bool PrepareBlock(const CBlock &block, const CBlockIndex *pindex,
+                      PreparedBlock &prepared) const override;
+
+    bool Rewind(const CBlockIndex *current_tip,
+                const CBlockIndex *new_tip) override;
+
+    BaseIndex::DB &GetDB() const override;
+
+    const char *GetName() const override { return "spentindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit SpentIndex(size_t n_cache_size, bool f_memory = false,
+                        bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an
+    // incomplete type.
+    virtual ~SpentIndex() override;
+
+    /// Look up where an outpoint is spent. Returns false if it is not spent
+    /// in the active chain.
+    bool FindSpentInfo(const COutPoint &outpoint, SpentInfo &info) const;
+
+    /// Look up where each of outpoints is spent, setting the entries of infos
+    /// of those not spent in the active chain to nullopt. The lookups are made
+    /// in key order with a single iterator.
+    bool FindSpentInfo(const std::vector<COutPoint> &outpoints,
+                       std::vector<std::optional<SpentInfo>> &infos) const;
+};
+
+/// The global spent index. May be null.
+extern std::unique_ptr<SpentIndex> g_spentindex;
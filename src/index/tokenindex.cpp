@@ -0,0 +1,372 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/tokenindex.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <config.h>
+#include <dbwrapper.h>
+#include <undo.h>
+#include <util/system.h>
+#include <validation.h>
+
+#include <cassert>
+#include <map>
+#include <stdexcept>
+
+constexpr char DB_CATEGORY = 'c';
+constexpr char DB_UNSPENT = 'o';
+
+std::unique_ptr<TokenIndex> g_tokenindex;
+
+namespace {
+
+struct CategoryKey {
+    token::Id category;
+
+    explicit CategoryKey(const token::Id &category_in)
+        : category(category_in) {}
+
+    SERIALIZE_METHODS(CategoryKey, obj) {
+        char prefix = DB_CATEGORY;
+        READWRITE(prefix);
+        if (prefix != DB_CATEGORY) {
+            throw std::ios_base::failure(
+                "Invalid format for token index DB category key");
+        }
+        READWRITE(obj.category);
+    }
+};
+
+/**
+ * Key of an unspent output holding tokens of a category. The output index is
+ * big-endian so that the outputs of a transaction are read in order.
+ */
+struct UnspentKey {
+    token::Id category;
+    COutPoint outpoint;
+
+    UnspentKey(const token::Id &category_in, const COutPoint &outpoint_in)
+        : category(category_in), outpoint(outpoint_in) {}
+
+    template <typename Stream> void Serialize(Stream &s) const {
+        ser_writedata8(s, DB_UNSPENT);
+        s << category << outpoint.GetTxId();
+        ser_writedata32be(s, outpoint.GetN());
+    }
+
+    template <typename Stream> void Unserialize(Stream &s) {
+        if (ser_readdata8(s) != DB_UNSPENT) {
+            throw std::ios_base::failure(
+                "Invalid format for token index DB unspent key");
+        }
+        TxId txid;
+        s >> category >> txid;
+        outpoint = COutPoint(txid, ser_readdata32be(s));
+    }
+};
+
+struct UnspentValue {
+    uint32_t height = 0;
+    CTxOut txout;
+
+    UnspentValue() = default;
+    UnspentValue(uint32_t height_in, const CTxOut &txout_in)
+        : height(height_in), txout(txout_in) {}
+
+    SERIALIZE_METHODS(UnspentValue, obj) {
+        READWRITE(VARINT(obj.height), obj.txout);
+    }
+};
+
+/** Change of the supply of a category. */
+struct CategoryDelta {
+    int64_t fungible_amount = 0;
+    int64_t utxo_count = 0;
+    int64_t nft_immutable = 0;
+    int64_t nft_mutable = 0;
+    int64_t nft_minting = 0;
+
+    void Add(const token::OutputData &token, int sign) {
+        fungible_amount += sign * token.GetAmount().getint64();
+        utxo_count += sign;
+        if (token.IsImmutableNFT()) {
+            nft_immutable += sign;
+        } else if (token.IsMutableNFT()) {
+            nft_mutable += sign;
+        } else if (token.IsMintingNFT()) {
+            nft_minting += sign;
+        }
+    }
+
+    void Add(const CategoryDelta &other) {
+        fungible_amount += other.fungible_amount;
+        utxo_count += other.utxo_count;
+        nft_immutable += other.nft_immutable;
+        nft_mutable += other.nft_mutable;
+        nft_minting += other.nft_minting;
+    }
+};
+
+/** Apply delta to a count, failing if it would go negative. */
+template <typename T> bool ApplyDelta(T &value, int64_t delta) {
+    const int64_t result = int64_t(value) + delta;
+    if (result < 0) {
+        return false;
+    }
+    value = T(result);
+    return true;
+}
+
+/**
+ * Add the changes of the unspent outputs holding tokens to batch, and the
+ * changes of the supplies of their categories to deltas, when connecting the
+ * block at height, or disconnecting it.
+ */
+void ApplyBlock(CDBBatch &batch, std::map<token::Id, CategoryDelta> &deltas,
+                const CBlock &block, const CBlockUndo &block_undo, int height,
+                bool connect) {
+    const int sign = connect ? 1 : -1;
+
+    // The supply changes are summed transaction by transaction: a transaction
+    // cannot create more fungible tokens of a category than it spends, except
+    // for its genesis, so the running totals cannot overflow even when the
+    // same tokens move several times within the block, or the blocks.
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        const CTransaction &tx = *block.vtx[i];
+        std::map<token::Id, CategoryDelta> tx_deltas;
+        for (const CTxOut &txout : tx.vout) {
+            if (txout.tokenDataPtr && !txout.scriptPubKey.IsUnspendable()) {
+                tx_deltas[txout.tokenDataPtr->GetId()].Add(*txout.tokenDataPtr,
+                                                           sign);
+            }
+        }
+        if (i > 0) {
+            for (const Coin &coin : block_undo.vtxundo[i - 1].vprevout) {
+                const CTxOut &txout = coin.GetTxOut();
+                if (txout.tokenDataPtr) {
+                    tx_deltas[txout.tokenDataPtr->GetId()].Add(
+                        *txout.tokenDataPtr, -sign);
+                }
+            }
+        }
+        for (const auto &[category, delta] : tx_deltas) {
+            deltas[category].Add(delta);
+        }
+    }
+
+    const auto applyCreated = [&] {
+        for (const CTransactionRef &tx : block.vtx) {
+            for (uint32_t n = 0; n < tx->vout.size(); ++n) {
+                const CTxOut &txout = tx->vout[n];
+                if (!txout.tokenDataPtr || txout.scriptPubKey.IsUnspendable()) {
+                    continue;
+                }
+                const UnspentKey key(txout.tokenDataPtr->GetId(),
+                                     COutPoint(tx->GetId(), n));
+                if (connect) {
+                    batch.Write(key, UnspentValue(height, txout));
+                } else {
+                    batch.Erase(key);
+                }
+            }
+        }
+    };
+
+    const auto applySpent = [&] {
+        for (size_t i = 1; i < block.vtx.size(); ++i) {
+            const CTransaction &tx = *block.vtx[i];
+            const CTxUndo &tx_undo = block_undo.vtxundo[i - 1];
+            for (size_t j = 0; j < tx.vin.size(); ++j) {
+                const Coin &coin = tx_undo.vprevout[j];
+                if (!coin.GetTxOut().tokenDataPtr) {
+                    continue;
+                }
+                const UnspentKey key(coin.GetTxOut().tokenDataPtr->GetId(),
+                                     tx.vin[j].prevout);
+                if (connect) {
+                    batch.Erase(key);
+                } else {
+                    batch.Write(key, UnspentValue(coin.GetHeight(),
+                                                  coin.GetTxOut()));
+                }
+            }
+        }
+    };
+
+    // Outputs created and spent within the block must end up absent whatever
+    // the order of the transactions, so the creations are applied first when
+    // connecting and last when disconnecting.
+    if (connect) {
+        applyCreated();
+        applySpent();
+    } else {
+        applySpent();
+        applyCreated();
+    }
+}
+
+/**
+ * Add the supplies of db changed by deltas to batch. If unwritten is not null,
+ * the supplies it has, which an earlier change of batch made, are used instead
+ * of those of db, and it gets the new ones.
+ */
+bool WriteCategoryStats(
+    const CDBWrapper &db, CDBBatch &batch,
+    const std::map<token::Id, CategoryDelta> &deltas,
+    std::map<token::Id, TokenIndex::CategoryStats> *unwritten = nullptr) {
+    for (const auto &[category, delta] : deltas) {
+        const CategoryKey key(category);
+        TokenIndex::CategoryStats stats;
+        if (unwritten && unwritten->count(category)) {
+            stats = unwritten->at(category);
+        } else if (db.Exists(key) && !db.Read(key, stats)) {
+            return error("%s: Cannot read the supply of token category %s",
+                         __func__, category.ToString());
+        }
+        if (!ApplyDelta(stats.fungible_amount, delta.fungible_amount) ||
+            !ApplyDelta(stats.utxo_count, delta.utxo_count) ||
+            !ApplyDelta(stats.nft_immutable, delta.nft_immutable) ||
+            !ApplyDelta(stats.nft_mutable, delta.nft_mutable) ||
+            !ApplyDelta(stats.nft_minting, delta.nft_minting)) {
+            return error("%s: Negative supply of token category %s", __func__,
+                         category.ToString());
+        }
+        if (stats.utxo_count == 0) {
+            batch.Erase(key);
+        } else {
+            batch.Write(key, stats);
+        }
+        if (unwritten) {
+            (*unwritten)[category] = stats;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+/**
+ * Access to the token index database (indexes/token/)
+ */
+class TokenIndex::DB : public BaseIndex::DB {
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false,
+                bool f_wipe = false);
+};
+
+TokenIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex::DB(GetDataDir() / "indexes" / "token", n_cache_size, f_memory,
+                    f_wipe) {}
+
+TokenIndex::TokenIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : m_db(std::make_unique<TokenIndex::DB>(n_cache_size, f_memory, f_wipe)) {}
+
+TokenIndex::~TokenIndex() {}
+
+bool TokenIndex::WriteBlock(const CBlock &block, const CBlockIndex *pindex,
+                            PreparedBlock &prepared, CDBBatch &batch) {
+    // The genesis block has no undo data and holds no tokens.
+    if (pindex->nHeight == 0) {
+        return true;
+    }
+
+    CBlockUndo block_undo;
+    if (!UndoReadFromDisk(block_undo, pindex)) {
+        return error("%s: Failed to read undo data of block %s from disk",
+                     __func__, pindex->GetBlockHash().ToString());
+    }
+
+    // The supplies are updated in place, so applying a block twice would count
+    // it twice: this relies on the entries of each block being written along
+    // with the best block (see BaseIndex::WriteBlock).
+    std::map<token::Id, CategoryDelta> deltas;
+    ApplyBlock(batch, deltas, block, block_undo, pindex->nHeight, true);
+    if (!WriteCategoryStats(*m_db, batch, deltas, &m_unwritten_stats)) {
+        return error("%s: Failed to add block %s to %s", __func__,
+                     pindex->GetBlockHash().ToString(), GetName());
+    }
+    return true;
+}
+
+bool TokenIndex::CommitInternal(CDBBatch &batch) {
+    // The supplies are written along with batch.
+    m_unwritten_stats.clear();
+    return BaseIndex::CommitInternal(batch);
+}
+
+void TokenIndex::WriteBestBlock(CDBBatch &batch, const CBlockIndex *pindex) {
+    LOCK(cs_main);
+    m_db->WriteBestBlock(batch, ::ChainActive().GetLocator(pindex));
+}
+
+bool TokenIndex::Rewind(const CBlockIndex *current_tip,
+                        const CBlockIndex *new_tip) {
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    // All the blocks are removed, and the fork point written as the best
+    // block, in a single batch: the supplies are updated in place, so an
+    // interrupted rewind must not leave some blocks removed but still covered
+    // by the best block.
+    const Consensus::Params &consensus_params =
+        GetConfig().GetChainParams().GetConsensus();
+    CDBBatch batch(*m_db);
+    std::map<token::Id, CategoryDelta> deltas;
+    for (const CBlockIndex *pindex = current_tip;
+         pindex != new_tip && pindex->nHeight > 0; pindex = pindex->pprev) {
+        CBlock block;
+        CBlockUndo block_undo;
+        if (!ReadBlockFromDisk(block, pindex, consensus_params) ||
+            !UndoReadFromDisk(block_undo, pindex)) {
+            return error("%s: Failed to read block %s or its undo data from "
+                         "disk",
+                         __func__, pindex->GetBlockHash().ToString());
+        }
+        ApplyBlock(batch, deltas, block, block_undo, pindex->nHeight, false);
+    }
+    if (!WriteCategoryStats(*m_db, batch, deltas)) {
+        return error("%s: Failed to rewind %s to block %s", __func__,
+                     GetName(), new_tip->GetBlockHash().ToString());
+    }
+    WriteBestBlock(batch, new_tip);
+    if (!m_db->WriteBatch(batch)) {
+        return error("%s: Failed to rewind %s to block %s", __func__,
+                     GetName(), new_tip->GetBlockHash().ToString());
+    }
+
+    return BaseIndex::Rewind(current_tip, new_tip);
+}
+
+BaseIndex::DB &TokenIndex::GetDB() const {
+    return *m_db;
+}
+
+bool TokenIndex::FindCategoryStats(const token::Id &category,
+                                   CategoryStats &stats) const {
+    return m_db->Read(CategoryKey(category), stats);
+}
+
+bool TokenIndex::FindUnspent(const token::Id &category,
+                             std::vector<Unspent> &unspent) const {
+    unspent.clear();
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+    UnspentKey key(category, COutPoint(TxId(), 0));
+    for (db_it->Seek(key); db_it->Valid(); db_it->Next()) {
+        if (!db_it->GetKey(key) || key.category != category) {
+            break;
+        }
+        UnspentValue value;
+        if (!db_it->GetValue(value)) {
+            return error("%s: Cannot read the unspent outputs of token "
+                         "category %s",
+                         __func__, category.ToString());
+        }
+        Unspent &entry = unspent.emplace_back();
+        entry.height = value.height;
+        entry.outpoint = key.outpoint;
+        entry.txout = std::move(value.txout);
+    }
+    return true;
+}
@@ -0,0 +1,105 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <index/base.h>
+#include <primitives/token.h>
+#include <primitives/transaction.h>
+#include <serialize.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+class CDBBatch;
+
+/** Default for -tokenindex */
+static constexpr bool DEFAULT_TOKENINDEX = false;
+
+/**
+ * TokenIndex is used to look up the tokens of a token category (token::Id)
+ * without scanning the UTXO set. It records:
+ *  - per category, the live supply: the fungible amount, the number of NFTs
+ *    by capability and the number of outputs holding tokens of the category;
+ *  - per category, the unspent outputs holding its tokens, by outpoint.
+ *
+ * Both are updated incrementally as blocks are connected, and rewound using
+ * the undo data of the blocks when they are disconnected.
+ */
+class TokenIndex final : public BaseIndex {
+public:
+    /** The live supply of a token category. */
+    struct CategoryStats {
+        //! The total fungible amount of the unspent outputs of the category.
+        int64_t fungible_amount = 0;
+        //! The number of unspent outputs holding tokens of the category.
+        uint64_t utxo_count = 0;
+        //! The number of NFTs of the category, by capability.
+        uint64_t nft_immutable = 0;
+        uint64_t nft_mutable = 0;
+        uint64_t nft_minting = 0;
+
+        SERIALIZE_METHODS(CategoryStats, obj) {
+            READWRITE(obj.fungible_amount, VARINT(obj.utxo_count),
+                      VARINT(obj.nft_immutable), VARINT(obj.nft_mutable),
+                      VARINT(obj.nft_minting));
+        }
+    };
+
+    /** An unspent output holding tokens of a category. */
+    struct Unspent {
+        int height = 0;
+        COutPoint outpoint;
+        CTxOut txout;
+    };
+
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+    /// The supplies of the categories changed by the blocks written to the
+    /// batch not committed yet, which the database does not have yet.
+    std::map<token::Id, CategoryStats> m_unwritten_stats;
+
+    /// Add the locator of pindex as the best block of the index to batch.
+    void WriteBestBlock(CDBBatch &batch, const CBlockIndex *pindex);
+
+protected:
+    bool WriteBlock(const CBlock &block, const CBlockIndex *pindex,
+                    PreparedBlock &prepared, CDBBatch &batch) override;
+
+    bool CommitInternal(CDBBatch &batch) override;
+
+    bool Rewind(const CBlockIndex *current_tip,
+                const CBlockIndex *new_tip) override;
+
+    BaseIndex::DB &GetDB() const override;
+
+    const char *GetName() const override { return "tokenindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit TokenIndex(size_t n_cache_size, bool f_memory = false,
+                        bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an
+    // incomplete type.
+    virtual ~TokenIndex() override;
+
+    /// Look up the live supply of a category. Returns false if no unspent
+    /// output holds tokens of the category.
+    bool FindCategoryStats(const token::Id &category,
+                           CategoryStats &stats) const;
+
+    /// Look up the unspent outputs holding tokens of a category.
+    bool FindUnspent(const token::Id &category,
+                     std::vector<Unspent> &unspent) const;
+};
+
+/// The global token index. May be null.
+extern std::unique_ptr<TokenIndex> g_tokenindex;
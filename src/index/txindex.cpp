@@ -54,8 +54,9 @@ public:
     /// Returns false if the transaction ID is not indexed.
     bool ReadTxPos(const TxId &txid, CDiskTxPos &pos) const;
 
-    /// Write a batch of transaction positions to the DB.
-    bool WriteTxs(const std::vector<std::pair<TxId, CDiskTxPos>> &v_pos);
+    /// Add transaction positions to a batch for the DB.
+    void WriteTxs(CDBBatch &batch,
+                  const std::vector<std::pair<TxId, CDiskTxPos>> &v_pos) const;
 
     /// Migrate txindex data from the block tree DB, where it may be for older
     /// nodes that have not been upgraded yet to the new database.
@@ -71,13 +72,12 @@ bool TxIndex::DB::ReadTxPos(const TxId &txid, CDiskTxPos &pos) const {
     return Read(std::make_pair(DB_TXINDEX, txid), pos);
 }
 
-bool TxIndex::DB::WriteTxs(
-    const std::vector<std::pair<TxId, CDiskTxPos>> &v_pos) {
-    CDBBatch batch(*this);
+void TxIndex::DB::WriteTxs(
+    CDBBatch &batch,
+    const std::vector<std::pair<TxId, CDiskTxPos>> &v_pos) const {
     for (const auto &tuple : v_pos) {
         batch.Write(std::make_pair(DB_TXINDEX, tuple.first), tuple.second);
     }
-    return WriteBatch(batch);
 }
 
 /*
@@ -240,7 +240,8 @@ bool TxIndex::Init() {
     return BaseIndex::Init();
 }
 
-bool TxIndex::WriteBlock(const CBlock &block, const CBlockIndex *pindex) {
+bool TxIndex::PrepareBlock(const CBlock &block, const CBlockIndex *pindex,
+                           PreparedBlock &prepared) const {
     // Exclude genesis block transaction because outputs are not spendable.
     if (pindex->nHeight == 0) {
         return true;
@@ -254,7 +255,8 @@ bool TxIndex::WriteBlock(const CBlock &block, const CBlockIndex *pindex) {
         vPos.emplace_back(tx->GetId(), pos);
         pos.nTxOffset += ::GetSerializeSize(*tx, CLIENT_VERSION);
     }
-    return m_db->WriteTxs(vPos);
+    m_db->WriteTxs(prepared.batch, vPos);
+    return true;
 }
 
 BaseIndex::DB &TxIndex::GetDB() const {
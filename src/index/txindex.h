@@ -26,7 +26,8 @@ protected:
     /// Override base class init to migrate from old database.
     bool Init() override;
 
-    bool WriteBlock(const CBlock &block, const CBlockIndex *pindex) override;
+    bool PrepareBlock(const CBlock &block, const CBlockIndex *pindex,
+                      PreparedBlock &prepared) const override;
 
     BaseIndex::DB &GetDB() const override;
 
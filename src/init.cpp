@@ -13,9 +13,12 @@
 #include <addrman.h>
 #include <amount.h>
 #include <banman.h>
+#include <blockprefetch.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <checkpoints.h>
+#include <coinsflush.h>
+#include <coinsprefetch.h>
 #include <compat/sanity.h>
 #include <config.h>
 #include <consensus/validation.h>
@@ -28,6 +31,10 @@
 #include <hash.h>
 #include <httprpc.h>
 #include <httpserver.h>
+#include <index/blockfilterindex.h>
+#include <index/scripthashindex.h>
+#include <index/spentindex.h>
+#include <index/tokenindex.h>
 #include <index/txindex.h>
 #include <interfaces/chain.h>
 #include <key.h>
@@ -56,9 +63,12 @@
 #include <ui_interface.h>
 #include <util/asmap.h>
 #include <util/moneystr.h>
+#include <util/strencodings.h>
 #include <util/string.h>
 #include <util/system.h>
 #include <util/threadnames.h>
+#include <utxo_snapshot.h>
+#include <utxostats.h>
 #include <validation.h>
 #include <validationinterface.h>
 #include <walletinitinterface.h>
@@ -78,6 +88,7 @@
 #include <cstdint>
 #include <cstdio>
 #include <memory>
+#include <set>
 #include <thread>
 
 #ifdef ENABLE_WALLET
@@ -207,6 +218,16 @@ void Interrupt() {
     if (g_txindex) {
         g_txindex->Interrupt();
     }
+    if (g_scripthashindex) {
+        g_scripthashindex->Interrupt();
+    }
+    if (g_spentindex) {
+        g_spentindex->Interrupt();
+    }
+    if (g_tokenindex) {
+        g_tokenindex->Interrupt();
+    }
+    ForEachBlockFilterIndex([](BaseIndex &index) { index.Interrupt(); });
 }
 
 void Shutdown(NodeContext &node) {
@@ -244,6 +265,16 @@ void Shutdown(NodeContext &node) {
     if (g_txindex) {
         g_txindex->Stop();
     }
+    if (g_scripthashindex) {
+        g_scripthashindex->Stop();
+    }
+    if (g_spentindex) {
+        g_spentindex->Stop();
+    }
+    if (g_tokenindex) {
+        g_tokenindex->Stop();
+    }
+    ForEachBlockFilterIndex([](BaseIndex &index) { index.Stop(); });
 
     StopTorControl();
 
@@ -258,6 +289,9 @@ void Shutdown(NodeContext &node) {
     }
 
     StopScriptCheckWorkerThreads();
+    StopTxPreVerifyThreads();
+    StopBlockPrefetchThreads();
+    StopCoinsPrefetchThreads();
 
     // After the threads that potentially access these pointers have been
     // stopped, destruct and reset all to nullptr.
@@ -265,6 +299,11 @@ void Shutdown(NodeContext &node) {
     g_connman.reset();
     g_banman.reset();
     g_txindex.reset();
+    g_scripthashindex.reset();
+    g_spentindex.reset();
+    g_tokenindex.reset();
+    DestroyAllBlockFilterIndexes();
+    g_incremental_block_assembler.reset();
 
     if (::g_mempool.IsLoaded() &&
         gArgs.GetArg("-persistmempool", DEFAULT_PERSIST_MEMPOOL)) {
@@ -295,8 +334,10 @@ void Shutdown(NodeContext &node) {
         if (pcoinsTip != nullptr) {
             FlushStateToDisk();
         }
+        g_utxo_stats.reset();
         pcoinsTip.reset();
         pcoinscatcher.reset();
+        pcoinsflusher.reset();
         pcoinsdbview.reset();
         pblocktree.reset();
     }
@@ -424,6 +465,13 @@ void SetupServerArgs() {
                            "(default: %d)",
                            DEFAULT_AUTOMATIC_UNPARKING),
                  ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-backgroundflush",
+                 strprintf("Write the coins database in the background when "
+                           "flushing the cache, so that validation does not "
+                           "wait for it, unless a complete write is needed "
+                           "(default: %d)",
+                           DEFAULT_BACKGROUND_FLUSH),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     gArgs.AddArg("-blocksdir=<dir>",
                  "Specify directory to hold blocks subdirectory for *.dat "
                  "files (default: <datadir>)",
@@ -431,6 +479,19 @@ void SetupServerArgs() {
     gArgs.AddArg("-indexdir=<dir>",
                  "Specify directory to hold leveldb files (default: <datadir>)",
                  ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-blockfilterindex=<type>",
+                 strprintf("Maintain an index of compact filters by block "
+                           "(default: %s, values: %s).",
+                           DEFAULT_BLOCKFILTERINDEX, ListBlockFilterTypes()) +
+                     " If <type> is not supplied or if <type> = 1, indexes "
+                     "for all known types are enabled.",
+                 ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-blockmapfiles=<n>",
+                 strprintf("Number of block files, and of undo files, to "
+                           "keep memory-mapped for reading blocks from, 0 to "
+                           "read them without mapping them (default: %d)",
+                           DEFAULT_BLOCK_MAP_FILES),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     gArgs.AddArg("-blocknotify=<cmd>",
                  "Execute command when the best block changes (%s in cmd is "
                  "replaced by block hash)",
@@ -440,6 +501,12 @@ void SetupServerArgs() {
                            "block reconstructions (default: %u)",
                            DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN),
                  ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-blockprefetch=<n>",
+                 strprintf("Number of blocks to read and deserialize in the "
+                           "background ahead of the block being connected, "
+                           "0 to disable (up to %d, default: %d)",
+                           MAX_BLOCK_PREFETCH, DEFAULT_BLOCK_PREFETCH),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     gArgs.AddArg("-blocksonly",
                  strprintf("Whether to reject transactions from network peers. Transactions from the wallet or RPC are "
                            "not affected. (default: %d)",
@@ -513,6 +580,20 @@ void SetupServerArgs() {
     gArgs.AddArg("-loadblock=<file>",
                  "Imports blocks from external blk000??.dat file on startup",
                  ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-loadutxoset=<file>",
+                 "Bootstrap an empty chainstate from a UTXO snapshot file "
+                 "written by the dumputxoset RPC, instead of from the blocks "
+                 "below the snapshot, which are treated as pruned. The blocks "
+                 "below the snapshot are never downloaded nor validated: the "
+                 "snapshot is trusted in their place for as long as the node "
+                 "keeps this chainstate. Requires -prune",
+                 ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-loadutxosethash=<hash>",
+                 "Only load a -loadutxoset snapshot whose UTXO set commitment "
+                 "(as returned by dumputxoset) is <hash>. Without it, only a "
+                 "snapshot whose commitment is built into the client is "
+                 "loaded",
+                 ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     gArgs.AddArg("-maxmempool=<n>", strprintf("Keep the transaction memory pool below <n> "
                  "megabytes (default: %u, testnet: %u, testnet4: %u, scalenet: %u, chipnet: %u)",
                  DEFAULT_MAX_MEMPOOL_SIZE_PER_MB * defaultChainParams->GetConsensus().nDefaultExcessiveBlockSize / ONE_MEGABYTE,
@@ -560,6 +641,15 @@ void SetupServerArgs() {
                   MAX_SCRIPTCHECK_THREADS,
                   DEFAULT_SCRIPTCHECK_THREADS),
         ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg(
+        "-parengine=<engine>",
+        strprintf("Select the script verification queue implementation. "
+                  "'legacy' shares one locked queue among all threads, "
+                  "'workstealing' gives each thread its own queue and "
+                  "supports up to %d threads (default: %s)",
+                  MAX_SCRIPTCHECK_THREADS_WORKSTEALING + 1,
+                  GetCheckQueueEngineName(DEFAULT_SCRIPTCHECK_ENGINE)),
+        ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     gArgs.AddArg("-parkdeepreorg",
                  strprintf("If connecting a new block would require rewinding "
                            "more than one block from the active chain (i.e., "
@@ -572,11 +662,24 @@ void SetupServerArgs() {
                            "on restart (default: %u)",
                            DEFAULT_PERSIST_MEMPOOL),
                  ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-txpreverify",
+                 strprintf("Verify the signatures of relayed transactions, and of the transactions "
+                           "loaded from mempool.dat, by batches, on the script verification threads "
+                           "(-par) before taking the validation lock to add them to the mempool "
+                           "(default: %u)",
+                           DEFAULT_TX_PREVERIFY),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     gArgs.AddArg("-pid=<file>",
                  strprintf("Specify pid file. Relative paths will be prefixed "
                            "by a net-specific datadir location. (default: %s)",
                            FITTEXXCOIN_PID_FILENAME),
                  ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-prefetchcoins=<n>",
+                 strprintf("Number of threads fetching the coins spent by a "
+                           "block from the database in parallel before "
+                           "connecting it, 0 to disable (up to %d, default: %d)",
+                           MAX_COINS_PREFETCH_THREADS, DEFAULT_COINS_PREFETCH_THREADS),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     gArgs.AddArg(
         "-prune=<n>",
         strprintf("Reduce storage requirements by enabling pruning (deleting) "
@@ -608,6 +711,24 @@ void SetupServerArgs() {
 #else
     hidden_args.emplace_back("-sysperms");
 #endif
+    gArgs.AddArg("-scripthashindex",
+                 strprintf("Maintain an index of the history and the unspent "
+                           "outputs of output scripts by script hash, used by "
+                           "the getscripthash* rpc calls (default: %d)",
+                           DEFAULT_SCRIPTHASHINDEX),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-spentindex",
+                 strprintf("Maintain an index of the transactions spending "
+                           "every outpoint, used by the getspendinginfo rpc "
+                           "call (default: %d)",
+                           DEFAULT_SPENTINDEX),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-tokenindex",
+                 strprintf("Maintain an index of the live supply and the "
+                           "unspent outputs of token categories, used by the "
+                           "gettokencategory* rpc calls (default: %d)",
+                           DEFAULT_TOKENINDEX),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     gArgs.AddArg("-txindex",
                  strprintf("Maintain a full transaction index, used by the "
                            "getrawtransaction rpc call (default: %d)",
@@ -623,6 +744,13 @@ void SetupServerArgs() {
                   "without warning.",
                   DEFAULT_USE_CASHADDR),
         ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-utxostats",
+                 strprintf("Maintain statistics of the UTXO set as blocks are "
+                           "connected, so that gettxoutsetinfo answers without "
+                           "scanning it. This costs an elliptic curve "
+                           "operation per coin created or spent (default: %d)",
+                           DEFAULT_UTXO_STATS),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
 
     gArgs.AddArg("-addnode=<ip>",
                  "Add a node to connect to and attempt to keep the connection "
@@ -723,6 +851,11 @@ void SetupServerArgs() {
                            "bloom filters (default: %d)",
                            DEFAULT_PEERBLOOMFILTERS),
                  ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
+    gArgs.AddArg("-peerblockfilters",
+                 strprintf("Serve compact block filters to peers per BIP 157 "
+                           "(default: %d)",
+                           DEFAULT_PEERBLOCKFILTERS),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     gArgs.AddArg("-port=<port>",
                  strprintf("Listen for connections on <port> (default: %u, "
                            "testnet: %u, testnet4: %u, scalenet: %u, chipnet: %u, regtest: %u)",
@@ -755,6 +888,18 @@ void SetupServerArgs() {
                   "the connection to it is dropped. (minimum: 1, default: %d)",
                   DEFAULT_PEER_CONNECT_TIMEOUT),
         ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::CONNECTION);
+    gArgs.AddArg("-msghandlerthreads=<n>",
+                 strprintf("Process the messages of the peers with <n> threads, "
+                           "each peer being pinned to one of them (1 to %d, "
+                           "default: %d)",
+                           MAX_MSGHANDLER_THREADS, DEFAULT_MSGHANDLER_THREADS),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
+    gArgs.AddArg("-socketevents=<mode>",
+                 strprintf("Wait for the peer sockets with the given mode, "
+                           "one of: %s (default: %s)",
+                           GetSupportedSocketEventsModes(),
+                           SocketEventsModeToString(DEFAULT_SOCKETEVENTS_MODE)),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     gArgs.AddArg(
         "-torcontrol=<ip>:<port>",
         strprintf(
@@ -1105,6 +1250,14 @@ void SetupServerArgs() {
                            "template_request object given to gbt. (default: %d)", DEFAULT_GBT_CHECK_VALIDITY),
                  ArgsManager::ALLOW_ANY, OptionsCategory::BLOCK_CREATION);
 
+    gArgs.AddArg("-incrementalblocktemplate",
+                 strprintf("Keep the transactions of the block template up to date as they enter and leave the "
+                           "mempool, so that getblocktemplate and getblocktemplatelight need not select them on every "
+                           "call. The template is then only tested for validity when they are selected from scratch: "
+                           "for each new block, and when it is stale, at most every %d seconds. (default: %d)",
+                           IncrementalBlockAssembler::REFRESH_INTERVAL / 1000000, DEFAULT_INCREMENTAL_BLOCK_TEMPLATE),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::BLOCK_CREATION);
+
     gArgs.AddArg("-blockmintxfee=<amt>",
                  strprintf("Set lowest fee rate (in %s/kB) for transactions to "
                            "be included in block creation. (default: %s)",
@@ -1165,6 +1318,19 @@ void SetupServerArgs() {
             "Set the number of threads to service RPC calls (default: %d)",
             DEFAULT_HTTP_THREADS),
         ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
+    gArgs.AddArg("-rpcworkerthreads=<n>",
+                 strprintf("Set the number of threads that share the work of "
+                           "RPC calls returning large results, such as "
+                           "verbose blocks (0 to disable, default: %d)",
+                           DEFAULT_RPC_WORKER_THREADS),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
+    gArgs.AddArg("-rpcbatchworkers=<n>",
+                 strprintf("Run the calls of a JSON-RPC batch in parallel, on "
+                           "up to <n> of the -rpcworkerthreads threads per "
+                           "batch besides its own (0 to run them in order, "
+                           "default: %d)",
+                           DEFAULT_RPC_BATCH_WORKERS),
+                 ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     gArgs.AddArg(
         "-rpccorsdomain=value",
         "Domain from which to accept cross origin requests (browser enforced)",
@@ -1617,6 +1783,7 @@ int nUserMaxConnections;
 int nFD;
 ServiceFlags nLocalServices = ServiceFlags(NODE_NETWORK | NODE_NETWORK_LIMITED);
 int64_t peer_connect_timeout;
+std::set<BlockFilterType> g_enabled_filter_types;
 
 } // namespace
 
@@ -1712,11 +1879,56 @@ bool AppInitParameterInteraction(Config &config) {
                 strprintf("Error creating index directory: %s", e.what()));
     }
 
-    // if using block pruning, then disallow txindex
+    // parse and validate enabled filter types
+    const std::string blockfilterindex_value =
+        gArgs.GetArg("-blockfilterindex", DEFAULT_BLOCKFILTERINDEX);
+    if (blockfilterindex_value == "" || blockfilterindex_value == "1") {
+        g_enabled_filter_types = AllBlockFilterTypes();
+    } else if (blockfilterindex_value != "0") {
+        const std::vector<std::string> names =
+            gArgs.GetArgs("-blockfilterindex");
+        for (const auto &name : names) {
+            BlockFilterType filter_type;
+            if (!BlockFilterTypeByName(name, filter_type)) {
+                return InitError(
+                    strprintf(_("Unknown -blockfilterindex value %s."), name));
+            }
+            g_enabled_filter_types.insert(filter_type);
+        }
+    }
+
+    // Signal NODE_CF if peerblockfilters and basic filters index are both
+    // enabled.
+    if (gArgs.GetBoolArg("-peerblockfilters", DEFAULT_PEERBLOCKFILTERS)) {
+        if (g_enabled_filter_types.count(BlockFilterType::BASIC) != 1) {
+            return InitError(
+                _("Cannot set -peerblockfilters without -blockfilterindex."));
+        }
+        nLocalServices = ServiceFlags(nLocalServices | NODE_CF);
+    }
+
+    // if using block pruning, then disallow txindex, blockfilterindex,
+    // scripthashindex, spentindex and tokenindex
     if (gArgs.GetArg("-prune", 0)) {
         if (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX)) {
             return InitError(_("Prune mode is incompatible with -txindex."));
         }
+        if (!g_enabled_filter_types.empty()) {
+            return InitError(
+                _("Prune mode is incompatible with -blockfilterindex."));
+        }
+        if (gArgs.GetBoolArg("-scripthashindex", DEFAULT_SCRIPTHASHINDEX)) {
+            return InitError(
+                _("Prune mode is incompatible with -scripthashindex."));
+        }
+        if (gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX)) {
+            return InitError(_("Prune mode is incompatible with -spentindex."));
+        }
+        if (gArgs.GetBoolArg("-tokenindex", DEFAULT_TOKENINDEX)) {
+            return InitError(_("Prune mode is incompatible with -tokenindex."));
+        }
+    } else if (gArgs.IsArgSet("-loadutxoset")) {
+        return InitError(_("-loadutxoset requires -prune."));
     }
 
     // -bind and -whitebind can't be set when not listening
@@ -1796,6 +2008,7 @@ bool AppInitParameterInteraction(Config &config) {
     fCheckBlockIndex = gArgs.GetBoolArg("-checkblockindex",
                                         chainparams.DefaultConsistencyChecks());
     fCheckBlockReads = gArgs.GetBoolArg("-checkblockreads", chainparams.DefaultConsistencyChecks());
+    SetBlockMapFiles(std::max<int64_t>(gArgs.GetArg("-blockmapfiles", DEFAULT_BLOCK_MAP_FILES), 0));
     fCheckpointsEnabled =
         gArgs.GetBoolArg("-checkpoints", DEFAULT_CHECKPOINTS_ENABLED);
     if (fCheckpointsEnabled) {
@@ -2010,6 +2223,7 @@ bool AppInitParameterInteraction(Config &config) {
     }
 
     fIsBareMultisigStd = gArgs.GetBoolArg("-permitbaremultisig", DEFAULT_PERMIT_BAREMULTISIG);
+    fTxPreVerify = gArgs.GetBoolArg("-txpreverify", DEFAULT_TX_PREVERIFY);
     nMaxDatacarrierBytes = gArgs.GetArg("-datacarriersize", MAX_OP_RETURN_RELAY);
 
     // Option to startup with mocktime set (used for regression testing):
@@ -2062,6 +2276,7 @@ bool AppInitSanityChecks() {
     // Initialize elliptic curve code
     std::string sha256_algo = SHA256AutoDetect();
     LogPrintf("Using the '%s' SHA256 implementation\n", sha256_algo);
+    LogPrintf("Using the '%s' hex implementation\n", HexAutoDetect());
     RandomInit();
     ECC_Start();
     globalVerifyHandle.reset(new ECCVerifyHandle());
@@ -2163,6 +2378,13 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
     InitSignatureCache();
     InitScriptExecutionCache();
 
+    const std::string script_engine_name =
+        gArgs.GetArg("-parengine", GetCheckQueueEngineName(DEFAULT_SCRIPTCHECK_ENGINE));
+    const auto script_engine = GetCheckQueueEngineFromName(script_engine_name);
+    if (!script_engine) {
+        return InitError(strprintf(_("Unknown -parengine value '%s'"), script_engine_name));
+    }
+
     int script_threads = gArgs.GetArg("-par", DEFAULT_SCRIPTCHECK_THREADS);
     if (script_threads <= 0) {
         // -par=0 means autodetect (number of cores - 1 script threads)
@@ -2173,12 +2395,34 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
     // Subtract 1 because the main thread counts towards the par threads
     script_threads = std::max(script_threads - 1, 0);
 
-    // Number of script-checking threads <= MAX_SCRIPTCHECK_THREADS
-    script_threads = std::min(script_threads, MAX_SCRIPTCHECK_THREADS);
+    // Number of script-checking threads <= MAX_SCRIPTCHECK_THREADS (or
+    // MAX_SCRIPTCHECK_THREADS_WORKSTEALING)
+    script_threads = std::min(script_threads, *script_engine == CheckQueueEngine::WORKSTEALING
+                                                  ? MAX_SCRIPTCHECK_THREADS_WORKSTEALING
+                                                  : MAX_SCRIPTCHECK_THREADS);
 
-    LogPrintf("Script verification uses %d additional threads\n", script_threads);
+    LogPrintf("Script verification uses %d additional threads (%s engine)\n", script_threads,
+              GetCheckQueueEngineName(*script_engine));
     if (script_threads >= 1) {
-        StartScriptCheckWorkerThreads(script_threads);
+        StartScriptCheckWorkerThreads(script_threads, *script_engine);
+        if (fTxPreVerify) {
+            StartTxPreVerifyThreads(script_threads);
+        }
+    }
+
+    const int block_prefetch = std::clamp<int>(gArgs.GetArg("-blockprefetch", DEFAULT_BLOCK_PREFETCH), 0,
+                                               MAX_BLOCK_PREFETCH);
+    if (block_prefetch > 0) {
+        LogPrintf("Reading up to %d blocks ahead of the tip when connecting blocks\n", block_prefetch);
+        StartBlockPrefetchThreads(block_prefetch);
+    }
+
+    const int coins_prefetch_threads = std::clamp<int>(
+        gArgs.GetArg("-prefetchcoins", DEFAULT_COINS_PREFETCH_THREADS), 0, MAX_COINS_PREFETCH_THREADS);
+    if (coins_prefetch_threads > 0) {
+        LogPrintf("Using %d threads to fetch the coins spent by blocks ahead of connecting them\n",
+                  coins_prefetch_threads);
+        StartCoinsPrefetchThreads(coins_prefetch_threads);
     }
 
     // Start the lightweight task scheduler thread
@@ -2247,6 +2491,15 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
         }
     }
 
+    if (gArgs.GetBoolArg("-incrementalblocktemplate", DEFAULT_INCREMENTAL_BLOCK_TEMPLATE)) {
+        g_incremental_block_assembler = std::make_unique<IncrementalBlockAssembler>(config, ::g_mempool);
+        // Select the transactions ahead of getblocktemplate when stale or on a new tip.
+        scheduler.scheduleEvery([] {
+            g_incremental_block_assembler->Refresh();
+            return true;
+        }, 1000);
+    }
+
     /// If the double-spend proof subsystem is enabled, enable the periodic dsproof orphan cleaner task.
     if (DoubleSpendProof::IsEnabled()) {
         auto *dspStorage = g_mempool.doubleSpendProofStorage();
@@ -2490,6 +2743,32 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
                                       ? nMaxTxIndexCache << 20
                                       : 0);
     nTotalCache -= nTxIndexCache;
+    int64_t script_hash_index_cache = std::min(
+        nTotalCache / 8,
+        gArgs.GetBoolArg("-scripthashindex", DEFAULT_SCRIPTHASHINDEX)
+            ? nMaxScriptHashIndexCache << 20
+            : 0);
+    nTotalCache -= script_hash_index_cache;
+    int64_t spent_index_cache =
+        std::min(nTotalCache / 8,
+                 gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX)
+                     ? nMaxSpentIndexCache << 20
+                     : 0);
+    nTotalCache -= spent_index_cache;
+    int64_t token_index_cache =
+        std::min(nTotalCache / 8,
+                 gArgs.GetBoolArg("-tokenindex", DEFAULT_TOKENINDEX)
+                     ? nMaxTokenIndexCache << 20
+                     : 0);
+    nTotalCache -= token_index_cache;
+    int64_t filter_index_cache = 0;
+    if (!g_enabled_filter_types.empty()) {
+        size_t n_indexes = g_enabled_filter_types.size();
+        int64_t max_cache =
+            std::min(nTotalCache / 8, nMaxFilterIndexCache << 20);
+        filter_index_cache = max_cache / n_indexes;
+        nTotalCache -= filter_index_cache * n_indexes;
+    }
     // use 25%-50% of the remainder for disk cache
     int64_t nCoinDBCache =
         std::min(nTotalCache / 2, (nTotalCache / 4) + (1 << 23));
@@ -2506,6 +2785,23 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
         LogPrintf("* Using %.1fMiB for transaction index database\n",
                   nTxIndexCache * (1.0 / 1024 / 1024));
     }
+    if (gArgs.GetBoolArg("-scripthashindex", DEFAULT_SCRIPTHASHINDEX)) {
+        LogPrintf("* Using %.1fMiB for script hash index database\n",
+                  script_hash_index_cache * (1.0 / 1024 / 1024));
+    }
+    if (gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX)) {
+        LogPrintf("* Using %.1fMiB for spent index database\n",
+                  spent_index_cache * (1.0 / 1024 / 1024));
+    }
+    if (gArgs.GetBoolArg("-tokenindex", DEFAULT_TOKENINDEX)) {
+        LogPrintf("* Using %.1fMiB for token index database\n",
+                  token_index_cache * (1.0 / 1024 / 1024));
+    }
+    for (BlockFilterType filter_type : g_enabled_filter_types) {
+        LogPrintf("* Using %.1fMiB for %s block filter index database\n",
+                  filter_index_cache * (1.0 / 1024 / 1024),
+                  BlockFilterTypeName(filter_type));
+    }
     LogPrintf("* Using %.1fMiB for chain state database\n",
               nCoinDBCache * (1.0 / 1024 / 1024));
     LogPrintf("* Using %.1fMiB for in-memory UTXO set (plus up to %.1fMiB of "
@@ -2525,9 +2821,11 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
             try {
                 LOCK(cs_main);
                 UnloadBlockIndex();
+                g_utxo_stats.reset();
                 pcoinsTip.reset();
-                pcoinsdbview.reset();
                 pcoinscatcher.reset();
+                pcoinsflusher.reset();
+                pcoinsdbview.reset();
                 // new CBlockTreeDB tries to delete the existing file, which
                 // fails if it's still open from the previous loop. Close it
                 // first:
@@ -2595,8 +2893,9 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
 
                 pcoinsdbview.reset(new CCoinsViewDB(
                     nCoinDBCache, false, fReset || fReindexChainState));
+                pcoinsflusher.reset(new CCoinsViewFlusher(pcoinsdbview.get()));
                 pcoinscatcher.reset(
-                    new CCoinsViewErrorCatcher(pcoinsdbview.get()));
+                    new CCoinsViewErrorCatcher(pcoinsflusher.get()));
 
                 // If necessary, upgrade from older database format.
                 // This is a no-op if we cleared the coinsviewdb with -reindex
@@ -2619,6 +2918,39 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
                 // The on-disk coinsdb is now in a good state, create the cache
                 pcoinsTip.reset(new CCoinsViewCache(pcoinscatcher.get()));
 
+                // Bootstrap the chainstate from a UTXO snapshot, if it is
+                // still empty.
+                if (gArgs.IsArgSet("-loadutxoset")) {
+                    const fs::path snapshotPath = fs::absolute(
+                        gArgs.GetArg("-loadutxoset", ""), GetDataDir());
+                    if (fReset || fReindexChainState ||
+                        !pcoinsTip->GetBestBlock().IsNull()) {
+                        LogPrintf("Not loading UTXO snapshot %s: the "
+                                  "chainstate is not empty\n",
+                                  snapshotPath.string());
+                    } else {
+                        const std::string strHash =
+                            gArgs.GetArg("-loadutxosethash", "");
+                        if (!strHash.empty() &&
+                            (strHash.size() != 64 || !IsHex(strHash))) {
+                            return InitError(
+                                strprintf(_("Invalid -loadutxosethash: '%s'"),
+                                          strHash));
+                        }
+                        uiInterface.InitMessage(_("Loading UTXO snapshot..."));
+                        std::string error;
+                        if (!LoadUTXOSnapshot(config, snapshotPath,
+                                              uint256S(strHash), error)) {
+                            if (ShutdownRequested()) {
+                                break;
+                            }
+                            return InitError(strprintf(
+                                _("Unable to load UTXO snapshot %s: %s"),
+                                snapshotPath.string(), error));
+                        }
+                    }
+                }
+
                 bool is_coinsview_empty = fReset || fReindexChainState ||
                                           pcoinsTip->GetBestBlock().IsNull();
                 if (!is_coinsview_empty) {
@@ -2707,6 +3039,22 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
         LogPrintf(" block index %15dms\n", GetTimeMillis() - nStart);
     }
 
+    if (gArgs.GetBoolArg("-utxostats", DEFAULT_UTXO_STATS) &&
+        !InitUTXOStats()) {
+        if (ShutdownRequested()) {
+            LogPrintf("Shutdown requested. Exiting.\n");
+            return false;
+        }
+        return InitError(_("Unable to compute the UTXO set statistics"));
+    }
+
+    // Only write flushed coins in the background once the chainstate is
+    // loaded and verified, which reads the coins database directly.
+    if (gArgs.GetBoolArg("-backgroundflush", DEFAULT_BACKGROUND_FLUSH)) {
+        LOCK(cs_main);
+        pcoinsflusher->Start();
+    }
+
     // Encoded addresses using cashaddr instead of base58.
     // We do this by default to avoid confusion with BTC addresses.
     config.SetCashAddrEncoding(gArgs.GetBoolArg("-usecashaddr", DEFAULT_USE_CASHADDR));
@@ -2717,6 +3065,29 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
         g_txindex->Start();
     }
 
+    if (gArgs.GetBoolArg("-scripthashindex", DEFAULT_SCRIPTHASHINDEX)) {
+        g_scripthashindex = std::make_unique<ScriptHashIndex>(
+            script_hash_index_cache, false, fReindex);
+        g_scripthashindex->Start();
+    }
+
+    if (gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX)) {
+        g_spentindex =
+            std::make_unique<SpentIndex>(spent_index_cache, false, fReindex);
+        g_spentindex->Start();
+    }
+
+    if (gArgs.GetBoolArg("-tokenindex", DEFAULT_TOKENINDEX)) {
+        g_tokenindex =
+            std::make_unique<TokenIndex>(token_index_cache, false, fReindex);
+        g_tokenindex->Start();
+    }
+
+    for (const auto &filter_type : g_enabled_filter_types) {
+        InitBlockFilterIndex(filter_type, filter_index_cache, false, fReindex);
+        GetBlockFilterIndex(filter_type)->Start();
+    }
+
     // Step 9: load wallet
     for (const auto &client : node.chain_clients) {
         if (!client->load(chainparams)) {
@@ -2837,6 +3208,20 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
     connOptions.nMaxOutboundTimeframe = nMaxOutboundTimeframe;
     connOptions.nMaxOutboundLimit = nMaxOutboundLimit;
     connOptions.m_peer_connect_timeout = peer_connect_timeout;
+    connOptions.nMessageHandlerThreads =
+        gArgs.GetArg("-msghandlerthreads", DEFAULT_MSGHANDLER_THREADS);
+    if (connOptions.nMessageHandlerThreads < 1 ||
+        connOptions.nMessageHandlerThreads > MAX_MSGHANDLER_THREADS) {
+        return InitError(strprintf(_("Invalid -msghandlerthreads '%d', must be between 1 and %d"),
+                                   connOptions.nMessageHandlerThreads, MAX_MSGHANDLER_THREADS));
+    }
+    if (gArgs.IsArgSet("-socketevents")) {
+        const std::string mode = gArgs.GetArg("-socketevents", "");
+        if (!SocketEventsModeFromString(mode, connOptions.socketEventsMode)) {
+            return InitError(strprintf(_("Invalid -socketevents mode '%s', must be one of: %s"),
+                                       mode, GetSupportedSocketEventsModes()));
+        }
+    }
 
     for (const std::string &bind_arg : gArgs.GetArgs("-bind")) {
         CService bind_addr;
@@ -32,6 +32,7 @@
 #include <validationinterface.h>
 
 #include <algorithm>
+#include <iterator>
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
@@ -119,23 +120,7 @@ void BlockAssembler::resetBlock() {
     nFees = Amount::zero();
 }
 
-std::unique_ptr<CBlockTemplate>
-BlockAssembler::CreateNewBlock(const CScript &scriptPubKeyIn, double timeLimitSecs, bool checkValidity) {
-    const int64_t nTimeStart = GetTimeMicros();
-
-    resetBlock();
-
-    pblocktemplate.reset(new CBlockTemplate());
-
-    // Pointer for convenience.
-    pblock = &pblocktemplate->block;
-
-    // Add dummy coinbase tx as first transaction.  It is updated at the end.
-    pblocktemplate->entries.emplace_back(CTransactionRef(), -SATOSHI, -1);
-
-    LOCK2(cs_main, mempool->cs);
-    CBlockIndex *pindexPrev = ::ChainActive().Tip();
-    assert(pindexPrev != nullptr);
+void BlockAssembler::initBlock(const CBlockIndex *pindexPrev) {
     nHeight = pindexPrev->nHeight + 1;
 
     const Consensus::Params &consensusParams = chainparams.GetConsensus();
@@ -153,6 +138,26 @@ BlockAssembler::CreateNewBlock(const CScript &scriptPubKeyIn, double timeLimitSe
         (STANDARD_LOCKTIME_VERIFY_FLAGS & LOCKTIME_MEDIAN_TIME_PAST)
             ? nMedianTimePast
             : pblock->GetBlockTime();
+}
+
+std::unique_ptr<CBlockTemplate>
+BlockAssembler::CreateNewBlock(const CScript &scriptPubKeyIn, double timeLimitSecs, bool checkValidity) {
+    const int64_t nTimeStart = GetTimeMicros();
+
+    resetBlock();
+
+    pblocktemplate.reset(new CBlockTemplate());
+
+    // Pointer for convenience.
+    pblock = &pblocktemplate->block;
+
+    // Add dummy coinbase tx as first transaction.  It is updated at the end.
+    pblocktemplate->entries.emplace_back(CTransactionRef(), -SATOSHI, -1);
+
+    LOCK2(cs_main, mempool->cs);
+    CBlockIndex *pindexPrev = ::ChainActive().Tip();
+    assert(pindexPrev != nullptr);
+    initBlock(pindexPrev);
 
     // CreateNewBlock's CPU time is divided between two parts: addTxs(), and TestBlockValidity(). Our goal is to
     // finish TestBlockValidity by timeLimitSecs, but to do that we have to know when to stop adding transactions in
@@ -174,7 +179,7 @@ BlockAssembler::CreateNewBlock(const CScript &scriptPubKeyIn, double timeLimitSe
 
     const int64_t nTime0 = GetTimeMicros();
 
-    if (IsMagneticAnomalyEnabled(consensusParams, pindexPrev)) {
+    if (IsMagneticAnomalyEnabled(chainparams.GetConsensus(), pindexPrev)) {
         // If magnetic anomaly is enabled, we make sure transaction are
         // canonically ordered.
         std::sort(std::begin(pblocktemplate->entries) + 1,
@@ -183,14 +188,61 @@ BlockAssembler::CreateNewBlock(const CScript &scriptPubKeyIn, double timeLimitSe
                       -> bool { return a.tx->GetId() < b.tx->GetId(); });
     }
 
+    const int64_t nTime1 = GetTimeMicros();
+
+    finishBlock(scriptPubKeyIn, pindexPrev, checkValidity);
+
+    const int64_t nTime2 = GetTimeMicros();
+
+    // Save time taken by addTxs() vs total time taken
+    const int64_t elapsedAddTxs = nTime0 - nTimeStart;
+    const int64_t elapsedTotal = nTime2 - nTimeStart;
+    // Adjust addTxsFrac based on elapsedAddTxs this run, using an EMA with alpha = 25% for non-tiny blocks
+    const double alpha = pblock->vtx.size() > 50 ? 0.25 : 0.05;
+    const double thisAddTxsFrac = elapsedTotal > 0 ? std::clamp(elapsedAddTxs / double(elapsedTotal), 0., 1.) : 0.;
+    addTxsFrac = addTxsFrac * (1. - alpha) + thisAddTxsFrac * alpha;
+
+    LogPrint(BCLog::BENCH,
+             "CreateNewBlock() addTxs: %.2fms, "
+             "CTOR: %.2fms, validity: %.2fms (total %.2fms), addTxsFrac: %1.2f, timeLimitSecs: %1.3f\n",
+             0.001 * elapsedAddTxs,
+             0.001 * (nTime1 - nTime0), 0.001 * (nTime2 - nTime1),
+             0.001 * elapsedTotal, addTxsFrac, timeLimitSecs);
+
+    return std::move(pblocktemplate);
+}
+
+std::unique_ptr<CBlockTemplate>
+BlockAssembler::CreateNewBlock(const CScript &scriptPubKeyIn, std::vector<CBlockTemplateEntry> &&entries,
+                               bool checkValidity) {
+    pblocktemplate.reset(new CBlockTemplate());
+    pblock = &pblocktemplate->block;
+
+    // The counters already account for the transactions.
+    assert(entries.size() == nBlockTx);
+    pblocktemplate->entries.reserve(entries.size() + 1);
+    pblocktemplate->entries.emplace_back(CTransactionRef(), -SATOSHI, -1);
+    std::move(entries.begin(), entries.end(), std::back_inserter(pblocktemplate->entries));
+
+    LOCK2(cs_main, mempool->cs);
+    CBlockIndex *pindexPrev = ::ChainActive().Tip();
+    assert(pindexPrev != nullptr && pindexPrev->nHeight + 1 == nHeight);
+    initBlock(pindexPrev);
+
+    finishBlock(scriptPubKeyIn, pindexPrev, checkValidity);
+
+    return std::move(pblocktemplate);
+}
+
+void BlockAssembler::finishBlock(const CScript &scriptPubKeyIn, CBlockIndex *pindexPrev, bool checkValidity) {
+    const Consensus::Params &consensusParams = chainparams.GetConsensus();
+
     // Copy all the transactions refs into the block
     pblock->vtx.reserve(pblocktemplate->entries.size());
     for (const CBlockTemplateEntry &entry : pblocktemplate->entries) {
         pblock->vtx.push_back(entry.tx);
     }
 
-    const int64_t nTime1 = GetTimeMicros();
-
     nLastBlockTx = nBlockTx;
     nLastBlockSize = nBlockSize;
 
@@ -240,24 +292,6 @@ BlockAssembler::CreateNewBlock(const CScript &scriptPubKeyIn, double timeLimitSe
                                                FormatStateMessage(state)));
         }
     }
-    const int64_t nTime2 = GetTimeMicros();
-
-    // Save time taken by addTxs() vs total time taken
-    const int64_t elapsedAddTxs = nTime0 - nTimeStart;
-    const int64_t elapsedTotal = nTime2 - nTimeStart;
-    // Adjust addTxsFrac based on elapsedAddTxs this run, using an EMA with alpha = 25% for non-tiny blocks
-    const double alpha = pblock->vtx.size() > 50 ? 0.25 : 0.05;
-    const double thisAddTxsFrac = elapsedTotal > 0 ? std::clamp(elapsedAddTxs / double(elapsedTotal), 0., 1.) : 0.;
-    addTxsFrac = addTxsFrac * (1. - alpha) + thisAddTxsFrac * alpha;
-
-    LogPrint(BCLog::BENCH,
-             "CreateNewBlock() addTxs: %.2fms, "
-             "CTOR: %.2fms, validity: %.2fms (total %.2fms), addTxsFrac: %1.2f, timeLimitSecs: %1.3f\n",
-             0.001 * elapsedAddTxs,
-             0.001 * (nTime1 - nTime0), 0.001 * (nTime2 - nTime1),
-             0.001 * elapsedTotal, addTxsFrac, timeLimitSecs);
-
-    return std::move(pblocktemplate);
 }
 
 bool BlockAssembler::TestTx(uint64_t txSize, int64_t txSigChecks) const {
@@ -288,6 +322,25 @@ void BlockAssembler::AddToBlock(CTxMemPool::txiter iter) {
     }
 }
 
+bool BlockAssembler::AddMempoolTx(CTxMemPool::txiter iter) {
+    if (iter->GetModifiedFeeRate() < blockMinFeeRate || !TestTx(iter->GetTxSize(), iter->GetSigChecks()) ||
+        !CheckTx(iter->GetTx())) {
+        return false;
+    }
+    nBlockSize += iter->GetTxSize();
+    ++nBlockTx;
+    nBlockSigChecks += iter->GetSigChecks();
+    nFees += iter->GetFee();
+    return true;
+}
+
+void BlockAssembler::RemoveTx(CTxMemPool::txiter iter) {
+    nBlockSize -= iter->GetTxSize();
+    --nBlockTx;
+    nBlockSigChecks -= iter->GetSigChecks();
+    nFees -= iter->GetFee();
+}
+
 bool BlockAssembler::CheckTx(const CTransaction &tx) const {
     CValidationState state;
     return ContextualCheckTransaction(chainparams.GetConsensus(),
@@ -422,6 +475,156 @@ void BlockAssembler::addTxs(int64_t nLimitTimePoint) {
     }
 }
 
+std::unique_ptr<IncrementalBlockAssembler> g_incremental_block_assembler;
+
+IncrementalBlockAssembler::IncrementalBlockAssembler(const Config &configIn, CTxMemPool &mempoolIn)
+    : config(configIn), mempool(mempoolIn) {
+    connEntryAdded = mempool.NotifyEntryAdded.connect(
+        [this](CTransactionRef tx) { EntryAdded(tx); });
+    connEntryRemoved = mempool.NotifyEntryRemoved.connect(
+        [this](CTransactionRef tx, MemPoolRemovalReason reason) { EntryRemoved(tx, reason); });
+    connEntryPrioritised = mempool.NotifyEntryPrioritised.connect(
+        [this](CTransactionRef tx) { EntryPrioritised(tx); });
+}
+
+IncrementalBlockAssembler::~IncrementalBlockAssembler() {
+    connEntryAdded.disconnect();
+    connEntryRemoved.disconnect();
+    connEntryPrioritised.disconnect();
+}
+
+bool IncrementalBlockAssembler::NeedsSelection() const {
+    return !pindexPrev || pindexPrev != ::ChainActive().Tip() ||
+           (fStale && GetTimeMicros() - nLastSelection >= REFRESH_INTERVAL);
+}
+
+std::unique_ptr<CBlockTemplate>
+IncrementalBlockAssembler::SelectTxs(const CScript &scriptPubKeyIn, double timeLimitSecs, bool checkValidity) {
+    // Nothing is maintained until the selection succeeds.
+    pindexPrev = nullptr;
+    entries.clear();
+
+    assembler = std::make_unique<BlockAssembler>(config, mempool);
+    std::unique_ptr<CBlockTemplate> pblocktemplate =
+        assembler->CreateNewBlock(scriptPubKeyIn, timeLimitSecs, checkValidity);
+    for (auto it = pblocktemplate->entries.begin() + 1; it != pblocktemplate->entries.end(); ++it) {
+        entries.emplace_hint(entries.end(), it->tx->GetId(), *it);
+    }
+    pindexPrev = ::ChainActive().Tip();
+    // A selection cut short by the time limit may have left transactions out.
+    fStale = timeLimitSecs > 0.;
+    nLastSelection = GetTimeMicros();
+    return pblocktemplate;
+}
+
+std::unique_ptr<CBlockTemplate>
+IncrementalBlockAssembler::CreateNewBlock(const CScript &scriptPubKeyIn, double timeLimitSecs, bool checkValidity) {
+    LOCK2(cs_main, mempool.cs);
+    LOCK(cs);
+    const CBlockIndex *tip = ::ChainActive().Tip();
+    assert(tip != nullptr);
+    if (!IsMagneticAnomalyEnabled(config.GetChainParams().GetConsensus(), tip)) {
+        // Only the canonical order is maintained.
+        return BlockAssembler(config, mempool).CreateNewBlock(scriptPubKeyIn, timeLimitSecs, checkValidity);
+    }
+    if (NeedsSelection()) {
+        return SelectTxs(scriptPubKeyIn, timeLimitSecs, checkValidity);
+    }
+
+    std::vector<CBlockTemplateEntry> txs;
+    txs.reserve(entries.size());
+    for (const auto &[txid, entry] : entries) {
+        txs.push_back(entry);
+    }
+    return assembler->CreateNewBlock(scriptPubKeyIn, std::move(txs), /* checkValidity = */ false);
+}
+
+void IncrementalBlockAssembler::Refresh() {
+    LOCK2(cs_main, mempool.cs);
+    LOCK(cs);
+    const CBlockIndex *tip = ::ChainActive().Tip();
+    if (!tip || IsInitialBlockDownload() ||
+        !IsMagneticAnomalyEnabled(config.GetChainParams().GetConsensus(), tip) || !NeedsSelection()) {
+        return;
+    }
+    try {
+        SelectTxs(CScript() << OP_TRUE, 0., config.GetGBTCheckValidity());
+    } catch (const std::exception &e) {
+        LogPrintf("%s: %s\n", __func__, e.what());
+    }
+}
+
+size_t IncrementalBlockAssembler::GetTxCount() const {
+    LOCK(cs);
+    return entries.size();
+}
+
+bool IncrementalBlockAssembler::IsStale() const {
+    LOCK(cs);
+    return fStale;
+}
+
+void IncrementalBlockAssembler::EntryAdded(const CTransactionRef &tx) {
+    AssertLockHeld(mempool.cs);
+    LOCK(cs);
+    if (!pindexPrev) {
+        return;
+    }
+    const auto iter = mempool.mapTx.find(tx->GetId());
+    assert(iter != mempool.mapTx.end());
+    for (const auto &parent : mempool.GetMemPoolParents(iter)) {
+        if (!entries.count(parent->GetTx().GetId())) {
+            // The parent was left out, so is the child, which may pay for both.
+            fStale = fStale || iter->GetModifiedFeeRate() >= assembler->GetBlockMinFeeRate();
+            return;
+        }
+    }
+    if (!assembler->AddMempoolTx(iter)) {
+        // The block may be full of transactions paying less.
+        fStale = fStale || iter->GetModifiedFeeRate() >= assembler->GetBlockMinFeeRate();
+        return;
+    }
+    entries.emplace(tx->GetId(), CBlockTemplateEntry(iter->GetSharedTx(), iter->GetFee(), iter->GetSigChecks()));
+}
+
+void IncrementalBlockAssembler::EntryRemoved(const CTransactionRef &tx, MemPoolRemovalReason reason) {
+    AssertLockHeld(mempool.cs);
+    LOCK(cs);
+    if (!pindexPrev) {
+        return;
+    }
+    if (reason == MemPoolRemovalReason::BLOCK || reason == MemPoolRemovalReason::REORG) {
+        // The tip is changing: select again.
+        pindexPrev = nullptr;
+        entries.clear();
+        return;
+    }
+    const auto it = entries.find(tx->GetId());
+    if (it == entries.end()) {
+        return;
+    }
+    // Its descendants in the block leave the mempool along with it.
+    const auto iter = mempool.mapTx.find(tx->GetId());
+    assert(iter != mempool.mapTx.end());
+    assembler->RemoveTx(iter);
+    entries.erase(it);
+    fStale = true;
+}
+
+void IncrementalBlockAssembler::EntryPrioritised(const CTransactionRef &tx) {
+    AssertLockHeld(mempool.cs);
+    LOCK(cs);
+    if (!pindexPrev) {
+        return;
+    }
+    const auto iter = mempool.mapTx.find(tx->GetId());
+    assert(iter != mempool.mapTx.end());
+    // A selected transaction may now pay less than those left out, and one
+    // left out may now pay enough.
+    fStale = fStale || entries.count(tx->GetId()) ||
+             iter->GetModifiedFeeRate() >= assembler->GetBlockMinFeeRate();
+}
+
 static
 std::vector<uint8_t> getExcessiveBlockSizeSig(uint64_t nExcessiveBlockSize) {
     std::string cbmsg = "/EB" + getSubVersionEB(nExcessiveBlockSize) + "/";
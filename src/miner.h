@@ -9,10 +9,14 @@
 #include <primitives/block.h>
 #include <txmempool.h>
 
+#include <sync.h>
+
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index_container.hpp>
+#include <boost/signals2/connection.hpp>
 
 #include <cstdint>
+#include <map>
 #include <memory>
 
 class CBlockIndex;
@@ -25,6 +29,8 @@ struct Params;
 }
 
 static const bool DEFAULT_PRINTPRIORITY = false;
+/** Default for -incrementalblocktemplate */
+static const bool DEFAULT_INCREMENTAL_BLOCK_TEMPLATE = false;
 
 struct CBlockTemplateEntry {
     CTransactionRef tx;
@@ -98,12 +104,35 @@ public:
     std::unique_ptr<CBlockTemplate>
     CreateNewBlock(const CScript &scriptPubKeyIn, double timeLimitSecs = 0., bool checkValidity = true);
 
+    /**
+     *  Construct a new block template with the transactions of an earlier
+     *  CreateNewBlock() call on the same tip, as since changed by
+     *  AddMempoolTx() and RemoveTx(). They must be in canonical order, and
+     *  without the coinbase.
+     */
+    std::unique_ptr<CBlockTemplate>
+    CreateNewBlock(const CScript &scriptPubKeyIn, std::vector<CBlockTemplateEntry> &&entries, bool checkValidity);
+
+    /**
+     * After CreateNewBlock(), account for a transaction that entered the
+     * mempool, if it passes the checks that CreateNewBlock() would make.
+     * Its mempool parents must already be in the block.
+     */
+    bool AddMempoolTx(CTxMemPool::txiter iter) EXCLUSIVE_LOCKS_REQUIRED(mempool->cs);
+    /** After CreateNewBlock(), account for a transaction leaving the block. */
+    void RemoveTx(CTxMemPool::txiter iter) EXCLUSIVE_LOCKS_REQUIRED(mempool->cs);
+
     uint64_t GetMaxGeneratedBlockSize() const { return nMaxGeneratedBlockSize; }
+    const CFeeRate &GetBlockMinFeeRate() const { return blockMinFeeRate; }
 
 private:
     // utility functions
     /** Clear the block's state and prepare for assembling a new block */
     void resetBlock();
+    /** Set the chain context and the header version and time, on top of pindexPrev */
+    void initBlock(const CBlockIndex *pindexPrev);
+    /** Add the coinbase and complete the header of the block, whose transactions are all in place */
+    void finishBlock(const CScript &scriptPubKeyIn, CBlockIndex *pindexPrev, bool checkValidity);
     /** Add a tx to the block */
     void AddToBlock(CTxMemPool::txiter iter);
 
@@ -122,6 +151,69 @@ private:
     bool CheckTx(const CTransaction &tx) const;
 };
 
+/**
+ * Keeps the transactions of a block template up to date with the mempool, so
+ * that getblocktemplate does not need to select them again on every call.
+ *
+ * The transactions are selected by BlockAssembler when the tip changes. After
+ * that, transactions that enter the mempool are added to them if their mempool
+ * parents are all in the block and they fit, and transactions that leave the
+ * mempool are removed from them. As the result may then be worse than a new
+ * selection, Refresh() selects them again once stale.
+ *
+ * Only a selection from scratch is tested with TestBlockValidity(): added
+ * transactions were accepted to the mempool on top of the others.
+ */
+class IncrementalBlockAssembler {
+public:
+    //! The minimum time between two selections for the same tip, in microseconds.
+    static constexpr int64_t REFRESH_INTERVAL = 5 * 1000 * 1000;
+
+    IncrementalBlockAssembler(const Config &configIn, CTxMemPool &mempoolIn);
+    ~IncrementalBlockAssembler();
+
+    /** As BlockAssembler::CreateNewBlock(), from the maintained transactions if possible */
+    std::unique_ptr<CBlockTemplate> CreateNewBlock(const CScript &scriptPubKeyIn, double timeLimitSecs = 0.,
+                                                   bool checkValidity = true);
+
+    /** Select the transactions again if the tip changed, or if they are stale and were selected long enough ago */
+    void Refresh();
+
+    //! The number of transactions maintained, without the coinbase.
+    size_t GetTxCount() const;
+    //! Whether a new selection might make a better block.
+    bool IsStale() const;
+
+private:
+    const Config &config;
+    CTxMemPool &mempool;
+
+    mutable Mutex cs;
+    //! The assembler of the last selection, which keeps the block counters.
+    std::unique_ptr<BlockAssembler> assembler GUARDED_BY(cs);
+    //! The tip the transactions were selected on, if they are still valid.
+    const CBlockIndex *pindexPrev GUARDED_BY(cs){nullptr};
+    //! The transactions, in canonical order.
+    std::map<TxId, CBlockTemplateEntry> entries GUARDED_BY(cs);
+    bool fStale GUARDED_BY(cs){false};
+    int64_t nLastSelection GUARDED_BY(cs){0};
+
+    boost::signals2::scoped_connection connEntryAdded;
+    boost::signals2::scoped_connection connEntryRemoved;
+    boost::signals2::scoped_connection connEntryPrioritised;
+
+    std::unique_ptr<CBlockTemplate> SelectTxs(const CScript &scriptPubKeyIn, double timeLimitSecs, bool checkValidity)
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main, mempool.cs, cs);
+    bool NeedsSelection() const EXCLUSIVE_LOCKS_REQUIRED(cs_main, cs);
+
+    void EntryAdded(const CTransactionRef &tx);
+    void EntryRemoved(const CTransactionRef &tx, MemPoolRemovalReason reason);
+    void EntryPrioritised(const CTransactionRef &tx);
+};
+
+/** Maintained block template for getblocktemplate, if -incrementalblocktemplate is set */
+extern std::unique_ptr<IncrementalBlockAssembler> g_incremental_block_assembler;
+
 /** Modify the extranonce in a block */
 void IncrementExtraNonce(CBlock *pblock, const CBlockIndex *pindexPrev, const Config &config,
                          unsigned int &nExtraNonce);
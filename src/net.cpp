@@ -38,6 +38,10 @@
 #include <poll.h>
 #endif
 
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
 #ifdef USE_UPNP
 #include <miniupnpc/miniupnpc.h>
 #include <miniupnpc/miniwget.h>
@@ -1094,6 +1098,7 @@ void CConnman::AcceptConnection(const ListenSocket &hListenSocket) {
 
     LogPrint(BCLog::NET, "connection from %s accepted\n", addr.ToString());
 
+    AddSocketEvents(pnode);
     {
         LOCK(cs_vNodes);
         vNodes.push_back(pnode);
@@ -1208,6 +1213,106 @@ void CConnman::InactivityCheck(CNode *pnode) {
     }
 }
 
+std::string SocketEventsModeToString(SocketEventsMode mode) {
+    switch (mode) {
+        case SocketEventsMode::Select:
+            return "select";
+        case SocketEventsMode::Poll:
+            return "poll";
+        case SocketEventsMode::EPoll:
+            return "epoll";
+    }
+    assert(false);
+}
+
+bool SocketEventsModeFromString(const std::string &str, SocketEventsMode &mode) {
+#ifdef USE_EPOLL
+    if (str == "epoll") {
+        mode = SocketEventsMode::EPoll;
+        return true;
+    }
+#endif
+#ifdef USE_POLL
+    if (str == "poll") {
+        mode = SocketEventsMode::Poll;
+        return true;
+    }
+#else
+    if (str == "select") {
+        mode = SocketEventsMode::Select;
+        return true;
+    }
+#endif
+    return false;
+}
+
+std::string GetSupportedSocketEventsModes() {
+    std::string modes;
+#ifdef USE_EPOLL
+    modes += SocketEventsModeToString(SocketEventsMode::EPoll) + ", ";
+#endif
+#ifdef USE_POLL
+    modes += SocketEventsModeToString(SocketEventsMode::Poll);
+#else
+    modes += SocketEventsModeToString(SocketEventsMode::Select);
+#endif
+    return modes;
+}
+
+void CConnman::InitSocketEvents(SocketEventsMode mode) {
+    socketEventsMode = mode;
+#ifdef USE_EPOLL
+    if (socketEventsMode == SocketEventsMode::EPoll && epollfd == -1) {
+        epollfd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollfd == -1) {
+            LogPrintf("epoll_create1 failed (%s), falling back to poll\n",
+                      NetworkErrorString(WSAGetLastError()));
+            socketEventsMode = SocketEventsMode::Poll;
+        }
+    }
+#endif
+}
+
+void CConnman::AddListenSocketEvents() {
+#ifdef USE_EPOLL
+    if (socketEventsMode != SocketEventsMode::EPoll) {
+        return;
+    }
+    // Level-triggered: one connection is accepted per call to SocketHandler(),
+    // and the others are reported again. vhListenSocket no longer changes.
+    for (ListenSocket &hListenSocket : vhListenSocket) {
+        struct epoll_event event {};
+        event.events = EPOLLIN;
+        event.data.ptr = &hListenSocket;
+        if (epoll_ctl(epollfd, EPOLL_CTL_ADD, hListenSocket.socket, &event) != 0) {
+            LogPrintf("epoll_ctl failed for a listen socket: %s\n",
+                      NetworkErrorString(WSAGetLastError()));
+        }
+    }
+#endif
+}
+
+void CConnman::AddSocketEvents(CNode *pnode) {
+#ifdef USE_EPOLL
+    if (socketEventsMode != SocketEventsMode::EPoll) {
+        return;
+    }
+    // Edge-triggered: the node stays registered until its socket is closed,
+    // and only the changes in readiness are reported.
+    struct epoll_event event {};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.ptr = pnode;
+    LOCK(pnode->cs_hSocket);
+    if (pnode->hSocket != INVALID_SOCKET &&
+        epoll_ctl(epollfd, EPOLL_CTL_ADD, pnode->hSocket, &event) != 0) {
+        LogPrintf("epoll_ctl failed for peer=%d: %s\n", pnode->GetId(),
+                  NetworkErrorString(WSAGetLastError()));
+        // It would never be serviced.
+        pnode->CloseSocketDisconnect();
+    }
+#endif
+}
+
 bool CConnman::GenerateSelectSet(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set) {
     for (const ListenSocket &hListenSocket : vhListenSocket) {
         recv_set.insert(hListenSocket.socket);
@@ -1254,8 +1359,72 @@ bool CConnman::GenerateSelectSet(std::set<SOCKET> &recv_set, std::set<SOCKET> &s
     return !recv_set.empty() || !send_set.empty() || !error_set.empty();
 }
 
-#ifdef USE_POLL
 void CConnman::SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set) {
+#ifdef USE_EPOLL
+    if (socketEventsMode == SocketEventsMode::EPoll) {
+        SocketEventsEPoll(recv_set);
+        return;
+    }
+#endif
+#ifdef USE_POLL
+    SocketEventsPoll(recv_set, send_set, error_set);
+#else
+    SocketEventsSelect(recv_set, send_set, error_set);
+#endif
+}
+
+#ifdef USE_EPOLL
+void CConnman::SocketEventsEPoll(std::set<SOCKET> &recv_set) {
+    // The sockets are already registered, so unlike with poll() or select(),
+    // the nodes that have nothing to report cost nothing here.
+    static constexpr int MAX_EVENTS = 256;
+    struct epoll_event events[MAX_EVENTS];
+    const int timeout = fEPollNodesReady ? 0 : SELECT_TIMEOUT_MILLISECONDS;
+    fEPollNodesReady = false;
+    const int nEvents = epoll_wait(epollfd, events, MAX_EVENTS, timeout);
+
+    if (interruptNet) {
+        return;
+    }
+
+    if (nEvents < 0) {
+        const int nErr = WSAGetLastError();
+        if (nErr != WSAEINTR) {
+            LogPrintf("socket epoll error %s\n", NetworkErrorString(nErr));
+            interruptNet.sleep_for(std::chrono::milliseconds(SELECT_TIMEOUT_MILLISECONDS));
+        }
+        return;
+    }
+
+    for (int i = 0; i < nEvents; ++i) {
+        const struct epoll_event &event = events[i];
+        bool fListenSocket = false;
+        for (const ListenSocket &hListenSocket : vhListenSocket) {
+            if (event.data.ptr == &hListenSocket) {
+                recv_set.insert(hListenSocket.socket);
+                fListenSocket = true;
+                break;
+            }
+        }
+        if (fListenSocket) {
+            continue;
+        }
+
+        // A node is only deleted by this thread, once its socket is closed,
+        // which removes it from the epoll set.
+        CNode *pnode = static_cast<CNode *>(event.data.ptr);
+        if (event.events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP)) {
+            pnode->fHasRecvData = true;
+        }
+        if (event.events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) {
+            pnode->fCanSendData = true;
+        }
+    }
+}
+#endif
+
+#ifdef USE_POLL
+void CConnman::SocketEventsPoll(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set) {
     std::set<SOCKET> recv_select_set, send_select_set, error_select_set;
     if (!GenerateSelectSet(recv_select_set, send_select_set, error_select_set)) {
         interruptNet.sleep_for(std::chrono::milliseconds(SELECT_TIMEOUT_MILLISECONDS));
@@ -1296,7 +1465,7 @@ void CConnman::SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_s
     }
 }
 #else
-void CConnman::SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set) {
+void CConnman::SocketEventsSelect(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set) {
     std::set<SOCKET> recv_select_set, send_select_set, error_select_set;
     if (!GenerateSelectSet(recv_select_set, send_select_set, error_select_set)) {
         interruptNet.sleep_for(std::chrono::milliseconds(SELECT_TIMEOUT_MILLISECONDS));
@@ -1410,7 +1579,21 @@ void CConnman::SocketHandler()
         bool recvSet = false;
         bool sendSet = false;
         bool errorSet = false;
-        {
+        if (socketEventsMode == SocketEventsMode::EPoll) {
+            // Same logic as GenerateSelectSet(), on the readiness kept for
+            // the node.
+            bool select_send;
+            {
+                LOCK(pnode->cs_vSend);
+                select_send = !pnode->vSendMsg.empty();
+            }
+            LOCK(pnode->cs_hSocket);
+            if (pnode->hSocket == INVALID_SOCKET) {
+                continue;
+            }
+            sendSet = select_send && pnode->fCanSendData;
+            recvSet = !select_send && !pnode->fPauseRecv && pnode->fHasRecvData;
+        } else {
             LOCK(pnode->cs_hSocket);
             if (pnode->hSocket == INVALID_SOCKET) {
                 continue;
@@ -1432,6 +1615,10 @@ void CConnman::SocketHandler()
                     recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
             }
             if (nBytes > 0) {
+#ifdef USE_EPOLL
+                // There may be more.
+                fEPollNodesReady = true;
+#endif
                 bool notify = false;
                 if (!pnode->ReceiveMsgBytes(*config, pchBuf, nBytes, notify)) {
                     pnode->CloseSocketDisconnect();
@@ -1456,7 +1643,7 @@ void CConnman::SocketHandler()
                         pnode->fPauseRecv =
                             pnode->nProcessQueueSize > nReceiveFloodSize;
                     }
-                    WakeMessageHandler();
+                    WakeMessageHandler(*pnode);
                 }
             } else if (nBytes == 0) {
                 // socket closed gracefully
@@ -1467,6 +1654,9 @@ void CConnman::SocketHandler()
             } else if (nBytes < 0) {
                 // error
                 int nErr = WSAGetLastError();
+                if (nErr == WSAEWOULDBLOCK) {
+                    pnode->fHasRecvData = false;
+                }
                 if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE &&
                     nErr != WSAEINTR && nErr != WSAEINPROGRESS) {
                     if (!pnode->fDisconnect) {
@@ -1487,6 +1677,16 @@ void CConnman::SocketHandler()
             if (nBytes) {
                 RecordBytesSent(nBytes);
             }
+            if (!pnode->vSendMsg.empty()) {
+                // The socket is full.
+                pnode->fCanSendData = false;
+            }
+#ifdef USE_EPOLL
+            else if (pnode->fHasRecvData) {
+                // Receiving was skipped for the send, which is done now.
+                fEPollNodesReady = true;
+            }
+#endif
         }
 
         InactivityCheck(pnode);
@@ -1508,11 +1708,23 @@ void CConnman::ThreadSocketHandler() {
 }
 
 void CConnman::WakeMessageHandler() {
+    for (int i = 0; i < nMessageHandlerThreads; ++i) {
+        MessageHandler &handler = messageHandlers[i];
+        {
+            LOCK(handler.mutexMsgProc);
+            handler.fMsgProcWake = true;
+        }
+        handler.condMsgProc.notify_one();
+    }
+}
+
+void CConnman::WakeMessageHandler(const CNode &node) {
+    MessageHandler &handler = messageHandlers[node.GetId() % nMessageHandlerThreads];
     {
-        std::lock_guard<std::mutex> lock(mutexMsgProc);
-        fMsgProcWake = true;
+        LOCK(handler.mutexMsgProc);
+        handler.fMsgProcWake = true;
     }
-    condMsgProc.notify_one();
+    handler.condMsgProc.notify_one();
 }
 
 #ifdef USE_UPNP
@@ -2092,34 +2304,53 @@ void CConnman::OpenNetworkConnection(const CAddress &addrConnect,
     }
 
     m_msgproc->InitializeNode(*config, pnode);
+    AddSocketEvents(pnode);
     {
         LOCK(cs_vNodes);
         vNodes.push_back(pnode);
     }
 }
 
-void CConnman::ThreadMessageHandler() {
+void CConnman::ThreadMessageHandler(int index) {
+    MessageHandler &handler = messageHandlers[index];
     while (!flagInterruptMsgProc) {
         std::vector<CNode *> vNodesCopy;
         {
             LOCK(cs_vNodes);
-            vNodesCopy = vNodes;
-            for (CNode *pnode : vNodesCopy) {
-                pnode->AddRef();
+            for (CNode *pnode : vNodes) {
+                if (pnode->GetId() % nMessageHandlerThreads == index) {
+                    vNodesCopy.push_back(pnode);
+                    pnode->AddRef();
+                }
             }
         }
 
         bool fMoreWork = false;
         auto nSleepUntil = GetTime<std::chrono::microseconds>() + std::chrono::microseconds{100000};
 
+        m_msgproc->PrepareMessages(*config, vNodesCopy, flagInterruptMsgProc);
+        if (flagInterruptMsgProc) {
+            return;
+        }
+
         for (CNode *pnode : vNodesCopy) {
             if (pnode->fDisconnect) {
                 continue;
             }
 
             // Receive messages
+#ifdef USE_EPOLL
+            const bool fPausedRecv = pnode->fPauseRecv;
+#endif
             bool fMoreNodeWork = m_msgproc->ProcessMessages(
                 *config, pnode, flagInterruptMsgProc);
+#ifdef USE_EPOLL
+            if (fPausedRecv && !pnode->fPauseRecv && pnode->fHasRecvData) {
+                // The socket handler skipped the data while receiving was
+                // paused, and epoll will not report it again.
+                fEPollNodesReady = true;
+            }
+#endif
             fMoreWork |= (fMoreNodeWork && !pnode->fPauseSend);
             if (flagInterruptMsgProc) {
                 return;
@@ -2144,14 +2375,16 @@ void CConnman::ThreadMessageHandler() {
             }
         }
 
-        WAIT_LOCK(mutexMsgProc, lock);
+        WAIT_LOCK(handler.mutexMsgProc, lock);
         if (!fMoreWork) {
             auto nSleepFor =
                 std::max(std::chrono::microseconds{0}, std::min(std::chrono::microseconds{100000},
                                                                 nSleepUntil - GetTime<std::chrono::microseconds>()));
-            condMsgProc.wait_for(lock, nSleepFor, [this] { return fMsgProcWake; });
+            handler.condMsgProc.wait_for(lock, nSleepFor, [&handler]() EXCLUSIVE_LOCKS_REQUIRED(handler.mutexMsgProc) {
+                return handler.fMsgProcWake;
+            });
         }
-        fMsgProcWake = false;
+        handler.fMsgProcWake = false;
     }
 }
 
@@ -2376,6 +2609,7 @@ bool CConnman::Start(CScheduler &scheduler, const Options &connOptions) {
         }
         return false;
     }
+    AddListenSocketEvents();
 
     for (const auto &strDest : connOptions.vSeedNodes) {
         AddOneShot(strDest);
@@ -2421,9 +2655,9 @@ bool CConnman::Start(CScheduler &scheduler, const Options &connOptions) {
     interruptNet.reset();
     flagInterruptMsgProc = false;
 
-    {
-        LOCK(mutexMsgProc);
-        fMsgProcWake = false;
+    for (MessageHandler &handler : messageHandlers) {
+        LOCK(handler.mutexMsgProc);
+        handler.fMsgProcWake = false;
     }
 
     // Send and receive from sockets, accept connections
@@ -2465,10 +2699,12 @@ bool CConnman::Start(CScheduler &scheduler, const Options &connOptions) {
     }
 
     // Process messages
-    threadMessageHandler =
-        std::thread(&TraceThread<std::function<void()>>, "msghand",
-                    std::function<void()>(
-                        std::bind(&CConnman::ThreadMessageHandler, this)));
+    for (int i = 0; i < nMessageHandlerThreads; ++i) {
+        const std::string name = nMessageHandlerThreads == 1 ? "msghand" : strprintf("msghand.%i", i);
+        messageHandlers[i].thread = std::thread([this, name, i]() {
+            TraceThread(name.c_str(), [this, i]() { ThreadMessageHandler(i); });
+        });
+    }
 
     // Dump network addresses
     scheduler.scheduleEvery(
@@ -2495,11 +2731,13 @@ public:
 } instance_of_cnetcleanup;
 
 void CConnman::Interrupt() {
-    {
-        std::lock_guard<std::mutex> lock(mutexMsgProc);
-        flagInterruptMsgProc = true;
+    for (MessageHandler &handler : messageHandlers) {
+        {
+            LOCK(handler.mutexMsgProc);
+            flagInterruptMsgProc = true;
+        }
+        handler.condMsgProc.notify_all();
     }
-    condMsgProc.notify_all();
 
     interruptNet();
     InterruptSocks5(true);
@@ -2518,8 +2756,10 @@ void CConnman::Interrupt() {
 }
 
 void CConnman::Stop() {
-    if (threadMessageHandler.joinable()) {
-        threadMessageHandler.join();
+    for (MessageHandler &handler : messageHandlers) {
+        if (handler.thread.joinable()) {
+            handler.thread.join();
+        }
     }
     if (threadOpenConnections.joinable()) {
         threadOpenConnections.join();
@@ -2579,6 +2819,11 @@ void CConnman::DeleteNode(CNode *pnode) {
 CConnman::~CConnman() {
     Interrupt();
     Stop();
+#ifdef USE_EPOLL
+    if (epollfd != -1) {
+        close(epollfd);
+    }
+#endif
     *deleted = true; // guard againse use-after-free in case our periodic lambda is triggered again
 }
 
@@ -2895,19 +3140,41 @@ bool CConnman::NodeFullyConnected(const CNode *pnode) {
     return pnode && pnode->fSuccessfullyConnected && !pnode->fDisconnect;
 }
 
-void CConnman::PushMessage(CNode *pnode, CSerializedNetMsg &&msg) {
-    size_t nMessageSize = msg.data.size();
-    size_t nTotalSize = nMessageSize + CMessageHeader::HEADER_SIZE;
-    LogPrint(BCLog::NET, "sending %s (%d bytes) peer=%d\n", SanitizeString(msg.m_type.c_str()), nMessageSize,
-             pnode->GetId());
-
+std::vector<uint8_t> CConnman::SerializeMessageHeader(const std::string &msg_type,
+                                                      const std::vector<uint8_t> &payload) const {
     std::vector<uint8_t> serializedHeader;
     serializedHeader.reserve(CMessageHeader::HEADER_SIZE);
-    uint256 hash = Hash(Span{msg.data}.first(nMessageSize));
-    CMessageHeader hdr(config->GetChainParams().NetMagic(), msg.m_type.c_str(), nMessageSize);
+    uint256 hash = Hash(payload);
+    CMessageHeader hdr(config->GetChainParams().NetMagic(), msg_type.c_str(), payload.size());
     memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
 
     CVectorWriter{SER_NETWORK, INIT_PROTO_VERSION, serializedHeader, 0, hdr};
+    return serializedHeader;
+}
+
+void CConnman::PushMessage(CNode *pnode, CSerializedNetMsg &&msg) {
+    CSendBuffer header(SerializeMessageHeader(msg.m_type, msg.data));
+    PushSendBuffers(pnode, msg.m_type, std::move(header), CSendBuffer(std::move(msg.data)));
+}
+
+void CConnman::PushMessage(CNode *pnode, const CSharedNetMsg &msg) {
+    PushSendBuffers(pnode, msg.m_type, CSendBuffer(msg.header), CSendBuffer(msg.payload));
+}
+
+CSharedNetMsg CConnman::MakeSharedMessage(CSerializedNetMsg &&msg) const {
+    CSharedNetMsg shared;
+    shared.header = std::make_shared<const std::vector<uint8_t>>(SerializeMessageHeader(msg.m_type, msg.data));
+    shared.payload = std::make_shared<const std::vector<uint8_t>>(std::move(msg.data));
+    shared.m_type = std::move(msg.m_type);
+    return shared;
+}
+
+void CConnman::PushSendBuffers(CNode *pnode, const std::string &msg_type, CSendBuffer &&header,
+                               CSendBuffer &&payload) {
+    size_t nMessageSize = payload.size();
+    size_t nTotalSize = nMessageSize + CMessageHeader::HEADER_SIZE;
+    LogPrint(BCLog::NET, "sending %s (%d bytes) peer=%d\n", SanitizeString(msg_type.c_str()), nMessageSize,
+             pnode->GetId());
 
     size_t nBytesSent = 0;
     {
@@ -2915,15 +3182,15 @@ void CConnman::PushMessage(CNode *pnode, CSerializedNetMsg &&msg) {
         bool optimisticSend(pnode->vSendMsg.empty());
 
         // log total amount of bytes per message type
-        pnode->mapSendBytesPerMsgType[msg.m_type] += nTotalSize;
+        pnode->mapSendBytesPerMsgType[msg_type] += nTotalSize;
         pnode->nSendSize += nTotalSize;
 
         if (pnode->nSendSize > nSendBufferMaxSize) {
             pnode->fPauseSend = true;
         }
-        pnode->vSendMsg.push_back(std::move(serializedHeader));
+        pnode->vSendMsg.push_back(std::move(header));
         if (nMessageSize) {
-            pnode->vSendMsg.push_back(std::move(msg.data));
+            pnode->vSendMsg.push_back(std::move(payload));
         }
 
         // If write queue empty, attempt "optimistic write"
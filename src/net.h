@@ -27,6 +27,8 @@
 #include <threadinterrupt.h>
 #include <uint256.h>
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
@@ -99,6 +101,32 @@ static const int64_t DEFAULT_PEER_CONNECT_TIMEOUT = 60;
 static const bool DEFAULT_FORCEDNSSEED = false;
 static const size_t DEFAULT_MAXRECEIVEBUFFER = 5 * 1000;
 static const size_t DEFAULT_MAXSENDBUFFER = 1 * 1000;
+/** Default for -msghandlerthreads */
+static const int DEFAULT_MSGHANDLER_THREADS = 1;
+/** Maximum number of message handler threads */
+static const int MAX_MSGHANDLER_THREADS = 16;
+
+/** How the socket handler waits for the sockets to become ready. */
+enum class SocketEventsMode {
+    Select,
+    Poll,
+    //! Sockets are registered once, and only changes are reported.
+    EPoll,
+};
+/** Default for -socketevents */
+#if defined(USE_EPOLL)
+static const SocketEventsMode DEFAULT_SOCKETEVENTS_MODE = SocketEventsMode::EPoll;
+#elif defined(USE_POLL)
+static const SocketEventsMode DEFAULT_SOCKETEVENTS_MODE = SocketEventsMode::Poll;
+#else
+static const SocketEventsMode DEFAULT_SOCKETEVENTS_MODE = SocketEventsMode::Select;
+#endif
+
+std::string SocketEventsModeToString(SocketEventsMode mode);
+/** Parse a -socketevents value; fails for the modes this platform lacks. */
+bool SocketEventsModeFromString(const std::string &str, SocketEventsMode &mode);
+/** The -socketevents values this platform supports, comma-separated. */
+std::string GetSupportedSocketEventsModes();
 
 struct AddedNodeInfo {
     std::string strAddedNode;
@@ -122,6 +150,32 @@ struct CSerializedNetMsg {
     std::string m_type;
 };
 
+/**
+ * A message whose header, checksum included, and payload are serialized once,
+ * to be queued for any number of peers without being copied.
+ */
+struct CSharedNetMsg {
+    std::string m_type;
+    std::shared_ptr<const std::vector<uint8_t>> header;
+    std::shared_ptr<const std::vector<uint8_t>> payload;
+
+    explicit operator bool() const { return header != nullptr; }
+};
+
+/** Bytes queued for sending to a peer, which may be shared with other peers. */
+class CSendBuffer {
+public:
+    explicit CSendBuffer(std::vector<uint8_t> &&bytes) : owned(std::move(bytes)) {}
+    explicit CSendBuffer(std::shared_ptr<const std::vector<uint8_t>> bytes) : shared(std::move(bytes)) {}
+
+    const uint8_t *data() const { return shared ? shared->data() : owned.data(); }
+    size_t size() const { return shared ? shared->size() : owned.size(); }
+
+private:
+    std::vector<uint8_t> owned;
+    std::shared_ptr<const std::vector<uint8_t>> shared;
+};
+
 class NetEventsInterface;
 class CConnman {
 public:
@@ -156,6 +210,8 @@ public:
         std::vector<std::string> m_specified_outgoing;
         std::vector<std::string> m_added_nodes;
         std::vector<bool> m_asmap;
+        SocketEventsMode socketEventsMode = DEFAULT_SOCKETEVENTS_MODE;
+        int nMessageHandlerThreads = DEFAULT_MSGHANDLER_THREADS;
     };
 
     void Init(const Options &connOptions) {
@@ -173,6 +229,8 @@ public:
         nSendBufferMaxSize = connOptions.nSendBufferMaxSize;
         nReceiveFloodSize = connOptions.nReceiveFloodSize;
         m_peer_connect_timeout = connOptions.m_peer_connect_timeout;
+        InitSocketEvents(connOptions.socketEventsMode);
+        nMessageHandlerThreads = std::max(1, std::min(connOptions.nMessageHandlerThreads, MAX_MSGHANDLER_THREADS));
         {
             LOCK(cs_totalBytesSent);
             nMaxOutboundTimeframe = connOptions.nMaxOutboundTimeframe;
@@ -218,6 +276,9 @@ public:
     bool ForNode(NodeId id, std::function<bool(CNode *pnode)> func);
 
     void PushMessage(CNode *pnode, CSerializedNetMsg &&msg);
+    void PushMessage(CNode *pnode, const CSharedNetMsg &msg);
+    //! Serialize the header of msg, to push it to any number of peers.
+    CSharedNetMsg MakeSharedMessage(CSerializedNetMsg &&msg) const;
 
     template <typename Callable> void ForEachNode(Callable &&func) {
         LOCK(cs_vNodes);
@@ -330,7 +391,10 @@ public:
 
     unsigned int GetReceiveFloodSize() const;
 
+    //! Wake all the message handler threads up.
     void WakeMessageHandler();
+    //! Wake the message handler thread of a node up.
+    void WakeMessageHandler(const CNode &node);
 
     /**
      * Attempts to obfuscate tx time through exponentially distributed emitting.
@@ -365,13 +429,30 @@ private:
     void AddOneShot(const std::string &strDest);
     void ProcessOneShot();
     void ThreadOpenConnections(std::vector<std::string> connect);
-    void ThreadMessageHandler();
+    void ThreadMessageHandler(int index);
     void AcceptConnection(const ListenSocket &hListenSocket);
     void DisconnectNodes();
     void NotifyNumConnectionsChanged();
     void InactivityCheck(CNode *pnode);
     bool GenerateSelectSet(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
+    void InitSocketEvents(SocketEventsMode mode);
+    //! Have epoll report the readiness of the listen sockets.
+    void AddListenSocketEvents();
+    //! Have epoll report the readiness of a new node's socket.
+    void AddSocketEvents(CNode *pnode);
     void SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
+#ifdef USE_POLL
+    void SocketEventsPoll(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
+#else
+    void SocketEventsSelect(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
+#endif
+#ifdef USE_EPOLL
+    /**
+     * Wait for epoll to report changes: the ready nodes are flagged, and the
+     * ready listen sockets put in recv_set.
+     */
+    void SocketEventsEPoll(std::set<SOCKET> &recv_set);
+#endif
     void SocketHandler();
     void ThreadSocketHandler();
     void ThreadDNSAddressSeed();
@@ -394,6 +475,8 @@ private:
     NodeId GetNewNodeId();
 
     size_t SocketSendData(CNode *pnode) const;
+    std::vector<uint8_t> SerializeMessageHeader(const std::string &msg_type, const std::vector<uint8_t> &payload) const;
+    void PushSendBuffers(CNode *pnode, const std::string &msg_type, CSendBuffer &&header, CSendBuffer &&payload);
     void DumpAddresses();
 
     // Network stats
@@ -427,6 +510,18 @@ private:
     unsigned int nSendBufferMaxSize{0};
     unsigned int nReceiveFloodSize{0};
 
+    SocketEventsMode socketEventsMode{DEFAULT_SOCKETEVENTS_MODE};
+#ifdef USE_EPOLL
+    int epollfd{-1};
+    /**
+     * A node has data to receive that epoll will not report again: the last
+     * SocketHandler() call left some in its socket, or the node could not
+     * receive then and now can. The next call must not wait for epoll to
+     * report anything.
+     */
+    std::atomic_bool fEPollNodesReady{false};
+#endif
+
     std::vector<ListenSocket> vhListenSocket;
     std::atomic<bool> fNetworkActive{true};
     bool fAddressesInitialized{false};
@@ -487,11 +582,22 @@ private:
     /** SipHasher seeds for deterministic randomness */
     const uint64_t nSeed0, nSeed1;
 
-    /** flag for waking the message processor. */
-    bool fMsgProcWake;
-
-    std::condition_variable condMsgProc;
-    Mutex mutexMsgProc;
+    /**
+     * A message handler thread. Each node is pinned to one of them by its id,
+     * so that the messages of a peer are processed in order, while those of
+     * different peers may be processed at the same time; whatever requires
+     * cs_main still is not.
+     */
+    struct MessageHandler {
+        Mutex mutexMsgProc;
+        std::condition_variable condMsgProc;
+        /** flag for waking the message processor. */
+        bool fMsgProcWake GUARDED_BY(mutexMsgProc){false};
+        std::thread thread;
+    };
+    //! Only the first nMessageHandlerThreads have a thread.
+    std::array<MessageHandler, MAX_MSGHANDLER_THREADS> messageHandlers;
+    std::atomic<int> nMessageHandlerThreads{DEFAULT_MSGHANDLER_THREADS};
     std::atomic<bool> flagInterruptMsgProc{false};
 
     CThreadInterrupt interruptNet;
@@ -500,7 +606,6 @@ private:
     std::thread threadSocketHandler;
     std::thread threadOpenAddedConnections;
     std::thread threadOpenConnections;
-    std::thread threadMessageHandler;
 
     /**
      * Flag for deciding to connect to an extra outbound peer, in excess of
@@ -529,6 +634,14 @@ unsigned short GetListenPort();
  */
 class NetEventsInterface {
 public:
+    /**
+     * Called by a message handler thread before it calls ProcessMessages()
+     * for each of nodes, to prepare the messages they are about to process
+     * together.
+     */
+    virtual void PrepareMessages(const Config &config,
+                                 const std::vector<CNode *> &nodes,
+                                 std::atomic<bool> &interrupt) {}
     virtual bool ProcessMessages(const Config &config, CNode *pnode,
                                  std::atomic<bool> &interrupt) = 0;
     virtual bool SendMessages(const Config &config, CNode *pnode,
@@ -702,7 +815,7 @@ public:
     // Offset inside the first vSendMsg already sent.
     size_t nSendOffset{0};
     uint64_t nSendBytes GUARDED_BY(cs_vSend){0};
-    std::deque<std::vector<uint8_t>> vSendMsg GUARDED_BY(cs_vSend);
+    std::deque<CSendBuffer> vSendMsg GUARDED_BY(cs_vSend);
     mutable RecursiveMutex cs_vSend;
     RecursiveMutex cs_hSocket;
     RecursiveMutex cs_vRecv;
@@ -771,6 +884,11 @@ public:
     const uint64_t nKeyedNetGroup;
     std::atomic_bool fPauseRecv{false};
     std::atomic_bool fPauseSend{false};
+    // The readiness of the socket as reported by epoll, which only reports
+    // changes: kept by the socket handler until a recv() or send() would
+    // block.
+    std::atomic_bool fHasRecvData{false};
+    std::atomic_bool fCanSendData{false};
 
     /* ExtVersion support */
     Mutex cs_extversion;
@@ -790,8 +908,10 @@ public:
     std::atomic<int> nStartingHeight{-1};
 
     // flood relay
-    std::vector<CAddress> vAddrToSend;
-    CRollingBloomFilter addrKnown;
+    // Addresses are also pushed by the message handlers of the other nodes.
+    RecursiveMutex cs_addrSend;
+    std::vector<CAddress> vAddrToSend GUARDED_BY(cs_addrSend);
+    CRollingBloomFilter addrKnown GUARDED_BY(cs_addrSend);
     bool fGetAddr{false};
     std::chrono::microseconds m_next_addr_send GUARDED_BY(cs_sendProcessing){0};
     std::chrono::microseconds m_next_local_addr_send GUARDED_BY(cs_sendProcessing){0};
@@ -895,6 +1015,7 @@ public:
     void Release() { nRefCount--; }
 
     void AddAddressKnown(const CAddress &_addr) {
+        LOCK(cs_addrSend);
         addrKnown.insert(_addr.GetKey());
     }
 
@@ -904,6 +1025,7 @@ public:
         // because they require ADDRv2 (BIP155) encoding.
         const bool addr_format_supported = m_wants_addrv2 || _addr.IsAddrV1Compatible();
 
+        LOCK(cs_addrSend);
         // Known checking here is only to save space from duplicates.
         // SendMessages will filter it again for knowns that were added
         // after addresses were pushed.
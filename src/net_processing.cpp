@@ -21,6 +21,7 @@
 #include <dsproof/storage.h>
 #include <extversion.h>
 #include <hash.h>
+#include <index/blockfilterindex.h>
 #include <merkleblock.h>
 #include <net.h>
 #include <netbase.h>
@@ -42,9 +43,12 @@
 #include <validation.h>
 #include <validationinterface.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <limits>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <type_traits>
 #include <typeinfo>
@@ -132,6 +136,10 @@ static const unsigned int MAX_GETDATA_SZ = 1000;
 
 /// How many non standard orphan do we consider from a node before ignoring it.
 static constexpr uint32_t MAX_NON_STANDARD_ORPHAN_PER_NODE = 5;
+/** Maximum number of compact filters that may be requested with one getcfilters. See BIP 157. */
+static constexpr uint32_t MAX_GETCFILTERS_SIZE = 1000;
+/** Maximum number of cf hashes that may be requested with one getcfheaders. See BIP 157. */
+static constexpr uint32_t MAX_GETCFHEADERS_SIZE = 2000;
 
 namespace internal {
 RecursiveMutex g_cs_orphans;
@@ -225,8 +233,15 @@ int g_outbound_peers_with_protect_from_disconnect GUARDED_BY(cs_main) = 0;
 /** When our tip was last updated. */
 std::atomic<int64_t> g_last_tip_update(0);
 
+/** A relayed transaction, and its tx message once a peer asked for it. */
+struct RelayTx {
+    CTransactionRef tx;
+    //! Shared by all the peers asking for the transaction.
+    CSharedNetMsg msg;
+};
+
 /** Relay map. */
-typedef std::map<uint256, CTransactionRef> MapRelay;
+typedef std::map<uint256, RelayTx> MapRelay;
 MapRelay mapRelay GUARDED_BY(cs_main);
 /**
  * Expiration-time ordered list of (expire time, relay map entry) pairs,
@@ -411,6 +426,10 @@ struct CNodeState {
 
     TxDownloadState m_tx_download;
 
+    //! What PrepareMessages() found of the scripts of the transaction of the
+    //! tx message the peer is to process next.
+    std::optional<PreVerifiedTx> m_preverified_tx;
+
     CNodeState(const CAddress &addrIn, const std::string &addrNameIn)
         : address(addrIn), name(addrNameIn) {
         fCurrentlyConnected = false;
@@ -1267,6 +1286,34 @@ static std::shared_ptr<const CBlock>
 static std::shared_ptr<const CBlockHeaderAndShortTxIDs>
     most_recent_compact_block GUARDED_BY(cs_most_recent_block);
 static uint256 most_recent_block_hash GUARDED_BY(cs_most_recent_block);
+// The block and cmpctblock messages of the recent block, serialized once for
+// all the peers it is sent to.
+static CSharedNetMsg most_recent_block_msg GUARDED_BY(cs_most_recent_block);
+static CSharedNetMsg most_recent_compact_block_msg GUARDED_BY(cs_most_recent_block);
+
+/**
+ * The block, or cmpctblock, message of the recent block if it has the given
+ * hash, serialized on first use; a null message otherwise.
+ */
+static CSharedNetMsg GetMostRecentBlockMessage(const CConnman &connman, const uint256 &hash, bool compact) {
+    LOCK(cs_most_recent_block);
+    if (!most_recent_block || most_recent_block_hash != hash) {
+        return {};
+    }
+    // Neither depends on the version of the peer.
+    const CNetMsgMaker msgMaker(PROTOCOL_VERSION);
+    if (compact) {
+        if (!most_recent_compact_block_msg) {
+            most_recent_compact_block_msg =
+                connman.MakeSharedMessage(msgMaker.Make(NetMsgType::CMPCTBLOCK, *most_recent_compact_block));
+        }
+        return most_recent_compact_block_msg;
+    }
+    if (!most_recent_block_msg) {
+        most_recent_block_msg = connman.MakeSharedMessage(msgMaker.Make(NetMsgType::BLOCK, *most_recent_block));
+    }
+    return most_recent_block_msg;
+}
 
 /**
  * Maintain state about the best-seen block and fast-announce a compact block
@@ -1276,7 +1323,6 @@ void PeerLogicValidation::NewPoWValidBlock(
     const CBlockIndex *pindex, const std::shared_ptr<const CBlock> &pblock) {
     std::shared_ptr<const CBlockHeaderAndShortTxIDs> pcmpctblock =
         std::make_shared<const CBlockHeaderAndShortTxIDs>(*pblock);
-    const CNetMsgMaker msgMaker(PROTOCOL_VERSION);
 
     LOCK(cs_main);
 
@@ -1293,13 +1339,14 @@ void PeerLogicValidation::NewPoWValidBlock(
         most_recent_block_hash = hashBlock;
         most_recent_block = pblock;
         most_recent_compact_block = pcmpctblock;
+        most_recent_block_msg = {};
+        most_recent_compact_block_msg = {};
     }
 
-    connman->ForEachNode([this, &pcmpctblock, pindex, &msgMaker,
-                          &hashBlock](CNode *pnode) {
+    CSharedNetMsg msg;
+    connman->ForEachNode([this, &msg, pindex, &hashBlock](CNode *pnode) {
         AssertLockHeld(cs_main);
 
-        // TODO: Avoid the repeated-serialization here
         if (pnode->nVersion < INVALID_CB_NO_BAN_VERSION || pnode->fDisconnect) {
             return;
         }
@@ -1312,8 +1359,10 @@ void PeerLogicValidation::NewPoWValidBlock(
             LogPrint(BCLog::NET, "%s sending header-and-ids %s to peer=%d\n",
                      "PeerLogicValidation::NewPoWValidBlock",
                      hashBlock.ToString(), pnode->GetId());
-            connman->PushMessage(
-                pnode, msgMaker.Make(NetMsgType::CMPCTBLOCK, *pcmpctblock));
+            if (!msg) {
+                msg = GetMostRecentBlockMessage(*connman, hashBlock, true);
+            }
+            connman->PushMessage(pnode, msg);
             state.pindexBestHeaderSent = pindex;
         }
     });
@@ -1539,64 +1588,88 @@ static void ProcessGetBlockData(const Config &config, CNode *pfrom,
         }
     }
 
-    LOCK(cs_main);
-    const CBlockIndex *pindex = LookupBlockIndex(hash);
-    if (pindex) {
-        send = BlockRequestAllowed(pindex, consensusParams);
-        if (!send) {
+    const CNetMsgMaker msgMaker(pfrom->GetSendVersion());
+    // Only decide whether to send the block with cs_main held: it is read from
+    // disk and serialized without.
+    const CBlockIndex *pindex;
+    bool fCompactAllowed = false;
+    BlockHash tipHash;
+    {
+        LOCK(cs_main);
+        pindex = LookupBlockIndex(hash);
+        if (pindex) {
+            send = BlockRequestAllowed(pindex, consensusParams);
+            if (!send) {
+                LogPrint(BCLog::NET,
+                         "%s: ignoring request from peer=%i for old "
+                         "block that isn't in the main chain\n",
+                         __func__, pfrom->GetId());
+            }
+        }
+        // Disconnect node in case we have reached the outbound limit for serving
+        // historical blocks.
+        // Never disconnect whitelisted nodes.
+        if (send && connman->OutboundTargetReached(true) &&
+            (((pindexBestHeader != nullptr) &&
+              (pindexBestHeader->GetBlockTime() - pindex->GetBlockTime() >
+               HISTORICAL_BLOCK_AGE)) ||
+             inv.type == MSG_FILTERED_BLOCK) &&
+            !pfrom->HasPermission(PF_NOBAN)) {
+            LogPrint(BCLog::NET,
+                     "historical block serving limit reached, disconnect peer=%d\n",
+                     pfrom->GetId());
+
+            // disconnect node
+            pfrom->fDisconnect = true;
+            send = false;
+        }
+        // Avoid leaking prune-height by never sending blocks below the
+        // NODE_NETWORK_LIMITED threshold.
+        // Add two blocks buffer extension for possible races
+        if (send && !pfrom->HasPermission(PF_NOBAN) &&
+            ((((pfrom->GetLocalServices() & NODE_NETWORK_LIMITED) ==
+               NODE_NETWORK_LIMITED) &&
+              ((pfrom->GetLocalServices() & NODE_NETWORK) != NODE_NETWORK) &&
+              (::ChainActive().Tip()->nHeight - pindex->nHeight >
+               (int)NODE_NETWORK_LIMITED_MIN_BLOCKS + 2)))) {
             LogPrint(BCLog::NET,
-                     "%s: ignoring request from peer=%i for old "
-                     "block that isn't in the main chain\n",
-                     __func__, pfrom->GetId());
+                     "Ignore block request below NODE_NETWORK_LIMITED "
+                     "threshold from peer=%d\n",
+                     pfrom->GetId());
+
+            // disconnect node and prevent it from stalling (would otherwise wait
+            // for the missing block)
+            pfrom->fDisconnect = true;
+            send = false;
         }
-    }
-    const CNetMsgMaker msgMaker(pfrom->GetSendVersion());
-    // Disconnect node in case we have reached the outbound limit for serving
-    // historical blocks.
-    // Never disconnect whitelisted nodes.
-    if (send && connman->OutboundTargetReached(true) &&
-        (((pindexBestHeader != nullptr) &&
-          (pindexBestHeader->GetBlockTime() - pindex->GetBlockTime() >
-           HISTORICAL_BLOCK_AGE)) ||
-         inv.type == MSG_FILTERED_BLOCK) &&
-        !pfrom->HasPermission(PF_NOBAN)) {
-        LogPrint(BCLog::NET,
-                 "historical block serving limit reached, disconnect peer=%d\n",
-                 pfrom->GetId());
+        // Pruned nodes may have deleted the block, so check whether it's available
+        // before trying to send.
+        send = send && pindex->nStatus.hasData();
+        if (send) {
+            fCompactAllowed = CanDirectFetch(consensusParams) &&
+                              pindex->nHeight >= ::ChainActive().Height() - MAX_CMPCTBLOCK_DEPTH;
+            tipHash = ::ChainActive().Tip()->GetBlockHash();
+        }
+    } // release cs_main
 
-        // disconnect node
-        pfrom->fDisconnect = true;
-        send = false;
-    }
-    // Avoid leaking prune-height by never sending blocks below the
-    // NODE_NETWORK_LIMITED threshold.
-    // Add two blocks buffer extension for possible races
-    if (send && !pfrom->HasPermission(PF_NOBAN) &&
-        ((((pfrom->GetLocalServices() & NODE_NETWORK_LIMITED) ==
-           NODE_NETWORK_LIMITED) &&
-          ((pfrom->GetLocalServices() & NODE_NETWORK) != NODE_NETWORK) &&
-          (::ChainActive().Tip()->nHeight - pindex->nHeight >
-           (int)NODE_NETWORK_LIMITED_MIN_BLOCKS + 2)))) {
-        LogPrint(BCLog::NET,
-                 "Ignore block request below NODE_NETWORK_LIMITED "
-                 "threshold from peer=%d\n",
-                 pfrom->GetId());
+    if (send) {
+        // The block may still be pruned before it is read.
+        auto read_failed = [&] {
+            if (WITH_LOCK(cs_main, return pindex->nStatus.hasData())) {
+                assert(!"cannot load block from disk");
+            }
+            LogPrint(BCLog::NET, "block %s was pruned before it could be sent, disconnect peer=%d\n",
+                     hash.ToString(), pfrom->GetId());
+            pfrom->fDisconnect = true;
+        };
 
-        // disconnect node and prevent it from stalling (would otherwise wait
-        // for the missing block)
-        pfrom->fDisconnect = true;
-        send = false;
-    }
-    // Pruned nodes may have deleted the block, so check whether it's available
-    // before trying to send.
-    if (send && pindex->nStatus.hasData()) {
         std::shared_ptr<const CBlock> pblock;
         if (a_recent_block &&
             a_recent_block->GetHash() == pindex->GetBlockHash()) {
             pblock = a_recent_block;
         }
 
-        auto make_raw_block_message = [&pblock, &pindex, &config, &msgMaker] {
+        auto push_raw_block_message = [&] {
             CSerializedNetMsg msg;
             if (pblock) {
                 // pblock points to the recent block already in memory, so just use it rather than reading from disk
@@ -1605,29 +1678,46 @@ static void ProcessGetBlockData(const Config &config, CNode *pfrom,
                 // read the raw block data from disk and send it directly to network
                 msg.m_type = NetMsgType::BLOCK;
                 if (!ReadRawBlockFromDisk(msg.data, pindex, config.GetChainParams(), SER_NETWORK, msgMaker.nVersion)) {
-                    assert(!"cannot load raw block data from disk");
+                    read_failed();
+                    return false;
                 }
             }
-            return msg;
+            connman->PushMessage(pfrom, std::move(msg));
+            return true;
+        };
+
+        // The recent block is serialized once for all the peers asking for it.
+        auto push_block_message = [&](bool compact) {
+            if (const CSharedNetMsg msg = GetMostRecentBlockMessage(*connman, pindex->GetBlockHash(), compact)) {
+                connman->PushMessage(pfrom, msg);
+                return true;
+            }
+            return false;
         };
 
         if (inv.type == MSG_BLOCK) {
-            connman->PushMessage(pfrom, make_raw_block_message());
+            if (!push_block_message(false) && !push_raw_block_message()) {
+                return;
+            }
         } else {
-            auto ensure_pblock = [&pblock, &pindex, &consensusParams]() -> const CBlock & {
+            auto ensure_pblock = [&]() -> bool {
                 // Read block from disk if not already in memory and deserialize to transform it to
                 // MerkleBlock or CompactBlock
                 if (!pblock) {
                     std::shared_ptr<CBlock> pblockRead = std::make_shared<CBlock>();
                     if (!ReadBlockFromDisk(*pblockRead, pindex, consensusParams)) {
-                        assert(!"cannot load block from disk");
+                        read_failed();
+                        return false;
                     }
                     pblock = pblockRead;
                 }
-                return *pblock;
+                return true;
             };
             if (inv.type == MSG_FILTERED_BLOCK) {
-                ensure_pblock();  // read into pblock now with pfrom->cs_filter not held
+                // read into pblock now with pfrom->cs_filter not held
+                if (!ensure_pblock()) {
+                    return;
+                }
                 bool sendMerkleBlock = false;
                 CMerkleBlock merkleBlock;
                 {
@@ -1663,15 +1753,18 @@ static void ProcessGetBlockData(const Config &config, CNode *pfrom,
                 // we don't feel like constructing the object for them, so instead
                 // we respond with the full, non-compact block.
                 int nSendFlags = 0;
-                if (CanDirectFetch(consensusParams) &&
-                    pindex->nHeight >=
-                        ::ChainActive().Height() - MAX_CMPCTBLOCK_DEPTH) {
-                    CBlockHeaderAndShortTxIDs cmpctblock(ensure_pblock());
-                    connman->PushMessage(
-                        pfrom, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK,
-                                            cmpctblock));
-                } else {
-                    connman->PushMessage(pfrom, make_raw_block_message());
+                if (fCompactAllowed) {
+                    if (!push_block_message(true)) {
+                        if (!ensure_pblock()) {
+                            return;
+                        }
+                        CBlockHeaderAndShortTxIDs cmpctblock(*pblock);
+                        connman->PushMessage(
+                            pfrom, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK,
+                                                cmpctblock));
+                    }
+                } else if (!push_block_message(false) && !push_raw_block_message()) {
+                    return;
                 }
             }
         }
@@ -1683,8 +1776,7 @@ static void ProcessGetBlockData(const Config &config, CNode *pfrom,
             // want it right after the last block so they don't wait for other
             // stuff first.
             std::vector<CInv> vInv;
-            vInv.emplace_back(
-                MSG_BLOCK, ::ChainActive().Tip()->GetBlockHash());
+            vInv.emplace_back(MSG_BLOCK, tipHash);
             connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::INV, vInv));
             pfrom->hashContinue = BlockHash();
         }
@@ -1700,54 +1792,82 @@ static void ProcessGetData(const Config &config, CNode *pfrom,
     std::deque<CInv>::iterator it = pfrom->vRecvGetData.begin();
     std::vector<CInv> vNotFound;
     const CNetMsgMaker msgMaker(pfrom->GetSendVersion());
+
+    // Only look up the relayed transactions with cs_main held: they are
+    // serialized and sent without it.
+    std::deque<CInv>::iterator itTxEnd = it;
+    std::vector<RelayTx> vRelayed;
     {
         LOCK(cs_main);
+        for (; itTxEnd != pfrom->vRecvGetData.end() &&
+               (itTxEnd->type == MSG_TX || itTxEnd->type == MSG_DOUBLESPENDPROOF);
+             ++itTxEnd) {
+            auto mi = mapRelay.find(itTxEnd->hash);
+            vRelayed.push_back(mi != mapRelay.end() ? mi->second : RelayTx{});
+        }
+    } // release cs_main
 
-        while (it != pfrom->vRecvGetData.end() &&
-               (it->type == MSG_TX || it->type == MSG_DOUBLESPENDPROOF)) {
-            if (interruptMsgProc) {
-                return;
-            }
-            // Don't bother if send buffer is too full to respond anyway.
-            if (pfrom->fPauseSend) {
-                break;
-            }
-
-            const CInv &inv = *it;
-            it++;
+    // The messages serialized here, to be kept in mapRelay.
+    std::vector<std::pair<uint256, CSharedNetMsg>> vNewRelayMsgs;
+    for (size_t i = 0; it != itTxEnd; ++i) {
+        if (interruptMsgProc) {
+            return;
+        }
+        // Don't bother if send buffer is too full to respond anyway.
+        if (pfrom->fPauseSend) {
+            break;
+        }
 
-            // Send stream from relay memory
-            bool push = false;
-            auto mi = mapRelay.find(inv.hash);
-            int nSendFlags = 0;
-            if (mi != mapRelay.end()) {
+        const CInv &inv = *it;
+        it++;
+
+        // Send stream from relay memory
+        bool push = false;
+        RelayTx &relay = vRelayed[i];
+        int nSendFlags = 0;
+        if (relay.tx) {
+            // Serialized once, for the first peer asking for it.
+            if (!relay.msg) {
+                relay.msg = connman->MakeSharedMessage(
+                    msgMaker.Make(nSendFlags, NetMsgType::TX, *relay.tx));
+                vNewRelayMsgs.emplace_back(inv.hash, relay.msg);
+            }
+            connman->PushMessage(pfrom, relay.msg);
+            push = true;
+        } else if (pfrom->timeLastMempoolReq) {
+            auto txinfo = g_mempool.info(TxId(inv.hash));
+            // To protect privacy, do not answer getdata using the mempool
+            // when that TX couldn't have been INVed in reply to a MEMPOOL
+            // request.
+            if (txinfo.tx && txinfo.nTime <= pfrom->timeLastMempoolReq) {
                 connman->PushMessage(
                     pfrom,
-                    msgMaker.Make(nSendFlags, NetMsgType::TX, *mi->second));
+                    msgMaker.Make(nSendFlags, NetMsgType::TX, *txinfo.tx));
+                push = true;
+            }
+        } else if (inv.type == MSG_DOUBLESPENDPROOF && DoubleSpendProof::IsEnabled()) {
+            DoubleSpendProof dsp = g_mempool.doubleSpendProofStorage()->lookup(inv.hash);
+            if (!dsp.isEmpty()) {
+                connman->PushMessage(pfrom, msgMaker.Make(nSendFlags, NetMsgType::DSPROOF, dsp));
                 push = true;
-            } else if (pfrom->timeLastMempoolReq) {
-                auto txinfo = g_mempool.info(TxId(inv.hash));
-                // To protect privacy, do not answer getdata using the mempool
-                // when that TX couldn't have been INVed in reply to a MEMPOOL
-                // request.
-                if (txinfo.tx && txinfo.nTime <= pfrom->timeLastMempoolReq) {
-                    connman->PushMessage(
-                        pfrom,
-                        msgMaker.Make(nSendFlags, NetMsgType::TX, *txinfo.tx));
-                    push = true;
-                }
-            } else if (inv.type == MSG_DOUBLESPENDPROOF && DoubleSpendProof::IsEnabled()) {
-                DoubleSpendProof dsp = g_mempool.doubleSpendProofStorage()->lookup(inv.hash);
-                if (!dsp.isEmpty()) {
-                    connman->PushMessage(pfrom, msgMaker.Make(nSendFlags, NetMsgType::DSPROOF, dsp));
-                    push = true;
-                }
             }
-            if (!push) {
-                vNotFound.push_back(inv);
+        }
+        if (!push) {
+            vNotFound.push_back(inv);
+        }
+    }
+
+    if (!vNewRelayMsgs.empty()) {
+        // Unless another peer asked for the transaction in the meantime, or it
+        // expired.
+        LOCK(cs_main);
+        for (auto &[hash, msg] : vNewRelayMsgs) {
+            auto mi = mapRelay.find(hash);
+            if (mi != mapRelay.end() && !mi->second.msg) {
+                mi->second.msg = std::move(msg);
             }
         }
-    } // release cs_main
+    }
 
     if (it != pfrom->vRecvGetData.end() && !pfrom->fPauseSend) {
         const CInv &inv = *it;
@@ -1805,6 +1925,231 @@ inline static void SendBlockTransactions(const CBlock &block,
                          msgMaker.Make(nSendFlags, NetMsgType::BLOCKTXN, resp));
 }
 
+/**
+ * Validate that the filter index requested by a peer in a getcfilters,
+ * getcfheaders or getcfcheckpt message is available, and look up the stop
+ * block. The peer is disconnected when the request is invalid.
+ *
+ * @param[in]   pfrom           The peer that we received the request from
+ * @param[in]   chain_params    Chain parameters
+ * @param[in]   filter_type     The filter type the request is for. Must be basic filters.
+ * @param[in]   start_height    The start height for the request
+ * @param[in]   stop_hash       The stop_hash for the request
+ * @param[in]   max_height_diff The maximum number of items permitted to request, as specified in BIP 157
+ * @param[out]  stop_index      The CBlockIndex for the stop_hash block, if the request can be serviced.
+ * @param[out]  filter_index    The filter index, if the request can be serviced.
+ * @return                      True if the request can be serviced.
+ */
+static bool PrepareBlockFilterRequest(
+    CNode *pfrom, const CChainParams &chain_params,
+    BlockFilterType filter_type, uint32_t start_height,
+    const BlockHash &stop_hash, uint32_t max_height_diff,
+    const CBlockIndex *&stop_index, BlockFilterIndex *&filter_index) {
+    const bool supported_filter_type =
+        (filter_type == BlockFilterType::BASIC &&
+         (pfrom->GetLocalServices() & NODE_CF));
+    if (!supported_filter_type) {
+        LogPrint(BCLog::NET,
+                 "peer %d requested unsupported block filter type: %d\n",
+                 pfrom->GetId(), static_cast<uint8_t>(filter_type));
+        pfrom->fDisconnect = true;
+        return false;
+    }
+
+    {
+        LOCK(cs_main);
+        stop_index = LookupBlockIndex(stop_hash);
+
+        // Check that the stop block exists and the peer would be allowed to
+        // fetch it.
+        if (!stop_index ||
+            !BlockRequestAllowed(stop_index, chain_params.GetConsensus())) {
+            LogPrint(BCLog::NET, "peer %d requested invalid block hash: %s\n",
+                     pfrom->GetId(), stop_hash.ToString());
+            pfrom->fDisconnect = true;
+            return false;
+        }
+    }
+
+    const uint32_t stop_height = stop_index->nHeight;
+    if (start_height > stop_height) {
+        LogPrint(BCLog::NET,
+                 "peer %d sent invalid getcfilters/getcfheaders with "
+                 "start height %d and stop height %d\n",
+                 pfrom->GetId(), start_height, stop_height);
+        pfrom->fDisconnect = true;
+        return false;
+    }
+    if (stop_height - start_height >= max_height_diff) {
+        LogPrint(BCLog::NET,
+                 "peer %d requested too many cfilters/cfheaders: %d / %d\n",
+                 pfrom->GetId(), stop_height - start_height + 1,
+                 max_height_diff);
+        pfrom->fDisconnect = true;
+        return false;
+    }
+
+    filter_index = GetBlockFilterIndex(filter_type);
+    if (!filter_index) {
+        LogPrint(BCLog::NET, "Filter index for supported type %s not found\n",
+                 BlockFilterTypeName(filter_type));
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Handle a cfilters request.
+ *
+ * May disconnect from the peer in the case of a bad request.
+ */
+static void ProcessGetCFilters(CNode *pfrom, CDataStream &vRecv,
+                               const CChainParams &chain_params,
+                               CConnman *connman) {
+    uint8_t filter_type_ser;
+    uint32_t start_height;
+    BlockHash stop_hash;
+
+    vRecv >> filter_type_ser >> start_height >> stop_hash;
+
+    const BlockFilterType filter_type =
+        static_cast<BlockFilterType>(filter_type_ser);
+
+    const CBlockIndex *stop_index;
+    BlockFilterIndex *filter_index;
+    if (!PrepareBlockFilterRequest(pfrom, chain_params, filter_type,
+                                   start_height, stop_hash,
+                                   MAX_GETCFILTERS_SIZE, stop_index,
+                                   filter_index)) {
+        return;
+    }
+
+    std::vector<BlockFilter> filters;
+    if (!filter_index->LookupFilterRange(start_height, stop_index, filters)) {
+        LogPrint(BCLog::NET,
+                 "Failed to find block filter in index: filter_type=%s, "
+                 "start_height=%d, stop_hash=%s\n",
+                 BlockFilterTypeName(filter_type), start_height,
+                 stop_hash.ToString());
+        return;
+    }
+
+    const CNetMsgMaker msgMaker(pfrom->GetSendVersion());
+    for (const auto &filter : filters) {
+        connman->PushMessage(pfrom,
+                             msgMaker.Make(NetMsgType::CFILTER, filter));
+    }
+}
+
+/**
+ * Handle a cfheaders request.
+ *
+ * May disconnect from the peer in the case of a bad request.
+ */
+static void ProcessGetCFHeaders(CNode *pfrom, CDataStream &vRecv,
+                                const CChainParams &chain_params,
+                                CConnman *connman) {
+    uint8_t filter_type_ser;
+    uint32_t start_height;
+    BlockHash stop_hash;
+
+    vRecv >> filter_type_ser >> start_height >> stop_hash;
+
+    const BlockFilterType filter_type =
+        static_cast<BlockFilterType>(filter_type_ser);
+
+    const CBlockIndex *stop_index;
+    BlockFilterIndex *filter_index;
+    if (!PrepareBlockFilterRequest(pfrom, chain_params, filter_type,
+                                   start_height, stop_hash,
+                                   MAX_GETCFHEADERS_SIZE, stop_index,
+                                   filter_index)) {
+        return;
+    }
+
+    uint256 prev_header;
+    if (start_height > 0) {
+        const CBlockIndex *const prev_block =
+            stop_index->GetAncestor(static_cast<int>(start_height - 1));
+        if (!filter_index->LookupFilterHeader(prev_block, prev_header)) {
+            LogPrint(BCLog::NET,
+                     "Failed to find block filter header in index: "
+                     "filter_type=%s, block_hash=%s\n",
+                     BlockFilterTypeName(filter_type),
+                     prev_block->GetBlockHash().ToString());
+            return;
+        }
+    }
+
+    std::vector<uint256> filter_hashes;
+    if (!filter_index->LookupFilterHashRange(start_height, stop_index,
+                                             filter_hashes)) {
+        LogPrint(BCLog::NET,
+                 "Failed to find block filter hashes in index: "
+                 "filter_type=%s, start_height=%d, stop_hash=%s\n",
+                 BlockFilterTypeName(filter_type), start_height,
+                 stop_hash.ToString());
+        return;
+    }
+
+    const CNetMsgMaker msgMaker(pfrom->GetSendVersion());
+    connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::CFHEADERS,
+                                              filter_type_ser,
+                                              stop_index->GetBlockHash(),
+                                              prev_header, filter_hashes));
+}
+
+/**
+ * Handle a getcfcheckpt request.
+ *
+ * May disconnect from the peer in the case of a bad request.
+ */
+static void ProcessGetCFCheckPt(CNode *pfrom, CDataStream &vRecv,
+                                const CChainParams &chain_params,
+                                CConnman *connman) {
+    uint8_t filter_type_ser;
+    BlockHash stop_hash;
+
+    vRecv >> filter_type_ser >> stop_hash;
+
+    const BlockFilterType filter_type =
+        static_cast<BlockFilterType>(filter_type_ser);
+
+    const CBlockIndex *stop_index;
+    BlockFilterIndex *filter_index;
+    if (!PrepareBlockFilterRequest(
+            pfrom, chain_params, filter_type, /*start_height=*/0, stop_hash,
+            /*max_height_diff=*/std::numeric_limits<uint32_t>::max(),
+            stop_index, filter_index)) {
+        return;
+    }
+
+    std::vector<uint256> headers(stop_index->nHeight / CFCHECKPT_INTERVAL);
+
+    // Populate headers.
+    const CBlockIndex *block_index = stop_index;
+    for (int i = headers.size() - 1; i >= 0; i--) {
+        const int height = (i + 1) * CFCHECKPT_INTERVAL;
+        block_index = block_index->GetAncestor(height);
+
+        if (!filter_index->LookupFilterHeader(block_index, headers[i])) {
+            LogPrint(BCLog::NET,
+                     "Failed to find block filter header in index: "
+                     "filter_type=%s, block_hash=%s\n",
+                     BlockFilterTypeName(filter_type),
+                     block_index->GetBlockHash().ToString());
+            return;
+        }
+    }
+
+    const CNetMsgMaker msgMaker(pfrom->GetSendVersion());
+    connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::CFCHECKPT,
+                                              filter_type_ser,
+                                              stop_index->GetBlockHash(),
+                                              headers));
+}
+
 static bool ProcessHeadersMessage(const Config &config, CNode *pfrom,
                                   CConnman *connman,
                                   const std::vector<CBlockHeader> &headers,
@@ -2828,6 +3173,21 @@ static bool ProcessMessage(const Config &config, CNode *pfrom,
         return true;
     }
 
+    if (msg_type == NetMsgType::GETCFILTERS) {
+        ProcessGetCFilters(pfrom, vRecv, chainparams, connman);
+        return true;
+    }
+
+    if (msg_type == NetMsgType::GETCFHEADERS) {
+        ProcessGetCFHeaders(pfrom, vRecv, chainparams, connman);
+        return true;
+    }
+
+    if (msg_type == NetMsgType::GETCFCHECKPT) {
+        ProcessGetCFCheckPt(pfrom, vRecv, chainparams, connman);
+        return true;
+    }
+
     if (msg_type == NetMsgType::GETHEADERS) {
         CBlockLocator locator;
         BlockHash hashStop;
@@ -2937,11 +3297,15 @@ static bool ProcessMessage(const Config &config, CNode *pfrom,
         nodestate->m_tx_download.m_tx_announced.erase(txid);
         nodestate->m_tx_download.m_tx_in_flight.erase(txid);
         EraseTxRequest(txid);
+        const std::optional<PreVerifiedTx> preverified = std::move(nodestate->m_preverified_tx);
+        nodestate->m_preverified_tx.reset();
 
         if (!AlreadyHave(inv) &&
             AcceptToMemoryPool(config, g_mempool, state, ptx, &fMissingInputs,
                                false /* bypass_limits */,
-                               Amount::zero() /* nAbsurdFee */)) {
+                               Amount::zero() /* nAbsurdFee */,
+                               false /* test_accept */,
+                               preverified ? &*preverified : nullptr)) {
             g_mempool.check(pcoinsTip.get());
             RelayTransaction(tx, connman);
             for (size_t i = 0; i < tx.vout.size(); i++) {
@@ -3631,7 +3995,7 @@ static bool ProcessMessage(const Config &config, CNode *pfrom,
         }
         pfrom->fSentAddr = true;
 
-        pfrom->vAddrToSend.clear();
+        WITH_LOCK(pfrom->cs_addrSend, pfrom->vAddrToSend.clear());
         std::vector<CAddress> vAddr;
         if (pfrom->HasPermission(PF_ADDR)) {
             vAddr = connman->GetAddresses(MAX_ADDR_TO_SEND, MAX_PCT_ADDR_TO_SEND);
@@ -3960,6 +4324,78 @@ bool PeerLogicValidation::SendRejectsAndCheckIfShouldDiscourage(CNode *pnode,
     return false;
 }
 
+void PeerLogicValidation::PrepareMessages(const Config &config, const std::vector<CNode *> &nodes,
+                                          std::atomic<bool> &interruptMsgProc) {
+    if (!fTxPreVerify) {
+        return;
+    }
+
+    // The transactions of the messages ProcessMessages() takes next, one per
+    // node, are verified as a batch on the txverify threads, without cs_main.
+    // AcceptToMemoryPool() is then passed what was found of their scripts.
+    std::vector<CTransactionRef> txs;
+    std::vector<NodeId> nodeids;
+    for (CNode *pnode : nodes) {
+        if (pnode->fDisconnect || pnode->fPauseSend || !pnode->vRecvGetData.empty() ||
+            (!g_relay_txes && !pnode->HasPermission(PF_RELAY))) {
+            // ProcessMessages() does not process a tx message from it.
+            continue;
+        }
+        LOCK(pnode->cs_vProcessMsg);
+        if (pnode->vProcessMsg.empty()) {
+            continue;
+        }
+        const CNetMessage &msg = pnode->vProcessMsg.front();
+        if (msg.hdr.GetCommand() != NetMsgType::TX) {
+            continue;
+        }
+        try {
+            CDataStream vRecv(msg.vRecv.begin(), msg.vRecv.end(), msg.vRecv.GetType(), pnode->GetRecvVersion());
+            CTransactionRef ptx;
+            vRecv >> ptx;
+            txs.push_back(std::move(ptx));
+            nodeids.push_back(pnode->GetId());
+        } catch (const std::exception &) {
+            // ProcessMessages() reports it.
+        }
+    }
+    if (txs.empty() || interruptMsgProc) {
+        return;
+    }
+
+    {
+        // Unless we would not even try to accept them.
+        LOCK(cs_main);
+        size_t n = 0;
+        for (size_t i = 0; i < txs.size(); ++i) {
+            if (!AlreadyHave(CInv(MSG_TX, txs[i]->GetId()))) {
+                txs[n] = std::move(txs[i]);
+                nodeids[n++] = nodeids[i];
+            }
+        }
+        txs.resize(n);
+        nodeids.resize(n);
+    }
+    if (txs.empty()) {
+        return;
+    }
+
+    std::vector<std::pair<NodeId, PreVerifiedTx>> results;
+    PreVerifyTransactions(config, g_mempool, txs, [&](size_t i, const PreVerifiedTx *preverified) {
+        if (preverified) {
+            results.emplace_back(nodeids[i], *preverified);
+        }
+        return true;
+    });
+    LOCK(cs_main);
+    for (auto &[nodeid, preverified] : results) {
+        // Unless the peer disconnected meanwhile.
+        if (CNodeState *state = State(nodeid)) {
+            state->m_preverified_tx = std::move(preverified);
+        }
+    }
+}
+
 bool PeerLogicValidation::ProcessMessages(const Config &config, CNode *pfrom,
                                           std::atomic<bool> &interruptMsgProc) {
     const CChainParams &chainparams = config.GetChainParams();
@@ -4370,8 +4806,21 @@ bool PeerLogicValidation::SendMessages(const Config &config, CNode *pto,
     //
     if (pto->m_next_addr_send < current_time) {
         pto->m_next_addr_send = PoissonNextSend(current_time, AVG_ADDRESS_BROADCAST_INTERVAL);
-        std::vector<CAddress> vAddr;
-        vAddr.reserve(pto->vAddrToSend.size());
+        std::vector<CAddress> vAddrToSend;
+        {
+            LOCK(pto->cs_addrSend);
+            for (const CAddress &addr : pto->vAddrToSend) {
+                if (!pto->addrKnown.contains(addr.GetKey())) {
+                    pto->addrKnown.insert(addr.GetKey());
+                    vAddrToSend.push_back(addr);
+                }
+            }
+            pto->vAddrToSend.clear();
+            // we only send the big addr message once
+            if (pto->vAddrToSend.capacity() > 40) {
+                pto->vAddrToSend.shrink_to_fit();
+            }
+        }
 
         const char *msg_type;
         int make_flags;
@@ -4383,26 +4832,19 @@ bool PeerLogicValidation::SendMessages(const Config &config, CNode *pto,
             make_flags = 0;
         }
 
-        for (const CAddress &addr : pto->vAddrToSend) {
-            if (!pto->addrKnown.contains(addr.GetKey())) {
-                pto->addrKnown.insert(addr.GetKey());
-                vAddr.push_back(addr);
-                // receiver rejects addr messages larger than MAX_ADDR_TO_SEND
-                if (vAddr.size() >= MAX_ADDR_TO_SEND) {
-                    connman->PushMessage(pto, msgMaker.Make(make_flags, msg_type, vAddr));
-                    vAddr.clear();
-                }
+        std::vector<CAddress> vAddr;
+        vAddr.reserve(std::min<size_t>(vAddrToSend.size(), MAX_ADDR_TO_SEND));
+        for (const CAddress &addr : vAddrToSend) {
+            vAddr.push_back(addr);
+            // receiver rejects addr messages larger than MAX_ADDR_TO_SEND
+            if (vAddr.size() >= MAX_ADDR_TO_SEND) {
+                connman->PushMessage(pto, msgMaker.Make(make_flags, msg_type, vAddr));
+                vAddr.clear();
             }
         }
-        pto->vAddrToSend.clear();
         if (!vAddr.empty()) {
             connman->PushMessage(pto, msgMaker.Make(make_flags, msg_type, vAddr));
         }
-
-        // we only send the big addr message once
-        if (pto->vAddrToSend.capacity() > 40) {
-            pto->vAddrToSend.shrink_to_fit();
-        }
     }
 
     // Start block sync
@@ -4538,20 +4980,10 @@ bool PeerLogicValidation::SendMessages(const Config &config, CNode *pto,
 
                 int nSendFlags = 0;
 
-                bool fGotBlockFromCache = false;
-                {
-                    LOCK(cs_most_recent_block);
-                    if (most_recent_block_hash == pBestIndex->GetBlockHash()) {
-                        CBlockHeaderAndShortTxIDs cmpctblock(
-                            *most_recent_block);
-                        connman->PushMessage(
-                            pto,
-                            msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK,
-                                          cmpctblock));
-                        fGotBlockFromCache = true;
-                    }
-                }
-                if (!fGotBlockFromCache) {
+                if (const CSharedNetMsg msg = GetMostRecentBlockMessage(
+                        *connman, pBestIndex->GetBlockHash(), true)) {
+                    connman->PushMessage(pto, msg);
+                } else {
                     CBlock block;
                     bool ret =
                         ReadBlockFromDisk(block, pBestIndex, consensusParams);
@@ -4778,8 +5210,8 @@ bool PeerLogicValidation::SendMessages(const Config &config, CNode *pto,
                         vRelayExpiration.pop_front();
                     }
 
-                    auto ret = mapRelay.insert(
-                        std::make_pair(txid, std::move(txinfo.tx)));
+                    auto ret = mapRelay.insert(std::make_pair(
+                        txid, RelayTx{std::move(txinfo.tx), {}}));
                     if (ret.second) {
                         vRelayExpiration.emplace_back(
                             nNow + 15 * 60 * 1000000, ret.first);
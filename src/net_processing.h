@@ -98,6 +98,12 @@ public:
      */
     void FinalizeNode(const Config &config, NodeId nodeid,
                       bool &fUpdateConnectionTime) override;
+    /**
+     * Verify together the signatures of the transactions which nodes relayed
+     * in the messages they are about to process.
+     */
+    void PrepareMessages(const Config &config, const std::vector<CNode *> &nodes,
+                         std::atomic<bool> &interrupt) override;
     /**
      * Process protocol messages received from a given node.
      */
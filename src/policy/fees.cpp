@@ -19,6 +19,7 @@ FeeFilterRounder::FeeFilterRounder(const CFeeRate &minIncrementalFee) {
 }
 
 Amount FeeFilterRounder::round(const Amount currentMinFee) {
+    LOCK(m_insecure_rand_mutex);
     auto it = feeset.lower_bound(currentMinFee);
     if ((it != feeset.begin() && insecure_rand.rand32() % 3 != 0) ||
         it == feeset.end()) {
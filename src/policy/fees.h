@@ -7,6 +7,7 @@
 
 #include <amount.h>
 #include <random.h>
+#include <sync.h>
 #include <uint256.h>
 
 #include <map>
@@ -35,5 +36,7 @@ public:
 
 private:
     std::set<Amount> feeset;
-    FastRandomContext insecure_rand;
+    //! Shared by the message handler threads.
+    Mutex m_insecure_rand_mutex;
+    FastRandomContext insecure_rand GUARDED_BY(m_insecure_rand_mutex);
 };
@@ -216,6 +216,43 @@ bool CPubKey::VerifySchnorr(const uint256 &hash,
                                     hash.begin(), &pubkey);
 }
 
+/* static */ bool
+CPubKey::VerifySchnorrBatch(const std::vector<SchnorrSigCheck> &checks) {
+    // Scratch space for the intermediate points and scalars of each signature
+    // and for the multi-multiplication that combines them.
+    static constexpr size_t SCRATCH_BASE_SIZE = 64 * 1024;
+    static constexpr size_t SCRATCH_SIZE_PER_SIG = 4 * 1024;
+
+    const size_t n = checks.size();
+    std::vector<secp256k1_pubkey> pubkeys(n);
+    std::vector<const secp256k1_pubkey *> pubkey_ptrs(n);
+    std::vector<const uint8_t *> sig_ptrs(n);
+    std::vector<const uint8_t *> hash_ptrs(n);
+    for (size_t i = 0; i < n; ++i) {
+        const CPubKey &pubkey = checks[i].pubkey;
+        if (!pubkey.IsValid() ||
+            !secp256k1_ec_pubkey_parse(secp256k1_context_verify, &pubkeys[i],
+                                       &pubkey[0], pubkey.size())) {
+            return false;
+        }
+        pubkey_ptrs[i] = &pubkeys[i];
+        sig_ptrs[i] = checks[i].sig.data();
+        hash_ptrs[i] = checks[i].hash.begin();
+    }
+
+    // If the scratch space cannot be allocated, libsecp256k1 verifies the
+    // signatures one at a time.
+    secp256k1_scratch_space *scratch = secp256k1_scratch_space_create(
+        secp256k1_context_verify, SCRATCH_BASE_SIZE + n * SCRATCH_SIZE_PER_SIG);
+    const int ret = secp256k1_schnorr_verify_batch(
+        secp256k1_context_verify, scratch, sig_ptrs.data(), hash_ptrs.data(),
+        pubkey_ptrs.data(), n);
+    if (scratch) {
+        secp256k1_scratch_space_destroy(secp256k1_context_verify, scratch);
+    }
+    return ret;
+}
+
 bool CPubKey::RecoverCompact(const uint256 &hash,
                              const std::vector<uint8_t> &vchSig) {
     if (vchSig.size() != COMPACT_SIGNATURE_SIZE) {
@@ -13,11 +13,14 @@
 
 #include <boost/range/adaptor/sliced.hpp>
 
+#include <array>
 #include <stdexcept>
 #include <vector>
 
 const unsigned int BIP32_EXTKEY_SIZE = 74;
 
+struct SchnorrSigCheck;
+
 /** A reference to a CKey: the Hash160 of its serialized public key */
 class CKeyID : public uint160 {
 public:
@@ -166,6 +169,13 @@ public:
     bool VerifySchnorr(const uint256 &hash,
                        const std::vector<uint8_t> &vchSig) const;
 
+    /**
+     * Verify several Schnorr signatures at once, which is considerably faster
+     * than calling VerifySchnorr on each of them. Returns true only if all the
+     * signatures are valid, without telling which one is not.
+     */
+    static bool VerifySchnorrBatch(const std::vector<SchnorrSigCheck> &checks);
+
     /**
      * Check whether a DER-serialized ECDSA signature is normalized (lower-S).
      */
@@ -187,6 +197,13 @@ public:
                 const ChainCode &cc) const;
 };
 
+/** A Schnorr signature to be verified by CPubKey::VerifySchnorrBatch. */
+struct SchnorrSigCheck {
+    CPubKey pubkey;
+    uint256 hash;
+    std::array<uint8_t, 64> sig;
+};
+
 struct CExtPubKey {
     uint8_t nDepth = 0;
     uint8_t vchFingerprint[4] = {};
@@ -10,6 +10,10 @@
 #include <config.h>
 #include <core_io.h>
 #include <httpserver.h>
+#include <index/blockfilterindex.h>
+#include <index/scripthashindex.h>
+#include <index/spentindex.h>
+#include <index/tokenindex.h>
 #include <index/txindex.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
@@ -27,6 +31,8 @@
 
 // Allow a max of 15 outpoints to be queried at once.
 static const size_t MAX_GETUTXOS_OUTPOINTS = 15;
+// Allow a max of 100 outpoints to be looked up in the spent index at once.
+static const size_t MAX_SPENDINGINFO_OUTPOINTS = 100;
 
 enum class RetFormat {
     UNDEF,
@@ -204,6 +210,231 @@ static bool rest_headers(const std::any& context, Config &config, HTTPRequest *r
     }
 }
 
+static bool rest_filter_header(const std::any& context, Config &config, HTTPRequest *req,
+                               const std::string &strURIPart) {
+    if (!CheckWarmup(req)) {
+        return false;
+    }
+
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    std::vector<std::string> uri_parts;
+    Split(uri_parts, param, "/");
+
+    if (uri_parts.size() != 3) {
+        return RESTERR(req, HTTP_BAD_REQUEST,
+                       "Invalid URI format. Expected "
+                       "/rest/blockfilterheaders/<filtertype>/<count>/"
+                       "<blockhash>.<ext>");
+    }
+
+    uint256 rawHash;
+    if (!ParseHashStr(uri_parts[2], rawHash)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + uri_parts[2]);
+    }
+    const BlockHash block_hash(rawHash);
+
+    BlockFilterType filtertype;
+    if (!BlockFilterTypeByName(uri_parts[0], filtertype)) {
+        return RESTERR(req, HTTP_BAD_REQUEST,
+                       "Unknown filtertype " + uri_parts[0]);
+    }
+
+    BlockFilterIndex *index = GetBlockFilterIndex(filtertype);
+    if (!index) {
+        return RESTERR(req, HTTP_BAD_REQUEST,
+                       "Index is not enabled for filtertype " + uri_parts[0]);
+    }
+
+    long count = strtol(uri_parts[1].c_str(), nullptr, 10);
+    if (count < 1 || count > 2000) {
+        return RESTERR(req, HTTP_BAD_REQUEST,
+                       "Header count out of range: " + uri_parts[1]);
+    }
+
+    std::vector<const CBlockIndex *> headers;
+    headers.reserve(count);
+    {
+        LOCK(cs_main);
+        const CBlockIndex *pindex = LookupBlockIndex(block_hash);
+        while (pindex != nullptr && ::ChainActive().Contains(pindex)) {
+            headers.push_back(pindex);
+            if (headers.size() == size_t(count)) {
+                break;
+            }
+            pindex = ::ChainActive().Next(pindex);
+        }
+    }
+
+    const bool index_ready = index->BlockUntilSyncedToCurrentChain();
+
+    std::vector<uint256> filter_headers;
+    filter_headers.reserve(count);
+    for (const CBlockIndex *pindex : headers) {
+        uint256 filter_header;
+        if (!index->LookupFilterHeader(pindex, filter_header)) {
+            std::string errmsg = "Filter not found.";
+
+            if (!index_ready) {
+                errmsg += " Block filters are still in the process of being "
+                          "indexed.";
+            } else {
+                errmsg += " This error is unexpected and indicates index "
+                          "corruption.";
+            }
+
+            return RESTERR(req, HTTP_NOT_FOUND, errmsg);
+        }
+        filter_headers.push_back(filter_header);
+    }
+
+    switch (rf) {
+        case RetFormat::BINARY: {
+            CDataStream ssHeader(SER_NETWORK, PROTOCOL_VERSION);
+            for (const uint256 &header : filter_headers) {
+                ssHeader << header;
+            }
+
+            std::string binaryHeader = ssHeader.str();
+            req->WriteHeader("Content-Type", "application/octet-stream");
+            req->WriteReply(HTTP_OK, binaryHeader);
+            return true;
+        }
+        case RetFormat::HEX: {
+            CDataStream ssHeader(SER_NETWORK, PROTOCOL_VERSION);
+            for (const uint256 &header : filter_headers) {
+                ssHeader << header;
+            }
+
+            std::string strHex = HexStr(ssHeader) + "\n";
+            req->WriteHeader("Content-Type", "text/plain");
+            req->WriteReply(HTTP_OK, strHex);
+            return true;
+        }
+        case RetFormat::JSON: {
+            UniValue::Array jsonHeaders;
+            jsonHeaders.reserve(filter_headers.size());
+            for (const uint256 &header : filter_headers) {
+                jsonHeaders.emplace_back(header.GetHex());
+            }
+
+            std::string strJSON = UniValue::stringify(jsonHeaders) + "\n";
+            req->WriteHeader("Content-Type", "application/json");
+            req->WriteReply(HTTP_OK, strJSON);
+            return true;
+        }
+        default: {
+            return RESTERR(req, HTTP_NOT_FOUND,
+                           "output format not found (available: " +
+                               AvailableDataFormatsString() + ")");
+        }
+    }
+}
+
+static bool rest_block_filter(const std::any& context, Config &config, HTTPRequest *req,
+                              const std::string &strURIPart) {
+    if (!CheckWarmup(req)) {
+        return false;
+    }
+
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+
+    // request is sent over URI scheme
+    // /rest/blockfilter/filtertype/blockhash
+    std::vector<std::string> uri_parts;
+    Split(uri_parts, param, "/");
+    if (uri_parts.size() != 2) {
+        return RESTERR(req, HTTP_BAD_REQUEST,
+                       "Invalid URI format. Expected "
+                       "/rest/blockfilter/<filtertype>/<blockhash>");
+    }
+
+    uint256 rawHash;
+    if (!ParseHashStr(uri_parts[1], rawHash)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + uri_parts[1]);
+    }
+    const BlockHash block_hash(rawHash);
+
+    BlockFilterType filtertype;
+    if (!BlockFilterTypeByName(uri_parts[0], filtertype)) {
+        return RESTERR(req, HTTP_BAD_REQUEST,
+                       "Unknown filtertype " + uri_parts[0]);
+    }
+
+    BlockFilterIndex *index = GetBlockFilterIndex(filtertype);
+    if (!index) {
+        return RESTERR(req, HTTP_BAD_REQUEST,
+                       "Index is not enabled for filtertype " + uri_parts[0]);
+    }
+
+    const CBlockIndex *block_index;
+    bool block_was_connected;
+    {
+        LOCK(cs_main);
+        block_index = LookupBlockIndex(block_hash);
+        if (!block_index) {
+            return RESTERR(req, HTTP_NOT_FOUND,
+                           uri_parts[1] + " not found");
+        }
+        block_was_connected = block_index->IsValid(BlockValidity::SCRIPTS);
+    }
+
+    const bool index_ready = index->BlockUntilSyncedToCurrentChain();
+
+    BlockFilter filter;
+    if (!index->LookupFilter(block_index, filter)) {
+        std::string errmsg = "Filter not found.";
+
+        if (!block_was_connected) {
+            errmsg += " Block was not connected to active chain.";
+        } else if (!index_ready) {
+            errmsg += " Block filters are still in the process of being "
+                      "indexed.";
+        } else {
+            errmsg += " This error is unexpected and indicates index "
+                      "corruption.";
+        }
+
+        return RESTERR(req, HTTP_NOT_FOUND, errmsg);
+    }
+
+    switch (rf) {
+        case RetFormat::BINARY: {
+            CDataStream ssResp(SER_NETWORK, PROTOCOL_VERSION);
+            ssResp << filter;
+
+            std::string binaryResp = ssResp.str();
+            req->WriteHeader("Content-Type", "application/octet-stream");
+            req->WriteReply(HTTP_OK, binaryResp);
+            return true;
+        }
+        case RetFormat::HEX: {
+            CDataStream ssResp(SER_NETWORK, PROTOCOL_VERSION);
+            ssResp << filter;
+
+            std::string strHex = HexStr(ssResp) + "\n";
+            req->WriteHeader("Content-Type", "text/plain");
+            req->WriteReply(HTTP_OK, strHex);
+            return true;
+        }
+        case RetFormat::JSON: {
+            UniValue::Object ret;
+            ret.reserve(1);
+            ret.emplace_back("filter", HexStr(filter.GetEncodedFilter()));
+            std::string strJSON = UniValue::stringify(ret) + "\n";
+            req->WriteHeader("Content-Type", "application/json");
+            req->WriteReply(HTTP_OK, strJSON);
+            return true;
+        }
+        default: {
+            return RESTERR(req, HTTP_NOT_FOUND,
+                           "output format not found (available: " +
+                               AvailableDataFormatsString() + ")");
+        }
+    }
+}
+
 static bool rest_block(const Config &config, HTTPRequest *req,
                        const std::string &strURIPart, TxVerbosity tx_verbosity) {
     if (!CheckWarmup(req)) {
@@ -221,6 +452,9 @@ static bool rest_block(const Config &config, HTTPRequest *req,
     const BlockHash hash(rawHash);
 
     CBlock block;
+    // The block data as stored on disk, for the binary and hex formats
+    Span<const uint8_t> rawBlock;
+    std::shared_ptr<const void> rawBlockOwner;
     CBlockIndex *pblockindex = nullptr;
     CBlockIndex *tip = nullptr;
     {
@@ -236,30 +470,29 @@ static bool rest_block(const Config &config, HTTPRequest *req,
                            hashStr + " not available (pruned data)");
         }
 
-        if (!ReadBlockFromDisk(block, pblockindex,
-                               config.GetChainParams().GetConsensus())) {
+        if (rf == RetFormat::BINARY || rf == RetFormat::HEX) {
+            if (!ReadRawBlockFromDisk(rawBlock, rawBlockOwner, pblockindex,
+                                      config.GetChainParams(), SER_NETWORK,
+                                      PROTOCOL_VERSION | RPCSerializationFlags())) {
+                return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+            }
+        } else if (!ReadBlockFromDisk(block, pblockindex,
+                                      config.GetChainParams().GetConsensus())) {
             return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
         }
     }
 
     switch (rf) {
         case RetFormat::BINARY: {
-            CDataStream ssBlock(SER_NETWORK,
-                                PROTOCOL_VERSION | RPCSerializationFlags());
-            ssBlock << block;
-            std::string binaryBlock = ssBlock.str();
+            // Sent without copying the block data
             req->WriteHeader("Content-Type", "application/octet-stream");
-            req->WriteReply(HTTP_OK, binaryBlock);
+            req->WriteReply(HTTP_OK, rawBlock, std::move(rawBlockOwner));
             return true;
         }
 
         case RetFormat::HEX: {
-            CDataStream ssBlock(SER_NETWORK,
-                                PROTOCOL_VERSION | RPCSerializationFlags());
-            ssBlock << block;
-            std::string strHex = HexStr(ssBlock) + "\n";
             req->WriteHeader("Content-Type", "text/plain");
-            req->WriteReply(HTTP_OK, strHex);
+            req->WriteReplyHex(HTTP_OK, rawBlock, "\n");
             return true;
         }
 
@@ -289,6 +522,209 @@ static bool rest_block_notxdetails(const std::any& context, Config &config, HTTP
     return rest_block(config, req, strURIPart, TxVerbosity::SHOW_TXID);
 }
 
+static bool rest_scripthash(const std::any& context, Config &config, HTTPRequest *req,
+                            const std::string &strURIPart) {
+    if (!CheckWarmup(req)) {
+        return false;
+    }
+
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+
+    // request is sent over URI scheme
+    // /rest/scripthash/<history|balance|utxos>/scripthash
+    std::vector<std::string> uri_parts;
+    Split(uri_parts, param, "/");
+    if (uri_parts.size() != 2 ||
+        (uri_parts[0] != "history" && uri_parts[0] != "balance" &&
+         uri_parts[0] != "utxos")) {
+        return RESTERR(req, HTTP_BAD_REQUEST,
+                       "Invalid URI format. Expected "
+                       "/rest/scripthash/<history|balance|utxos>/<scripthash>");
+    }
+
+    uint256 scripthash;
+    if (!ParseHashStr(uri_parts[1], scripthash)) {
+        return RESTERR(req, HTTP_BAD_REQUEST,
+                       "Invalid hash: " + uri_parts[1]);
+    }
+
+    if (!g_scripthashindex) {
+        return RESTERR(req, HTTP_BAD_REQUEST,
+                       "Script hash index is not enabled");
+    }
+    if (!g_scripthashindex->BlockUntilSyncedToCurrentChain()) {
+        return RESTERR(req, HTTP_SERVICE_UNAVAILABLE,
+                       "Script hashes are still in the process of being "
+                       "indexed");
+    }
+
+    switch (rf) {
+        case RetFormat::JSON: {
+            UniValue result;
+            if (uri_parts[0] == "history") {
+                std::vector<ScriptHashIndex::HistoryEntry> history;
+                if (!g_scripthashindex->FindHistory(scripthash, 0, history)) {
+                    return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR,
+                                   "Unable to read the script hash index");
+                }
+                result = ScriptHashHistoryToJSON(history);
+            } else {
+                std::vector<ScriptHashIndex::Unspent> unspent;
+                if (!g_scripthashindex->FindUnspent(scripthash, unspent)) {
+                    return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR,
+                                   "Unable to read the script hash index");
+                }
+                if (uri_parts[0] == "balance") {
+                    result = ScriptHashBalanceToJSON(unspent);
+                } else {
+                    result = ScriptHashUnspentToJSON(unspent);
+                }
+            }
+            std::string strJSON = UniValue::stringify(result) + "\n";
+            req->WriteHeader("Content-Type", "application/json");
+            req->WriteReply(HTTP_OK, strJSON);
+            return true;
+        }
+        default: {
+            return RESTERR(req, HTTP_NOT_FOUND,
+                           "output format not found (available: json)");
+        }
+    }
+}
+
+static bool rest_spending_info(const std::any& context, Config &config, HTTPRequest *req,
+                               const std::string &strURIPart) {
+    if (!CheckWarmup(req)) {
+        return false;
+    }
+
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+
+    // request is sent over URI scheme
+    // /rest/spendinginfo/checkmempool/txid1-n/txid2-n/...
+    std::vector<std::string> uri_parts;
+    Split(uri_parts, param, "/");
+    const bool check_mempool =
+        !uri_parts.empty() && uri_parts[0] == "checkmempool";
+
+    std::vector<COutPoint> outpoints;
+    for (size_t i = check_mempool ? 1 : 0; i < uri_parts.size(); ++i) {
+        int32_t nOutput;
+        const size_t dash = uri_parts[i].find('-');
+        const std::string strTxid = uri_parts[i].substr(0, dash);
+        const std::string strOutput =
+            dash == std::string::npos ? "" : uri_parts[i].substr(dash + 1);
+        if (!ParseInt32(strOutput, &nOutput) || nOutput < 0 ||
+            !IsHex(strTxid)) {
+            return RESTERR(req, HTTP_BAD_REQUEST, "Parse error");
+        }
+        TxId txid;
+        txid.SetHex(strTxid);
+        outpoints.emplace_back(txid, uint32_t(nOutput));
+    }
+    if (outpoints.empty()) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Error: empty request");
+    }
+    if (outpoints.size() > MAX_SPENDINGINFO_OUTPOINTS) {
+        return RESTERR(
+            req, HTTP_BAD_REQUEST,
+            strprintf("Error: max outpoints exceeded (max: %d, tried: %d)",
+                      MAX_SPENDINGINFO_OUTPOINTS, outpoints.size()));
+    }
+
+    if (!g_spentindex) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Spent index is not enabled");
+    }
+    if (!g_spentindex->BlockUntilSyncedToCurrentChain()) {
+        return RESTERR(req, HTTP_SERVICE_UNAVAILABLE,
+                       "Spent outpoints are still in the process of being "
+                       "indexed");
+    }
+
+    switch (rf) {
+        case RetFormat::JSON: {
+            UniValue::Array result;
+            if (!SpendingInfoToJSON(*g_spentindex, outpoints, check_mempool,
+                                    result)) {
+                return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR,
+                               "Unable to read the spent index");
+            }
+            std::string strJSON = UniValue::stringify(result) + "\n";
+            req->WriteHeader("Content-Type", "application/json");
+            req->WriteReply(HTTP_OK, strJSON);
+            return true;
+        }
+        default: {
+            return RESTERR(req, HTTP_NOT_FOUND,
+                           "output format not found (available: json)");
+        }
+    }
+}
+
+static bool rest_token_category(const std::any& context, Config &config, HTTPRequest *req,
+                                const std::string &strURIPart) {
+    if (!CheckWarmup(req)) {
+        return false;
+    }
+
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+
+    // request is sent over URI scheme
+    // /rest/tokencategory/<info|utxos>/category
+    std::vector<std::string> uri_parts;
+    Split(uri_parts, param, "/");
+    if (uri_parts.size() != 2 ||
+        (uri_parts[0] != "info" && uri_parts[0] != "utxos")) {
+        return RESTERR(req, HTTP_BAD_REQUEST,
+                       "Invalid URI format. Expected "
+                       "/rest/tokencategory/<info|utxos>/<category>");
+    }
+
+    uint256 rawCategory;
+    if (!ParseHashStr(uri_parts[1], rawCategory)) {
+        return RESTERR(req, HTTP_BAD_REQUEST,
+                       "Invalid hash: " + uri_parts[1]);
+    }
+    const token::Id category(rawCategory);
+
+    if (!g_tokenindex) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Token index is not enabled");
+    }
+    if (!g_tokenindex->BlockUntilSyncedToCurrentChain()) {
+        return RESTERR(req, HTTP_SERVICE_UNAVAILABLE,
+                       "Tokens are still in the process of being indexed");
+    }
+
+    switch (rf) {
+        case RetFormat::JSON: {
+            UniValue result;
+            if (uri_parts[0] == "info") {
+                TokenIndex::CategoryStats stats;
+                g_tokenindex->FindCategoryStats(category, stats);
+                result = TokenCategoryStatsToJSON(category, stats);
+            } else {
+                std::vector<TokenIndex::Unspent> unspent;
+                if (!g_tokenindex->FindUnspent(category, unspent)) {
+                    return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR,
+                                   "Unable to read the token index");
+                }
+                result = TokenCategoryUnspentToJSON(config, unspent);
+            }
+            std::string strJSON = UniValue::stringify(result) + "\n";
+            req->WriteHeader("Content-Type", "application/json");
+            req->WriteReply(HTTP_OK, strJSON);
+            return true;
+        }
+        default: {
+            return RESTERR(req, HTTP_NOT_FOUND,
+                           "output format not found (available: json)");
+        }
+    }
+}
+
 static bool rest_chaininfo(const std::any& context, Config &config, HTTPRequest *req,
                            const std::string &strURIPart) {
     if (!CheckWarmup(req)) {
@@ -670,7 +1106,12 @@ static const struct {
     {"/rest/mempool/info", rest_mempool_info},
     {"/rest/mempool/contents", rest_mempool_contents},
     {"/rest/headers/", rest_headers},
+    {"/rest/blockfilter/", rest_block_filter},
+    {"/rest/blockfilterheaders/", rest_filter_header},
     {"/rest/getutxos", rest_getutxos},
+    {"/rest/scripthash/", rest_scripthash},
+    {"/rest/spendinginfo/", rest_spending_info},
+    {"/rest/tokencategory/", rest_token_category},
 };
 
 void StartREST(const std::any& context) {
@@ -15,6 +15,10 @@
 #include <consensus/validation.h>
 #include <core_io.h>
 #include <hash.h>
+#include <index/blockfilterindex.h>
+#include <index/scripthashindex.h>
+#include <index/spentindex.h>
+#include <index/tokenindex.h>
 #include <index/txindex.h>
 #include <key_io.h>
 #include <policy/policy.h>
@@ -30,17 +34,22 @@
 #include <undo.h>
 #include <util/strencodings.h>
 #include <util/system.h>
+#include <utxo_snapshot.h>
+#include <utxostats.h>
 #include <validation.h>
 #include <validationinterface.h>
 #include <warnings.h>
 
+#include <algorithm>
 #include <cassert>
 #include <condition_variable>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <string_view>
+#include <vector>
 
 struct CUpdatedBlock {
     uint256 hash;
@@ -112,6 +121,9 @@ UniValue::Object blockheaderToJSON(const CBlockIndex *tip, const CBlockIndex *bl
     return result;
 }
 
+/** blockToJSON() converts the transactions in chunks of this many, in parallel for larger blocks. */
+static constexpr size_t TX_JSON_CHUNK_SIZE = 64;
+
 UniValue::Object blockToJSON(const Config &config, const CBlock &block, const CBlockIndex *tip,
                              const CBlockIndex *blockindex, TxVerbosity verbosity) LOCKS_EXCLUDED(cs_main) {
     const CBlockIndex *pnext;
@@ -142,12 +154,26 @@ UniValue::Object blockToJSON(const Config &config, const CBlock &block, const CB
         CBlockUndo blockUndo;
         const bool have_undo{WITH_LOCK(::cs_main, return !IsBlockPruned(blockindex) && UndoReadFromDisk(blockUndo, blockindex))};
 
-        for (size_t i = 0u; i < block.vtx.size(); ++i) {
-            const CTransactionRef& tx = block.vtx[i];
-            // coinbase transaction (i.e. i == 0) doesn't have undo data
-            const CTxUndo* txundo = (have_undo && i > 0u) ? &blockUndo.vtxundo.at(i - 1u) : nullptr;
-            txs.push_back(TxToUniv(config, *tx, /*block_hash=*/uint256(), /*include_hex=*/true, RPCSerializationFlags(),
-                                   txundo, verbosity));
+        // Convert the transactions in chunks, sharing them with the RPC
+        // workers for large blocks, and append the chunks in order.
+        const size_t num_chunks = (block.vtx.size() + TX_JSON_CHUNK_SIZE - 1u) / TX_JSON_CHUNK_SIZE;
+        std::vector<UniValue::Array> chunks(num_chunks);
+        g_rpc_worker_pool.ForEach(num_chunks, [&](size_t chunk) {
+            const size_t begin = chunk * TX_JSON_CHUNK_SIZE;
+            const size_t end = std::min(begin + TX_JSON_CHUNK_SIZE, block.vtx.size());
+            chunks[chunk].reserve(end - begin);
+            for (size_t i = begin; i < end; ++i) {
+                const CTransactionRef& tx = block.vtx[i];
+                // coinbase transaction (i.e. i == 0) doesn't have undo data
+                const CTxUndo* txundo = (have_undo && i > 0u) ? &blockUndo.vtxundo.at(i - 1u) : nullptr;
+                chunks[chunk].push_back(TxToUniv(config, *tx, /*block_hash=*/uint256(), /*include_hex=*/true,
+                                                 RPCSerializationFlags(), txundo, verbosity));
+            }
+        });
+        for (UniValue::Array &chunk : chunks) {
+            for (UniValue &tx : chunk) {
+                txs.push_back(std::move(tx));
+            }
         }
         break;
 
@@ -460,29 +486,22 @@ static std::string EntryDescriptionString() {
            "       ... ]\n";
 }
 
-static UniValue::Object entryToJSON(const CTxMemPool &pool, const CTxMemPoolEntry &e)
-    EXCLUSIVE_LOCKS_REQUIRED(pool.cs) {
-    AssertLockHeld(pool.cs);
-
+static UniValue::Object entryToJSON(const MempoolSnapshot::Entry &e) {
     UniValue::Object info;
     info.reserve(5);
 
     UniValue::Object fees;
     fees.reserve(2);
-    fees.emplace_back("base", ValueFromAmount(e.GetFee()));
-    fees.emplace_back("modified", ValueFromAmount(e.GetModifiedFee()));
+    fees.emplace_back("base", ValueFromAmount(e.fee));
+    fees.emplace_back("modified", ValueFromAmount(e.modifiedFee));
 
     info.emplace_back("fees", std::move(fees));
-    info.emplace_back("size", e.GetTxSize());
-    info.emplace_back("time", e.GetTime());
-
-    const CTransaction &tx = e.GetTx();
+    info.emplace_back("size", e.size);
+    info.emplace_back("time", e.time);
 
     std::set<std::string> setDepends;
-    for (const CTxIn &txin : tx.vin) {
-        if (pool.exists(txin.prevout.GetTxId())) {
-            setDepends.insert(txin.prevout.GetTxId().ToString());
-        }
+    for (const TxId &txid : e.depends) {
+        setDepends.insert(txid.ToString());
     }
     UniValue::Array depends;
     depends.reserve(setDepends.size());
@@ -492,11 +511,9 @@ static UniValue::Object entryToJSON(const CTxMemPool &pool, const CTxMemPoolEntr
     info.emplace_back("depends", std::move(depends));
 
     UniValue::Array spent;
-    const CTxMemPool::txiter &it = pool.mapTx.find(tx.GetId());
-    const CTxMemPool::setEntries &setChildren = pool.GetMemPoolChildren(it);
-    spent.reserve(setChildren.size());
-    for (CTxMemPool::txiter childiter : setChildren) {
-        spent.emplace_back(childiter->GetTx().GetId().ToString());
+    spent.reserve(e.spentBy.size());
+    for (const TxId &txid : e.spentBy) {
+        spent.emplace_back(txid.ToString());
     }
     info.emplace_back("spentby", std::move(spent));
 
@@ -504,23 +521,37 @@ static UniValue::Object entryToJSON(const CTxMemPool &pool, const CTxMemPoolEntr
 }
 
 UniValue MempoolToJSON(const CTxMemPool &pool, bool verbose) {
+    // The snapshot is immutable: walk it without holding pool.cs.
+    const MempoolSnapshotRef snapshot = pool.GetSnapshot();
+
     if (verbose) {
+        // The entries are keyed by txid: list them in txid order, which is
+        // stable, rather than in the order of the snapshot.
+        std::vector<const MempoolSnapshot::Entry *> entries;
+        entries.reserve(snapshot->entries.size());
+        for (const MempoolSnapshot::Entry &e : snapshot->entries) {
+            entries.push_back(&e);
+        }
+        std::sort(entries.begin(), entries.end(),
+                  [](const MempoolSnapshot::Entry *a,
+                     const MempoolSnapshot::Entry *b) {
+                      return a->tx->GetId() < b->tx->GetId();
+                  });
+
         UniValue::Object ret;
-        LOCK(pool.cs);
-        ret.reserve(pool.mapTx.size());
-        for (const CTxMemPoolEntry &e : pool.mapTx) {
-            const uint256 &txid = e.GetTx().GetId();
-            ret.emplace_back(txid.ToString(), entryToJSON(pool, e));
+        ret.reserve(entries.size());
+        for (const MempoolSnapshot::Entry *e : entries) {
+            ret.emplace_back(e->tx->GetId().ToString(), entryToJSON(*e));
         }
         return ret;
     }
 
-    std::vector<uint256> vtxids;
-    pool.queryHashes(vtxids);
+    // The txids are listed in the order the transactions entered the
+    // mempool, as the snapshot is.
     UniValue::Array ret;
-    ret.reserve(vtxids.size());
-    for (const uint256 &txid : vtxids) {
-        ret.emplace_back(txid.ToString());
+    ret.reserve(snapshot->entries.size());
+    for (const MempoolSnapshot::Entry &e : snapshot->entries) {
+        ret.emplace_back(e.tx->GetId().ToString());
     }
     return ret;
 }
@@ -537,12 +568,13 @@ static UniValue getrawmempool(const Config &config,
                 }}
                 .ToString() +
             "\nResult: (for verbose = false):\n"
-            "[                     (json array of string)\n"
+            "[                     (json array of string) In the order the transactions entered the mempool,\n"
+            "                      which lists the parents before their children\n"
             "  \"transactionid\"     (string) The transaction id\n"
             "  ,...\n"
             "]\n"
             "\nResult: (for verbose = true):\n"
-            "{                           (json object)\n"
+            "{                           (json object) Sorted by transaction id\n"
             "  \"transactionid\" : {       (json object)\n" +
             EntryDescriptionString() +
             "  }, ...\n"
@@ -619,9 +651,8 @@ static UniValue getmempoolancestors(const Config &config,
     UniValue::Object ret;
     ret.reserve(setAncestors.size());
     for (CTxMemPool::txiter ancestorIt : setAncestors) {
-        const CTxMemPoolEntry &e = *ancestorIt;
-        const TxId &_txid = e.GetTx().GetId();
-        ret.emplace_back(_txid.ToString(), entryToJSON(::g_mempool, e));
+        const TxId &_txid = ancestorIt->GetTx().GetId();
+        ret.emplace_back(_txid.ToString(), entryToJSON(::g_mempool.GetSnapshotEntry(ancestorIt)));
     }
     return ret;
 }
@@ -687,9 +718,8 @@ static UniValue getmempooldescendants(const Config &config,
     UniValue::Object ret;
     ret.reserve(setDescendants.size());
     for (CTxMemPool::txiter descendantIt : setDescendants) {
-        const CTxMemPoolEntry &e = *descendantIt;
-        const TxId &_txid = e.GetTx().GetId();
-        ret.emplace_back(_txid.ToString(), entryToJSON(::g_mempool, e));
+        const TxId &_txid = descendantIt->GetTx().GetId();
+        ret.emplace_back(_txid.ToString(), entryToJSON(::g_mempool.GetSnapshotEntry(descendantIt)));
     }
     return ret;
 }
@@ -723,8 +753,7 @@ static UniValue getmempoolentry(const Config &config,
                            "Transaction not in mempool");
     }
 
-    const CTxMemPoolEntry &e = *it;
-    return entryToJSON(::g_mempool, e);
+    return entryToJSON(::g_mempool.GetSnapshotEntry(it));
 }
 
 static UniValue getblockhash(const Config &config,
@@ -755,6 +784,532 @@ static UniValue getblockhash(const Config &config,
     return pblockindex->GetBlockHash().GetHex();
 }
 
+static UniValue getblockfilter(const Config &,
+                               const JSONRPCRequest &request) {
+    if (request.fHelp || request.params.size() < 1 ||
+        request.params.size() > 2) {
+        throw std::runtime_error(
+            RPCHelpMan{"getblockfilter",
+                "\nRetrieve a BIP 157 content filter for a particular block.\n",
+                {
+                    {"blockhash", RPCArg::Type::STR_HEX, /* opt */ false, /* default_val */ "", "The hash of the block"},
+                    {"filtertype", RPCArg::Type::STR, /* opt */ true, /* default_val */ "basic", "The type name of the filter"},
+                }}
+                .ToString() +
+            "\nResult:\n"
+            "{\n"
+            "  \"filter\" : (string) the hex-encoded filter data\n"
+            "  \"header\" : (string) the hex-encoded filter header\n"
+            "}\n"
+            "\nExamples:\n" +
+            HelpExampleCli("getblockfilter", "\"00000000c937983704a73af28acdec37b049d214adbda81d7e2a3dd146f6ed09\" \"basic\"") +
+            HelpExampleRpc("getblockfilter", "\"00000000c937983704a73af28acdec37b049d214adbda81d7e2a3dd146f6ed09\", \"basic\""));
+    }
+
+    const BlockHash block_hash(ParseHashV(request.params[0], "blockhash"));
+    std::string filtertype_name = "basic";
+    if (!request.params[1].isNull()) {
+        filtertype_name = request.params[1].get_str();
+    }
+
+    BlockFilterType filtertype;
+    if (!BlockFilterTypeByName(filtertype_name, filtertype)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown filtertype");
+    }
+
+    BlockFilterIndex *index = GetBlockFilterIndex(filtertype);
+    if (!index) {
+        throw JSONRPCError(RPC_MISC_ERROR,
+                           "Index is not enabled for filtertype " +
+                               filtertype_name);
+    }
+
+    const CBlockIndex *block_index;
+    bool block_was_connected;
+    {
+        LOCK(cs_main);
+        block_index = LookupBlockIndex(block_hash);
+        if (!block_index) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+        }
+        block_was_connected = block_index->IsValid(BlockValidity::SCRIPTS);
+    }
+
+    const bool index_ready = index->BlockUntilSyncedToCurrentChain();
+
+    BlockFilter filter;
+    uint256 filter_header;
+    if (!index->LookupFilter(block_index, filter) ||
+        !index->LookupFilterHeader(block_index, filter_header)) {
+        RPCErrorCode err_code;
+        std::string errmsg = "Filter not found.";
+
+        if (!block_was_connected) {
+            err_code = RPC_INVALID_ADDRESS_OR_KEY;
+            errmsg += " Block was not connected to active chain.";
+        } else if (!index_ready) {
+            err_code = RPC_MISC_ERROR;
+            errmsg +=
+                " Block filters are still in the process of being indexed.";
+        } else {
+            err_code = RPC_INTERNAL_ERROR;
+            errmsg += " This error is unexpected and indicates index "
+                      "corruption.";
+        }
+
+        throw JSONRPCError(err_code, errmsg);
+    }
+
+    UniValue::Object ret;
+    ret.reserve(2);
+    ret.emplace_back("filter", HexStr(filter.GetEncodedFilter()));
+    ret.emplace_back("header", filter_header.GetHex());
+    return ret;
+}
+
+UniValue::Array
+ScriptHashHistoryToJSON(const std::vector<ScriptHashIndex::HistoryEntry> &history) {
+    UniValue::Array ret;
+    ret.reserve(history.size());
+    for (const ScriptHashIndex::HistoryEntry &entry : history) {
+        UniValue::Array funded;
+        funded.reserve(entry.funded.size());
+        for (const uint32_t n : entry.funded) {
+            funded.emplace_back(n);
+        }
+        UniValue::Array spent;
+        spent.reserve(entry.spent.size());
+        for (const COutPoint &outpoint : entry.spent) {
+            UniValue::Object prevout;
+            prevout.reserve(2);
+            prevout.emplace_back("tx_hash", outpoint.GetTxId().GetHex());
+            prevout.emplace_back("tx_pos", outpoint.GetN());
+            spent.emplace_back(std::move(prevout));
+        }
+        UniValue::Object obj;
+        obj.reserve(4);
+        obj.emplace_back("height", entry.height);
+        obj.emplace_back("tx_hash", entry.txid.GetHex());
+        obj.emplace_back("funded", std::move(funded));
+        obj.emplace_back("spent", std::move(spent));
+        ret.emplace_back(std::move(obj));
+    }
+    return ret;
+}
+
+UniValue::Object
+ScriptHashBalanceToJSON(const std::vector<ScriptHashIndex::Unspent> &unspent) {
+    Amount confirmed = Amount::zero();
+    std::map<token::Id, token::SafeAmount> tokenIdTotals;
+    for (const ScriptHashIndex::Unspent &utxo : unspent) {
+        confirmed += utxo.txout.nValue;
+        if (utxo.txout.tokenDataPtr && utxo.txout.tokenDataPtr->HasAmount()) {
+            auto &amt = tokenIdTotals[utxo.txout.tokenDataPtr->GetId()];
+            // guard against overflow, as in scantxoutset
+            if (const auto optSum = amt.safeAdd(utxo.txout.tokenDataPtr->GetAmount())) {
+                amt = *optSum;
+            }
+        }
+    }
+
+    UniValue::Object ret;
+    ret.reserve(tokenIdTotals.empty() ? 2u : 3u);
+    ret.emplace_back("confirmed", ValueFromAmount(confirmed));
+    ret.emplace_back("utxo_count", unspent.size());
+    if (!tokenIdTotals.empty()) {
+        UniValue::Object tokTotals;
+        tokTotals.reserve(tokenIdTotals.size());
+        for (const auto & [id, amt] : tokenIdTotals) {
+            tokTotals.emplace_back(id.ToString(), SafeAmountToUniv(amt));
+        }
+        ret.emplace_back("token_total_amounts", std::move(tokTotals));
+    }
+    return ret;
+}
+
+UniValue::Array
+ScriptHashUnspentToJSON(const std::vector<ScriptHashIndex::Unspent> &unspent) {
+    UniValue::Array ret;
+    ret.reserve(unspent.size());
+    for (const ScriptHashIndex::Unspent &utxo : unspent) {
+        UniValue::Object obj;
+        obj.reserve(4u + bool(utxo.txout.tokenDataPtr));
+        obj.emplace_back("tx_hash", utxo.outpoint.GetTxId().GetHex());
+        obj.emplace_back("tx_pos", utxo.outpoint.GetN());
+        obj.emplace_back("height", utxo.height);
+        obj.emplace_back("value", ValueFromAmount(utxo.txout.nValue));
+        if (utxo.txout.tokenDataPtr) {
+            obj.emplace_back("tokenData", TokenDataToUniv(*utxo.txout.tokenDataPtr));
+        }
+        ret.emplace_back(std::move(obj));
+    }
+    return ret;
+}
+
+/** Get the script hash index once it is synced with the active chain. */
+static const ScriptHashIndex &GetSyncedScriptHashIndex() {
+    if (!g_scripthashindex) {
+        throw JSONRPCError(RPC_MISC_ERROR,
+                           "Script hash index is not enabled. Use "
+                           "-scripthashindex to enable it.");
+    }
+    if (!g_scripthashindex->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_MISC_ERROR,
+                           "Script hashes are still in the process of being "
+                           "indexed.");
+    }
+    return *g_scripthashindex;
+}
+
+static UniValue getscripthashhistory(const Config &,
+                                     const JSONRPCRequest &request) {
+    if (request.fHelp || request.params.size() < 1 ||
+        request.params.size() > 2) {
+        throw std::runtime_error(
+            RPCHelpMan{"getscripthashhistory",
+                "\nReturns the confirmed transactions funding or spending outputs of an output script, in the order of the chain.\n"
+                "Requires -scripthashindex.\n",
+                {
+                    {"scripthash", RPCArg::Type::STR_HEX, /* opt */ false, /* default_val */ "", "The script hash: the SHA256 of the output script, in the byte order used by Electrum"},
+                    {"from_height", RPCArg::Type::NUM, /* opt */ true, /* default_val */ "0", "Only return the transactions from this height"},
+                }}
+                .ToString() +
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"height\" : n,          (numeric) the height of the block of the transaction\n"
+            "    \"tx_hash\" : \"hex\",    (string) the transaction id\n"
+            "    \"funded\" : [n, ...],   (array) the indexes of the outputs of the transaction paying to the script\n"
+            "    \"spent\" : [          (array) the outputs of the script spent by the transaction\n"
+            "      {\n"
+            "        \"tx_hash\" : \"hex\",  (string) the transaction id of the output\n"
+            "        \"tx_pos\" : n         (numeric) the index of the output\n"
+            "      }, ...\n"
+            "    ]\n"
+            "  }, ...\n"
+            "]\n"
+            "\nExamples:\n" +
+            HelpExampleCli("getscripthashhistory", "\"8b01df4e368ea28f8dc0423bcf7a4923e3a12d307c875e47a0cfbf90b5c39161\"") +
+            HelpExampleRpc("getscripthashhistory", "\"8b01df4e368ea28f8dc0423bcf7a4923e3a12d307c875e47a0cfbf90b5c39161\", 100000"));
+    }
+
+    const uint256 scripthash(ParseHashV(request.params[0], "scripthash"));
+    int from_height = 0;
+    if (!request.params[1].isNull()) {
+        from_height = request.params[1].get_int();
+        if (from_height < 0) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative from_height");
+        }
+    }
+
+    std::vector<ScriptHashIndex::HistoryEntry> history;
+    if (!GetSyncedScriptHashIndex().FindHistory(scripthash, from_height, history)) {
+        throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to read the script hash index");
+    }
+    return ScriptHashHistoryToJSON(history);
+}
+
+static UniValue getscripthashbalance(const Config &,
+                                     const JSONRPCRequest &request) {
+    if (request.fHelp || request.params.size() != 1) {
+        throw std::runtime_error(
+            RPCHelpMan{"getscripthashbalance",
+                "\nReturns the confirmed balance of an output script.\n"
+                "Requires -scripthashindex.\n",
+                {
+                    {"scripthash", RPCArg::Type::STR_HEX, /* opt */ false, /* default_val */ "", "The script hash: the SHA256 of the output script, in the byte order used by Electrum"},
+                }}
+                .ToString() +
+            "\nResult:\n"
+            "{\n"
+            "  \"confirmed\" : x.xxx,         (numeric) the total amount of the unspent outputs of the script, in " + CURRENCY_UNIT + "\n"
+            "  \"utxo_count\" : n,            (numeric) the number of unspent outputs of the script\n"
+            "  \"token_total_amounts\" : {    (json object, optional) the total fungible token amount of the unspent outputs, by token category\n"
+            "    \"category\" : \"amount\", ...\n"
+            "  }\n"
+            "}\n"
+            "\nExamples:\n" +
+            HelpExampleCli("getscripthashbalance", "\"8b01df4e368ea28f8dc0423bcf7a4923e3a12d307c875e47a0cfbf90b5c39161\"") +
+            HelpExampleRpc("getscripthashbalance", "\"8b01df4e368ea28f8dc0423bcf7a4923e3a12d307c875e47a0cfbf90b5c39161\""));
+    }
+
+    const uint256 scripthash(ParseHashV(request.params[0], "scripthash"));
+    std::vector<ScriptHashIndex::Unspent> unspent;
+    if (!GetSyncedScriptHashIndex().FindUnspent(scripthash, unspent)) {
+        throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to read the script hash index");
+    }
+    return ScriptHashBalanceToJSON(unspent);
+}
+
+static UniValue getscripthashutxos(const Config &,
+                                   const JSONRPCRequest &request) {
+    if (request.fHelp || request.params.size() != 1) {
+        throw std::runtime_error(
+            RPCHelpMan{"getscripthashutxos",
+                "\nReturns the confirmed unspent outputs of an output script, in the order of the chain.\n"
+                "Requires -scripthashindex.\n",
+                {
+                    {"scripthash", RPCArg::Type::STR_HEX, /* opt */ false, /* default_val */ "", "The script hash: the SHA256 of the output script, in the byte order used by Electrum"},
+                }}
+                .ToString() +
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"tx_hash\" : \"hex\",  (string) the transaction id of the output\n"
+            "    \"tx_pos\" : n,        (numeric) the index of the output\n"
+            "    \"height\" : n,        (numeric) the height of the block of the output\n"
+            "    \"value\" : x.xxx,     (numeric) the amount of the output, in " + CURRENCY_UNIT + "\n"
+            "    \"tokenData\" : {...}  (json object, optional) the tokens of the output\n"
+            "  }, ...\n"
+            "]\n"
+            "\nExamples:\n" +
+            HelpExampleCli("getscripthashutxos", "\"8b01df4e368ea28f8dc0423bcf7a4923e3a12d307c875e47a0cfbf90b5c39161\"") +
+            HelpExampleRpc("getscripthashutxos", "\"8b01df4e368ea28f8dc0423bcf7a4923e3a12d307c875e47a0cfbf90b5c39161\""));
+    }
+
+    const uint256 scripthash(ParseHashV(request.params[0], "scripthash"));
+    std::vector<ScriptHashIndex::Unspent> unspent;
+    if (!GetSyncedScriptHashIndex().FindUnspent(scripthash, unspent)) {
+        throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to read the script hash index");
+    }
+    return ScriptHashUnspentToJSON(unspent);
+}
+
+bool SpendingInfoToJSON(const SpentIndex &index, const std::vector<COutPoint> &outpoints, bool include_mempool,
+                        UniValue::Array &result) {
+    std::vector<std::optional<SpentIndex::SpentInfo>> infos;
+    if (!index.FindSpentInfo(outpoints, infos)) {
+        return false;
+    }
+
+    if (include_mempool) {
+        LOCK(g_mempool.cs);
+        for (size_t i = 0; i < outpoints.size(); ++i) {
+            if (infos[i]) {
+                continue;
+            }
+            const CTransaction *tx = g_mempool.GetConflictTx(outpoints[i]);
+            if (!tx) {
+                continue;
+            }
+            for (uint32_t n = 0; n < tx->vin.size(); ++n) {
+                if (tx->vin[n].prevout == outpoints[i]) {
+                    infos[i] = SpentIndex::SpentInfo{tx->GetId(), n, -1};
+                    break;
+                }
+            }
+        }
+    }
+
+    result.clear();
+    result.reserve(outpoints.size());
+    for (size_t i = 0; i < outpoints.size(); ++i) {
+        UniValue::Object obj;
+        obj.reserve(infos[i] ? 6 : 3);
+        obj.emplace_back("txid", outpoints[i].GetTxId().GetHex());
+        obj.emplace_back("vout", outpoints[i].GetN());
+        obj.emplace_back("spent", bool(infos[i]));
+        if (infos[i]) {
+            obj.emplace_back("spending_txid", infos[i]->txid.GetHex());
+            obj.emplace_back("input_index", infos[i]->input_index);
+            obj.emplace_back("height", infos[i]->height);
+        }
+        result.emplace_back(std::move(obj));
+    }
+    return true;
+}
+
+static UniValue getspendinginfo(const Config &,
+                                const JSONRPCRequest &request) {
+    if (request.fHelp || request.params.size() < 1 ||
+        request.params.size() > 2) {
+        throw std::runtime_error(
+            RPCHelpMan{"getspendinginfo",
+                "\nReturns the transactions spending the given outpoints.\n"
+                "Requires -spentindex.\n",
+                {
+                    {"outpoints", RPCArg::Type::ARR, /* opt */ false, /* default_val */ "", "The outpoints to look up",
+                        {
+                            {"", RPCArg::Type::OBJ, /* opt */ false, /* default_val */ "", "",
+                                {
+                                    {"txid", RPCArg::Type::STR_HEX, /* opt */ false, /* default_val */ "", "The transaction id"},
+                                    {"vout", RPCArg::Type::NUM, /* opt */ false, /* default_val */ "", "The output number"},
+                                },
+                            },
+                        },
+                    },
+                    {"include_mempool", RPCArg::Type::BOOL, /* opt */ true, /* default_val */ "true", "Whether to also look up the spending transactions in the mempool"},
+                }}
+                .ToString() +
+            "\nResult:\n"
+            "[                         (array) one entry per outpoint, in the order given\n"
+            "  {\n"
+            "    \"txid\" : \"hex\",          (string) the transaction id of the outpoint\n"
+            "    \"vout\" : n,              (numeric) the output number of the outpoint\n"
+            "    \"spent\" : true|false,    (boolean) whether the outpoint is spent\n"
+            "    \"spending_txid\" : \"hex\", (string, optional) the transaction id of the spending transaction\n"
+            "    \"input_index\" : n,       (numeric, optional) the index of the input of the spending transaction\n"
+            "    \"height\" : n             (numeric, optional) the height of the block of the spending transaction, -1 if in the mempool\n"
+            "  }, ...\n"
+            "]\n"
+            "\nExamples:\n" +
+            HelpExampleCli("getspendinginfo", "\"[{\\\"txid\\\":\\\"mytxid\\\",\\\"vout\\\":0}]\"") +
+            HelpExampleRpc("getspendinginfo", "[{\"txid\":\"mytxid\",\"vout\":0}], false"));
+    }
+
+    std::vector<COutPoint> outpoints;
+    const UniValue::Array &outpoints_array = request.params[0].get_array();
+    outpoints.reserve(outpoints_array.size());
+    for (const UniValue &outpoint_value : outpoints_array) {
+        const UniValue::Object &obj = outpoint_value.get_obj();
+        RPCTypeCheckObj(obj, {{"txid", UniValue::VSTR},
+                              {"vout", UniValue::VNUM}});
+        const TxId txid(ParseHashO(obj, "txid"));
+        const int vout = obj["vout"].get_int();
+        if (vout < 0) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "vout must be positive");
+        }
+        outpoints.emplace_back(txid, uint32_t(vout));
+    }
+    const bool include_mempool =
+        request.params[1].isNull() || request.params[1].get_bool();
+
+    if (!g_spentindex) {
+        throw JSONRPCError(RPC_MISC_ERROR,
+                           "Spent index is not enabled. Use -spentindex to "
+                           "enable it.");
+    }
+    if (!g_spentindex->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_MISC_ERROR,
+                           "Spent outpoints are still in the process of being "
+                           "indexed.");
+    }
+
+    UniValue::Array result;
+    if (!SpendingInfoToJSON(*g_spentindex, outpoints, include_mempool, result)) {
+        throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to read the spent index");
+    }
+    return result;
+}
+
+UniValue::Object TokenCategoryStatsToJSON(const token::Id &category,
+                                          const TokenIndex::CategoryStats &stats) {
+    UniValue::Object nfts;
+    nfts.reserve(3);
+    nfts.emplace_back("none", stats.nft_immutable);
+    nfts.emplace_back("mutable", stats.nft_mutable);
+    nfts.emplace_back("minting", stats.nft_minting);
+
+    UniValue::Object ret;
+    ret.reserve(4);
+    ret.emplace_back("category", category.ToString());
+    ret.emplace_back("fungible_amount", stats.fungible_amount);
+    ret.emplace_back("nft_count", std::move(nfts));
+    ret.emplace_back("utxo_count", stats.utxo_count);
+    return ret;
+}
+
+UniValue::Array TokenCategoryUnspentToJSON(const Config &config,
+                                           const std::vector<TokenIndex::Unspent> &unspent) {
+    UniValue::Array ret;
+    ret.reserve(unspent.size());
+    for (const TokenIndex::Unspent &utxo : unspent) {
+        UniValue::Object obj;
+        obj.reserve(6);
+        obj.emplace_back("tx_hash", utxo.outpoint.GetTxId().GetHex());
+        obj.emplace_back("tx_pos", utxo.outpoint.GetN());
+        obj.emplace_back("height", utxo.height);
+        obj.emplace_back("value", ValueFromAmount(utxo.txout.nValue));
+        obj.emplace_back("scriptPubKey", ScriptPubKeyToUniv(config, utxo.txout.scriptPubKey, true));
+        obj.emplace_back("tokenData", TokenDataToUniv(*utxo.txout.tokenDataPtr));
+        ret.emplace_back(std::move(obj));
+    }
+    return ret;
+}
+
+/** Get the token index once it is synced with the active chain. */
+static const TokenIndex &GetSyncedTokenIndex() {
+    if (!g_tokenindex) {
+        throw JSONRPCError(RPC_MISC_ERROR,
+                           "Token index is not enabled. Use -tokenindex to "
+                           "enable it.");
+    }
+    if (!g_tokenindex->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_MISC_ERROR,
+                           "Tokens are still in the process of being indexed.");
+    }
+    return *g_tokenindex;
+}
+
+static UniValue gettokencategoryinfo(const Config &,
+                                     const JSONRPCRequest &request) {
+    if (request.fHelp || request.params.size() != 1) {
+        throw std::runtime_error(
+            RPCHelpMan{"gettokencategoryinfo",
+                "\nReturns the confirmed live supply of a token category.\n"
+                "Requires -tokenindex.\n",
+                {
+                    {"category", RPCArg::Type::STR_HEX, /* opt */ false, /* default_val */ "", "The token id"},
+                }}
+                .ToString() +
+            "\nResult:\n"
+            "{\n"
+            "  \"category\" : \"hex\",      (string) the token id\n"
+            "  \"fungible_amount\" : n,   (numeric) the total fungible amount of the unspent outputs of the category\n"
+            "  \"nft_count\" : {          (json object) the number of unspent NFTs of the category, by capability\n"
+            "    \"none\" : n,\n"
+            "    \"mutable\" : n,\n"
+            "    \"minting\" : n\n"
+            "  },\n"
+            "  \"utxo_count\" : n         (numeric) the number of unspent outputs holding tokens of the category\n"
+            "}\n"
+            "\nExamples:\n" +
+            HelpExampleCli("gettokencategoryinfo", "\"a261967bdc72718f310e61dca71a11affde0c6ad95f98a729ca0bdb7b125cf77\"") +
+            HelpExampleRpc("gettokencategoryinfo", "\"a261967bdc72718f310e61dca71a11affde0c6ad95f98a729ca0bdb7b125cf77\""));
+    }
+
+    const token::Id category(ParseHashV(request.params[0], "category"));
+    TokenIndex::CategoryStats stats;
+    // A category without unspent outputs has no supply.
+    GetSyncedTokenIndex().FindCategoryStats(category, stats);
+    return TokenCategoryStatsToJSON(category, stats);
+}
+
+static UniValue gettokencategoryutxos(const Config &config,
+                                      const JSONRPCRequest &request) {
+    if (request.fHelp || request.params.size() != 1) {
+        throw std::runtime_error(
+            RPCHelpMan{"gettokencategoryutxos",
+                "\nReturns the confirmed unspent outputs holding tokens of a token category, with their holders.\n"
+                "Requires -tokenindex.\n",
+                {
+                    {"category", RPCArg::Type::STR_HEX, /* opt */ false, /* default_val */ "", "The token id"},
+                }}
+                .ToString() +
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"tx_hash\" : \"hex\",       (string) the transaction id of the output\n"
+            "    \"tx_pos\" : n,             (numeric) the index of the output\n"
+            "    \"height\" : n,             (numeric) the height of the block of the output\n"
+            "    \"value\" : x.xxx,          (numeric) the amount of the output, in " + CURRENCY_UNIT + "\n"
+            "    \"scriptPubKey\" : {...},   (json object) the output script, as in gettxout\n"
+            "    \"tokenData\" : {...}       (json object) the tokens of the output\n"
+            "  }, ...\n"
+            "]\n"
+            "\nExamples:\n" +
+            HelpExampleCli("gettokencategoryutxos", "\"a261967bdc72718f310e61dca71a11affde0c6ad95f98a729ca0bdb7b125cf77\"") +
+            HelpExampleRpc("gettokencategoryutxos", "\"a261967bdc72718f310e61dca71a11affde0c6ad95f98a729ca0bdb7b125cf77\""));
+    }
+
+    const token::Id category(ParseHashV(request.params[0], "category"));
+    std::vector<TokenIndex::Unspent> unspent;
+    if (!GetSyncedTokenIndex().FindUnspent(category, unspent)) {
+        throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to read the token index");
+    }
+    return TokenCategoryUnspentToJSON(config, unspent);
+}
+
 static UniValue getblockheader(const Config &config,
                                const JSONRPCRequest &request) {
     if (request.fHelp || request.params.size() < 1 ||
@@ -899,11 +1454,13 @@ static CBlock ReadBlockChecked(const Config &config, const CBlockIndex *pblockin
 }
 
 /// Lock-free -- will throw if block not found or was pruned, etc. Guaranteed to return valid bytes or fail.
-/// Like the above function but does no sanity checking on the block. Just returns the bytes it read from disk.
-static std::vector<uint8_t> ReadRawBlockUnchecked(const Config &config, const CBlockIndex *pblockindex) {
-    std::vector<uint8_t> rawBlock;
+/// Like the above function but does no sanity checking on the block. Just returns the bytes it read from disk,
+/// which are not copied if the block file is memory-mapped, and remain valid as long as `owner` is held on to.
+static Span<const uint8_t> ReadRawBlockUnchecked(const Config &config, const CBlockIndex *pblockindex,
+                                                 std::shared_ptr<const void> &owner) {
+    Span<const uint8_t> rawBlock;
     GenericReadBlockHelper([&]{
-        return ReadRawBlockFromDisk(rawBlock, pblockindex, config.GetChainParams(), SER_NETWORK,
+        return ReadRawBlockFromDisk(rawBlock, owner, pblockindex, config.GetChainParams(), SER_NETWORK,
                                     PROTOCOL_VERSION | RPCSerializationFlags());
     });
     return rawBlock;
@@ -1038,7 +1595,8 @@ static UniValue getblock(const Config &config, const JSONRPCRequest &request) {
     }
 
     if (verbosity <= 0) {
-        const auto rawBlock = ReadRawBlockUnchecked(config, pblockindex);
+        std::shared_ptr<const void> owner;
+        const auto rawBlock = ReadRawBlockUnchecked(config, pblockindex, owner);
         return HexStr(rawBlock);
     }
 
@@ -1198,35 +1756,102 @@ static UniValue pruneblockchain(const Config &config,
 
 static UniValue gettxoutsetinfo(const Config &config,
                                 const JSONRPCRequest &request) {
-    if (request.fHelp || request.params.size() != 0) {
+    if (request.fHelp || request.params.size() > 1) {
         throw std::runtime_error(
             RPCHelpMan{"gettxoutsetinfo",
                 "\nReturns statistics about the unspent transaction output set.\n"
-                "Note this call may take some time.\n",
-                {}}
+                "Note this call may take some time, unless hash_type is \"ecmultiset\" and the\n"
+                "statistics are maintained with -utxostats.\n",
+                {
+                    {"hash_type", RPCArg::Type::STR, /* opt */ true, /* default_val */ "hash_serialized", "Which UTXO set hash to calculate. Options: \"hash_serialized\" (the legacy hash, along with the number of transactions), \"ecmultiset\" (the ECMultiSet hash, along with the token amounts)."},
+                }}
                 .ToString() +
             "\nResult:\n"
             "{\n"
             "  \"height\":n,     (numeric) The current block height (index)\n"
             "  \"bestblock\": \"hex\",   (string) the best block hash hex\n"
-            "  \"transactions\": n,      (numeric) The number of transactions\n"
+            "  \"transactions\": n,      (numeric) The number of transactions "
+            "(hash_serialized only)\n"
             "  \"txouts\": n,            (numeric) The number of output "
             "transactions\n"
             "  \"bogosize\": n,          (numeric) A database-independent "
             "metric for UTXO set size\n"
-            "  \"hash_serialized\": \"hash\",   (string) The serialized hash\n"
+            "  \"hash_serialized\": \"hash\",   (string) The serialized hash "
+            "(hash_serialized only)\n"
+            "  \"utxo_commitment\": \"hash\",   (string) The ECMultiSet hash "
+            "of the coins, as in dumputxoset (ecmultiset only)\n"
             "  \"disk_size\": n,         (numeric) The estimated size of the "
             "chainstate on disk\n"
             "  \"total_amount\": x.xxx          (numeric) The total amount\n"
+            "  \"token_amounts\": {       (json object) The fungible token "
+            "amount of every token category (ecmultiset only)\n"
+            "    \"category\": \"xxx\",   (string) The amount (is a string to "
+            "support >53-bit amounts)\n"
+            "    ...\n"
+            "  }\n"
             "}\n"
             "\nExamples:\n" +
             HelpExampleCli("gettxoutsetinfo", "") +
-            HelpExampleRpc("gettxoutsetinfo", ""));
+            HelpExampleCli("gettxoutsetinfo", "\"ecmultiset\"") +
+            HelpExampleRpc("gettxoutsetinfo", "\"ecmultiset\""));
+    }
+
+    std::string hash_type = "hash_serialized";
+    if (!request.params[0].isNull()) {
+        hash_type = request.params[0].get_str();
+    }
+    if (hash_type != "hash_serialized" && hash_type != "ecmultiset") {
+        throw JSONRPCError(RPC_INVALID_PARAMETER,
+                           "Unknown hash_type " + hash_type);
+    }
+
+    NodeContext& node = EnsureAnyNodeContext(request.context);
+    if (hash_type == "ecmultiset") {
+        int height;
+        BlockHash hashBlock;
+        CUTXOStats stats;
+        std::unique_ptr<CCoinsViewCursor> pcursor;
+        {
+            LOCK(cs_main);
+            if (g_utxo_stats) {
+                stats = *g_utxo_stats;
+                hashBlock = pcoinsTip->GetBestBlock();
+            } else {
+                // Without -utxostats, scan the coins database, from a
+                // snapshot of it taken at the flushed tip so that cs_main
+                // is not held during the scan.
+                FlushStateToDisk();
+                pcursor.reset(pcoinsdbview->Cursor());
+                hashBlock = pcursor->GetBestBlock();
+            }
+            const CBlockIndex *pindex = LookupBlockIndex(hashBlock);
+            height = pindex ? pindex->nHeight : -1;
+        }
+        if (pcursor &&
+            !ComputeUTXOStats(*pcursor, stats, node.rpc_interruption_point)) {
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read UTXO set");
+        }
+
+        UniValue::Object tokenAmounts;
+        tokenAmounts.reserve(stats.tokenAmounts.size());
+        for (const auto &[id, amount] : stats.tokenAmounts) {
+            tokenAmounts.emplace_back(id.GetHex(), strprintf("%d", amount));
+        }
+        UniValue::Object ret;
+        ret.reserve(8);
+        ret.emplace_back("height", height);
+        ret.emplace_back("bestblock", hashBlock.GetHex());
+        ret.emplace_back("txouts", stats.nTransactionOutputs);
+        ret.emplace_back("bogosize", stats.nBogoSize);
+        ret.emplace_back("utxo_commitment", stats.commitment.GetHash().GetHex());
+        ret.emplace_back("disk_size", pcoinsdbview->EstimateSize());
+        ret.emplace_back("total_amount", ValueFromAmount(stats.nTotalAmount));
+        ret.emplace_back("token_amounts", std::move(tokenAmounts));
+        return ret;
     }
 
     CCoinsStats stats;
     FlushStateToDisk();
-    NodeContext& node = EnsureAnyNodeContext(request.context);
     if (!GetUTXOStats(pcoinsdbview.get(), stats, node.rpc_interruption_point)) {
         throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read UTXO set");
     }
@@ -1244,6 +1869,68 @@ static UniValue gettxoutsetinfo(const Config &config,
     return ret;
 }
 
+static UniValue dumputxoset(const Config &config,
+                            const JSONRPCRequest &request) {
+    if (request.fHelp || request.params.size() != 1) {
+        throw std::runtime_error(
+            RPCHelpMan{"dumputxoset",
+                "\nWrites the unspent transaction output set to a snapshot file, from which\n"
+                "a pruning node may be bootstrapped with -loadutxoset.\n"
+                "Note this call may take some time.\n",
+                {
+                    {"path", RPCArg::Type::STR, /* opt */ false, /* default_val */ "", "The snapshot file to write. Relative paths are prefixed by the datadir."},
+                }}
+                .ToString() +
+            "\nResult:\n"
+            "{\n"
+            "  \"path\": \"path\",           (string) the absolute path of the snapshot file\n"
+            "  \"base_hash\": \"hex\",       (string) the hash of the block the snapshot is taken at\n"
+            "  \"base_height\": n,         (numeric) the height of that block\n"
+            "  \"coins_written\": n,       (numeric) the number of coins in the snapshot\n"
+            "  \"utxo_commitment\": \"hash\", (string) the ECMultiSet hash of the coins, to be\n"
+            "                              checked with -loadutxosethash\n"
+            "}\n"
+            "\nExamples:\n" +
+            HelpExampleCli("dumputxoset", "\"utxo.dat\"") +
+            HelpExampleRpc("dumputxoset", "\"utxo.dat\""));
+    }
+
+    const fs::path path =
+        fs::absolute(request.params[0].get_str(), GetDataDir());
+    if (fs::exists(path)) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER,
+                           path.string() + " already exists");
+    }
+
+    NodeContext& node = EnsureAnyNodeContext(request.context);
+    UTXOSnapshotSource source;
+    std::string error;
+    {
+        // No block may be connected between the flush and the capture, so
+        // that the snapshot is of the flushed tip. The coins are then read
+        // from a database snapshot, without holding cs_main.
+        LOCK(cs_main);
+        FlushStateToDisk();
+        if (!OpenUTXOSnapshotSource(config, *pcoinsdbview, source, error)) {
+            throw JSONRPCError(RPC_MISC_ERROR, error);
+        }
+    }
+    SnapshotMetadata metadata;
+    if (!WriteUTXOSnapshot(source, path, metadata, node.rpc_interruption_point,
+                           error)) {
+        throw JSONRPCError(RPC_MISC_ERROR, error);
+    }
+
+    UniValue::Object ret;
+    ret.reserve(5);
+    ret.emplace_back("path", path.string());
+    ret.emplace_back("base_hash", metadata.base_hash.GetHex());
+    ret.emplace_back("base_height", metadata.base_height);
+    ret.emplace_back("coins_written", metadata.coins_count);
+    ret.emplace_back("utxo_commitment", metadata.commitment.GetHash().GetHex());
+    return ret;
+}
+
 UniValue gettxout(const Config &config, const JSONRPCRequest &request) {
     if (request.fHelp || request.params.size() < 2 ||
         request.params.size() > 3) {
@@ -1589,10 +2276,11 @@ static UniValue getchaintips(const Config &config,
 UniValue::Object MempoolInfoToJSON(const Config &config, const CTxMemPool &pool) {
     UniValue::Object ret;
     ret.reserve(7);
-    ret.emplace_back("loaded", pool.IsLoaded());
-    ret.emplace_back("size", pool.size());
-    ret.emplace_back("bytes", pool.GetTotalTxSize());
-    ret.emplace_back("usage", pool.DynamicMemoryUsage());
+    const MempoolSnapshotRef snapshot = pool.GetSnapshot();
+    ret.emplace_back("loaded", snapshot->loaded);
+    ret.emplace_back("size", snapshot->entries.size());
+    ret.emplace_back("bytes", snapshot->totalTxSize);
+    ret.emplace_back("usage", snapshot->usage);
     auto maxmempool = config.GetMaxMemPoolSize();
     ret.emplace_back("maxmempool", maxmempool);
     ret.emplace_back("mempoolminfee", ValueFromAmount(std::max(pool.GetMinFee(maxmempool), ::minRelayTxFee).GetFeePerK()));
@@ -2694,27 +3382,35 @@ static UniValue scantxoutset(const Config &config,
 
 // clang-format off
 static const ContextFreeRPCCommand commands[] = {
-    //  category            name                      actor (function)        argNames
+    //  category            name                      actor (function)        argNames  readOnly
     //  ------------------- ------------------------  ----------------------  ----------
+    { "blockchain",         "dumputxoset",            dumputxoset,            {"path"} },
     { "blockchain",         "finalizeblock",          finalizeblock,          {"blockhash"} },
-    { "blockchain",         "getbestblockhash",       getbestblockhash,       {} },
-    { "blockchain",         "getblock",               getblock,               {"blockhash","verbosity|verbose"} },
-    { "blockchain",         "getblockchaininfo",      getblockchaininfo,      {} },
-    { "blockchain",         "getblockcount",          getblockcount,          {} },
-    { "blockchain",         "getblockhash",           getblockhash,           {"height"} },
-    { "blockchain",         "getblockheader",         getblockheader,         {"blockhash|hash_or_height","verbose"} },
-    { "blockchain",         "getblockstats",          getblockstats,          {"hash_or_height","stats"} },
-    { "blockchain",         "getchaintips",           getchaintips,           {} },
-    { "blockchain",         "getchaintxstats",        getchaintxstats,        {"nblocks", "blockhash"} },
-    { "blockchain",         "getdifficulty",          getdifficulty,          {} },
-    { "blockchain",         "getfinalizedblockhash",  getfinalizedblockhash,  {} },
-    { "blockchain",         "getmempoolancestors",    getmempoolancestors,    {"txid","verbose"} },
-    { "blockchain",         "getmempooldescendants",  getmempooldescendants,  {"txid","verbose"} },
-    { "blockchain",         "getmempoolentry",        getmempoolentry,        {"txid"} },
-    { "blockchain",         "getmempoolinfo",         getmempoolinfo,         {} },
-    { "blockchain",         "getrawmempool",          getrawmempool,          {"verbose"} },
-    { "blockchain",         "gettxout",               gettxout,               {"txid","n","include_mempool"} },
-    { "blockchain",         "gettxoutsetinfo",        gettxoutsetinfo,        {} },
+    { "blockchain",         "getbestblockhash",       getbestblockhash,       {}, true },
+    { "blockchain",         "getblock",               getblock,               {"blockhash","verbosity|verbose"}, true },
+    { "blockchain",         "getblockchaininfo",      getblockchaininfo,      {}, true },
+    { "blockchain",         "getblockcount",          getblockcount,          {}, true },
+    { "blockchain",         "getblockhash",           getblockhash,           {"height"}, true },
+    { "blockchain",         "getblockfilter",         getblockfilter,         {"blockhash","filtertype"}, true },
+    { "blockchain",         "getblockheader",         getblockheader,         {"blockhash|hash_or_height","verbose"}, true },
+    { "blockchain",         "getblockstats",          getblockstats,          {"hash_or_height","stats"}, true },
+    { "blockchain",         "getchaintips",           getchaintips,           {}, true },
+    { "blockchain",         "getchaintxstats",        getchaintxstats,        {"nblocks", "blockhash"}, true },
+    { "blockchain",         "getdifficulty",          getdifficulty,          {}, true },
+    { "blockchain",         "getfinalizedblockhash",  getfinalizedblockhash,  {}, true },
+    { "blockchain",         "getmempoolancestors",    getmempoolancestors,    {"txid","verbose"}, true },
+    { "blockchain",         "getmempooldescendants",  getmempooldescendants,  {"txid","verbose"}, true },
+    { "blockchain",         "getmempoolentry",        getmempoolentry,        {"txid"}, true },
+    { "blockchain",         "getmempoolinfo",         getmempoolinfo,         {}, true },
+    { "blockchain",         "getrawmempool",          getrawmempool,          {"verbose"}, true },
+    { "blockchain",         "getscripthashbalance",   getscripthashbalance,   {"scripthash"}, true },
+    { "blockchain",         "getscripthashhistory",   getscripthashhistory,   {"scripthash","from_height"}, true },
+    { "blockchain",         "getscripthashutxos",     getscripthashutxos,     {"scripthash"}, true },
+    { "blockchain",         "getspendinginfo",        getspendinginfo,        {"outpoints","include_mempool"}, true },
+    { "blockchain",         "gettokencategoryinfo",   gettokencategoryinfo,   {"category"}, true },
+    { "blockchain",         "gettokencategoryutxos",  gettokencategoryutxos,  {"category"}, true },
+    { "blockchain",         "gettxout",               gettxout,               {"txid","n","include_mempool"}, true },
+    { "blockchain",         "gettxoutsetinfo",        gettxoutsetinfo,        {"hash_type"} },
     { "blockchain",         "invalidateblock",        invalidateblock,        {"blockhash"} },
     { "blockchain",         "parkblock",              parkblock,              {"blockhash"} },
     { "blockchain",         "preciousblock",          preciousblock,          {"blockhash"} },
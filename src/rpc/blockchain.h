@@ -6,6 +6,9 @@
 
 #include <amount.h>
 #include <core_io.h>
+#include <index/scripthashindex.h>
+#include <index/spentindex.h>
+#include <index/tokenindex.h>
 #include <sync.h>
 #include <univalue.h>
 
@@ -48,5 +51,28 @@ UniValue MempoolToJSON(const CTxMemPool &pool, bool verbose = false);
 /** Block header to JSON */
 UniValue::Object blockheaderToJSON(const CBlockIndex *tip, const CBlockIndex *blockindex);
 
+/** Script hash history to JSON */
+UniValue::Array ScriptHashHistoryToJSON(const std::vector<ScriptHashIndex::HistoryEntry> &history);
+
+/** Script hash balance to JSON, from its unspent outputs */
+UniValue::Object ScriptHashBalanceToJSON(const std::vector<ScriptHashIndex::Unspent> &unspent);
+
+/** Script hash unspent outputs to JSON */
+UniValue::Array ScriptHashUnspentToJSON(const std::vector<ScriptHashIndex::Unspent> &unspent);
+
+/**
+ * Spending transactions of outpoints to JSON, looked up in the spent index
+ * and, if include_mempool, in the mempool. Returns false if the index cannot be
+ * read.
+ */
+bool SpendingInfoToJSON(const SpentIndex &index, const std::vector<COutPoint> &outpoints, bool include_mempool,
+                        UniValue::Array &result) LOCKS_EXCLUDED(cs_main);
+
+/** Token category supply to JSON */
+UniValue::Object TokenCategoryStatsToJSON(const token::Id &category, const TokenIndex::CategoryStats &stats);
+
+/** Token category unspent outputs to JSON */
+UniValue::Array TokenCategoryUnspentToJSON(const Config &config, const std::vector<TokenIndex::Unspent> &unspent);
+
 /** Used by getblockstats to get feerates at different percentiles by weight  */
 void CalculatePercentilesBySize(Amount result[NUM_GETBLOCKSTATS_PERCENTILES], std::vector<std::pair<Amount, int64_t>>& scores, int64_t total_size);
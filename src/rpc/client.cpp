@@ -52,6 +52,9 @@ static const CRPCConvertParam vRPCConvertParams[] = {
     {"getbalance", 1, "minconf"},
     {"getbalance", 2, "include_watchonly"},
     {"getblockhash", 0, "height"},
+    {"getscripthashhistory", 1, "from_height"},
+    {"getspendinginfo", 0, "outpoints"},
+    {"getspendinginfo", 1, "include_mempool"},
     {"waitforblockheight", 0, "height"},
     {"waitforblockheight", 1, "timeout"},
     {"waitforblock", 1, "timeout"},
@@ -42,6 +42,12 @@ public:
     virtual UniValue Execute(const JSONRPCRequest &request) const = 0;
 
     const std::string &GetName() const { return name; };
+
+    /**
+     * Whether the command only reads the node's state, so that it may run
+     * concurrently with the other read-only commands of a JSON-RPC batch.
+     */
+    virtual bool IsReadOnly() const { return false; }
 };
 
 /**
@@ -519,7 +519,7 @@ static UniValue getblocktemplatecommon(bool fLight, const Config &config, const
     bool fNewTip = (pindexPrev && pindexPrev != ::ChainActive().Tip());
     if (pindexPrev != ::ChainActive().Tip() || fIgnoreCache || ignoreCacheOverride ||
         (g_mempool.GetTransactionsUpdated() != nTransactionsUpdatedLast &&
-         GetTime() - nStart > 5)) {
+         (g_incremental_block_assembler || GetTime() - nStart > 5))) {
         // Clear pindexPrev so future calls make a new block, despite any
         // failures from here on
         pindexPrev = nullptr;
@@ -547,7 +547,9 @@ static UniValue getblocktemplatecommon(bool fLight, const Config &config, const
         // Create new block
         CScript scriptDummy = CScript() << OP_TRUE;
         pblocktemplate =
-            BlockAssembler(config, g_mempool).CreateNewBlock(scriptDummy, timeLimitSecs, checkValidity);
+            g_incremental_block_assembler
+                ? g_incremental_block_assembler->CreateNewBlock(scriptDummy, timeLimitSecs, checkValidity)
+                : BlockAssembler(config, g_mempool).CreateNewBlock(scriptDummy, timeLimitSecs, checkValidity);
         plightresult.reset();
         if (!pblocktemplate) {
             throw JSONRPCError(RPC_OUT_OF_MEMORY, "Out of memory");
@@ -537,18 +537,18 @@ static UniValue getinfo_deprecated(const Config &config,
 
 // clang-format off
 static const ContextFreeRPCCommand commands[] = {
-    //  category            name                      actor (function)        argNames
+    //  category            name                      actor (function)        argNames  readOnly
     //  ------------------- ------------------------  ----------------------  ----------
     { "control",            "getmemoryinfo",          getmemoryinfo,          {"mode"} },
     { "control",            "logging",                logging,                {"include", "exclude"} },
-    { "util",               "validateaddress",        validateaddress,        {"address"} },
+    { "util",               "validateaddress",        validateaddress,        {"address"}, true },
     { "util",               "createmultisig",         createmultisig,         {"nrequired","keys"} },
-    { "util",               "verifymessage",          verifymessage,          {"address","signature","message"} },
+    { "util",               "verifymessage",          verifymessage,          {"address","signature","message"}, true },
     { "util",               "signmessagewithprivkey", signmessagewithprivkey, {"privkey","message"} },
     /* Not shown in help */
     { "hidden",             "setmocktime",            setmocktime,            {"timestamp"}},
-    { "hidden",             "echo",                   echo,                   {"arg0","arg1","arg2","arg3","arg4","arg5","arg6","arg7","arg8","arg9"}},
-    { "hidden",             "echojson",               echo,                   {"arg0","arg1","arg2","arg3","arg4","arg5","arg6","arg7","arg8","arg9"}},
+    { "hidden",             "echo",                   echo,                   {"arg0","arg1","arg2","arg3","arg4","arg5","arg6","arg7","arg8","arg9"}, true },
+    { "hidden",             "echojson",               echo,                   {"arg0","arg1","arg2","arg3","arg4","arg5","arg6","arg7","arg8","arg9"}, true },
     { "hidden",             "getinfo",                getinfo_deprecated,     {}},
 };
 // clang-format on
@@ -890,18 +890,18 @@ static UniValue addpeeraddress(const Config &config, const JSONRPCRequest &reque
 
 // clang-format off
 static const ContextFreeRPCCommand commands[] = {
-    //  category            name                      actor (function)        argNames
+    //  category            name                      actor (function)        argNames  readOnly
     //  ------------------- ------------------------  ----------------------  ----------
-    { "network",            "getconnectioncount",     getconnectioncount,     {} },
+    { "network",            "getconnectioncount",     getconnectioncount,     {}, true },
     { "network",            "ping",                   ping,                   {} },
-    { "network",            "getpeerinfo",            getpeerinfo,            {} },
+    { "network",            "getpeerinfo",            getpeerinfo,            {}, true },
     { "network",            "addnode",                addnode,                {"node","command"} },
     { "network",            "disconnectnode",         disconnectnode,         {"address", "nodeid"} },
-    { "network",            "getaddednodeinfo",       getaddednodeinfo,       {"node"} },
-    { "network",            "getnettotals",           getnettotals,           {} },
-    { "network",            "getnetworkinfo",         getnetworkinfo,         {} },
+    { "network",            "getaddednodeinfo",       getaddednodeinfo,       {"node"}, true },
+    { "network",            "getnettotals",           getnettotals,           {}, true },
+    { "network",            "getnetworkinfo",         getnetworkinfo,         {}, true },
     { "network",            "setban",                 setban,                 {"subnet", "command", "bantime", "absolute"} },
-    { "network",            "listbanned",             listbanned,             {} },
+    { "network",            "listbanned",             listbanned,             {}, true },
     { "network",            "clearbanned",            clearbanned,            {"manual", "automatic"} },
     { "network",            "setnetworkactive",       setnetworkactive,       {"state"} },
     { "network",            "getnodeaddresses",       getnodeaddresses,       {"count"} },
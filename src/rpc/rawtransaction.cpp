@@ -2038,24 +2038,24 @@ static UniValue converttopsbt(const Config &,
 
 // clang-format off
 static const ContextFreeRPCCommand commands[] = {
-    //  category            name                         actor (function)           argNames
+    //  category            name                         actor (function)           argNames  readOnly
     //  ------------------- ------------------------     ----------------------     ----------
-    { "rawtransactions",    "getrawtransaction",         getrawtransaction,         {"txid","verbose","blockhash"} },
+    { "rawtransactions",    "getrawtransaction",         getrawtransaction,         {"txid","verbose","blockhash"}, true },
     { "rawtransactions",    "createrawtransaction",      createrawtransaction,      {"inputs","outputs","locktime"} },
-    { "rawtransactions",    "decoderawtransaction",      decoderawtransaction,      {"hexstring"} },
-    { "rawtransactions",    "decodescript",              decodescript,              {"hexstring"} },
+    { "rawtransactions",    "decoderawtransaction",      decoderawtransaction,      {"hexstring"}, true },
+    { "rawtransactions",    "decodescript",              decodescript,              {"hexstring"}, true },
     { "rawtransactions",    "sendrawtransaction",        sendrawtransaction,        {"hexstring","allowhighfees"} },
     { "rawtransactions",    "combinerawtransaction",     combinerawtransaction,     {"txs"} },
     { "rawtransactions",    "signrawtransactionwithkey", signrawtransactionwithkey, {"hexstring","privkeys","prevtxs","sighashtype"} },
     { "rawtransactions",    "testmempoolaccept",         testmempoolaccept,         {"rawtxs","allowhighfees"} },
-    { "rawtransactions",    "decodepsbt",                decodepsbt,                {"psbt"} },
+    { "rawtransactions",    "decodepsbt",                decodepsbt,                {"psbt"}, true },
     { "rawtransactions",    "combinepsbt",               combinepsbt,               {"txs"} },
     { "rawtransactions",    "finalizepsbt",              finalizepsbt,              {"psbt", "extract"} },
     { "rawtransactions",    "createpsbt",                createpsbt,                {"inputs","outputs","locktime"} },
     { "rawtransactions",    "converttopsbt",             converttopsbt,             {"hexstring","permitsigdata"} },
 
-    { "blockchain",         "gettxoutproof",             gettxoutproof,             {"txids", "blockhash"} },
-    { "blockchain",         "verifytxoutproof",          verifytxoutproof,          {"proof"} },
+    { "blockchain",         "gettxoutproof",             gettxoutproof,             {"txids", "blockhash"}, true },
+    { "blockchain",         "verifytxoutproof",          verifytxoutproof,          {"proof"}, true },
 };
 // clang-format on
 
@@ -23,9 +23,11 @@
 
 #include <boost/signals2/signal.hpp>
 
+#include <algorithm>
 #include <memory> // for unique_ptr
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 static RecursiveMutex cs_rpcWarmup;
 static std::atomic<bool> g_rpc_running{false};
@@ -101,6 +103,19 @@ UniValue RPCServer::ExecuteCommand(Config &config,
     return tableRPC.execute(config, request);
 }
 
+bool RPCServer::IsReadOnlyCommand(const std::string &commandName) const {
+    {
+        auto commandsReadView = commands.getReadView();
+        auto iter = commandsReadView->find(commandName);
+        if (iter != commandsReadView.end()) {
+            return iter->second->IsReadOnly();
+        }
+    }
+
+    const ContextFreeRPCCommand *pcmd = tableRPC[commandName];
+    return pcmd && pcmd->readOnly;
+}
+
 void RPCServer::RegisterCommand(std::unique_ptr<RPCCommand> command) {
     if (command != nullptr) {
         const std::string &commandName = command->GetName();
@@ -441,6 +456,7 @@ bool CRPCTable::appendCommand(const std::string &name,
 void StartRPC() {
     LogPrint(BCLog::RPC, "Starting RPC\n");
     g_rpc_running = true;
+    g_rpc_worker_pool.Start(std::max<int>(gArgs.GetArg("-rpcworkerthreads", DEFAULT_RPC_WORKER_THREADS), 0));
     g_rpcSignals.Started();
 }
 
@@ -453,6 +469,7 @@ void InterruptRPC() {
 void StopRPC() {
     LogPrint(BCLog::RPC, "Stopping RPC\n");
     WITH_LOCK(g_deadline_timers_mutex, deadlineTimers.clear());
+    g_rpc_worker_pool.Stop();
     DeleteAuthCookie();
     g_rpcSignals.Stopped();
 }
@@ -506,11 +523,48 @@ static UniValue::Object JSONRPCExecOne(Config &config, RPCServer &rpcServer, JSO
     }
 }
 
+/** Whether the batch element req may run concurrently with the other such elements of its batch. */
+static bool IsReadOnlyRequest(const RPCServer &rpcServer, const UniValue &req) {
+    if (!req.isObject()) {
+        // Fails to parse: nothing is executed.
+        return true;
+    }
+    const UniValue *method = req.get_obj().locate("method");
+    return !method || !method->isStr() || rpcServer.IsReadOnlyCommand(method->get_str());
+}
+
 std::string JSONRPCExecBatch(Config &config, RPCServer &rpcServer, const JSONRPCRequest &jreq, UniValue::Array &&vReq) {
     UniValue::Array ret;
     ret.reserve(vReq.size());
-    for (UniValue& req: vReq) {
-        ret.emplace_back(JSONRPCExecOne(config, rpcServer, jreq, std::move(req)));
+    const int64_t max_workers = gArgs.GetArg("-rpcbatchworkers", DEFAULT_RPC_BATCH_WORKERS);
+    if (max_workers <= 0 || vReq.size() < 2) {
+        for (UniValue& req: vReq) {
+            ret.emplace_back(JSONRPCExecOne(config, rpcServer, jreq, std::move(req)));
+        }
+    } else {
+        // A command may see the effects of the commands requested before it:
+        // only the read-only ones are independent. Share each run of them with
+        // the RPC workers, and execute the others one at a time, in the order
+        // they were requested. The replies are in the order of the requests.
+        std::vector<UniValue::Object> replies(vReq.size());
+        for (size_t begin = 0; begin < vReq.size();) {
+            size_t end = begin;
+            while (end < vReq.size() && IsReadOnlyRequest(rpcServer, vReq.at(end))) {
+                ++end;
+            }
+            if (end - begin >= 2) {
+                g_rpc_worker_pool.ForEach(end - begin, [&](size_t i) {
+                    replies[begin + i] = JSONRPCExecOne(config, rpcServer, jreq, std::move(vReq.at(begin + i)));
+                }, max_workers);
+                begin = end;
+            } else {
+                replies[begin] = JSONRPCExecOne(config, rpcServer, jreq, std::move(vReq.at(begin)));
+                ++begin;
+            }
+        }
+        for (UniValue::Object &reply : replies) {
+            ret.emplace_back(std::move(reply));
+        }
     }
 
     return UniValue::stringify(ret) + '\n';
@@ -659,3 +713,4 @@ int RPCSerializationFlags() {
 }
 
 CRPCTable tableRPC;
+ThreadPool g_rpc_worker_pool("rpcworker");
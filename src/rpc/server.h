@@ -14,6 +14,7 @@
 #include <uint256.h>
 #include <util/noncopyable.h>
 #include <util/system.h>
+#include <util/threadpool.h>
 
 #include <cstdint>
 #include <functional>
@@ -24,6 +25,10 @@
 #include <univalue.h>
 
 static const unsigned int DEFAULT_RPC_SERIALIZE_VERSION = 1;
+/** Default for -rpcworkerthreads */
+static const int DEFAULT_RPC_WORKER_THREADS = 4;
+/** Default for -rpcbatchworkers */
+static const int DEFAULT_RPC_BATCH_WORKERS = 0;
 
 class ContextFreeRPCCommand;
 
@@ -57,6 +62,12 @@ public:
      * Register an RPC command.
      */
     void RegisterCommand(std::unique_ptr<RPCCommand> command);
+
+    /**
+     * Whether the command named commandName is registered and read-only (see
+     * RPCCommand::IsReadOnly() and ContextFreeRPCCommand::readOnly).
+     */
+    bool IsReadOnlyCommand(const std::string &commandName) const;
 };
 
 /**
@@ -183,11 +194,18 @@ private:
 
 public:
     std::vector<std::string> argNames;
+    /**
+     * Whether the command only reads the node's state, so that it may run
+     * concurrently with the other read-only commands of a JSON-RPC batch.
+     */
+    bool readOnly;
 
     ContextFreeRPCCommand(std::string _category, std::string _name,
-                          rpcfn_type _actor, std::vector<std::string> _argNames)
+                          rpcfn_type _actor, std::vector<std::string> _argNames,
+                          bool _readOnly = false)
         : category{std::move(_category)}, name{std::move(_name)},
-          useConstConfig{false}, argNames{std::move(_argNames)} {
+          useConstConfig{false}, argNames{std::move(_argNames)},
+          readOnly{_readOnly} {
         actor.fn = _actor;
     }
 
@@ -198,9 +216,11 @@ public:
      */
     ContextFreeRPCCommand(std::string _category, std::string _name,
                           const_rpcfn_type _actor,
-                          std::vector<std::string> _argNames)
+                          std::vector<std::string> _argNames,
+                          bool _readOnly = false)
         : category{std::move(_category)}, name{std::move(_name)},
-          useConstConfig{true}, argNames{std::move(_argNames)} {
+          useConstConfig{true}, argNames{std::move(_argNames)},
+          readOnly{_readOnly} {
         actor.cfn = _actor;
     }
 
@@ -260,6 +280,12 @@ bool IsDeprecatedRPCEnabled(const ArgsManager &args, const std::string &method);
 
 extern CRPCTable tableRPC;
 
+/**
+ * Threads that RPC calls may share work with, such as the conversion of large
+ * blocks to JSON. Started with -rpcworkerthreads threads by StartRPC().
+ */
+extern ThreadPool g_rpc_worker_pool;
+
 /**
  * Utilities: convert hex-encoded values (throws error if not hex).
  */
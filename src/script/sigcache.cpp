@@ -13,6 +13,7 @@
 #include <uint256.h>
 #include <util/system.h>
 
+#include <algorithm>
 #include <mutex>
 #include <shared_mutex>
 
@@ -125,3 +126,62 @@ bool CachingTransactionSignatureChecker::VerifySignature(
                                                             sighash);
     });
 }
+
+bool BatchingTransactionSignatureChecker::VerifySignature(
+    const std::vector<uint8_t> &vchSig, const CPubKey &pubkey,
+    const uint256 &sighash) const {
+    if (vchSig.size() != 64 || !pubkey.IsValid()) {
+        return CachingTransactionSignatureChecker::VerifySignature(
+            vchSig, pubkey, sighash);
+    }
+    uint256 entry;
+    signatureCache.ComputeEntry(entry, sighash, vchSig, pubkey);
+    if (signatureCache.Get(entry, !store)) {
+        return true;
+    }
+    batch.Add(vchSig, pubkey, sighash, entry, store, tag);
+    return true;
+}
+
+void SchnorrSigBatch::Add(const std::vector<uint8_t> &vchSig,
+                          const CPubKey &pubkey, const uint256 &sighash,
+                          const uint256 &cacheEntry, bool store, size_t tag) {
+    assert(vchSig.size() == 64);
+    SchnorrSigCheck &check = checks.emplace_back();
+    check.pubkey = pubkey;
+    check.hash = sighash;
+    std::copy(vchSig.begin(), vchSig.end(), check.sig.begin());
+    origins.push_back({cacheEntry, store, tag});
+}
+
+bool SchnorrSigBatch::Verify() const {
+    bool fOk;
+    if (checks.size() < 2) {
+        // Nothing to gain from batching.
+        fOk = std::all_of(checks.begin(), checks.end(), [](const SchnorrSigCheck &check) {
+            return check.pubkey.VerifySchnorr(check.hash, {check.sig.begin(), check.sig.end()});
+        });
+    } else {
+        fOk = CPubKey::VerifySchnorrBatch(checks);
+    }
+    if (!fOk) {
+        return false;
+    }
+    for (const Origin &origin : origins) {
+        if (origin.store) {
+            uint256 entry = origin.cacheEntry;
+            signatureCache.Set(entry);
+        }
+    }
+    return true;
+}
+
+std::optional<size_t> SchnorrSigBatch::FindInvalid() const {
+    for (size_t i = 0; i < checks.size(); ++i) {
+        const SchnorrSigCheck &check = checks[i];
+        if (!check.pubkey.VerifySchnorr(check.hash, {check.sig.begin(), check.sig.end()})) {
+            return origins[i].tag;
+        }
+    }
+    return std::nullopt;
+}
@@ -6,8 +6,10 @@
 
 #pragma once
 
+#include <pubkey.h>
 #include <script/interpreter.h>
 
+#include <optional>
 #include <vector>
 
 // DoS prevention: limit cache size to 32MB (over 1000000 entries on 64-bit
@@ -17,8 +19,6 @@ static constexpr int64_t DEFAULT_MAX_SIG_CACHE_SIZE = 32;
 // Maximum sig cache size allowed
 static constexpr int64_t MAX_MAX_SIG_CACHE_SIZE = 16384;
 
-class CPubKey;
-
 /**
  * We're hashing a nonce into the entries themselves, so we don't need extra
  * blinding in the set hash computation.
@@ -40,9 +40,10 @@ public:
 };
 
 class CachingTransactionSignatureChecker : public TransactionSignatureChecker {
-private:
+protected:
     bool store;
 
+private:
     bool IsCached(const std::vector<uint8_t> &vchSig, const CPubKey &vchPubKey,
                   const uint256 &sighash) const;
 
@@ -59,6 +60,73 @@ public:
     friend class TestCachingTransactionSignatureChecker;
 };
 
+/**
+ * Schnorr signatures whose verification was deferred by a
+ * BatchingTransactionSignatureChecker, to be verified all at once.
+ * Each signature carries a tag identifying the check it came from, so that a
+ * failing batch can be attributed to the offending check.
+ */
+class SchnorrSigBatch {
+    std::vector<SchnorrSigCheck> checks;
+    struct Origin {
+        uint256 cacheEntry;
+        bool store;
+        size_t tag;
+    };
+    std::vector<Origin> origins;
+
+public:
+    void Add(const std::vector<uint8_t> &vchSig, const CPubKey &pubkey,
+             const uint256 &sighash, const uint256 &cacheEntry, bool store,
+             size_t tag);
+
+    size_t size() const { return checks.size(); }
+    bool empty() const { return checks.empty(); }
+    void clear() {
+        checks.clear();
+        origins.clear();
+    }
+
+    /**
+     * Verify all the signatures in the batch. On success, the signatures are
+     * added to the signature cache when requested.
+     */
+    bool Verify() const;
+
+    /**
+     * Verify the signatures one at a time and return the tag of the first
+     * invalid one, if any.
+     */
+    std::optional<size_t> FindInvalid() const;
+};
+
+/**
+ * A signature checker that defers the verification of Schnorr signatures to a
+ * SchnorrSigBatch and optimistically reports them as valid.
+ *
+ * This is only sound for scripts verified with SCRIPT_VERIFY_NULLFAIL: any
+ * failing non-empty Schnorr signature then makes the script fail, so a script
+ * passing with deferred signatures is valid if and only if the batch is.
+ */
+class BatchingTransactionSignatureChecker
+    : public CachingTransactionSignatureChecker {
+private:
+    SchnorrSigBatch &batch;
+    size_t tag;
+
+public:
+    BatchingTransactionSignatureChecker(const ScriptExecutionContext &contextIn,
+                                        bool storeIn,
+                                        PrecomputedTransactionData &txdataIn,
+                                        SchnorrSigBatch &batchIn, size_t tagIn)
+        : CachingTransactionSignatureChecker(contextIn, storeIn, txdataIn),
+          batch(batchIn), tag(tagIn) {}
+
+    bool VerifySignature(const std::vector<uint8_t> &vchSig,
+                         const CPubKey &vchPubKey,
+                         const uint256 &sighash) const override;
+};
+
 /**
  * Initialize the signature cache. Must be called once in
  * AppInitMain/BasicTestingSetup to initialize the signatureCache. Subsequent
@@ -23,6 +23,35 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorr_verify(
   const secp256k1_pubkey *pubkey
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/**
+ * Verify a batch of signatures created by secp256k1_schnorr_sign at once.
+ * This is significantly faster than verifying each signature on its own, but
+ * only tells whether all the signatures are valid. Use secp256k1_schnorr_verify
+ * on each signature to find out which one is invalid.
+ * Returns: 1: all signatures are correct (or n is 0)
+ *          0: at least one signature is incorrect
+ * Args:    ctx:     a secp256k1 context object, initialized for verification.
+ *          scratch: scratch space used to hold the intermediate values and to
+ *                   run the multi-multiplication (can be NULL, in which case,
+ *                   or if it is too small, the signatures are verified one at
+ *                   a time)
+ * In:      sig64s:  array of n pointers to 64-byte signatures (cannot be NULL
+ *                   unless n is 0)
+ *          msg32s:  array of n pointers to the 32-byte message hashes being
+ *                   verified (cannot be NULL unless n is 0)
+ *          pubkeys: array of n pointers to the public keys to verify with
+ *                   (cannot be NULL unless n is 0)
+ *          n:       the number of signatures
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorr_verify_batch(
+  const secp256k1_context* ctx,
+  secp256k1_scratch_space *scratch,
+  const unsigned char *const *sig64s,
+  const unsigned char *const *msg32s,
+  const secp256k1_pubkey *const *pubkeys,
+  size_t n
+) SECP256K1_ARG_NONNULL(1);
+
 /**
  * Create a signature using a custom EC-Schnorr-SHA256 construction. It
  * produces non-malleable 64-byte signatures which support batch validation,
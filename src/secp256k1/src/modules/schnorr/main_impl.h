@@ -27,6 +27,114 @@ int secp256k1_schnorr_verify(
     return secp256k1_schnorr_sig_verify(&ctx->ecmult_ctx, sig64, &q, msg32);
 }
 
+typedef struct {
+    const secp256k1_ge *points;
+    const secp256k1_scalar *scalars;
+} secp256k1_schnorr_verify_batch_ecmult_data;
+
+static int secp256k1_schnorr_verify_batch_ecmult_callback(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *data) {
+    const secp256k1_schnorr_verify_batch_ecmult_data *ecmult_data = (const secp256k1_schnorr_verify_batch_ecmult_data *) data;
+    *sc = ecmult_data->scalars[idx];
+    *pt = ecmult_data->points[idx];
+    return 1;
+}
+
+int secp256k1_schnorr_verify_batch(
+    const secp256k1_context* ctx,
+    secp256k1_scratch_space *scratch,
+    const unsigned char *const *sig64s,
+    const unsigned char *const *msg32s,
+    const secp256k1_pubkey *const *pubkeys,
+    size_t n
+) {
+    secp256k1_schnorr_verify_batch_ecmult_data ecmult_data;
+    secp256k1_ge *points;
+    secp256k1_scalar *scalars;
+    secp256k1_scalar sum_as, as, e;
+    secp256k1_sha256 sha;
+    secp256k1_gej rj;
+    unsigned char seed[32];
+    unsigned char buf[33];
+    size_t size;
+    size_t checkpoint;
+    size_t i;
+    int ret = 1;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(n == 0 || sig64s != NULL);
+    ARG_CHECK(n == 0 || msg32s != NULL);
+    ARG_CHECK(n == 0 || pubkeys != NULL);
+
+    for (i = 0; i < n; i++) {
+        ARG_CHECK(sig64s[i] != NULL);
+        ARG_CHECK(msg32s[i] != NULL);
+        ARG_CHECK(pubkeys[i] != NULL);
+    }
+
+    if (n == 0) {
+        return 1;
+    }
+
+    /* Without room for the intermediate values, verify one at a time. */
+    points = NULL;
+    scalars = NULL;
+    checkpoint = 0;
+    if (scratch != NULL) {
+        checkpoint = secp256k1_scratch_checkpoint(&ctx->error_callback, scratch);
+        points = (secp256k1_ge *) secp256k1_scratch_alloc(&ctx->error_callback, scratch, 2 * n * sizeof(secp256k1_ge));
+        scalars = (secp256k1_scalar *) secp256k1_scratch_alloc(&ctx->error_callback, scratch, 2 * n * sizeof(secp256k1_scalar));
+    }
+    if (points == NULL || scalars == NULL) {
+        if (scratch != NULL) {
+            secp256k1_scratch_apply_checkpoint(&ctx->error_callback, scratch, checkpoint);
+        }
+        for (i = 0; i < n && ret; i++) {
+            ret = secp256k1_schnorr_verify(ctx, sig64s[i], msg32s[i], pubkeys[i]);
+        }
+        return ret;
+    }
+
+    /* Load every public key and derive the randomizer seed from the whole
+     * batch. The points array temporarily holds the public keys. */
+    secp256k1_sha256_initialize(&sha);
+    for (i = 0; i < n && ret; i++) {
+        ret = secp256k1_pubkey_load(ctx, &points[2 * i + 1], pubkeys[i]);
+        if (ret) {
+            secp256k1_eckey_pubkey_serialize(&points[2 * i + 1], buf, &size, 1);
+            secp256k1_sha256_write(&sha, sig64s[i], 64);
+            secp256k1_sha256_write(&sha, msg32s[i], 32);
+            secp256k1_sha256_write(&sha, buf, 33);
+        }
+    }
+    secp256k1_sha256_finalize(&sha, seed);
+
+    /* Build the terms a_i * R_i and a_i * e_i * P_i, and sum(a_i * s_i). */
+    secp256k1_scalar_clear(&sum_as);
+    for (i = 0; i < n && ret; i++) {
+        secp256k1_scalar *a = &scalars[2 * i];
+        secp256k1_scalar s;
+        ret = secp256k1_schnorr_sig_load_batch_terms(&points[2 * i], &e, &s, sig64s[i], &points[2 * i + 1], msg32s[i]);
+        if (ret) {
+            secp256k1_schnorr_batch_randomizer(a, seed, i);
+            secp256k1_scalar_mul(&scalars[2 * i + 1], a, &e);
+            secp256k1_scalar_mul(&as, a, &s);
+            secp256k1_scalar_add(&sum_as, &sum_as, &as);
+        }
+    }
+
+    if (ret) {
+        secp256k1_scalar_negate(&sum_as, &sum_as);
+        ecmult_data.points = points;
+        ecmult_data.scalars = scalars;
+        ret = secp256k1_ecmult_multi_var(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &rj, &sum_as,
+                                         secp256k1_schnorr_verify_batch_ecmult_callback, &ecmult_data, 2 * n)
+              && secp256k1_gej_is_infinity(&rj);
+    }
+
+    secp256k1_scratch_apply_checkpoint(&ctx->error_callback, scratch, checkpoint);
+    return ret;
+}
+
 int secp256k1_schnorr_sign(
     const secp256k1_context *ctx,
     unsigned char *sig64,
@@ -17,6 +17,21 @@ static int secp256k1_schnorr_sig_verify(
     const unsigned char *msg32
 );
 
+static int secp256k1_schnorr_sig_load_batch_terms(
+    secp256k1_ge *R,
+    secp256k1_scalar *e,
+    secp256k1_scalar *s,
+    const unsigned char *sig64,
+    secp256k1_ge *pubkey,
+    const unsigned char *msg32
+);
+
+static void secp256k1_schnorr_batch_randomizer(
+    secp256k1_scalar *a,
+    const unsigned char *seed32,
+    size_t idx
+);
+
 static int secp256k1_schnorr_compute_e(
     secp256k1_scalar* res,
     const unsigned char *r,
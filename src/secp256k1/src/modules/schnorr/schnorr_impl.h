@@ -100,6 +100,83 @@ static int secp256k1_schnorr_sig_verify(
     return 1;
 }
 
+/**
+ * Batch verification (Option 2 above) of n signatures checks the single
+ * equation
+ *   sum(a_i * R_i) + sum(a_i * e_i * P_i) - sum(a_i * s_i) * G == 0
+ * where a_0 = 1 and the other a_i are pseudorandom scalars derived from all
+ * the signatures, messages and public keys in the batch. This equation only
+ * holds for a batch that contains an invalid signature with negligible
+ * probability, as the signer cannot predict the a_i.
+ *
+ * This function extracts R, e and s from a single signature. It returns 0 if
+ * the signature is invalid on its own (s >= n, r >= p, or r is not the x
+ * coordinate of a point on the curve).
+ */
+static int secp256k1_schnorr_sig_load_batch_terms(
+    secp256k1_ge *R,
+    secp256k1_scalar *e,
+    secp256k1_scalar *s,
+    const unsigned char *sig64,
+    secp256k1_ge *pubkey,
+    const unsigned char *msg32
+) {
+    secp256k1_fe Rx;
+    int overflow;
+
+    if (secp256k1_ge_is_infinity(pubkey)) {
+        return 0;
+    }
+
+    /* Extract s */
+    overflow = 0;
+    secp256k1_scalar_set_b32(s, sig64 + 32, &overflow);
+    if (overflow) {
+        return 0;
+    }
+
+    /* Extract R.x and lift it to the point R with a quadratic residue y */
+    if (!secp256k1_fe_set_b32(&Rx, sig64)) {
+        return 0;
+    }
+    if (!secp256k1_ge_set_xquad(R, &Rx)) {
+        return 0;
+    }
+
+    /* Compute e */
+    secp256k1_schnorr_compute_e(e, sig64, pubkey, msg32);
+    return 1;
+}
+
+/**
+ * Compute the randomizer a_idx = SHA256(seed32 || idx) used for batch
+ * verification, with a_0 = 1.
+ */
+static void secp256k1_schnorr_batch_randomizer(
+    secp256k1_scalar *a,
+    const unsigned char *seed32,
+    size_t idx
+) {
+    secp256k1_sha256 sha;
+    unsigned char buf[32];
+    unsigned char idx8[8];
+    int i;
+
+    if (idx == 0) {
+        secp256k1_scalar_set_int(a, 1);
+        return;
+    }
+
+    for (i = 0; i < 8; i++) {
+        idx8[i] = (idx >> (8 * i)) & 0xff;
+    }
+    secp256k1_sha256_initialize(&sha);
+    secp256k1_sha256_write(&sha, seed32, 32);
+    secp256k1_sha256_write(&sha, idx8, 8);
+    secp256k1_sha256_finalize(&sha, buf);
+    secp256k1_scalar_set_b32(a, buf, NULL);
+}
+
 static int secp256k1_schnorr_compute_e(
     secp256k1_scalar* e,
     const unsigned char *r,
@@ -78,6 +78,66 @@ void test_schnorr_sign_verify(void) {
 
 #undef SIG_COUNT
 
+#define SIG_COUNT 16
+
+void test_schnorr_verify_batch(void) {
+    unsigned char privkey[SIG_COUNT][32];
+    unsigned char msg32[SIG_COUNT][32];
+    unsigned char sig64[SIG_COUNT][64];
+    secp256k1_pubkey pubkey[SIG_COUNT];
+    const unsigned char *sig64s[SIG_COUNT];
+    const unsigned char *msg32s[SIG_COUNT];
+    const secp256k1_pubkey *pubkeys[SIG_COUNT];
+    secp256k1_scratch_space *scratch;
+    int i;
+
+    for (i = 0; i < SIG_COUNT; i++) {
+        secp256k1_scalar key;
+        random_scalar_order_test(&key);
+        secp256k1_scalar_get_b32(privkey[i], &key);
+        secp256k1_rand256_test(msg32[i]);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey[i], privkey[i]) == 1);
+        CHECK(secp256k1_schnorr_sign(ctx, sig64[i], msg32[i], privkey[i], NULL, NULL) == 1);
+        sig64s[i] = sig64[i];
+        msg32s[i] = msg32[i];
+        pubkeys[i] = &pubkey[i];
+    }
+
+    scratch = secp256k1_scratch_space_create(ctx, 1024 * 1024);
+
+    /* Empty and single element batches. */
+    CHECK(secp256k1_schnorr_verify_batch(ctx, scratch, NULL, NULL, NULL, 0) == 1);
+    CHECK(secp256k1_schnorr_verify_batch(ctx, scratch, sig64s, msg32s, pubkeys, 1) == 1);
+
+    /* Valid batches, with and without scratch space. */
+    CHECK(secp256k1_schnorr_verify_batch(ctx, scratch, sig64s, msg32s, pubkeys, SIG_COUNT) == 1);
+    CHECK(secp256k1_schnorr_verify_batch(ctx, NULL, sig64s, msg32s, pubkeys, SIG_COUNT) == 1);
+
+    /* Corrupting any single signature makes the batch fail. */
+    for (i = 0; i < SIG_COUNT; i++) {
+        int pos = secp256k1_rand_bits(6);
+        int mod = 1 + secp256k1_rand_int(255);
+        sig64[i][pos] ^= mod;
+        CHECK(secp256k1_schnorr_verify_batch(ctx, scratch, sig64s, msg32s, pubkeys, SIG_COUNT) == 0);
+        CHECK(secp256k1_schnorr_verify_batch(ctx, NULL, sig64s, msg32s, pubkeys, SIG_COUNT) == 0);
+        sig64[i][pos] ^= mod;
+    }
+
+    /* Swapping messages between two signatures makes the batch fail. */
+    msg32s[0] = msg32[1];
+    msg32s[1] = msg32[0];
+    CHECK(secp256k1_schnorr_verify_batch(ctx, scratch, sig64s, msg32s, pubkeys, SIG_COUNT) == 0);
+    msg32s[0] = msg32[0];
+    msg32s[1] = msg32[1];
+
+    /* The scratch space is released after each call. */
+    CHECK(secp256k1_schnorr_verify_batch(ctx, scratch, sig64s, msg32s, pubkeys, SIG_COUNT) == 1);
+
+    secp256k1_scratch_space_destroy(ctx, scratch);
+}
+
+#undef SIG_COUNT
+
 void run_schnorr_compact_test(void) {
     {
         /* Test vector 1 */
@@ -516,6 +576,9 @@ void run_schnorr_tests(void) {
     }
 
     test_schnorr_sign_verify();
+    for (i = 0; i < count; i++) {
+        test_schnorr_verify_batch();
+    }
     run_schnorr_compact_test();
 }
 
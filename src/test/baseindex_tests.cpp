@@ -0,0 +1,220 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chain.h>
+#include <config.h>
+#include <dbwrapper.h>
+#include <hash.h>
+#include <index/base.h>
+#include <sync.h>
+#include <util/system.h>
+#include <validation.h>
+
+#include <test/setup_common.h>
+#include <test/util.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(baseindex_tests)
+
+namespace {
+constexpr uint8_t DB_BLOCK_HASH = 'h';
+constexpr uint8_t DB_CHAIN_HASH = 'c';
+
+using Key = std::pair<uint8_t, uint32_t>;
+
+/** The hash of a block chained with that of the blocks before it. */
+uint256 ChainHash(const uint256 &prev_chain_hash, const uint256 &block_hash) {
+    return (CHashWriter(SER_GETHASH, 0) << prev_chain_hash << block_hash)
+        .GetHash();
+}
+
+/**
+ * An index of the hash of every block, which PrepareBlock writes, and of the
+ * chained hash of the blocks up to it, which WriteBlock writes from the one of
+ * the block before it, whether that one is written already or not.
+ */
+class TestIndex final : public BaseIndex {
+    const std::unique_ptr<BaseIndex::DB> m_db;
+
+    //! The chained hash WriteBlock wrote last, at m_last_height, which the
+    //! batch being written may not have in the database yet.
+    uint256 m_last_chain_hash;
+    int m_last_height = -1;
+
+protected:
+    bool PrepareBlock(const CBlock &block, const CBlockIndex *pindex,
+                      PreparedBlock &prepared) const override {
+        prepared.batch.Write(Key(DB_BLOCK_HASH, pindex->nHeight),
+                             block.GetHash());
+        return true;
+    }
+
+    bool WriteBlock(const CBlock &block, const CBlockIndex *pindex,
+                    PreparedBlock &prepared, CDBBatch &batch) override {
+        uint256 prev_chain_hash;
+        if (pindex->nHeight > 0 && m_last_height == pindex->nHeight - 1) {
+            prev_chain_hash = m_last_chain_hash;
+        } else if (pindex->nHeight > 0 &&
+                   !m_db->Read(Key(DB_CHAIN_HASH, pindex->nHeight - 1),
+                               prev_chain_hash)) {
+            return false;
+        }
+        m_last_chain_hash = ChainHash(prev_chain_hash, block.GetHash());
+        m_last_height = pindex->nHeight;
+        batch.Write(Key(DB_CHAIN_HASH, pindex->nHeight), m_last_chain_hash);
+        if (pindex->nHeight == interrupt_height) {
+            Interrupt();
+        }
+        return true;
+    }
+
+    bool Rewind(const CBlockIndex *current_tip,
+                const CBlockIndex *new_tip) override {
+        // Another thread can take cs_main, unless this one holds it.
+        bool cs_main_free = false;
+        std::thread([&] {
+            TRY_LOCK(cs_main, lock);
+            cs_main_free = lock;
+        }).join();
+        rewinds.push_back({current_tip, new_tip, cs_main_free});
+
+        CDBBatch batch(*m_db);
+        for (const CBlockIndex *pindex = current_tip; pindex != new_tip;
+             pindex = pindex->pprev) {
+            batch.Erase(Key(DB_BLOCK_HASH, pindex->nHeight));
+            batch.Erase(Key(DB_CHAIN_HASH, pindex->nHeight));
+        }
+        m_last_height = -1;
+        return CommitRewind(current_tip, new_tip, batch);
+    }
+
+    BaseIndex::DB &GetDB() const override { return *m_db; }
+
+    const char *GetName() const override { return "testindex"; }
+
+public:
+    struct Rewound {
+        const CBlockIndex *current_tip;
+        const CBlockIndex *new_tip;
+        bool cs_main_free;
+    };
+
+    //! The height of the block after which the sync is interrupted, if any.
+    int interrupt_height = -1;
+    std::vector<Rewound> rewinds;
+
+    TestIndex(bool f_wipe)
+        : m_db(std::make_unique<BaseIndex::DB>(
+              GetDataDir() / "indexes" / "testindex", 1 << 20, false,
+              f_wipe)) {}
+
+    ~TestIndex() override {
+        // Before m_db goes.
+        Interrupt();
+        Stop();
+    }
+
+    BlockHash BestBlockHash() const {
+        CBlockLocator locator;
+        if (!m_db->ReadBestBlock(locator) || locator.IsNull()) {
+            return BlockHash();
+        }
+        return locator.vHave.front();
+    }
+
+    /**
+     * Check the entries are those of the active chain up to pindex, computed
+     * one block at a time, and that there are none after it.
+     */
+    void CheckEntries(const CBlockIndex *pindex) const {
+        BOOST_CHECK(BestBlockHash() == pindex->GetBlockHash());
+        const CBlockIndex *tip =
+            WITH_LOCK(cs_main, return ::ChainActive().Tip());
+        uint256 chain_hash;
+        for (int height = 0; height <= tip->nHeight + 1; ++height) {
+            uint256 block_hash, stored_chain_hash;
+            const bool has_block_hash =
+                m_db->Read(Key(DB_BLOCK_HASH, height), block_hash);
+            const bool has_chain_hash =
+                m_db->Read(Key(DB_CHAIN_HASH, height), stored_chain_hash);
+            if (height > pindex->nHeight) {
+                BOOST_CHECK(!has_block_hash);
+                BOOST_CHECK(!has_chain_hash);
+                continue;
+            }
+            const uint256 expected =
+                pindex->GetAncestor(height)->GetBlockHash();
+            chain_hash = ChainHash(chain_hash, expected);
+            BOOST_REQUIRE(has_block_hash);
+            BOOST_REQUIRE(has_chain_hash);
+            BOOST_CHECK(block_hash == expected);
+            BOOST_CHECK(stored_chain_hash == chain_hash);
+        }
+    }
+};
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(baseindex_batch_sync, TestChain100Setup) {
+    // Several times as many blocks as the sync writes in one batch.
+    const CScript script = CScript() << OP_TRUE;
+    for (int i = 0; i < 100; ++i) {
+        CreateAndProcessBlock({}, script);
+    }
+    CBlockIndex *tip = WITH_LOCK(cs_main, return ::ChainActive().Tip());
+    BOOST_REQUIRE_EQUAL(tip->nHeight, 200);
+
+    // Interrupted in the middle of the second batch, the index writes the
+    // blocks up to the interruption, and the best block with them.
+    {
+        TestIndex index(true);
+        index.interrupt_height = 100;
+        index.Start();
+        // The sync thread exits once interrupted.
+        index.Stop();
+        BOOST_CHECK(!index.BlockUntilSyncedToCurrentChain());
+        index.CheckEntries(tip->GetAncestor(100));
+    }
+
+    // Restarted, it resumes from there.
+    {
+        TestIndex index(false);
+        index.Start();
+        WaitForIndexSync(index);
+        index.Stop();
+        index.CheckEntries(tip);
+        BOOST_CHECK(index.rewinds.empty());
+    }
+
+    // Replace the last blocks while the index is not running: on restart it
+    // rewinds them in one go, without holding cs_main, before syncing the
+    // blocks replacing them.
+    const CBlockIndex *fork = tip->GetAncestor(189);
+    InvalidateBlockAndClearMempool(GetConfig(), tip->GetAncestor(190));
+    for (int i = 0; i < 15; ++i) {
+        CreateAndProcessBlock({}, CScript() << OP_2);
+    }
+    const CBlockIndex *new_tip =
+        WITH_LOCK(cs_main, return ::ChainActive().Tip());
+    BOOST_REQUIRE_EQUAL(new_tip->nHeight, 204);
+    BOOST_REQUIRE(new_tip->GetAncestor(189) == fork);
+    {
+        TestIndex index(false);
+        index.Start();
+        WaitForIndexSync(index);
+        index.Stop();
+        BOOST_REQUIRE_EQUAL(index.rewinds.size(), 1U);
+        BOOST_CHECK(index.rewinds[0].current_tip == tip);
+        BOOST_CHECK(index.rewinds[0].new_tip == fork);
+        BOOST_CHECK(index.rewinds[0].cs_main_free);
+        index.CheckEntries(new_tip);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
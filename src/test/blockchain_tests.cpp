@@ -4,6 +4,10 @@
 #include <rpc/blockchain.h>
 
 #include <chain.h>
+#include <config.h>
+#include <primitives/block.h>
+#include <rpc/server.h>
+#include <script/script.h>
 
 #include <test/setup_common.h>
 
@@ -69,4 +73,39 @@ BOOST_AUTO_TEST_CASE(get_difficulty_for_very_high_target) {
     TestDifficulty(0x12345678, 5913134931067755359633408.0);
 }
 
+BOOST_AUTO_TEST_CASE(block_to_json_parallel) {
+    CBlock block;
+    for (int i = 0; i < 1000; ++i) {
+        CMutableTransaction mtx;
+        mtx.vin.resize(1 + i % 3);
+        for (CTxIn &txin : mtx.vin) {
+            txin.prevout = COutPoint(TxId(InsecureRand256()), i);
+            txin.scriptSig = CScript() << ScriptInt::fromIntUnchecked(i);
+        }
+        mtx.vout.resize(1 + i % 2);
+        for (CTxOut &txout : mtx.vout) {
+            txout.nValue = int64_t(i) * SATOSHI;
+            txout.scriptPubKey = CScript() << OP_DUP << OP_HASH160 << g_insecure_rand_ctx.randbytes(20) << OP_EQUALVERIFY
+                                           << OP_CHECKSIG;
+        }
+        block.vtx.push_back(MakeTransactionRef(std::move(mtx)));
+    }
+    CBlockIndex blockindex;
+    const BlockHash blockHash = block.GetHash();
+    blockindex.phashBlock = &blockHash;
+
+    // The transactions are the same, and in the same order, when shared with
+    // the RPC workers.
+    const auto toJSON = [&]() {
+        return UniValue::stringify(blockToJSON(GetConfig(), block, &blockindex, &blockindex, TxVerbosity::SHOW_DETAILS));
+    };
+    const std::string serial = toJSON();
+    g_rpc_worker_pool.Start(3);
+    const std::string parallel = toJSON();
+    g_rpc_worker_pool.Stop();
+    BOOST_CHECK_EQUAL(serial.size(), parallel.size());
+    BOOST_CHECK(serial == parallel);
+    BOOST_CHECK(serial.find(block.vtx.back()->GetId().GetHex()) != std::string::npos);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
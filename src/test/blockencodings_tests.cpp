@@ -390,6 +390,48 @@ BOOST_AUTO_TEST_CASE(EmptyBlockRoundTripTest) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(CollidingShortIDsTest) {
+    CTxMemPool pool;
+    TestMemPoolEntryHelper entry;
+    CBlock block(BuildBlockTestCase());
+
+    LOCK2(cs_main, pool.cs);
+    pool.addUnchecked(entry.FromTx(block.vtx[2]));
+
+    // Short IDs which all fall in the slots following the one of the short ID
+    // of the mempool transaction, leaving a run of occupied slots longer than
+    // any lookup is allowed to probe.
+    TestHeaderAndShortIDs shortIDs(block);
+    const uint64_t shortid = shortIDs.GetShortID(block.vtx[2]->GetHash());
+    const size_t count = 300;
+    // The table has the smallest power of two slots at least twice the number
+    // of short IDs.
+    const uint64_t mask = 1023;
+    shortIDs.shorttxids.clear();
+    for (uint64_t i = 0; i < count; ++i) {
+        shortIDs.shorttxids.push_back(((i + 1) << 32) |
+                                      ((shortid + i) & mask));
+        BOOST_REQUIRE(shortIDs.shorttxids.back() != shortid);
+    }
+
+    CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+    stream << shortIDs;
+    CBlockHeaderAndShortTxIDs shortIDs2;
+    stream >> shortIDs2;
+
+    PartiallyDownloadedBlock partialBlock(GetConfig(), &pool);
+    BOOST_CHECK(partialBlock.InitData(shortIDs2, extra_txn) ==
+                READ_STATUS_FAILED);
+
+    // The same happens when the colliding transaction is an extra one.
+    CTxMemPool empty_pool;
+    const std::vector<std::pair<TxHash, CTransactionRef>> colliding_extra_txn{
+        {block.vtx[2]->GetHash(), block.vtx[2]}};
+    PartiallyDownloadedBlock partialBlock2(GetConfig(), &empty_pool);
+    BOOST_CHECK(partialBlock2.InitData(shortIDs2, colliding_extra_txn) ==
+                READ_STATUS_FAILED);
+}
+
 BOOST_AUTO_TEST_CASE(TransactionsRequestSerializationTest) {
     BlockTransactionsRequest req1;
     req1.blockhash = BlockHash(InsecureRand256());
@@ -0,0 +1,261 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockfilter.h>
+#include <chain.h>
+#include <chainparams.h>
+#include <config.h>
+#include <index/blockfilterindex.h>
+#include <undo.h>
+#include <validation.h>
+
+#include <test/setup_common.h>
+#include <test/util.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(blockfilter_index_tests, TestingSetup)
+
+/** The filter of the block at block_index, computed from the block on disk. */
+static BlockFilter ComputeFilter(const CBlockIndex *block_index) {
+    CBlock block;
+    BOOST_REQUIRE(ReadBlockFromDisk(block, block_index,
+                                    Params().GetConsensus()));
+    CBlockUndo block_undo;
+    BOOST_REQUIRE(block_index->nHeight == 0 ||
+                  UndoReadFromDisk(block_undo, block_index));
+    return BlockFilter(BlockFilterType::BASIC, block, block_undo);
+}
+
+/**
+ * Check the filter and header of the block at block_index against those
+ * computed from the block, with prev_header the header of its parent, and
+ * set prev_header to its header.
+ */
+static void CheckFilterLookups(const BlockFilterIndex &filter_index,
+                               const CBlockIndex *block_index,
+                               uint256 &prev_header) {
+    const BlockFilter expected_filter = ComputeFilter(block_index);
+
+    BlockFilter filter;
+    uint256 filter_header;
+    std::vector<BlockFilter> filters;
+    std::vector<uint256> filter_hashes;
+    BOOST_REQUIRE(filter_index.LookupFilter(block_index, filter));
+    BOOST_REQUIRE(filter_index.LookupFilterHeader(block_index, filter_header));
+    BOOST_REQUIRE(filter_index.LookupFilterRange(block_index->nHeight,
+                                                 block_index, filters));
+    BOOST_REQUIRE(filter_index.LookupFilterHashRange(
+        block_index->nHeight, block_index, filter_hashes));
+    BOOST_REQUIRE_EQUAL(filters.size(), 1U);
+    BOOST_REQUIRE_EQUAL(filter_hashes.size(), 1U);
+
+    BOOST_CHECK(filter.GetBlockHash() == block_index->GetBlockHash());
+    BOOST_CHECK(filter.GetEncodedFilter() ==
+                expected_filter.GetEncodedFilter());
+    BOOST_CHECK(filter_header == expected_filter.ComputeHeader(prev_header));
+    BOOST_CHECK(filters[0].GetBlockHash() == block_index->GetBlockHash());
+    BOOST_CHECK(filters[0].GetHash() == expected_filter.GetHash());
+    BOOST_CHECK(filter_hashes[0] == expected_filter.GetHash());
+
+    prev_header = filter_header;
+}
+
+/** Check the filters of the chain ending at tip, one by one and at once. */
+static void CheckChainFilters(const BlockFilterIndex &filter_index,
+                              const CBlockIndex *tip) {
+    uint256 prev_header;
+    for (int height = 0; height <= tip->nHeight; ++height) {
+        CheckFilterLookups(filter_index, tip->GetAncestor(height),
+                           prev_header);
+    }
+
+    std::vector<BlockFilter> filters;
+    std::vector<uint256> filter_hashes;
+    BOOST_REQUIRE(filter_index.LookupFilterRange(0, tip, filters));
+    BOOST_REQUIRE(filter_index.LookupFilterHashRange(0, tip, filter_hashes));
+    BOOST_REQUIRE_EQUAL(filters.size(), size_t(tip->nHeight + 1));
+    BOOST_REQUIRE_EQUAL(filter_hashes.size(), size_t(tip->nHeight + 1));
+    for (int height = 0; height <= tip->nHeight; ++height) {
+        const CBlockIndex *block_index = tip->GetAncestor(height);
+        const uint256 expected_hash = ComputeFilter(block_index).GetHash();
+        BOOST_CHECK(filters[height].GetBlockHash() ==
+                    block_index->GetBlockHash());
+        BOOST_CHECK(filters[height].GetHash() == expected_hash);
+        BOOST_CHECK(filter_hashes[height] == expected_hash);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(blockfilter_index_initial_sync, TestChain100Setup) {
+    BlockFilterIndex filter_index(BlockFilterType::BASIC, 1 << 20, true);
+
+    const CScript coinbase_script = CScript()
+                                    << ToByteVector(coinbaseKey.GetPubKey())
+                                    << OP_CHECKSIG;
+    const CScript other_script = CScript() << OP_2;
+
+    // Block 101 spends a coinbase and pays elsewhere: its filter holds the
+    // spent script, which only the undo data of the block has.
+    const CTransaction &coinbase = *m_coinbase_txns[0];
+    CreateAndProcessBlock(
+        {Spend(coinbase, 0, coinbaseKey,
+               {CTxOut(coinbase.vout[0].nValue - COIN, other_script)})},
+        other_script);
+
+    const CBlockIndex *genesis_index;
+    {
+        LOCK(cs_main);
+        genesis_index = ::ChainActive().Genesis();
+    }
+    BOOST_REQUIRE(genesis_index);
+
+    // Lookups fail before the index is started.
+    BlockFilter filter;
+    uint256 filter_header;
+    BOOST_CHECK(!filter_index.LookupFilter(genesis_index, filter));
+    BOOST_CHECK(!filter_index.LookupFilterHeader(genesis_index, filter_header));
+    BOOST_CHECK(!filter_index.BlockUntilSyncedToCurrentChain());
+
+    filter_index.Start();
+
+    // Allow filter index to catch up with the block index.
+    WaitForIndexSync(filter_index);
+
+    const CBlockIndex *tip = WITH_LOCK(cs_main, return ::ChainActive().Tip());
+    BOOST_REQUIRE_EQUAL(tip->nHeight, 101);
+    CheckChainFilters(filter_index, tip);
+    BOOST_REQUIRE(filter_index.LookupFilter(tip, filter));
+    BOOST_CHECK(filter.GetFilter().Match(
+        GCSFilter::Element(coinbase_script.begin(), coinbase_script.end())));
+
+    // Block 102 is connected while the index is running.
+    CreateAndProcessBlock({}, coinbase_script);
+    BOOST_CHECK(filter_index.BlockUntilSyncedToCurrentChain());
+    const CBlockIndex *stale_tip =
+        WITH_LOCK(cs_main, return ::ChainActive().Tip());
+    CheckChainFilters(filter_index, stale_tip);
+
+    const std::vector<const CBlockIndex *> stale_blocks{stale_tip->pprev,
+                                                        stale_tip};
+    std::vector<uint256> stale_filter_hashes;
+    std::vector<uint256> stale_headers;
+    for (const CBlockIndex *pindex : stale_blocks) {
+        BOOST_REQUIRE(filter_index.LookupFilter(pindex, filter));
+        stale_filter_hashes.push_back(filter.GetHash());
+        BOOST_REQUIRE(filter_index.LookupFilterHeader(pindex, filter_header));
+        stale_headers.push_back(filter_header);
+    }
+
+    // Replace blocks 101 and 102 by three others.
+    InvalidateBlockAndClearMempool(
+        GetConfig(),
+        WITH_LOCK(cs_main, return ::ChainActive().Tip()->GetAncestor(101)));
+    for (int i = 0; i < 3; ++i) {
+        CreateAndProcessBlock({}, other_script);
+    }
+    BOOST_CHECK(filter_index.BlockUntilSyncedToCurrentChain());
+    tip = WITH_LOCK(cs_main, return ::ChainActive().Tip());
+    BOOST_REQUIRE_EQUAL(tip->nHeight, 103);
+    BOOST_REQUIRE(tip->GetAncestor(101) != stale_blocks[0]);
+    CheckChainFilters(filter_index, tip);
+
+    // The filters and headers of the stale blocks remain available.
+    for (size_t i = 0; i < stale_blocks.size(); ++i) {
+        const CBlockIndex *pindex = stale_blocks[i];
+        BOOST_REQUIRE(filter_index.LookupFilter(pindex, filter));
+        BOOST_CHECK(filter.GetBlockHash() == pindex->GetBlockHash());
+        BOOST_CHECK(filter.GetHash() == stale_filter_hashes[i]);
+        BOOST_REQUIRE(filter_index.LookupFilterHeader(pindex, filter_header));
+        BOOST_CHECK(filter_header == stale_headers[i]);
+    }
+    std::vector<uint256> filter_hashes;
+    BOOST_REQUIRE(
+        filter_index.LookupFilterHashRange(101, stale_tip, filter_hashes));
+    BOOST_CHECK(filter_hashes == stale_filter_hashes);
+
+    // Invalid ranges.
+    std::vector<BlockFilter> filters;
+    BOOST_CHECK(!filter_index.LookupFilterRange(-1, tip, filters));
+    BOOST_CHECK(!filter_index.LookupFilterRange(tip->nHeight + 1, tip,
+                                                filters));
+
+    filter_index.Stop();
+}
+
+BOOST_FIXTURE_TEST_CASE(blockfilter_index_parallel_sync, TestChain100Setup) {
+    {
+        BlockFilterIndex filter_index(BlockFilterType::BASIC, 1 << 20, false,
+                                      true);
+        filter_index.Start();
+        WaitForIndexSync(filter_index);
+        filter_index.Stop();
+    }
+
+    // Replace the tip, and extend the chain by more blocks than the sync
+    // reads at once, while the index is not running. Each block spends the
+    // coinbase that became mature with it, but that of the stale tip.
+    InvalidateBlockAndClearMempool(
+        GetConfig(), WITH_LOCK(cs_main, return ::ChainActive().Tip()));
+    const CScript other_script = CScript() << OP_2;
+    CreateAndProcessBlock({}, other_script);
+    for (size_t i = 0; i + 1 < m_coinbase_txns.size(); ++i) {
+        const CTransaction &coinbase = *m_coinbase_txns[i];
+        CreateAndProcessBlock(
+            {Spend(coinbase, 0, coinbaseKey,
+                   {CTxOut(coinbase.vout[0].nValue - COIN, other_script)})},
+            other_script);
+    }
+    const CBlockIndex *tip = WITH_LOCK(cs_main, return ::ChainActive().Tip());
+    BOOST_REQUIRE_EQUAL(tip->nHeight, 199);
+
+    // On restart, the sync rewinds the stale tip, then reads and prepares the
+    // blocks in parallel batches. The filters and headers it writes are those
+    // computed one block after the other.
+    BlockFilterIndex filter_index(BlockFilterType::BASIC, 1 << 20, false,
+                                  false);
+    filter_index.Start();
+    WaitForIndexSync(filter_index);
+    CheckChainFilters(filter_index, tip);
+    filter_index.Stop();
+}
+
+BOOST_AUTO_TEST_CASE(blockfilter_index_init_destroy) {
+    BlockFilterIndex *filter_index;
+
+    filter_index = GetBlockFilterIndex(BlockFilterType::BASIC);
+    BOOST_CHECK(filter_index == nullptr);
+
+    BOOST_CHECK(InitBlockFilterIndex(BlockFilterType::BASIC, 1 << 20, true, false));
+
+    filter_index = GetBlockFilterIndex(BlockFilterType::BASIC);
+    BOOST_CHECK(filter_index != nullptr);
+    BOOST_CHECK(filter_index->GetFilterType() == BlockFilterType::BASIC);
+
+    // Initialize returns false if index already exists.
+    BOOST_CHECK(!InitBlockFilterIndex(BlockFilterType::BASIC, 1 << 20, true, false));
+
+    int iter_count = 0;
+    ForEachBlockFilterIndex([&iter_count](BlockFilterIndex &index) { iter_count++; });
+    BOOST_CHECK_EQUAL(iter_count, 1);
+
+    BOOST_CHECK(DestroyBlockFilterIndex(BlockFilterType::BASIC));
+
+    // Destroy returns false because index was already destroyed.
+    BOOST_CHECK(!DestroyBlockFilterIndex(BlockFilterType::BASIC));
+
+    filter_index = GetBlockFilterIndex(BlockFilterType::BASIC);
+    BOOST_CHECK(filter_index == nullptr);
+
+    // Reinitialize index.
+    BOOST_CHECK(InitBlockFilterIndex(BlockFilterType::BASIC, 1 << 20, true, false));
+
+    DestroyAllBlockFilterIndexes();
+
+    filter_index = GetBlockFilterIndex(BlockFilterType::BASIC);
+    BOOST_CHECK(filter_index == nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,160 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockprefetch.h>
+
+#include <chain.h>
+
+#include <test/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <thread>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(blockprefetch_tests, BasicTestingSetup)
+
+namespace {
+/**
+ * A chain of fake blocks, where the block at height h is stored at position
+ * h (+ 1000 for the blocks of the fork) of file 0.
+ */
+struct FakeChain {
+    std::deque<CBlock> blocks;
+    std::deque<BlockHash> hashes;
+    std::deque<CBlockIndex> indexes;
+
+    FakeChain(int length, const CBlockIndex *pindexFork = nullptr, uint32_t posOffset = 0) {
+        const int forkHeight = pindexFork ? pindexFork->nHeight + 1 : 0;
+        for (int height = forkHeight; height < length; ++height) {
+            CBlock &block = blocks.emplace_back();
+            block.nNonce = height + posOffset;
+            hashes.push_back(block.GetHash());
+            CBlockIndex &index = indexes.emplace_back();
+            index.phashBlock = &hashes.back();
+            index.nHeight = height;
+            index.pprev = height == forkHeight ? const_cast<CBlockIndex *>(pindexFork) : &indexes[indexes.size() - 2];
+            index.nFile = 0;
+            index.nDataPos = height + posOffset;
+            index.nStatus = index.nStatus.withData();
+            index.BuildSkip();
+        }
+    }
+
+    const CBlockIndex *At(int height) const { return &indexes.at(height - indexes.front().nHeight); }
+    const CBlockIndex *Tip() const { return &indexes.back(); }
+};
+
+bool ReadFakeBlock(CBlock &block, const FlatFilePos &pos) {
+    block.SetNull();
+    block.nNonce = pos.nPos;
+    return true;
+}
+
+/** Wait until the prefetcher read count blocks, so that Take() waits for them. */
+void WaitForReads(const std::atomic<int> &reads, int count) {
+    while (reads < count) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(prefetch_in_order) {
+    FakeChain chain(30);
+    std::atomic<int> reads{0};
+    CBlockPrefetcher prefetcher([&](CBlock &block, const FlatFilePos &pos) {
+        ++reads;
+        return ReadFakeBlock(block, pos);
+    });
+
+    // Nothing happens before the threads are started.
+    prefetcher.Schedule(chain.At(0), chain.Tip());
+    BOOST_CHECK(!prefetcher.Take(chain.At(1)));
+    BOOST_CHECK_EQUAL(reads, 0);
+
+    prefetcher.Start(2, 8);
+    prefetcher.Schedule(chain.At(0), chain.Tip());
+    WaitForReads(reads, 8);
+    for (int height = 1; height <= 8; ++height) {
+        auto block = prefetcher.Take(chain.At(height));
+        BOOST_REQUIRE(block);
+        BOOST_CHECK(block->GetHash() == chain.At(height)->GetBlockHash());
+    }
+    // Only the first 8 blocks were scheduled, and each block is taken once.
+    BOOST_CHECK(!prefetcher.Take(chain.At(9)));
+    BOOST_CHECK(!prefetcher.Take(chain.At(8)));
+    BOOST_CHECK_EQUAL(prefetcher.GetHits(), 8U);
+
+    // Scheduling from a later tip reads the following blocks, up to the target.
+    prefetcher.Schedule(chain.At(25), chain.Tip());
+    WaitForReads(reads, 12);
+    for (int height = 26; height < 30; ++height) {
+        BOOST_CHECK(prefetcher.Take(chain.At(height)));
+    }
+    BOOST_CHECK_EQUAL(reads, 12);
+
+    prefetcher.Stop();
+}
+
+BOOST_AUTO_TEST_CASE(prefetch_reorg) {
+    FakeChain chain(20);
+    FakeChain fork(20, chain.At(9), 1000);
+    std::atomic<int> reads{0};
+    CBlockPrefetcher prefetcher([&](CBlock &block, const FlatFilePos &pos) {
+        ++reads;
+        return ReadFakeBlock(block, pos);
+    });
+    prefetcher.Start(1, 16);
+
+    prefetcher.Schedule(chain.At(5), chain.Tip());
+    WaitForReads(reads, 14);
+
+    // Switching to the fork keeps the common blocks and drops the others.
+    prefetcher.Schedule(chain.At(5), fork.Tip());
+    WaitForReads(reads, 14 + 10);
+    for (int height = 6; height < 10; ++height) {
+        BOOST_CHECK(prefetcher.Take(chain.At(height)));
+    }
+    BOOST_CHECK(!prefetcher.Take(chain.At(10)));
+    for (int height = 10; height < 16; ++height) {
+        auto block = prefetcher.Take(fork.At(height));
+        BOOST_REQUIRE(block);
+        BOOST_CHECK(block->GetHash() == fork.At(height)->GetBlockHash());
+    }
+
+    prefetcher.Stop();
+}
+
+BOOST_AUTO_TEST_CASE(prefetch_failures) {
+    FakeChain chain(10);
+    std::atomic<int> reads{0};
+    CBlockPrefetcher prefetcher([&](CBlock &block, const FlatFilePos &pos) {
+        ++reads;
+        // Fail to read block 2 and return the wrong block for block 3.
+        return pos.nPos != 2 && ReadFakeBlock(block, FlatFilePos(pos.nFile, pos.nPos == 3 ? 4 : pos.nPos));
+    });
+    prefetcher.Start(2, 4);
+
+    prefetcher.Schedule(chain.At(0), chain.Tip());
+    WaitForReads(reads, 4);
+    BOOST_CHECK(prefetcher.Take(chain.At(1)));
+    BOOST_CHECK(!prefetcher.Take(chain.At(2)));
+    BOOST_CHECK(!prefetcher.Take(chain.At(3)));
+    BOOST_CHECK(prefetcher.Take(chain.At(4)));
+
+    // Blocks we do not have are not read, nor anything after them.
+    const_cast<CBlockIndex *>(chain.At(6))->nStatus = chain.At(6)->nStatus.withData(false);
+    prefetcher.Schedule(chain.At(4), chain.Tip());
+    WaitForReads(reads, 5);
+    BOOST_CHECK(prefetcher.Take(chain.At(5)));
+    BOOST_CHECK(!prefetcher.Take(chain.At(7)));
+    BOOST_CHECK_EQUAL(reads, 5);
+
+    prefetcher.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
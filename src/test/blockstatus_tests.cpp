@@ -133,4 +133,22 @@ BOOST_AUTO_TEST_CASE(sighash_construction_test) {
     CheckHaveDataAndUndo(BlockStatus());
 }
 
+BOOST_AUTO_TEST_CASE(assumed_valid) {
+    const BlockStatus s =
+        BlockStatus().withValidity(BlockValidity::TRANSACTIONS).withAssumedValid();
+    BOOST_CHECK(s.isAssumedValid());
+    // Assumed valid blocks are not validated.
+    BOOST_CHECK(s.isValid(BlockValidity::TRANSACTIONS));
+    BOOST_CHECK(!s.isValid(BlockValidity::SCRIPTS));
+    // The flag is independent of the others.
+    CheckBlockStatus(s.withData(false).withUndo(false), BlockValidity::TRANSACTIONS,
+                     false, false, false, false, false, false);
+    BOOST_CHECK(s.withFailed().withClearedFailureFlags().isAssumedValid());
+    BOOST_CHECK(s.withParked().withClearedParkedFlags().isAssumedValid());
+    BOOST_CHECK(s.withValidity(BlockValidity::SCRIPTS).isAssumedValid());
+    BOOST_CHECK(!s.withAssumedValid(false).isAssumedValid());
+    BOOST_CHECK(s.withAssumedValid(false) == BlockStatus().withValidity(BlockValidity::TRANSACTIONS));
+    BOOST_CHECK(!BlockStatus().isAssumedValid());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
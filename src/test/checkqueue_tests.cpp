@@ -114,37 +114,34 @@ std::unordered_multiset<size_t> UniqueCheck::results;
 std::atomic<size_t> FakeCheckCheckCompletion::n_calls{0};
 std::atomic<size_t> MemoryCheck::fake_allocated_memory{0};
 
-// Queue Typedefs
-typedef CCheckQueue<FakeCheckCheckCompletion> Correct_Queue;
-typedef CCheckQueue<FakeCheck> Standard_Queue;
-typedef CCheckQueue<FailingCheck> Failing_Queue;
-typedef CCheckQueue<UniqueCheck> Unique_Queue;
-typedef CCheckQueue<MemoryCheck> Memory_Queue;
-typedef CCheckQueue<FrozenCleanupCheck> FrozenCleanup_Queue;
+// Every test is run against each check queue implementation
+static constexpr CheckQueueEngine ENGINES[] = {CheckQueueEngine::LEGACY, CheckQueueEngine::WORKSTEALING};
 
 /** This test case checks that the CCheckQueue works properly
  * with each specified size_t Checks pushed.
  */
 static void Correct_Queue_range(std::vector<size_t> range) {
-    auto small_queue = std::make_unique<Correct_Queue>(QUEUE_BATCH_SIZE);
-    small_queue->StartWorkerThreads(SCRIPT_CHECK_THREADS);
-    // Make vChecks here to save on malloc (this test can be slow...)
-    std::vector<FakeCheckCheckCompletion> vChecks;
-    for (const size_t i : range) {
-        size_t total = i;
-        FakeCheckCheckCompletion::n_calls = 0;
-        CCheckQueueControl<FakeCheckCheckCompletion> control(small_queue.get());
-        while (total) {
-            vChecks.resize(std::min(total, (size_t)InsecureRandRange(10)));
-            total -= vChecks.size();
-            control.Add(vChecks);
-        }
-        BOOST_REQUIRE(control.Wait());
-        if (FakeCheckCheckCompletion::n_calls != i) {
-            BOOST_REQUIRE_EQUAL(FakeCheckCheckCompletion::n_calls, i);
+    for (const auto engine : ENGINES) {
+        auto small_queue = MakeCheckQueue<FakeCheckCheckCompletion>(engine, QUEUE_BATCH_SIZE);
+        small_queue->StartWorkerThreads(SCRIPT_CHECK_THREADS);
+        // Make vChecks here to save on malloc (this test can be slow...)
+        std::vector<FakeCheckCheckCompletion> vChecks;
+        for (const size_t i : range) {
+            size_t total = i;
+            FakeCheckCheckCompletion::n_calls = 0;
+            CCheckQueueControl<FakeCheckCheckCompletion> control(small_queue.get());
+            while (total) {
+                vChecks.resize(std::min(total, (size_t)InsecureRandRange(10)));
+                total -= vChecks.size();
+                control.Add(vChecks);
+            }
+            BOOST_REQUIRE(control.Wait());
+            if (FakeCheckCheckCompletion::n_calls != i) {
+                BOOST_REQUIRE_EQUAL(FakeCheckCheckCompletion::n_calls, i);
+            }
         }
+        small_queue->StopWorkerThreads();
     }
-    small_queue->StopWorkerThreads();
 }
 
 /** Test that 0 checks is correct
@@ -183,81 +180,88 @@ BOOST_AUTO_TEST_CASE(test_CheckQueue_Correct_Random) {
 
 /** Test that failing checks are caught */
 BOOST_AUTO_TEST_CASE(test_CheckQueue_Catches_Failure) {
-    auto fail_queue = std::make_unique<Failing_Queue>(QUEUE_BATCH_SIZE);
+    for (const auto engine : ENGINES) {
+        auto fail_queue = MakeCheckQueue<FailingCheck>(engine, QUEUE_BATCH_SIZE);
 
-    fail_queue->StartWorkerThreads(SCRIPT_CHECK_THREADS);
+        fail_queue->StartWorkerThreads(SCRIPT_CHECK_THREADS);
 
-    for (size_t i = 0; i < 1001; ++i) {
-        CCheckQueueControl<FailingCheck> control(fail_queue.get());
-        size_t remaining = i;
-        while (remaining) {
-            size_t r = InsecureRandRange(10);
+        for (size_t i = 0; i < 1001; ++i) {
+            CCheckQueueControl<FailingCheck> control(fail_queue.get());
+            size_t remaining = i;
+            while (remaining) {
+                size_t r = InsecureRandRange(10);
 
-            std::vector<FailingCheck> vChecks;
-            vChecks.reserve(r);
-            for (size_t k = 0; k < r && remaining; k++, remaining--) {
-                vChecks.emplace_back(remaining == 1);
+                std::vector<FailingCheck> vChecks;
+                vChecks.reserve(r);
+                for (size_t k = 0; k < r && remaining; k++, remaining--) {
+                    vChecks.emplace_back(remaining == 1);
+                }
+                control.Add(vChecks);
+            }
+            bool success = control.Wait();
+            if (i > 0) {
+                BOOST_REQUIRE(!success);
+            } else if (i == 0) {
+                BOOST_REQUIRE(success);
             }
-            control.Add(vChecks);
-        }
-        bool success = control.Wait();
-        if (i > 0) {
-            BOOST_REQUIRE(!success);
-        } else if (i == 0) {
-            BOOST_REQUIRE(success);
         }
+        fail_queue->StopWorkerThreads();
     }
-    fail_queue->StopWorkerThreads();
 }
 // Test that a block validation which fails does not interfere with
 // future blocks, ie, the bad state is cleared.
 BOOST_AUTO_TEST_CASE(test_CheckQueue_Recovers_From_Failure) {
-    auto fail_queue = std::make_unique<Failing_Queue>(QUEUE_BATCH_SIZE);
-    fail_queue->StartWorkerThreads(SCRIPT_CHECK_THREADS);
+    for (const auto engine : ENGINES) {
+        auto fail_queue = MakeCheckQueue<FailingCheck>(engine, QUEUE_BATCH_SIZE);
+        fail_queue->StartWorkerThreads(SCRIPT_CHECK_THREADS);
 
-    for (auto times = 0; times < 10; ++times) {
-        for (const bool end_fails : {true, false}) {
-            CCheckQueueControl<FailingCheck> control(fail_queue.get());
-            {
-                std::vector<FailingCheck> vChecks;
-                vChecks.resize(100, false);
-                vChecks[99] = end_fails;
-                control.Add(vChecks);
+        for (auto times = 0; times < 10; ++times) {
+            for (const bool end_fails : {true, false}) {
+                CCheckQueueControl<FailingCheck> control(fail_queue.get());
+                {
+                    std::vector<FailingCheck> vChecks;
+                    vChecks.resize(100, false);
+                    vChecks[99] = end_fails;
+                    control.Add(vChecks);
+                }
+                bool r = control.Wait();
+                BOOST_REQUIRE(r != end_fails);
             }
-            bool r = control.Wait();
-            BOOST_REQUIRE(r != end_fails);
         }
+        fail_queue->StopWorkerThreads();
     }
-    fail_queue->StopWorkerThreads();
 }
 
 // Test that unique checks are actually all called individually, rather than
 // just one check being called repeatedly. Test that checks are not called
 // more than once as well
 BOOST_AUTO_TEST_CASE(test_CheckQueue_UniqueCheck) {
-    auto queue = std::make_unique<Unique_Queue>(QUEUE_BATCH_SIZE);
-    queue->StartWorkerThreads(SCRIPT_CHECK_THREADS);
+    for (const auto engine : ENGINES) {
+        auto queue = MakeCheckQueue<UniqueCheck>(engine, QUEUE_BATCH_SIZE);
+        UniqueCheck::results.clear();
+        queue->StartWorkerThreads(SCRIPT_CHECK_THREADS);
 
-    size_t COUNT = 100000;
-    size_t total = COUNT;
-    {
-        CCheckQueueControl<UniqueCheck> control(queue.get());
-        while (total) {
-            size_t r = InsecureRandRange(10);
-            std::vector<UniqueCheck> vChecks;
-            for (size_t k = 0; k < r && total; k++) {
-                vChecks.emplace_back(--total);
+        size_t COUNT = 100000;
+        size_t total = COUNT;
+        {
+            CCheckQueueControl<UniqueCheck> control(queue.get());
+            while (total) {
+                size_t r = InsecureRandRange(10);
+                std::vector<UniqueCheck> vChecks;
+                for (size_t k = 0; k < r && total; k++) {
+                    vChecks.emplace_back(--total);
+                }
+                control.Add(vChecks);
             }
-            control.Add(vChecks);
         }
+        bool r = true;
+        BOOST_REQUIRE_EQUAL(UniqueCheck::results.size(), COUNT);
+        for (size_t i = 0; i < COUNT; ++i) {
+            r = r && UniqueCheck::results.count(i) == 1;
+        }
+        BOOST_REQUIRE(r);
+        queue->StopWorkerThreads();
     }
-    bool r = true;
-    BOOST_REQUIRE_EQUAL(UniqueCheck::results.size(), COUNT);
-    for (size_t i = 0; i < COUNT; ++i) {
-        r = r && UniqueCheck::results.count(i) == 1;
-    }
-    BOOST_REQUIRE(r);
-    queue->StopWorkerThreads();
 }
 
 // Test that blocks which might allocate lots of memory free their memory
@@ -267,129 +271,135 @@ BOOST_AUTO_TEST_CASE(test_CheckQueue_UniqueCheck) {
 // checks might mean leaving a check un-swapped out, and decreasing by 1 each
 // time could leave the data hanging across a sequence of blocks.
 BOOST_AUTO_TEST_CASE(test_CheckQueue_Memory) {
-    auto queue = std::make_unique<Memory_Queue>(QUEUE_BATCH_SIZE);
-    queue->StartWorkerThreads(SCRIPT_CHECK_THREADS);
-    for (size_t i = 0; i < 1000; ++i) {
-        size_t total = i;
-        {
-            CCheckQueueControl<MemoryCheck> control(queue.get());
-            while (total) {
-                size_t r = InsecureRandRange(10);
-                std::vector<MemoryCheck> vChecks;
-                for (size_t k = 0; k < r && total; k++) {
-                    total--;
-                    // Each iteration leaves data at the front, back, and middle
-                    // to catch any sort of deallocation failure
-                    vChecks.emplace_back(total == 0 || total == i ||
-                                         total == i / 2);
+    for (const auto engine : ENGINES) {
+        auto queue = MakeCheckQueue<MemoryCheck>(engine, QUEUE_BATCH_SIZE);
+        queue->StartWorkerThreads(SCRIPT_CHECK_THREADS);
+        for (size_t i = 0; i < 1000; ++i) {
+            size_t total = i;
+            {
+                CCheckQueueControl<MemoryCheck> control(queue.get());
+                while (total) {
+                    size_t r = InsecureRandRange(10);
+                    std::vector<MemoryCheck> vChecks;
+                    for (size_t k = 0; k < r && total; k++) {
+                        total--;
+                        // Each iteration leaves data at the front, back, and middle
+                        // to catch any sort of deallocation failure
+                        vChecks.emplace_back(total == 0 || total == i ||
+                                             total == i / 2);
+                    }
+                    control.Add(vChecks);
                 }
-                control.Add(vChecks);
             }
+            BOOST_REQUIRE_EQUAL(MemoryCheck::fake_allocated_memory, 0U);
         }
-        BOOST_REQUIRE_EQUAL(MemoryCheck::fake_allocated_memory, 0U);
+        queue->StopWorkerThreads();
     }
-    queue->StopWorkerThreads();
 }
 
 // Test that a new verification cannot occur until all checks
 // have been destructed
 BOOST_AUTO_TEST_CASE(test_CheckQueue_FrozenCleanup) {
-    auto queue = std::make_unique<FrozenCleanup_Queue>(QUEUE_BATCH_SIZE);
-    bool fails = false;
-    queue->StartWorkerThreads(SCRIPT_CHECK_THREADS);
-    std::thread t0([&]() {
-        CCheckQueueControl<FrozenCleanupCheck> control(queue.get());
-        std::vector<FrozenCleanupCheck> vChecks(1);
-        // Freezing can't be the default initialized behavior given how the
-        // queue
-        // swaps in default initialized Checks (otherwise freezing destructor
-        // would get called twice).
-        vChecks[0].should_freeze = true;
-        control.Add(vChecks);
-        BOOST_CHECK(control.Wait()); // Hangs here
-    });
-    {
-        std::unique_lock<std::mutex> l(FrozenCleanupCheck::m);
-        // Wait until the queue has finished all jobs and frozen
-        FrozenCleanupCheck::cv.wait(
-            l, []() { return FrozenCleanupCheck::nFrozen == 1; });
-    }
-    // Try to get control of the queue a bunch of times
-    for (auto x = 0; x < 100 && !fails; ++x) {
-        fails = queue->m_control_mutex.try_lock();
-    }
-    {
-        // Unfreeze (we need lock n case of spurious wakeup)
-        std::unique_lock<std::mutex> l(FrozenCleanupCheck::m);
-        FrozenCleanupCheck::nFrozen = 0;
+    for (const auto engine : ENGINES) {
+        auto queue = MakeCheckQueue<FrozenCleanupCheck>(engine, QUEUE_BATCH_SIZE);
+        bool fails = false;
+        queue->StartWorkerThreads(SCRIPT_CHECK_THREADS);
+        std::thread t0([&]() {
+            CCheckQueueControl<FrozenCleanupCheck> control(queue.get());
+            std::vector<FrozenCleanupCheck> vChecks(1);
+            // Freezing can't be the default initialized behavior given how the
+            // queue
+            // swaps in default initialized Checks (otherwise freezing destructor
+            // would get called twice).
+            vChecks[0].should_freeze = true;
+            control.Add(vChecks);
+            BOOST_CHECK(control.Wait()); // Hangs here
+        });
+        {
+            std::unique_lock<std::mutex> l(FrozenCleanupCheck::m);
+            // Wait until the queue has finished all jobs and frozen
+            FrozenCleanupCheck::cv.wait(
+                l, []() { return FrozenCleanupCheck::nFrozen == 1; });
+        }
+        // Try to get control of the queue a bunch of times
+        for (auto x = 0; x < 100 && !fails; ++x) {
+            fails = queue->m_control_mutex.try_lock();
+        }
+        {
+            // Unfreeze (we need lock n case of spurious wakeup)
+            std::unique_lock<std::mutex> l(FrozenCleanupCheck::m);
+            FrozenCleanupCheck::nFrozen = 0;
+        }
+        // Awaken frozen destructor
+        FrozenCleanupCheck::cv.notify_one();
+        // Wait for control to finish
+        t0.join();
+        BOOST_REQUIRE(!fails);
+        queue->StopWorkerThreads();
     }
-    // Awaken frozen destructor
-    FrozenCleanupCheck::cv.notify_one();
-    // Wait for control to finish
-    t0.join();
-    BOOST_REQUIRE(!fails);
-    queue->StopWorkerThreads();
 }
 
 /** Test that CCheckQueueControl is threadsafe */
 BOOST_AUTO_TEST_CASE(test_CheckQueueControl_Locks) {
-    auto queue = std::make_unique<Standard_Queue>(QUEUE_BATCH_SIZE);
-    {
-        std::vector<std::thread> threadGroup;
-        std::atomic<int> nThreads{0};
-        std::atomic<int> fails{0};
-        for (size_t i = 0; i < 3; ++i) {
-            threadGroup.emplace_back([&] {
-                CCheckQueueControl<FakeCheck> control(queue.get());
-                // While sleeping, no other thread should execute to this point
-                auto observed = ++nThreads;
-                MilliSleep(10);
-                fails += observed != nThreads;
-            });
-        }
-        for (auto &thread : threadGroup) {
-            thread.join();
+    for (const auto engine : ENGINES) {
+        auto queue = MakeCheckQueue<FakeCheck>(engine, QUEUE_BATCH_SIZE);
+        {
+            std::vector<std::thread> threadGroup;
+            std::atomic<int> nThreads{0};
+            std::atomic<int> fails{0};
+            for (size_t i = 0; i < 3; ++i) {
+                threadGroup.emplace_back([&] {
+                    CCheckQueueControl<FakeCheck> control(queue.get());
+                    // While sleeping, no other thread should execute to this point
+                    auto observed = ++nThreads;
+                    MilliSleep(10);
+                    fails += observed != nThreads;
+                });
+            }
+            for (auto &thread : threadGroup) {
+                thread.join();
+            }
+            BOOST_REQUIRE_EQUAL(fails, 0);
         }
-        BOOST_REQUIRE_EQUAL(fails, 0);
-    }
-    {
-        std::vector<std::thread> threadGroup;
-        std::mutex m;
-        std::condition_variable cv;
-        bool has_lock{false};
-        bool has_tried{false};
-        bool done{false};
-        bool done_ack{false};
         {
-            std::unique_lock<std::mutex> l(m);
-            threadGroup.emplace_back([&] {
-                CCheckQueueControl<FakeCheck> control(queue.get());
-                std::unique_lock<std::mutex> ll(m);
-                has_lock = true;
+            std::vector<std::thread> threadGroup;
+            std::mutex m;
+            std::condition_variable cv;
+            bool has_lock{false};
+            bool has_tried{false};
+            bool done{false};
+            bool done_ack{false};
+            {
+                std::unique_lock<std::mutex> l(m);
+                threadGroup.emplace_back([&] {
+                    CCheckQueueControl<FakeCheck> control(queue.get());
+                    std::unique_lock<std::mutex> ll(m);
+                    has_lock = true;
+                    cv.notify_one();
+                    cv.wait(ll, [&] { return has_tried; });
+                    done = true;
+                    cv.notify_one();
+                    // Wait until the done is acknowledged
+                    //
+                    cv.wait(ll, [&] { return done_ack; });
+                });
+                // Wait for thread to get the lock
+                cv.wait(l, [&]() { return has_lock; });
+                bool fails = false;
+                for (auto x = 0; x < 100 && !fails; ++x) {
+                    fails = queue->m_control_mutex.try_lock();
+                }
+                has_tried = true;
                 cv.notify_one();
-                cv.wait(ll, [&] { return has_tried; });
-                done = true;
+                cv.wait(l, [&]() { return done; });
+                // Acknowledge the done
+                done_ack = true;
                 cv.notify_one();
-                // Wait until the done is acknowledged
-                //
-                cv.wait(ll, [&] { return done_ack; });
-            });
-            // Wait for thread to get the lock
-            cv.wait(l, [&]() { return has_lock; });
-            bool fails = false;
-            for (auto x = 0; x < 100 && !fails; ++x) {
-                fails = queue->m_control_mutex.try_lock();
+                BOOST_REQUIRE(!fails);
+            }
+            for (auto &thread : threadGroup) {
+                thread.join();
             }
-            has_tried = true;
-            cv.notify_one();
-            cv.wait(l, [&]() { return done; });
-            // Acknowledge the done
-            done_ack = true;
-            cv.notify_one();
-            BOOST_REQUIRE(!fails);
-        }
-        for (auto &thread : threadGroup) {
-            thread.join();
         }
     }
 }
@@ -0,0 +1,107 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <coinsflush.h>
+
+#include <script/script.h>
+#include <txdb.h>
+
+#include <test/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(coinsflush_tests, BasicTestingSetup)
+
+namespace {
+Coin MakeCoin(uint32_t height) {
+    return Coin(CTxOut(int64_t(height) * SATOSHI, CScript() << OP_TRUE), height, false);
+}
+
+/** Check that view has exactly the coins of expected, among outpoints. */
+void CheckCoins(const CCoinsView &view, const std::vector<COutPoint> &outpoints,
+                const std::map<COutPoint, uint32_t> &expected) {
+    for (const COutPoint &outpoint : outpoints) {
+        Coin coin;
+        const auto it = expected.find(outpoint);
+        BOOST_CHECK_EQUAL(view.GetCoin(outpoint, coin), it != expected.end());
+        BOOST_CHECK_EQUAL(view.HaveCoin(outpoint), it != expected.end());
+        if (it != expected.end()) {
+            BOOST_CHECK_EQUAL(coin.GetHeight(), it->second);
+        }
+    }
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(flush_in_background) {
+    CCoinsViewDB db(1 << 20, true);
+    CCoinsViewFlusher flusher(&db);
+
+    std::vector<COutPoint> outpoints;
+    for (uint32_t i = 0; i < 2000; ++i) {
+        outpoints.emplace_back(TxId(InsecureRand256()), i % 3);
+    }
+    std::map<COutPoint, uint32_t> expected;
+
+    for (int round = 0; round < 10; ++round) {
+        // Until started, flushes are written right away.
+        if (round == 2) {
+            flusher.Start();
+        }
+
+        CCoinsViewCache cache(&flusher);
+        for (int i = 0; i < 500; ++i) {
+            const COutPoint &outpoint = outpoints[InsecureRandRange(outpoints.size())];
+            if (expected.count(outpoint)) {
+                BOOST_CHECK(cache.SpendCoin(outpoint));
+                expected.erase(outpoint);
+            } else {
+                const uint32_t height = round * 1000 + i;
+                cache.AddCoin(outpoint, MakeCoin(height), false);
+                expected.emplace(outpoint, height);
+            }
+        }
+        const BlockHash hashBlock(InsecureRand256());
+        cache.SetBestBlock(hashBlock);
+        BOOST_CHECK(cache.Flush());
+        BOOST_CHECK_EQUAL(cache.GetCacheSize(), 0U);
+        BOOST_CHECK_EQUAL(flusher.IsFlushing(), round >= 2);
+
+        // Whether or not the write is complete, lookups see the flushed coins.
+        BOOST_CHECK(flusher.GetBestBlock() == hashBlock);
+        CheckCoins(cache, outpoints, expected);
+        CheckCoins(flusher, outpoints, expected);
+
+        // Every other round, the next flush waits for this one instead.
+        if (round % 2 == 0) {
+            BOOST_CHECK(flusher.Wait());
+            BOOST_CHECK(!flusher.IsFlushing());
+            BOOST_CHECK(flusher.IsWriteComplete());
+            BOOST_CHECK(db.GetBestBlock() == hashBlock);
+            BOOST_CHECK(db.GetHeadBlocks().empty());
+            CheckCoins(db, outpoints, expected);
+        }
+    }
+
+    flusher.Stop();
+    // Stopping waits for the write in progress; the snapshot stays readable
+    // until released.
+    BOOST_CHECK(flusher.IsWriteComplete());
+    CheckCoins(flusher, outpoints, expected);
+    BOOST_CHECK(flusher.Wait());
+    CheckCoins(db, outpoints, expected);
+
+    // Flushes are written right away again.
+    CCoinsViewCache cache(&flusher);
+    cache.SpendCoin(expected.begin()->first);
+    expected.erase(expected.begin());
+    cache.SetBestBlock(BlockHash(InsecureRand256()));
+    BOOST_CHECK(cache.Flush());
+    BOOST_CHECK(!flusher.IsFlushing());
+    CheckCoins(db, outpoints, expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,169 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <coinsprefetch.h>
+
+#include <primitives/block.h>
+#include <script/script.h>
+
+#include <test/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(coinsprefetch_tests, BasicTestingSetup)
+
+namespace {
+/** A read-only view that is safe to query from several threads, like CCoinsViewDB. */
+class CCoinsViewFakeDB : public CCoinsView {
+    std::map<COutPoint, Coin> coins;
+    COutPoint failing;
+
+public:
+    mutable std::atomic<int> lookups{0};
+
+    void Add(const COutPoint &outpoint, const Coin &coin) { coins.emplace(outpoint, coin); }
+    void SetFailing(const COutPoint &outpoint) { failing = outpoint; }
+
+    bool GetCoin(const COutPoint &outpoint, Coin &coin) const override {
+        ++lookups;
+        if (outpoint == failing) {
+            throw std::runtime_error("database error");
+        }
+        const auto it = coins.find(outpoint);
+        if (it == coins.end()) {
+            return false;
+        }
+        coin = it->second;
+        return true;
+    }
+};
+
+Coin MakeCoin(uint32_t height) {
+    return Coin(CTxOut(int64_t(height) * SATOSHI, CScript() << OP_TRUE), height, false);
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(fetch_and_stage) {
+    CCoinsViewFakeDB db;
+    std::vector<COutPoint> outpoints;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        outpoints.emplace_back(TxId(InsecureRand256()), i);
+        // Only the even outpoints exist.
+        if (i % 2 == 0) {
+            db.Add(outpoints.back(), MakeCoin(i + 1));
+        }
+    }
+    db.SetFailing(outpoints[3]);
+
+    CCoinsViewCache cache(&db);
+    CCoinsPrefetcher prefetcher;
+    prefetcher.Start(3);
+    BOOST_CHECK(prefetcher.IsActive());
+    for (int round = 0; round < 5; ++round) {
+        db.lookups = 0;
+        CCoinsViewPrefetched staging(&cache);
+        prefetcher.Fetch(db, outpoints, staging);
+        BOOST_CHECK_EQUAL(db.lookups, 1000);
+        // The failed lookup is not staged.
+        BOOST_CHECK_EQUAL(staging.GetStagedCount(), 999U);
+
+        db.lookups = 0;
+        for (uint32_t i = 0; i < 1000; ++i) {
+            if (i == 3) {
+                continue;
+            }
+            Coin coin;
+            BOOST_CHECK_EQUAL(staging.GetCoin(outpoints[i], coin), i % 2 == 0);
+            if (i % 2 == 0) {
+                BOOST_CHECK_EQUAL(coin.GetHeight(), i + 1);
+            }
+        }
+        // Everything was answered by the staged coins.
+        BOOST_CHECK_EQUAL(db.lookups, 0);
+        BOOST_CHECK_EQUAL(staging.GetHits(), 999U);
+        BOOST_CHECK_EQUAL(staging.GetMisses(), 0U);
+
+        // Other lookups go to the backing view.
+        Coin coin;
+        BOOST_CHECK_THROW(staging.GetCoin(outpoints[3], coin), std::runtime_error);
+        BOOST_CHECK_EQUAL(staging.GetMisses(), 1U);
+    }
+    prefetcher.Stop();
+    BOOST_CHECK(!prefetcher.IsActive());
+}
+
+BOOST_AUTO_TEST_CASE(staging_layer_writes_through) {
+    CCoinsViewFakeDB db;
+    const COutPoint spent(TxId(InsecureRand256()), 0);
+    const COutPoint kept(TxId(InsecureRand256()), 1);
+    db.Add(spent, MakeCoin(10));
+    db.Add(kept, MakeCoin(11));
+
+    CCoinsViewCache tip(&db);
+    CCoinsPrefetcher prefetcher;
+    prefetcher.Start(2);
+    {
+        CCoinsViewPrefetched staging(&tip);
+        prefetcher.Fetch(db, {spent, kept}, staging);
+
+        CCoinsViewCache view(&staging);
+        BOOST_CHECK(view.SpendCoin(spent));
+        const COutPoint created(TxId(InsecureRand256()), 0);
+        view.AddCoin(created, MakeCoin(12), false);
+        BOOST_CHECK(view.Flush());
+
+        // The changes reached the cache below the staging layer.
+        BOOST_CHECK(tip.HaveEntryInCache(spent));
+        BOOST_CHECK(!tip.HaveCoin(spent));
+        BOOST_CHECK(tip.HaveCoin(created));
+        // Coins that were only read stay out of it.
+        BOOST_CHECK(!tip.HaveEntryInCache(kept));
+    }
+    prefetcher.Stop();
+}
+
+BOOST_AUTO_TEST_CASE(uncached_outpoints) {
+    CCoinsViewFakeDB db;
+    CCoinsViewCache cache(&db);
+
+    const COutPoint cached(TxId(InsecureRand256()), 0);
+    const COutPoint uncached(TxId(InsecureRand256()), 0);
+    const COutPoint spentInCache(TxId(InsecureRand256()), 0);
+    cache.AddCoin(cached, MakeCoin(1), false);
+    // A coin that is spent in the cache but still in the database must not be
+    // fetched again.
+    db.Add(spentInCache, MakeCoin(2));
+    BOOST_CHECK(cache.SpendCoin(spentInCache));
+    BOOST_CHECK(cache.HaveEntryInCache(spentInCache));
+
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vout.resize(1);
+
+    CMutableTransaction parent;
+    parent.vin.emplace_back(cached);
+    parent.vin.emplace_back(uncached);
+    parent.vin.emplace_back(spentInCache);
+    parent.vout.resize(1);
+
+    CMutableTransaction child;
+    child.vin.emplace_back(COutPoint(parent.GetId(), 0));
+    child.vin.emplace_back(uncached);
+    child.vout.resize(1);
+
+    CBlock block;
+    block.vtx.push_back(MakeTransactionRef(coinbase));
+    block.vtx.push_back(MakeTransactionRef(parent));
+    block.vtx.push_back(MakeTransactionRef(child));
+
+    const auto outpoints = CCoinsPrefetcher::GetUncachedOutpoints(block, cache);
+    BOOST_CHECK(outpoints == std::vector<COutPoint>({uncached, uncached}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -84,6 +84,41 @@ BOOST_AUTO_TEST_CASE(dbwrapper_batch) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(dbwrapper_batch_append) {
+    // Perform tests both obfuscated and non-obfuscated.
+    for (const bool obfuscate : {false, true}) {
+        fs::path ph = SetDataDir(std::string("dbwrapper_batch_append")
+                                     .append(obfuscate ? "_true" : "_false"));
+        CDBWrapper dbw(ph, (1 << 20), true, false, obfuscate);
+
+        char key = 'i';
+        uint256 in = InsecureRand256();
+        char key2 = 'j';
+        uint256 in2 = InsecureRand256();
+        uint256 in3 = InsecureRand256();
+
+        uint256 res;
+        CDBBatch batch(dbw);
+        CDBBatch other(dbw);
+
+        batch.Write(key, in);
+        batch.Write(key2, in2);
+        other.Erase(key);
+        other.Write(key2, in3);
+
+        // The changes of other come after those of batch.
+        const size_t size_estimate =
+            batch.SizeEstimate() + other.SizeEstimate();
+        batch.Append(other);
+        BOOST_CHECK_EQUAL(batch.SizeEstimate(), size_estimate);
+        BOOST_CHECK(dbw.WriteBatch(batch));
+
+        BOOST_CHECK(dbw.Read(key, res) == false);
+        BOOST_CHECK(dbw.Read(key2, res));
+        BOOST_CHECK_EQUAL(res.ToString(), in3.ToString());
+    }
+}
+
 BOOST_AUTO_TEST_CASE(dbwrapper_iterator) {
     // Perform tests both obfuscated and non-obfuscated.
     for (const bool obfuscate : {false, true}) {
@@ -22,27 +22,13 @@
 #include <validation.h>
 
 #include <test/setup_common.h>
+#include <test/util.h>
 
 #include <boost/test/unit_test.hpp>
 
 #include <cstdint>
 #include <cstring>
 
-struct CConnmanTest : public CConnman {
-    using CConnman::CConnman;
-    void AddNode(CNode &node) {
-        LOCK(cs_vNodes);
-        vNodes.push_back(&node);
-    }
-    void ClearNodes() {
-        LOCK(cs_vNodes);
-        for (CNode *node : vNodes) {
-            delete node;
-        }
-        vNodes.clear();
-    }
-};
-
 static CService ip(uint32_t i) {
     struct in_addr s;
     s.s_addr = i;
@@ -131,4 +131,76 @@ BOOST_AUTO_TEST_CASE(flatfile_flush) {
     BOOST_CHECK_EQUAL(fs::file_size(seq.FileName(FlatFilePos(0, 1))), 1);
 }
 
+#ifndef WIN32
+BOOST_AUTO_TEST_CASE(flatfile_map) {
+    auto data_dir = SetDataDir("flatfile_test");
+    FlatFileSeq seq(data_dir, "a", 100);
+    FlatFileMapCache maps(2);
+
+    const auto write = [&](const FlatFilePos &pos, const std::string &text) {
+        CAutoFile file(seq.Open(pos), SER_DISK, CLIENT_VERSION);
+        file.write(text.data(), text.size());
+    };
+    const auto read = [](const std::shared_ptr<const MappedFlatFile> &file,
+                         size_t pos, size_t size) {
+        const auto data = file->Data().subspan(pos, size);
+        return std::string(data.begin(), data.end());
+    };
+
+    // Files which don't exist, or are too small, aren't mapped.
+    BOOST_CHECK(!maps.Get(seq, FlatFilePos(0, 0), 1));
+    write(FlatFilePos(0, 0), "first");
+    BOOST_CHECK(!maps.Get(seq, FlatFilePos(0, 0), 6));
+    const auto file0 = maps.Get(seq, FlatFilePos(0, 1), 4);
+    BOOST_REQUIRE(file0);
+    BOOST_CHECK_EQUAL(read(file0, 1, 4), "irst");
+    BOOST_CHECK(maps.Get(seq, FlatFilePos(0, 0), 5) == file0);
+
+    // Appending to a file maps it again, once the mapping is too small. The
+    // previous mapping remains valid.
+    write(FlatFilePos(0, 5), "second");
+    const auto file0_grown = maps.Get(seq, FlatFilePos(0, 5), 6);
+    BOOST_REQUIRE(file0_grown);
+    BOOST_CHECK(file0_grown != file0);
+    BOOST_CHECK_EQUAL(read(file0_grown, 0, 11), "firstsecond");
+    BOOST_CHECK_EQUAL(read(file0, 0, 5), "first");
+    BOOST_CHECK_EQUAL(maps.size(), 1U);
+
+    // Writes within the mapping are visible through it.
+    bool out_of_space;
+    seq.Allocate(FlatFilePos(1, 0), 1, out_of_space);
+    const auto file1 = maps.Get(seq, FlatFilePos(1, 0), 100);
+    BOOST_REQUIRE(file1);
+    write(FlatFilePos(1, 10), "third");
+    BOOST_CHECK_EQUAL(read(file1, 10, 5), "third");
+
+    // The least recently used file is evicted.
+    BOOST_CHECK(maps.Get(seq, FlatFilePos(0, 0), 1) == file0_grown);
+    write(FlatFilePos(2, 0), "fourth");
+    BOOST_CHECK(maps.Get(seq, FlatFilePos(2, 0), 6));
+    BOOST_CHECK_EQUAL(maps.size(), 2U);
+    BOOST_CHECK(maps.Get(seq, FlatFilePos(0, 0), 1) == file0_grown);
+    const auto file1_again = maps.Get(seq, FlatFilePos(1, 10), 5);
+    BOOST_REQUIRE(file1_again);
+    BOOST_CHECK(file1_again != file1);
+    BOOST_CHECK_EQUAL(read(file1, 10, 5), "third");
+
+    // Removed files are mapped again.
+    maps.Remove(1);
+    BOOST_CHECK_EQUAL(maps.size(), 1U);
+    BOOST_CHECK(maps.Get(seq, FlatFilePos(1, 10), 5) != file1_again);
+
+    // So are all files once cleared.
+    maps.Clear();
+    BOOST_CHECK_EQUAL(maps.size(), 0U);
+    BOOST_CHECK(maps.Get(seq, FlatFilePos(0, 0), 1) != file0_grown);
+
+    // No files are mapped with a limit of 0.
+    maps.SetMaxFiles(0);
+    BOOST_CHECK_EQUAL(maps.size(), 0U);
+    BOOST_CHECK(!maps.Get(seq, FlatFilePos(0, 0), 1));
+    BOOST_CHECK_EQUAL(read(file0_grown, 0, 11), "firstsecond");
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END()
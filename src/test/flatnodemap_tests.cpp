@@ -0,0 +1,180 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <flatnodemap.h>
+
+#include <coins.h>
+
+#include <test/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(flatnodemap_tests, BasicTestingSetup)
+
+namespace {
+/** Only 8 distinct hashes, so that the probe sequences are long and overlap. */
+struct CollidingHasher {
+    size_t operator()(uint32_t key) const { return key % 8; }
+};
+
+/** Compare the contents of a flatnodemap with those of a std::map, both ways. */
+template <typename Map>
+void CheckEqual(const Map &map, const std::map<uint32_t, std::string> &expected) {
+    BOOST_CHECK_EQUAL(map.size(), expected.size());
+    BOOST_CHECK_EQUAL(map.empty(), expected.empty());
+    size_t n = 0;
+    for (const auto &[key, value] : map) {
+        const auto it = expected.find(key);
+        BOOST_REQUIRE(it != expected.end());
+        BOOST_CHECK_EQUAL(value, it->second);
+        ++n;
+    }
+    BOOST_CHECK_EQUAL(n, expected.size());
+    for (const auto &[key, value] : expected) {
+        const auto it = map.find(key);
+        BOOST_REQUIRE(it != map.end());
+        BOOST_CHECK_EQUAL(it->second, value);
+    }
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(random_operations) {
+    flatnodemap<uint32_t, std::string, CollidingHasher> map;
+    std::map<uint32_t, std::string> expected;
+    for (int i = 0; i < 20000; ++i) {
+        const uint32_t key = InsecureRandRange(500);
+        switch (InsecureRandRange(4)) {
+            case 0: {
+                const auto [it, inserted] = map.try_emplace(key, std::to_string(i));
+                BOOST_CHECK_EQUAL(inserted, expected.emplace(key, std::to_string(i)).second);
+                BOOST_CHECK_EQUAL(it->first, key);
+                BOOST_CHECK_EQUAL(it->second, expected[key]);
+                break;
+            }
+            case 1:
+                map[key] = std::to_string(i);
+                expected[key] = std::to_string(i);
+                break;
+            case 2:
+                BOOST_CHECK_EQUAL(map.erase(key), expected.erase(key));
+                break;
+            case 3: {
+                const auto it = map.find(key);
+                if (it != map.end()) {
+                    BOOST_CHECK_EQUAL(map.count(key), 1U);
+                    BOOST_CHECK(map.erase(it) == std::next(it));
+                    expected.erase(key);
+                } else {
+                    BOOST_CHECK_EQUAL(map.count(key), 0U);
+                    BOOST_CHECK(!expected.count(key));
+                }
+                break;
+            }
+        }
+        if (i % 1000 == 0) {
+            CheckEqual(map, expected);
+        }
+    }
+    CheckEqual(map, expected);
+
+    // Copies and moves.
+    const auto copy = map;
+    CheckEqual(copy, expected);
+    auto moved = std::move(map);
+    CheckEqual(moved, expected);
+    moved.clear();
+    CheckEqual(moved, {});
+    BOOST_CHECK(moved.begin() == moved.end());
+    CheckEqual(copy, expected);
+}
+
+BOOST_AUTO_TEST_CASE(stable_references) {
+    flatnodemap<uint32_t, std::string, CollidingHasher> map;
+    std::vector<const std::string *> values;
+    for (uint32_t key = 0; key < 1000; ++key) {
+        values.push_back(&map.try_emplace(key, std::to_string(key)).first->second);
+    }
+    // Erasing, inserting and growing the table do not move the elements.
+    for (uint32_t key = 0; key < 1000; key += 2) {
+        map.erase(key);
+    }
+    for (uint32_t key = 1000; key < 5000; ++key) {
+        map[key] = std::to_string(key);
+    }
+    for (uint32_t key = 1; key < 1000; key += 2) {
+        const auto it = map.find(key);
+        BOOST_REQUIRE(it != map.end());
+        BOOST_CHECK_EQUAL(&it->second, values[key]);
+        BOOST_CHECK_EQUAL(*values[key], std::to_string(key));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(erase_while_iterating) {
+    flatnodemap<uint32_t, std::string, CollidingHasher> map;
+    std::map<uint32_t, std::string> expected;
+    for (uint32_t key = 0; key < 3000; ++key) {
+        map.try_emplace(key, std::to_string(key));
+        expected.emplace(key, std::to_string(key));
+    }
+
+    // As in CCoinsViewDB::BatchWrite: erase every other element through a
+    // copy of the iterator, which must still be valid afterwards.
+    size_t visited = 0;
+    for (auto it = map.begin(); it != map.end();) {
+        ++visited;
+        auto itOld = it++;
+        if (itOld->first % 2 == 0) {
+            expected.erase(itOld->first);
+            map.erase(itOld);
+        }
+    }
+    BOOST_CHECK_EQUAL(visited, 3000U);
+    CheckEqual(map, expected);
+
+    // As in CCoinsViewCache::BatchWrite: erase everything.
+    visited = 0;
+    for (auto it = map.begin(); it != map.end(); it = map.erase(it)) {
+        ++visited;
+    }
+    BOOST_CHECK_EQUAL(visited, 1500U);
+    CheckEqual(map, {});
+}
+
+BOOST_AUTO_TEST_CASE(keys_spread_across_buckets) {
+    // Truncate the hashes to what a 32-bit size_t holds.
+    struct Hasher32 : SaltedOutpointHasher {
+        size_t operator()(const COutPoint &o) const { return uint32_t(SaltedOutpointHasher::operator()(o)); }
+    };
+    flatnodemap<COutPoint, int, Hasher32> map;
+    for (uint32_t i = 0; i < 10000; ++i) {
+        map.try_emplace(COutPoint(TxId(InsecureRand256()), i));
+    }
+    std::set<size_t> buckets;
+    for (const auto &[outpoint, value] : map) {
+        buckets.insert(map.bucket(outpoint));
+    }
+    // With 16384 slots, random keys start from about 7500 distinct ones.
+    BOOST_CHECK_EQUAL(map.bucket_count(), 16384U);
+    BOOST_CHECK_GT(buckets.size(), 6000U);
+}
+
+BOOST_AUTO_TEST_CASE(coins_map_memory_usage) {
+    CCoinsMap map;
+    std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> reference;
+    for (uint32_t i = 0; i < 100000; ++i) {
+        const COutPoint outpoint(TxId(InsecureRand256()), i);
+        map.try_emplace(outpoint);
+        reference.try_emplace(outpoint);
+    }
+    // Leave some room for the different load factors at this size.
+    BOOST_CHECK_LT(memusage::DynamicUsage(map) * 10, memusage::DynamicUsage(reference) * 9);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -166,6 +166,22 @@ BOOST_AUTO_TEST_CASE(siphash) {
         BOOST_CHECK_EQUAL(SipHashUint256(k1, k2, x), sip256.Finalize());
         BOOST_CHECK_EQUAL(SipHashUint256Extra(k1, k2, x, n), sip288.Finalize());
     }
+
+    // Check consistency between SipHashUint256Batch and SipHashUint256, for
+    // batches that are, or not, a multiple of the number of lanes.
+    for (size_t count = 0; count < 20; ++count) {
+        uint64_t k1 = ctx.rand64();
+        uint64_t k2 = ctx.rand64();
+        std::vector<uint256> vals(count);
+        for (uint256 &val : vals) {
+            val = InsecureRand256();
+        }
+        std::vector<uint64_t> hashes(count);
+        SipHashUint256Batch(k1, k2, vals.data(), hashes.data(), count);
+        for (size_t i = 0; i < count; ++i) {
+            BOOST_CHECK_EQUAL(hashes[i], SipHashUint256(k1, k2, vals[i]));
+        }
+    }
 }
 
 namespace {
@@ -6,6 +6,7 @@
 #define BOOST_TEST_MODULE Fittexxcoin Node unit tests
 
 #include <util/system.h>
+#include <validation.h>
 
 #include <boost/test/unit_test.hpp>
 
@@ -59,7 +60,11 @@ struct CustomArgumentsFixture {
         }
     }
 
-    ~CustomArgumentsFixture(){};
+    ~CustomArgumentsFixture() {
+        // Should a test case have left script-checking threads running, stop
+        // them before the static queues they run on are destroyed.
+        StopScriptCheckWorkerThreads();
+    };
 };
 
 BOOST_GLOBAL_FIXTURE(CustomArgumentsFixture);
@@ -7,15 +7,21 @@
 
 #include <policy/policy.h>
 #include <reverse_iterator.h>
+#include <rpc/blockchain.h>
 #include <util/system.h>
 
 #include <test/setup_common.h>
 
 #include <boost/test/unit_test.hpp>
 
+#include <univalue.h>
+
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <future>
 #include <list>
+#include <thread>
 #include <vector>
 
 BOOST_FIXTURE_TEST_SUITE(mempool_tests, TestingSetup)
@@ -140,6 +146,146 @@ BOOST_AUTO_TEST_CASE(MempoolClearTest) {
     BOOST_CHECK_EQUAL(testPool.GetIndex().size(), 0UL);
 }
 
+BOOST_AUTO_TEST_CASE(MempoolSnapshotTest) {
+    TestMemPoolEntryHelper entry;
+    // A parent with two outputs, spent by two children.
+    CMutableTransaction txParent;
+    txParent.vin.resize(1);
+    txParent.vin[0].scriptSig = CScript() << OP_11;
+    txParent.vout.resize(2);
+    for (int i = 0; i < 2; i++) {
+        txParent.vout[i].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+        txParent.vout[i].nValue = 33000 * SATOSHI;
+    }
+    CMutableTransaction txChild[2];
+    for (int i = 0; i < 2; i++) {
+        txChild[i].vin.resize(1);
+        txChild[i].vin[0].scriptSig = CScript() << OP_11;
+        txChild[i].vin[0].prevout = COutPoint(txParent.GetId(), i);
+        txChild[i].vout.resize(1);
+        txChild[i].vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+        txChild[i].vout[0].nValue = 11000 * SATOSHI;
+    }
+
+    CTxMemPool testPool;
+    const MempoolSnapshotRef empty = testPool.GetSnapshot();
+    BOOST_CHECK(empty->entries.empty());
+    BOOST_CHECK(!empty->loaded);
+    // Nothing changed: the same snapshot is shared.
+    BOOST_CHECK_EQUAL(testPool.GetSnapshot(), empty);
+
+    {
+        LOCK2(cs_main, testPool.cs);
+        testPool.addUnchecked(entry.Fee(1000 * SATOSHI).Time(1).FromTx(txParent));
+        testPool.addUnchecked(entry.Fee(2000 * SATOSHI).Time(2).FromTx(txChild[0]));
+        testPool.addUnchecked(entry.Fee(3000 * SATOSHI).Time(3).FromTx(txChild[1]));
+    }
+    testPool.PrioritiseTransaction(txChild[1].GetId(), 500 * SATOSHI);
+    testPool.SetIsLoaded(true);
+
+    const MempoolSnapshotRef snapshot = testPool.GetSnapshot();
+    BOOST_CHECK(snapshot != empty);
+    BOOST_CHECK(empty->entries.empty());
+    BOOST_CHECK_EQUAL(snapshot->version, testPool.GetVersion());
+    BOOST_CHECK(snapshot->loaded);
+    BOOST_CHECK_EQUAL(snapshot->totalTxSize, testPool.GetTotalTxSize());
+    BOOST_CHECK_EQUAL(snapshot->usage, testPool.DynamicMemoryUsage());
+    BOOST_CHECK_EQUAL(snapshot->entries.size(), 3U);
+
+    // In topological order.
+    const MempoolSnapshot::Entry &parent = snapshot->entries[0];
+    BOOST_CHECK(parent.tx->GetId() == txParent.GetId());
+    BOOST_CHECK_EQUAL(parent.fee, 1000 * SATOSHI);
+    BOOST_CHECK_EQUAL(parent.time, 1);
+    BOOST_CHECK_EQUAL(parent.size, CTransaction(txParent).GetTotalSize());
+    BOOST_CHECK(parent.depends.empty());
+    BOOST_CHECK(parent.spentBy == std::vector<TxId>({txChild[0].GetId(), txChild[1].GetId()}));
+    for (int i = 0; i < 2; i++) {
+        const MempoolSnapshot::Entry &child = snapshot->entries[1 + i];
+        BOOST_CHECK(child.tx->GetId() == txChild[i].GetId());
+        BOOST_CHECK(child.depends == std::vector<TxId>({txParent.GetId()}));
+        BOOST_CHECK(child.spentBy.empty());
+    }
+    BOOST_CHECK_EQUAL(snapshot->entries[1].modifiedFee, 2000 * SATOSHI);
+    BOOST_CHECK_EQUAL(snapshot->entries[2].fee, 3000 * SATOSHI);
+    BOOST_CHECK_EQUAL(snapshot->entries[2].modifiedFee, 3500 * SATOSHI);
+
+    // The RPC lists the txids in the order they entered the mempool, and the
+    // verbose entries by txid.
+    std::vector<TxId> txids{txParent.GetId(), txChild[0].GetId(), txChild[1].GetId()};
+    const UniValue json = MempoolToJSON(testPool, false);
+    BOOST_REQUIRE_EQUAL(json.size(), txids.size());
+    for (size_t i = 0; i < txids.size(); ++i) {
+        BOOST_CHECK_EQUAL(json[i].get_str(), txids[i].ToString());
+    }
+    std::sort(txids.begin(), txids.end());
+    const UniValue jsonVerbose = MempoolToJSON(testPool, true);
+    BOOST_REQUIRE_EQUAL(jsonVerbose.size(), txids.size());
+    auto it = jsonVerbose.get_obj().begin();
+    for (size_t i = 0; i < txids.size(); ++i, ++it) {
+        BOOST_CHECK_EQUAL(it->first, txids[i].ToString());
+    }
+
+    // While nothing changes, taking the snapshot does not wait for the lock.
+    {
+        std::promise<void> locked, done;
+        std::thread holder([&]() {
+            LOCK(testPool.cs);
+            locked.set_value();
+            done.get_future().wait_for(std::chrono::seconds(10));
+        });
+        locked.get_future().wait();
+        const auto start = std::chrono::steady_clock::now();
+        BOOST_CHECK_EQUAL(testPool.GetSnapshot(), snapshot);
+        BOOST_CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+        done.set_value();
+        holder.join();
+    }
+
+    // The entries which changed are merged with the last snapshot: the parent
+    // loses a child and gains it back, which comes last, and the other child
+    // is prioritised.
+    testPool.removeRecursive(CTransaction(txChild[0]));
+    {
+        LOCK2(cs_main, testPool.cs);
+        testPool.addUnchecked(entry.Fee(2000 * SATOSHI).Time(4).FromTx(txChild[0]));
+    }
+    testPool.PrioritiseTransaction(txChild[1].GetId(), 500 * SATOSHI);
+    const MempoolSnapshotRef changed = testPool.GetSnapshot();
+    BOOST_CHECK_EQUAL(changed->totalTxSize, testPool.GetTotalTxSize());
+    BOOST_CHECK_EQUAL(changed->entries.size(), 3U);
+    BOOST_CHECK(changed->entries[0].tx->GetId() == txParent.GetId());
+    BOOST_CHECK(changed->entries[0].spentBy == std::vector<TxId>({txChild[1].GetId(), txChild[0].GetId()}));
+    BOOST_CHECK(changed->entries[1].tx->GetId() == txChild[1].GetId());
+    BOOST_CHECK_EQUAL(changed->entries[1].modifiedFee, 4000 * SATOSHI);
+    BOOST_CHECK(changed->entries[2].tx->GetId() == txChild[0].GetId());
+    BOOST_CHECK_EQUAL(changed->entries[2].time, 4);
+    BOOST_CHECK(changed->entries[2].depends == std::vector<TxId>({txParent.GetId()}));
+
+    // The txids are still listed in the order of queryHashes(), as they were
+    // before the RPC read them from the snapshots.
+    std::vector<uint256> queried;
+    testPool.queryHashes(queried);
+    const UniValue jsonChanged = MempoolToJSON(testPool, false);
+    BOOST_REQUIRE_EQUAL(jsonChanged.size(), queried.size());
+    for (size_t i = 0; i < queried.size(); ++i) {
+        BOOST_CHECK_EQUAL(jsonChanged[i].get_str(), queried[i].ToString());
+    }
+
+    // Clearing a prioritisation changes the memory usage.
+    testPool.ClearPrioritisation(txChild[1].GetId());
+    BOOST_CHECK(testPool.GetSnapshot() != changed);
+    BOOST_CHECK_EQUAL(testPool.GetSnapshot()->usage, testPool.DynamicMemoryUsage());
+
+    // Removing the parent removes its children.
+    testPool.removeRecursive(CTransaction(txParent));
+    const MempoolSnapshotRef after = testPool.GetSnapshot();
+    BOOST_CHECK(after->entries.empty());
+    BOOST_CHECK_EQUAL(after->totalTxSize, 0U);
+    // Readers holding the old snapshot still see what it had.
+    BOOST_CHECK_EQUAL(snapshot->entries.size(), 3U);
+}
+
 template <typename name>
 static void CheckSort(CTxMemPool &pool, std::vector<std::string> &sortedOrder,
                       const std::string &testcase)
@@ -9,6 +9,7 @@
 #include <chainparams.h>
 #include <coins.h>
 #include <config.h>
+#include <consensus/activation.h>
 #include <consensus/consensus.h>
 #include <consensus/merkle.h>
 #include <consensus/tx_verify.h>
@@ -27,6 +28,8 @@
 #include <boost/test/unit_test.hpp>
 
 #include <memory>
+#include <set>
+#include <vector>
 
 BOOST_FIXTURE_TEST_SUITE(miner_tests, TestingSetup)
 
@@ -691,4 +694,148 @@ BOOST_AUTO_TEST_CASE(TestCBlockTemplateEntry) {
     BOOST_CHECK_EQUAL(txEntry.sigChecks, 10);
 }
 
+BOOST_AUTO_TEST_CASE(IncrementalBlockAssembler_maintenance) {
+    GlobalConfig config;
+    const CScript scriptPubKey = CScript() << OP_TRUE;
+    IncrementalBlockAssembler assembler(config, g_mempool);
+    TestMemPoolEntryHelper entry;
+    // Only the canonical order is maintained.
+    BOOST_REQUIRE(IsMagneticAnomalyEnabled(config.GetChainParams().GetConsensus(),
+                                           WITH_LOCK(cs_main, return ::ChainActive().Tip())));
+
+    // Transactions of at least the minimum size, spending outputs of txPrev
+    // (or made up ones).
+    const auto MakeTx = [](const CTransactionRef &txPrev, Amount fee) {
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vin[0].prevout = txPrev ? COutPoint(txPrev->GetId(), 0) : COutPoint(TxId(InsecureRand256()), 0);
+        tx.vin[0].scriptSig = CScript() << std::vector<uint8_t>(100, 0x01);
+        tx.vout.resize(1);
+        tx.vout[0].nValue = 10 * COIN - fee;
+        tx.vout[0].scriptPubKey = CScript() << OP_TRUE;
+        return MakeTransactionRef(tx);
+    };
+    const auto AddToMempool = [&](const CTransactionRef &tx, Amount fee) {
+        LOCK2(cs_main, g_mempool.cs);
+        g_mempool.addUnchecked(entry.Fee(fee).FromTx(tx));
+    };
+    const auto CheckTemplate = [&](const std::vector<CTransactionRef> &expected) {
+        const auto pblocktemplate = assembler.CreateNewBlock(scriptPubKey, 0., false);
+        BOOST_REQUIRE(pblocktemplate);
+        const std::vector<CTransactionRef> &vtx = pblocktemplate->block.vtx;
+        BOOST_REQUIRE_EQUAL(vtx.size(), expected.size() + 1);
+        BOOST_CHECK(vtx[0]->IsCoinBase());
+        Amount fees = Amount::zero();
+        std::set<TxId> txids;
+        for (const CTransactionRef &tx : expected) {
+            txids.insert(tx->GetId());
+            fees += 1000 * SATOSHI;
+        }
+        // In canonical order.
+        size_t i = 1;
+        for (const TxId &txid : txids) {
+            BOOST_CHECK(vtx[i]->GetId() == txid);
+            BOOST_CHECK_EQUAL(pblocktemplate->entries[i].fees, 1000 * SATOSHI);
+            ++i;
+        }
+        BOOST_CHECK_EQUAL(pblocktemplate->entries[0].fees, -1 * fees);
+        // The same as a selection from scratch.
+        const auto fresh = AssemblerForTest(config.GetChainParams(), g_mempool).CreateNewBlock(scriptPubKey, 0., false);
+        BOOST_CHECK_EQUAL(fresh->block.vtx.size(), vtx.size());
+        BOOST_CHECK(vtx[0]->vout[0].nValue == fresh->block.vtx[0]->vout[0].nValue);
+    };
+
+    const CTransactionRef txA = MakeTx(nullptr, 1000 * SATOSHI);
+    const CTransactionRef txB = MakeTx(txA, 1000 * SATOSHI);
+    const CTransactionRef txC = MakeTx(nullptr, 1000 * SATOSHI);
+    AddToMempool(txA, 1000 * SATOSHI);
+    AddToMempool(txB, 1000 * SATOSHI);
+    AddToMempool(txC, 1000 * SATOSHI);
+
+    // Selected from scratch first.
+    CheckTemplate({txA, txB, txC});
+    BOOST_CHECK_EQUAL(assembler.GetTxCount(), 3U);
+    BOOST_CHECK(!assembler.IsStale());
+
+    // New transactions are added as they enter the mempool, unless paying too
+    // little.
+    const CTransactionRef txD = MakeTx(txB, 1000 * SATOSHI);
+    const CTransactionRef txE = MakeTx(nullptr, 1000 * SATOSHI);
+    const CTransactionRef txLow = MakeTx(nullptr, Amount::zero());
+    AddToMempool(txD, 1000 * SATOSHI);
+    AddToMempool(txE, 1000 * SATOSHI);
+    AddToMempool(txLow, Amount::zero());
+    BOOST_CHECK_EQUAL(assembler.GetTxCount(), 5U);
+    BOOST_CHECK(!assembler.IsStale());
+    CheckTemplate({txA, txB, txC, txD, txE});
+
+    // Nor are the children of transactions left out.
+    const CTransactionRef txLowChild = MakeTx(txLow, 1000 * SATOSHI);
+    AddToMempool(txLowChild, 1000 * SATOSHI);
+    BOOST_CHECK_EQUAL(assembler.GetTxCount(), 5U);
+
+    // Removing a transaction removes its descendants, and makes the
+    // transactions stale.
+    {
+        LOCK2(cs_main, g_mempool.cs);
+        g_mempool.removeRecursive(*txB, MemPoolRemovalReason::CONFLICT);
+    }
+    BOOST_CHECK_EQUAL(assembler.GetTxCount(), 3U);
+    BOOST_CHECK(assembler.IsStale());
+    CheckTemplate({txA, txC, txE});
+
+    LOCK2(cs_main, g_mempool.cs);
+    g_mempool.clear();
+}
+
+BOOST_AUTO_TEST_CASE(IncrementalBlockAssembler_staleness) {
+    GlobalConfig config;
+    const CScript scriptPubKey = CScript() << OP_TRUE;
+    TestMemPoolEntryHelper entry;
+
+    const auto MakeTx = [](const CTransactionRef &txPrev) {
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vin[0].prevout = txPrev ? COutPoint(txPrev->GetId(), 0) : COutPoint(TxId(InsecureRand256()), 0);
+        tx.vin[0].scriptSig = CScript() << std::vector<uint8_t>(100, 0x01);
+        tx.vout.resize(1);
+        tx.vout[0].nValue = 10 * COIN;
+        tx.vout[0].scriptPubKey = CScript() << OP_TRUE;
+        return MakeTransactionRef(tx);
+    };
+    const auto AddToMempool = [&](const CTransactionRef &tx, Amount fee) {
+        LOCK2(cs_main, g_mempool.cs);
+        g_mempool.addUnchecked(entry.Fee(fee).FromTx(tx));
+    };
+
+    // A transaction paying nothing is left out.
+    const CTransactionRef txFree = MakeTx(nullptr);
+    AddToMempool(txFree, Amount::zero());
+    {
+        IncrementalBlockAssembler assembler(config, g_mempool);
+        BOOST_REQUIRE(assembler.CreateNewBlock(scriptPubKey, 0., false));
+        BOOST_CHECK_EQUAL(assembler.GetTxCount(), 0U);
+        BOOST_CHECK(!assembler.IsStale());
+
+        // So is its child, but the child pays enough for a new selection to
+        // be worth it.
+        const CTransactionRef txChild = MakeTx(txFree);
+        AddToMempool(txChild, 1000 * SATOSHI);
+        BOOST_CHECK_EQUAL(assembler.GetTxCount(), 0U);
+        BOOST_CHECK(assembler.IsStale());
+    }
+    {
+        IncrementalBlockAssembler assembler(config, g_mempool);
+        BOOST_REQUIRE(assembler.CreateNewBlock(scriptPubKey, 0., false));
+        BOOST_CHECK(!assembler.IsStale());
+
+        // Prioritising a transaction left out may make it worth selecting.
+        g_mempool.PrioritiseTransaction(txFree->GetId(), 1000 * SATOSHI);
+        BOOST_CHECK(assembler.IsStale());
+    }
+
+    LOCK2(cs_main, g_mempool.cs);
+    g_mempool.clear();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
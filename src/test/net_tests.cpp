@@ -10,6 +10,7 @@
 #include <config.h>
 #include <hash.h>
 #include <netbase.h>
+#include <netmessagemaker.h>
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
@@ -17,12 +18,23 @@
 #include <version.h>
 
 #include <test/setup_common.h>
+#include <test/util.h>
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
 #include <ios>
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
+#include <thread>
+#include <vector>
+
+#ifndef WIN32
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
 
 class CAddrManSerializationMock : public CAddrMan {
 public:
@@ -206,6 +218,184 @@ BOOST_AUTO_TEST_CASE(cnode_simple_test) {
     BOOST_CHECK(pnode2->fFeeler == false);
 }
 
+#ifndef WIN32
+BOOST_AUTO_TEST_CASE(socket_events) {
+    std::vector<SocketEventsMode> modes{DEFAULT_SOCKETEVENTS_MODE};
+#ifdef USE_EPOLL
+    modes.push_back(SocketEventsMode::Poll);
+#endif
+    for (const SocketEventsMode mode : modes) {
+        BOOST_TEST_MESSAGE("socket events mode " << SocketEventsModeToString(mode));
+        CConnmanTest connman(GetConfig(), 0x1337, 0x1337);
+        CConnman::Options options;
+        options.socketEventsMode = mode;
+        options.nSendBufferMaxSize = 10 * 1000 * 1000;
+        options.nReceiveFloodSize = 10 * 1000 * 1000;
+        connman.Init(options);
+
+        // Two nodes connected to each other, and one whose peer goes away.
+        int sockets[2], sockets_closed[2];
+        BOOST_REQUIRE_EQUAL(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+        BOOST_REQUIRE_EQUAL(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets_closed), 0);
+        CNode *pnodeFrom = new CNode(0, NODE_NETWORK, 0, sockets[0], CAddress(), 0, 0, CAddress(), "", true);
+        CNode *pnodeTo = new CNode(1, NODE_NETWORK, 0, sockets[1], CAddress(), 1, 1, CAddress(), "", true);
+        CNode *pnodeClosed = new CNode(2, NODE_NETWORK, 0, sockets_closed[0], CAddress(), 2, 2, CAddress(), "", true);
+        connman.AddNode(*pnodeFrom);
+        connman.AddNode(*pnodeTo);
+        connman.AddNode(*pnodeClosed);
+        close(sockets_closed[1]);
+
+        // More than the socket takes at once, and than is received at once:
+        // it takes a few rounds to get through.
+        const std::vector<uint8_t> payload(500 * 1000, 0x42);
+        connman.PushMessage(pnodeFrom, CNetMsgMaker(INIT_PROTO_VERSION).Make(NetMsgType::PING, payload));
+        BOOST_CHECK(WITH_LOCK(pnodeFrom->cs_vSend, return !pnodeFrom->vSendMsg.empty()));
+
+        for (int i = 0; i < 1000; ++i) {
+            if (WITH_LOCK(pnodeTo->cs_vProcessMsg, return !pnodeTo->vProcessMsg.empty()) &&
+                pnodeClosed->fDisconnect) {
+                break;
+            }
+            connman.SocketHandler();
+        }
+        BOOST_CHECK(WITH_LOCK(pnodeFrom->cs_vSend, return pnodeFrom->vSendMsg.empty()));
+        {
+            LOCK(pnodeTo->cs_vProcessMsg);
+            BOOST_REQUIRE_EQUAL(pnodeTo->vProcessMsg.size(), 1U);
+            const CNetMessage &msg = pnodeTo->vProcessMsg.front();
+            BOOST_CHECK_EQUAL(msg.hdr.GetCommand(), NetMsgType::PING);
+            std::vector<uint8_t> received;
+            CDataStream(msg.vRecv) >> received;
+            BOOST_CHECK(received == payload);
+        }
+        BOOST_CHECK(pnodeClosed->fDisconnect);
+        BOOST_CHECK(WITH_LOCK(pnodeClosed->cs_hSocket, return pnodeClosed->hSocket == INVALID_SOCKET));
+
+        // Nothing is left to do, and nothing is done.
+        const uint64_t nSendBytes = WITH_LOCK(pnodeFrom->cs_vSend, return pnodeFrom->nSendBytes);
+        const uint64_t nRecvBytes = WITH_LOCK(pnodeTo->cs_vRecv, return pnodeTo->nRecvBytes);
+        BOOST_CHECK_EQUAL(nSendBytes, nRecvBytes);
+        connman.SocketHandler();
+        BOOST_CHECK_EQUAL(WITH_LOCK(pnodeTo->cs_vRecv, return pnodeTo->nRecvBytes), nRecvBytes);
+
+        connman.ClearNodes();
+    }
+}
+#endif
+
+namespace {
+/** Records which threads process the messages of each node. */
+class ThreadRecorder final : public NetEventsInterface {
+public:
+    Mutex mutex;
+    std::map<NodeId, std::set<std::thread::id>> threads GUARDED_BY(mutex);
+    std::map<NodeId, int> calls GUARDED_BY(mutex);
+
+    bool ProcessMessages(const Config &, CNode *pnode, std::atomic<bool> &) override {
+        LOCK(mutex);
+        threads[pnode->GetId()].insert(std::this_thread::get_id());
+        ++calls[pnode->GetId()];
+        return true;
+    }
+    bool SendMessages(const Config &, CNode *pnode, std::atomic<bool> &) override {
+        LOCK(mutex);
+        threads[pnode->GetId()].insert(std::this_thread::get_id());
+        return true;
+    }
+    void InitializeNode(const Config &, CNode *) override {}
+    void FinalizeNode(const Config &, NodeId, bool &) override {}
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE(message_handler_affinity) {
+    ThreadRecorder recorder;
+    CConnmanTest connman(GetConfig(), 0x1337, 0x1337);
+    CConnman::Options options;
+    options.m_msgproc = &recorder;
+    options.nMessageHandlerThreads = 4;
+    connman.Init(options);
+
+    const int nNodes = 10;
+    for (NodeId id = 0; id < nNodes; ++id) {
+        connman.AddNode(*new CNode(id, NODE_NETWORK, 0, INVALID_SOCKET, CAddress(), 0, 0, CAddress(), "", true));
+    }
+    connman.StartMessageHandlers();
+    // ProcessMessages() reports more work, so the handlers keep going.
+    for (int i = 0; i < 1000; ++i) {
+        if (WITH_LOCK(recorder.mutex, return recorder.calls.size() == nNodes &&
+                      std::all_of(recorder.calls.begin(), recorder.calls.end(),
+                                  [](const auto &calls) { return calls.second >= 10; }))) {
+            break;
+        }
+        UninterruptibleSleep(std::chrono::milliseconds{10});
+    }
+    connman.StopMessageHandlers();
+
+    LOCK(recorder.mutex);
+    BOOST_CHECK_EQUAL(recorder.calls.size(), size_t(nNodes));
+    std::set<std::thread::id> allThreads;
+    std::map<std::thread::id, NodeId> firstNode;
+    for (const auto &[id, threads] : recorder.threads) {
+        // Each node always is processed by the same thread...
+        BOOST_REQUIRE_EQUAL(threads.size(), 1U);
+        const std::thread::id thread = *threads.begin();
+        BOOST_CHECK(thread != std::this_thread::get_id());
+        allThreads.insert(thread);
+        // ... which is the one of the nodes with the same id modulo 4.
+        const auto it = firstNode.emplace(thread, id).first;
+        BOOST_CHECK_EQUAL(it->second % 4, id % 4);
+    }
+    BOOST_CHECK_EQUAL(allThreads.size(), 4U);
+    connman.ClearNodes();
+}
+
+BOOST_AUTO_TEST_CASE(shared_message) {
+    CConnmanTest connman(GetConfig(), 0x1337, 0x1337);
+    connman.Init(CConnman::Options());
+
+    // Without a socket, nothing is sent and the messages stay queued.
+    CNode *pnodeCopy = new CNode(0, NODE_NETWORK, 0, INVALID_SOCKET, CAddress(), 0, 0, CAddress(), "", true);
+    CNode *pnodeShared1 = new CNode(1, NODE_NETWORK, 0, INVALID_SOCKET, CAddress(), 1, 1, CAddress(), "", true);
+    CNode *pnodeShared2 = new CNode(2, NODE_NETWORK, 0, INVALID_SOCKET, CAddress(), 2, 2, CAddress(), "", true);
+    for (CNode *pnode : {pnodeCopy, pnodeShared1, pnodeShared2}) {
+        connman.AddNode(*pnode);
+    }
+
+    const CNetMsgMaker msgMaker(PROTOCOL_VERSION);
+    const std::vector<uint8_t> payload(1000, 0x42);
+    connman.PushMessage(pnodeCopy, msgMaker.Make(NetMsgType::BLOCK, payload));
+    const CSharedNetMsg msg = connman.MakeSharedMessage(msgMaker.Make(NetMsgType::BLOCK, payload));
+    BOOST_REQUIRE(msg);
+    BOOST_CHECK_EQUAL(msg.m_type, NetMsgType::BLOCK);
+    connman.PushMessage(pnodeShared1, msg);
+    connman.PushMessage(pnodeShared2, msg);
+
+    const auto GetQueued = [](CNode *pnode) {
+        LOCK(pnode->cs_vSend);
+        std::vector<std::vector<uint8_t>> queued;
+        for (const CSendBuffer &buffer : pnode->vSendMsg) {
+            queued.emplace_back(buffer.data(), buffer.data() + buffer.size());
+        }
+        return queued;
+    };
+    const std::vector<std::vector<uint8_t>> expected = GetQueued(pnodeCopy);
+    BOOST_REQUIRE_EQUAL(expected.size(), 2U);
+    BOOST_CHECK(GetQueued(pnodeShared1) == expected);
+    BOOST_CHECK(GetQueued(pnodeShared2) == expected);
+    BOOST_CHECK_EQUAL(WITH_LOCK(pnodeShared1->cs_vSend, return pnodeShared1->nSendSize),
+                      expected[0].size() + expected[1].size());
+
+    // The same bytes are queued for both peers.
+    {
+        LOCK2(pnodeShared1->cs_vSend, pnodeShared2->cs_vSend);
+        BOOST_CHECK(pnodeShared1->vSendMsg[0].data() == msg.header->data());
+        BOOST_CHECK(pnodeShared1->vSendMsg[1].data() == msg.payload->data());
+        BOOST_CHECK(pnodeShared2->vSendMsg[1].data() == msg.payload->data());
+    }
+
+    connman.ClearNodes();
+}
+
 BOOST_AUTO_TEST_CASE(cnetaddr_basic) {
     CNetAddr addr;
 
@@ -15,6 +15,7 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
 #include <string>
 
 BOOST_FIXTURE_TEST_SUITE(rpc_server_tests, TestingSetup)
@@ -100,4 +101,76 @@ BOOST_AUTO_TEST_CASE(rpc_server_execute_command_from_request_context) {
     BOOST_CHECK_EQUAL(output.get_str(), "testing2");
 }
 
+class EchoRPCCommand : public RPCCommand {
+    const std::atomic<int> &counter;
+
+public:
+    EchoRPCCommand(const std::string &nameIn, const std::atomic<int> &counterIn)
+        : RPCCommand(nameIn), counter(counterIn) {}
+
+    UniValue Execute(const JSONRPCRequest &request) const override {
+        UniValue::Array ret;
+        ret.emplace_back(request.params);
+        ret.emplace_back(counter.load());
+        return ret;
+    }
+
+    bool IsReadOnly() const override { return true; }
+};
+
+class IncrementRPCCommand : public RPCCommand {
+    std::atomic<int> &counter;
+
+public:
+    IncrementRPCCommand(const std::string &nameIn, std::atomic<int> &counterIn)
+        : RPCCommand(nameIn), counter(counterIn) {}
+
+    UniValue Execute(const JSONRPCRequest &request) const override {
+        return UniValue(++counter);
+    }
+};
+
+BOOST_AUTO_TEST_CASE(rpc_server_execute_batch) {
+    DummyConfig config;
+    RPCServer rpcServer;
+    std::atomic<int> counter{0};
+    rpcServer.RegisterCommand(std::make_unique<EchoRPCCommand>("echo", counter));
+    rpcServer.RegisterCommand(std::make_unique<IncrementRPCCommand>("increment", counter));
+    BOOST_CHECK(rpcServer.IsReadOnlyCommand("echo"));
+    BOOST_CHECK(!rpcServer.IsReadOnlyCommand("increment"));
+    BOOST_CHECK(rpcServer.IsReadOnlyCommand("getblockcount"));
+    BOOST_CHECK(!rpcServer.IsReadOnlyCommand("invalidateblock"));
+    BOOST_CHECK(!rpcServer.IsReadOnlyCommand("this-command-does-not-exist"));
+
+    const auto makeBatch = []() {
+        UniValue::Array batch;
+        for (int i = 0; i < 500; ++i) {
+            UniValue::Object req;
+            req.emplace_back("method", i % 10 == 0 ? "this-command-does-not-exist"
+                                       : i % 7 == 0 ? "increment" : "echo");
+            UniValue::Array params;
+            params.emplace_back(i);
+            req.emplace_back("params", std::move(params));
+            req.emplace_back("id", i);
+            batch.emplace_back(i % 50 == 0 ? UniValue(i) : UniValue(std::move(req)));
+        }
+        return batch;
+    };
+
+    // Run in order, then on up to 3 workers: the replies are the same, in
+    // the order of the requests, and each echo sees the increments requested
+    // before it.
+    const std::string serial = JSONRPCExecBatch(config, rpcServer, JSONRPCRequest(), makeBatch());
+    BOOST_CHECK(serial.find("\"result\":[[499],64]") != std::string::npos);
+    BOOST_CHECK(serial.find("Method not found") != std::string::npos);
+
+    counter = 0;
+    g_rpc_worker_pool.Start(4);
+    gArgs.ForceSetArg("-rpcbatchworkers", "3");
+    const std::string parallel = JSONRPCExecBatch(config, rpcServer, JSONRPCRequest(), makeBatch());
+    gArgs.ClearArg("-rpcbatchworkers");
+    g_rpc_worker_pool.Stop();
+    BOOST_CHECK_EQUAL(serial, parallel);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
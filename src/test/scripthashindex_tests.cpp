@@ -0,0 +1,218 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <config.h>
+#include <index/scripthashindex.h>
+#include <script/script.h>
+#include <script/standard.h>
+#include <util/strencodings.h>
+#include <validation.h>
+
+#include <test/setup_common.h>
+#include <test/util.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(scripthashindex_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(scripthash) {
+    // The SHA256 of the script, displayed in reverse byte order as Electrum
+    // clients do.
+    BOOST_CHECK_EQUAL(ScriptHash(CScript()).GetHex(),
+                      "55b852781b9995a44c939b64e441ae2724b96f99c8f4fb9a141cfc98"
+                      "42c4b0e3");
+    const std::vector<uint8_t> p2pkh = ParseHex(
+        "76a91462e907b15cbf27d5425399ebf6f0fb50ebb88f1888ac");
+    BOOST_CHECK_EQUAL(
+        ScriptHash(CScript(p2pkh.begin(), p2pkh.end())).GetHex(),
+        "8b01df4e368ea28f8dc0423bcf7a4923e3a12d307c875e47a0cfbf90b5c39161");
+}
+
+static Amount UnspentValue(const std::vector<ScriptHashIndex::Unspent> &unspent) {
+    Amount value = Amount::zero();
+    for (const ScriptHashIndex::Unspent &entry : unspent) {
+        value += entry.txout.nValue;
+    }
+    return value;
+}
+
+BOOST_FIXTURE_TEST_CASE(scripthashindex_history_and_rollback,
+                        TestChain100Setup) {
+    const CScript coinbase_script = CScript()
+                                    << ToByteVector(coinbaseKey.GetPubKey())
+                                    << OP_CHECKSIG;
+    CKey key;
+    key.MakeNewKey(true);
+    const CScript script_a = GetScriptForDestination(key.GetPubKey().GetID());
+    const CScript script_b = CScript() << OP_TRUE;
+    const uint256 coinbase_scripthash = ScriptHash(coinbase_script);
+    const uint256 scripthash_a = ScriptHash(script_a);
+    const uint256 scripthash_b = ScriptHash(script_b);
+
+    // Block 101 sends part of the first coinbase to script_a, and the rest
+    // back to the coinbase script.
+    const CTransaction &coinbase = *m_coinbase_txns[0];
+    const Amount coinbase_value = coinbase.vout[0].nValue;
+    const CMutableTransaction tx1 = Spend(
+        coinbase, 0, coinbaseKey,
+        {CTxOut(10 * COIN, script_a),
+         CTxOut(coinbase_value - 10 * COIN - 1000 * SATOSHI, coinbase_script)});
+    const CBlock block101 = CreateAndProcessBlock({tx1}, coinbase_script);
+
+    ScriptHashIndex scripthash_index(1 << 20, true);
+    std::vector<ScriptHashIndex::HistoryEntry> history;
+    std::vector<ScriptHashIndex::Unspent> unspent;
+    // The index is empty before it is started.
+    BOOST_REQUIRE(scripthash_index.FindHistory(coinbase_scripthash, 0, history));
+    BOOST_CHECK(history.empty());
+    BOOST_CHECK(!scripthash_index.BlockUntilSyncedToCurrentChain());
+
+    scripthash_index.Start();
+    WaitForIndexSync(scripthash_index);
+
+    // The outputs of the genesis block are not indexed.
+    BOOST_REQUIRE(scripthash_index.FindHistory(
+        ScriptHash(Params().GenesisBlock().vtx[0]->vout[0].scriptPubKey), 0,
+        history));
+    BOOST_CHECK(history.empty());
+
+    // Block 102, connected while the index is running, sends the output of
+    // script_a to script_b.
+    const CMutableTransaction tx2 =
+        Spend(CTransaction(tx1), 0, key,
+              {CTxOut(10 * COIN - 1000 * SATOSHI, script_b)});
+    const CBlock block102 = CreateAndProcessBlock({tx2}, coinbase_script);
+    BOOST_CHECK(scripthash_index.BlockUntilSyncedToCurrentChain());
+
+    BOOST_REQUIRE(scripthash_index.FindHistory(scripthash_a, 0, history));
+    BOOST_REQUIRE_EQUAL(history.size(), 2U);
+    BOOST_CHECK_EQUAL(history[0].height, 101);
+    BOOST_CHECK(history[0].txid == tx1.GetId());
+    BOOST_CHECK(history[0].funded == std::vector<uint32_t>{0});
+    BOOST_CHECK(history[0].spent.empty());
+    BOOST_CHECK_EQUAL(history[1].height, 102);
+    BOOST_CHECK(history[1].txid == tx2.GetId());
+    BOOST_CHECK(history[1].funded.empty());
+    BOOST_CHECK(history[1].spent ==
+                std::vector<COutPoint>{COutPoint(tx1.GetId(), 0)});
+    BOOST_REQUIRE(scripthash_index.FindHistory(scripthash_a, 102, history));
+    BOOST_CHECK_EQUAL(history.size(), 1U);
+    BOOST_REQUIRE(scripthash_index.FindUnspent(scripthash_a, unspent));
+    BOOST_CHECK(unspent.empty());
+
+    BOOST_REQUIRE(scripthash_index.FindUnspent(scripthash_b, unspent));
+    BOOST_REQUIRE_EQUAL(unspent.size(), 1U);
+    BOOST_CHECK_EQUAL(unspent[0].height, 102);
+    BOOST_CHECK(unspent[0].outpoint == COutPoint(tx2.GetId(), 0));
+    BOOST_CHECK_EQUAL(UnspentValue(unspent), 10 * COIN - 1000 * SATOSHI);
+
+    // The coinbase script has the 102 coinbases but the first one, and the
+    // change of tx1.
+    BOOST_REQUIRE(
+        scripthash_index.FindHistory(coinbase_scripthash, 0, history));
+    BOOST_CHECK_EQUAL(history.size(), 103U);
+    BOOST_REQUIRE(scripthash_index.FindUnspent(coinbase_scripthash, unspent));
+    BOOST_REQUIRE_EQUAL(unspent.size(), 102U);
+    BOOST_CHECK(std::none_of(
+        unspent.begin(), unspent.end(),
+        [&](const ScriptHashIndex::Unspent &entry) {
+            return entry.outpoint == COutPoint(coinbase.GetId(), 0);
+        }));
+    BOOST_CHECK_EQUAL(UnspentValue(unspent),
+                      99 * coinbase_value + block101.vtx[0]->vout[0].nValue +
+                          block102.vtx[0]->vout[0].nValue +
+                          tx1.vout[1].nValue);
+
+    // Replace block 102 by one without tx2: its entries are removed.
+    InvalidateBlockAndClearMempool(
+        GetConfig(), WITH_LOCK(cs_main, return ::ChainActive().Tip()));
+    const CScript other_script = CScript() << OP_2;
+    const CBlock other_block = CreateAndProcessBlock({}, other_script);
+    BOOST_CHECK(scripthash_index.BlockUntilSyncedToCurrentChain());
+
+    BOOST_REQUIRE(scripthash_index.FindHistory(ScriptHash(other_script), 0,
+                                               history));
+    BOOST_REQUIRE_EQUAL(history.size(), 1U);
+    BOOST_CHECK(history[0].txid == other_block.vtx[0]->GetId());
+    BOOST_CHECK_EQUAL(history[0].height, 102);
+
+    BOOST_REQUIRE(scripthash_index.FindHistory(scripthash_a, 0, history));
+    BOOST_REQUIRE_EQUAL(history.size(), 1U);
+    BOOST_CHECK(history[0].txid == tx1.GetId());
+    BOOST_REQUIRE(scripthash_index.FindUnspent(scripthash_a, unspent));
+    BOOST_REQUIRE_EQUAL(unspent.size(), 1U);
+    BOOST_CHECK_EQUAL(unspent[0].height, 101);
+    BOOST_CHECK(unspent[0].outpoint == COutPoint(tx1.GetId(), 0));
+    BOOST_CHECK_EQUAL(UnspentValue(unspent), 10 * COIN);
+
+    BOOST_REQUIRE(scripthash_index.FindHistory(scripthash_b, 0, history));
+    BOOST_CHECK(history.empty());
+    BOOST_REQUIRE(scripthash_index.FindUnspent(scripthash_b, unspent));
+    BOOST_CHECK(unspent.empty());
+
+    BOOST_REQUIRE(
+        scripthash_index.FindHistory(coinbase_scripthash, 0, history));
+    BOOST_CHECK_EQUAL(history.size(), 102U);
+    BOOST_REQUIRE(scripthash_index.FindUnspent(coinbase_scripthash, unspent));
+    BOOST_CHECK_EQUAL(unspent.size(), 101U);
+    BOOST_CHECK_EQUAL(UnspentValue(unspent),
+                      99 * coinbase_value + block101.vtx[0]->vout[0].nValue +
+                          tx1.vout[1].nValue);
+
+    scripthash_index.Stop();
+}
+
+BOOST_FIXTURE_TEST_CASE(scripthashindex_restart_after_reorg,
+                        TestChain100Setup) {
+    const CScript coinbase_script = CScript()
+                                    << ToByteVector(coinbaseKey.GetPubKey())
+                                    << OP_CHECKSIG;
+    const uint256 scripthash = ScriptHash(coinbase_script);
+    const TxId stale_txid = m_coinbase_txns.back()->GetId();
+
+    std::vector<ScriptHashIndex::HistoryEntry> history;
+    std::vector<ScriptHashIndex::Unspent> unspent;
+    {
+        ScriptHashIndex scripthash_index(1 << 20, false, true);
+        scripthash_index.Start();
+        WaitForIndexSync(scripthash_index);
+        BOOST_REQUIRE(scripthash_index.FindUnspent(scripthash, unspent));
+        BOOST_CHECK_EQUAL(unspent.size(), m_coinbase_txns.size());
+        scripthash_index.Stop();
+    }
+
+    // Replace the tip while the index is not running.
+    InvalidateBlockAndClearMempool(
+        GetConfig(), WITH_LOCK(cs_main, return ::ChainActive().Tip()));
+    const CScript other_script = CScript() << OP_TRUE;
+    const CBlock block = CreateAndProcessBlock({}, other_script);
+
+    // On restart, the index starts from the block it was written up to and
+    // removes the entries of the stale tip.
+    ScriptHashIndex scripthash_index(1 << 20, false, false);
+    scripthash_index.Start();
+    WaitForIndexSync(scripthash_index);
+
+    BOOST_REQUIRE(scripthash_index.FindUnspent(scripthash, unspent));
+    BOOST_CHECK_EQUAL(unspent.size(), m_coinbase_txns.size() - 1);
+    for (const ScriptHashIndex::Unspent &entry : unspent) {
+        BOOST_CHECK(entry.outpoint.GetTxId() != stale_txid);
+    }
+    BOOST_REQUIRE(scripthash_index.FindHistory(scripthash, 0, history));
+    BOOST_CHECK_EQUAL(history.size(), m_coinbase_txns.size() - 1);
+
+    BOOST_REQUIRE(scripthash_index.FindHistory(ScriptHash(other_script), 0,
+                                               history));
+    BOOST_REQUIRE_EQUAL(history.size(), 1U);
+    BOOST_CHECK(history[0].txid == block.vtx[0]->GetId());
+    BOOST_CHECK_EQUAL(history[0].height, 100);
+
+    scripthash_index.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -27,6 +27,8 @@
 #include <script/script_error.h>
 #include <script/scriptcache.h>
 #include <script/sigcache.h>
+#include <script/sighashtype.h>
+#include <script/sign.h>
 #include <streams.h>
 #include <sync.h>
 #include <txdb.h>
@@ -63,6 +65,7 @@ std::ostream &operator<<(std::ostream &os, const ScriptError &err) {
 BasicTestingSetup::BasicTestingSetup(const std::string &chainName)
     : m_path_root(MakePathRoot()) {
     SHA256AutoDetect();
+    HexAutoDetect();
     ECC_Start();
     SetupEnvironment();
     SetupNetworking();
@@ -194,15 +197,16 @@ TestingSetup::TestingSetup(const std::string &chainName)
         }
     }
 
-    // Start script-checking threads
-    constexpr int script_check_threads = 2;
-    StartScriptCheckWorkerThreads(script_check_threads);
-
     g_banman =
         std::make_unique<BanMan>(GetDataDir() / "banlist.dat", chainparams,
                                  nullptr, DEFAULT_MANUAL_BANTIME);
     // Deterministic randomness for tests.
     g_connman = std::make_unique<CConnman>(config, 0x1337, 0x1337);
+
+    // Start script-checking threads last: the destructor, which stops them,
+    // does not run if the constructor throws.
+    constexpr int script_check_threads = 2;
+    StartScriptCheckWorkerThreads(script_check_threads);
 }
 
 TestingSetup::~TestingSetup() {
@@ -286,6 +290,36 @@ CBlock TestChain100Setup::CreateAndProcessBlock(
     return result;
 }
 
+void TestChain100Setup::SignAll(const CTransaction &tx_from, const CKey &key,
+                                CMutableTransaction &tx) {
+    FlatSigningProvider provider;
+    provider.keys[key.GetPubKey().GetID()] = key;
+    provider.pubkeys[key.GetPubKey().GetID()] = key.GetPubKey();
+
+    const uint32_t flags = WITH_LOCK(
+        cs_main, return GetMemPoolScriptFlags(
+                     GetConfig().GetChainParams().GetConsensus(),
+                     ::ChainActive().Tip()));
+    for (size_t n = 0; n < tx.vin.size(); ++n) {
+        if (!SignSignature(provider, tx_from, tx, n, SigHashType().withFork(),
+                           flags, std::nullopt)) {
+            throw std::runtime_error(strprintf(
+                "Failed to sign input %u of %s", n, tx.GetId().ToString()));
+        }
+    }
+}
+
+CMutableTransaction
+TestChain100Setup::Spend(const CTransaction &tx_from, uint32_t n,
+                         const CKey &key, const std::vector<CTxOut> &outputs) {
+    CMutableTransaction tx;
+    tx.nVersion = 1;
+    tx.vin.emplace_back(COutPoint(tx_from.GetId(), n));
+    tx.vout = outputs;
+    SignAll(tx_from, key, tx);
+    return tx;
+}
+
 TestChain100Setup::~TestChain100Setup() {}
 
 CTxMemPoolEntry TestMemPoolEntryHelper::FromTx(const CMutableTransaction &tx) {
@@ -138,6 +138,18 @@ struct TestChain100Setup : public TestingSetup {
     CBlock CreateAndProcessBlock(const std::vector<CMutableTransaction> &txns,
                                  const CScript &scriptPubKey);
 
+    // Sign all the inputs of tx, which spend outputs of tx_from locked to the
+    // public key or the public key hash of key, with the script flags of the
+    // mempool.
+    static void SignAll(const CTransaction &tx_from, const CKey &key,
+                        CMutableTransaction &tx);
+
+    // Spend output n of tx_from, locked to the public key or the public key
+    // hash of key, to outputs.
+    static CMutableTransaction Spend(const CTransaction &tx_from, uint32_t n,
+                                     const CKey &key,
+                                     const std::vector<CTxOut> &outputs);
+
     ~TestChain100Setup() override;
 
     // For convenience, coinbase transactions.
@@ -14,6 +14,7 @@
 #include <util/strencodings.h>
 
 #include <test/setup_common.h>
+#include <test/sigutil.h>
 
 #include <boost/test/unit_test.hpp>
 
@@ -25,30 +26,6 @@ static const std::string strSecret1 =
 static const std::string strSecret1C =
     "Kwr371tjA9u2rFSMZjTNun2PXXP3WPZu2afRHTcta6KxEUdm1vEw";
 
-/**
- * Sigcache is only accessible via CachingTransactionSignatureChecker
- * as friend.
- */
-class TestCachingTransactionSignatureChecker {
-    CachingTransactionSignatureChecker *pchecker;
-
-public:
-    TestCachingTransactionSignatureChecker(
-        CachingTransactionSignatureChecker &checkerarg) {
-        pchecker = &checkerarg;
-    }
-
-    inline bool VerifyAndStore(const std::vector<uint8_t> &vchSig,
-                               const CPubKey &pubkey, const uint256 &sighash) {
-        return pchecker->VerifySignature(vchSig, pubkey, sighash);
-    }
-
-    inline bool IsCached(const std::vector<uint8_t> &vchSig,
-                         const CPubKey &pubkey, const uint256 &sighash) {
-        return pchecker->IsCached(vchSig, pubkey, sighash);
-    }
-};
-
 BOOST_FIXTURE_TEST_SUITE(sigcache_tests, BasicTestingSetup)
 
 BOOST_AUTO_TEST_CASE(sig_pubkey_hash_variations) {
@@ -116,4 +93,94 @@ BOOST_AUTO_TEST_CASE(sig_pubkey_hash_variations) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(batched_schnorr_deferral) {
+    CDataStream stream(
+        ParseHex(
+            "010000000122739e70fbee987a8be1788395a2f2e6ad18ccb7ff611cd798071539"
+            "dde3c38e000000000151ffffffff010000000000000000016a00000000"),
+        SER_NETWORK, PROTOCOL_VERSION);
+    CTransaction dummyTx(deserialize, stream);
+    ScriptExecutionContext limitedContext(0, CTxOut{0 * SATOSHI, {}}, dummyTx);
+    PrecomputedTransactionData txdata(limitedContext);
+    CachingTransactionSignatureChecker checker(limitedContext, true, txdata);
+    TestCachingTransactionSignatureChecker testChecker(checker);
+
+    CKey key = DecodeSecret(strSecret1C);
+    CPubKey pubkey = key.GetPubKey();
+
+    std::vector<uint256> hashes;
+    std::vector<std::vector<uint8_t>> sigs;
+    for (int n = 0; n < 8; n++) {
+        hashes.push_back(Hash(strprintf("Sigcache batch test %i", n)));
+        sigs.emplace_back();
+        BOOST_CHECK(key.SignSchnorr(hashes.back(), sigs.back()));
+    }
+
+    // All valid: deferred, then verified and cached at once.
+    {
+        SchnorrSigBatch batch;
+        for (size_t i = 0; i < sigs.size(); i++) {
+            BatchingTransactionSignatureChecker batchChecker(limitedContext, true, txdata, batch, i);
+            BOOST_CHECK(batchChecker.VerifySignature(sigs[i], pubkey, hashes[i]));
+            BOOST_CHECK(!testChecker.IsCached(sigs[i], pubkey, hashes[i]));
+        }
+        BOOST_CHECK_EQUAL(batch.size(), sigs.size());
+        BOOST_CHECK(batch.Verify());
+        BOOST_CHECK(!batch.FindInvalid());
+        for (size_t i = 0; i < sigs.size(); i++) {
+            BOOST_CHECK(testChecker.IsCached(sigs[i], pubkey, hashes[i]));
+        }
+    }
+
+    // Cached signatures are not deferred again.
+    {
+        SchnorrSigBatch batch;
+        BatchingTransactionSignatureChecker batchChecker(limitedContext, true, txdata, batch, 0);
+        BOOST_CHECK(batchChecker.VerifySignature(sigs[0], pubkey, hashes[0]));
+        BOOST_CHECK(batch.empty());
+    }
+
+    // ECDSA signatures are verified immediately.
+    {
+        SchnorrSigBatch batch;
+        BatchingTransactionSignatureChecker batchChecker(limitedContext, false, txdata, batch, 0);
+        std::vector<uint8_t> ecdsaSig;
+        BOOST_CHECK(key.SignECDSA(hashes[0], ecdsaSig));
+        BOOST_CHECK(batchChecker.VerifySignature(ecdsaSig, pubkey, hashes[0]));
+        BOOST_CHECK(!batchChecker.VerifySignature(ecdsaSig, pubkey, hashes[1]));
+        BOOST_CHECK(batch.empty());
+    }
+
+    // A single bad signature fails the batch and is attributed to its tag.
+    {
+        const uint256 otherHash = Hash(std::string("Sigcache batch test other"));
+        SchnorrSigBatch batch;
+        for (size_t i = 0; i < sigs.size(); i++) {
+            std::vector<uint8_t> sig;
+            BOOST_CHECK(key.SignSchnorr(otherHash, sig));
+            const uint256 &hash = i == 5 ? hashes[i] : otherHash;
+            BatchingTransactionSignatureChecker batchChecker(limitedContext, true, txdata, batch, 100 + i);
+            BOOST_CHECK(batchChecker.VerifySignature(sig, pubkey, hash));
+        }
+        BOOST_CHECK(!batch.Verify());
+        const auto invalid = batch.FindInvalid();
+        BOOST_REQUIRE(invalid);
+        BOOST_CHECK_EQUAL(*invalid, 105U);
+    }
+
+    // Batch verification agrees with individual verification.
+    {
+        std::vector<SchnorrSigCheck> checks(sigs.size());
+        for (size_t i = 0; i < sigs.size(); i++) {
+            checks[i].pubkey = pubkey;
+            checks[i].hash = hashes[i];
+            std::copy(sigs[i].begin(), sigs[i].end(), checks[i].sig.begin());
+        }
+        BOOST_CHECK(CPubKey::VerifySchnorrBatch(checks));
+        BOOST_CHECK(CPubKey::VerifySchnorrBatch({}));
+        std::swap(checks[0].hash, checks[1].hash);
+        BOOST_CHECK(!CPubKey::VerifySchnorrBatch(checks));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
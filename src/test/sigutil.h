@@ -4,7 +4,33 @@
 
 #pragma once
 
+#include <script/sigcache.h>
+
 #include <cstdint>
 #include <vector>
 
 void NegateSignatureS(std::vector<uint8_t> &vchSig);
+
+/**
+ * Sigcache is only accessible via CachingTransactionSignatureChecker
+ * as friend.
+ */
+class TestCachingTransactionSignatureChecker {
+    CachingTransactionSignatureChecker *pchecker;
+
+public:
+    TestCachingTransactionSignatureChecker(
+        CachingTransactionSignatureChecker &checkerarg) {
+        pchecker = &checkerarg;
+    }
+
+    inline bool VerifyAndStore(const std::vector<uint8_t> &vchSig,
+                               const CPubKey &pubkey, const uint256 &sighash) {
+        return pchecker->VerifySignature(vchSig, pubkey, sighash);
+    }
+
+    inline bool IsCached(const std::vector<uint8_t> &vchSig,
+                         const CPubKey &pubkey, const uint256 &sighash) {
+        return pchecker->IsCached(vchSig, pubkey, sighash);
+    }
+};
@@ -0,0 +1,105 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <config.h>
+#include <index/spentindex.h>
+#include <validation.h>
+
+#include <test/setup_common.h>
+#include <test/util.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <optional>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(spentindex_tests, TestChain100Setup)
+
+static void CheckSpentInfo(const std::optional<SpentIndex::SpentInfo> &info,
+                           const TxId &txid, uint32_t input_index,
+                           int height) {
+    BOOST_REQUIRE(info);
+    BOOST_CHECK(info->txid == txid);
+    BOOST_CHECK_EQUAL(info->input_index, input_index);
+    BOOST_CHECK_EQUAL(info->height, height);
+}
+
+BOOST_AUTO_TEST_CASE(spentindex_spends_and_rollback) {
+    const CScript coinbase_script = CScript()
+                                    << ToByteVector(coinbaseKey.GetPubKey())
+                                    << OP_CHECKSIG;
+
+    // Block 101 spends the first coinbase.
+    const CTransaction &coinbase = *m_coinbase_txns[0];
+    const CMutableTransaction tx1 =
+        Spend(coinbase, 0, coinbaseKey,
+              {CTxOut(10 * COIN, coinbase_script),
+               CTxOut(coinbase.vout[0].nValue - 11 * COIN, coinbase_script)});
+    CreateAndProcessBlock({tx1}, coinbase_script);
+
+    SpentIndex spent_index(1 << 20, true);
+    BOOST_CHECK(!spent_index.BlockUntilSyncedToCurrentChain());
+    spent_index.Start();
+
+    WaitForIndexSync(spent_index);
+
+    // Block 102, connected while the index is running, spends the second
+    // output of tx1, and then the first output of the transaction doing so.
+    const CMutableTransaction tx2 =
+        Spend(CTransaction(tx1), 1, coinbaseKey,
+              {CTxOut(tx1.vout[1].nValue - COIN, coinbase_script)});
+    const CMutableTransaction tx3 =
+        Spend(CTransaction(tx2), 0, coinbaseKey,
+              {CTxOut(tx2.vout[0].nValue - COIN, coinbase_script)});
+    CreateAndProcessBlock({tx2, tx3}, coinbase_script);
+    BOOST_CHECK(spent_index.BlockUntilSyncedToCurrentChain());
+
+    // Nothing is spent by the genesis block.
+    const COutPoint genesis_outpoint(Params().GenesisBlock().vtx[0]->GetId(),
+                                     0);
+    SpentIndex::SpentInfo info;
+    BOOST_CHECK(!spent_index.FindSpentInfo(genesis_outpoint, info));
+    BOOST_REQUIRE(
+        spent_index.FindSpentInfo(COutPoint(coinbase.GetId(), 0), info));
+    CheckSpentInfo(info, tx1.GetId(), 0, 101);
+
+    // The batched lookup returns one entry per outpoint, in the order given.
+    const std::vector<COutPoint> outpoints{
+        COutPoint(tx2.GetId(), 0),     COutPoint(tx1.GetId(), 0),
+        COutPoint(coinbase.GetId(), 0), COutPoint(tx1.GetId(), 1),
+        COutPoint(tx3.GetId(), 0),     COutPoint(tx1.GetId(), 1)};
+    std::vector<std::optional<SpentIndex::SpentInfo>> infos;
+    BOOST_REQUIRE(spent_index.FindSpentInfo(outpoints, infos));
+    BOOST_REQUIRE_EQUAL(infos.size(), outpoints.size());
+    CheckSpentInfo(infos[0], tx3.GetId(), 0, 102);
+    BOOST_CHECK(!infos[1]);
+    CheckSpentInfo(infos[2], tx1.GetId(), 0, 101);
+    CheckSpentInfo(infos[3], tx2.GetId(), 0, 102);
+    BOOST_CHECK(!infos[4]);
+    CheckSpentInfo(infos[5], tx2.GetId(), 0, 102);
+
+    BOOST_REQUIRE(spent_index.FindSpentInfo({}, infos));
+    BOOST_CHECK(infos.empty());
+
+    // Replace block 102 by an empty block: its spends are removed.
+    InvalidateBlockAndClearMempool(
+        GetConfig(), WITH_LOCK(cs_main, return ::ChainActive().Tip()));
+    CreateAndProcessBlock({}, CScript() << OP_2);
+    BOOST_CHECK_EQUAL(WITH_LOCK(cs_main, return ::ChainActive().Height()), 102);
+    BOOST_CHECK(spent_index.BlockUntilSyncedToCurrentChain());
+
+    BOOST_REQUIRE(spent_index.FindSpentInfo(outpoints, infos));
+    BOOST_REQUIRE_EQUAL(infos.size(), outpoints.size());
+    BOOST_CHECK(!infos[0]);
+    BOOST_CHECK(!infos[1]);
+    CheckSpentInfo(infos[2], tx1.GetId(), 0, 101);
+    BOOST_CHECK(!infos[3]);
+    BOOST_CHECK(!infos[4]);
+    BOOST_CHECK(!infos[5]);
+
+    spent_index.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,211 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <clientversion.h>
+#include <config.h>
+#include <index/tokenindex.h>
+#include <primitives/token.h>
+#include <streams.h>
+#include <util/system.h>
+#include <validation.h>
+
+#include <test/setup_common.h>
+#include <test/util.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(tokenindex_tests, TestingSetup)
+
+// Mixin to ensure tokens are enabled for this test
+struct Upgrade9ActivatedMixin {
+    std::optional<std::string> optOrigUpgrade9ActivationTime;
+
+    Upgrade9ActivatedMixin() {
+        if (gArgs.IsArgSet("-upgrade9activationtime")) {
+            optOrigUpgrade9ActivationTime =
+                gArgs.GetArg("-upgrade9activationtime", "");
+        }
+        gArgs.ForceSetArg("-upgrade9activationtime", "0");
+    }
+
+    ~Upgrade9ActivatedMixin() {
+        gArgs.ClearArg("-upgrade9activationtime");
+        if (optOrigUpgrade9ActivationTime) {
+            gArgs.SoftSetArg("-upgrade9activationtime",
+                             *optOrigUpgrade9ActivationTime);
+        }
+    }
+};
+
+struct Upgrade9TestChain100Setup : Upgrade9ActivatedMixin, TestChain100Setup {};
+
+static token::SafeAmount TokenAmount(int64_t amount) {
+    return token::SafeAmount::fromInt(amount).value();
+}
+
+/** An output of value to script holding the tokens data. */
+static CTxOut TokenOutput(const Amount value, const CScript &script,
+                          const token::OutputData &data) {
+    CTxOut txout(value, script);
+    txout.tokenDataPtr.emplace(data);
+    return txout;
+}
+
+static void CheckStats(const TokenIndex &token_index,
+                       const token::Id &category, int64_t fungible_amount,
+                       uint64_t utxo_count, uint64_t nft_immutable,
+                       uint64_t nft_mutable, uint64_t nft_minting) {
+    TokenIndex::CategoryStats stats;
+    BOOST_REQUIRE(token_index.FindCategoryStats(category, stats));
+    BOOST_CHECK_EQUAL(stats.fungible_amount, fungible_amount);
+    BOOST_CHECK_EQUAL(stats.utxo_count, utxo_count);
+    BOOST_CHECK_EQUAL(stats.nft_immutable, nft_immutable);
+    BOOST_CHECK_EQUAL(stats.nft_mutable, nft_mutable);
+    BOOST_CHECK_EQUAL(stats.nft_minting, nft_minting);
+}
+
+BOOST_AUTO_TEST_CASE(tokenindex_initial_sync) {
+    TokenIndex token_index(1 << 20, true);
+
+    BOOST_CHECK(!token_index.BlockUntilSyncedToCurrentChain());
+
+    token_index.Start();
+
+    WaitForIndexSync(token_index);
+
+    // No category has any supply.
+    const token::Id category(InsecureRand256());
+    TokenIndex::CategoryStats stats;
+    BOOST_CHECK(!token_index.FindCategoryStats(category, stats));
+    BOOST_CHECK_EQUAL(stats.utxo_count, 0U);
+    std::vector<TokenIndex::Unspent> unspent;
+    BOOST_REQUIRE(token_index.FindUnspent(category, unspent));
+    BOOST_CHECK(unspent.empty());
+
+    token_index.Stop();
+}
+
+BOOST_FIXTURE_TEST_CASE(tokenindex_supply_and_rollback,
+                        Upgrade9TestChain100Setup) {
+    const CScript coinbase_script = CScript()
+                                    << ToByteVector(coinbaseKey.GetPubKey())
+                                    << OP_CHECKSIG;
+
+    // Block 101 creates the category, spending the output 0 of a coinbase,
+    // with a fungible amount and a minting NFT.
+    const CTransaction &coinbase = *m_coinbase_txns[0];
+    const token::Id category(coinbase.GetId());
+    CMutableTransaction genesis_tx;
+    genesis_tx.nVersion = 1;
+    genesis_tx.vin.emplace_back(COutPoint(coinbase.GetId(), 0));
+    genesis_tx.vout.push_back(TokenOutput(
+        COIN, coinbase_script, token::OutputData(category, TokenAmount(1000))));
+    genesis_tx.vout.push_back(
+        TokenOutput(COIN, coinbase_script,
+                    token::OutputData(category, TokenAmount(0), {}, true,
+                                      false, true)));
+    genesis_tx.vout.emplace_back(coinbase.vout[0].nValue - 3 * COIN,
+                                 coinbase_script);
+    SignAll(coinbase, coinbaseKey, genesis_tx);
+    CreateAndProcessBlock({genesis_tx}, coinbase_script);
+
+    TokenIndex token_index(1 << 20, true);
+    BOOST_CHECK(!token_index.BlockUntilSyncedToCurrentChain());
+    token_index.Start();
+
+    WaitForIndexSync(token_index);
+
+    CheckStats(token_index, category, 1000, 2, 0, 0, 1);
+    std::vector<TokenIndex::Unspent> unspent;
+    BOOST_REQUIRE(token_index.FindUnspent(category, unspent));
+    BOOST_REQUIRE_EQUAL(unspent.size(), 2U);
+    for (uint32_t n = 0; n < unspent.size(); ++n) {
+        BOOST_CHECK_EQUAL(unspent[n].height, 101);
+        BOOST_CHECK(unspent[n].outpoint == COutPoint(genesis_tx.GetId(), n));
+        BOOST_CHECK(unspent[n].txout == genesis_tx.vout[n]);
+    }
+
+    // Block 102, connected while the index is running, splits the fungible
+    // amount, burning 100 of it, and mints a mutable and an immutable NFT.
+    const token::NFTCommitment commitment(size_t{2}, uint8_t{0xab});
+    CMutableTransaction transfer_tx;
+    transfer_tx.nVersion = 1;
+    transfer_tx.vin.emplace_back(COutPoint(genesis_tx.GetId(), 0));
+    transfer_tx.vin.emplace_back(COutPoint(genesis_tx.GetId(), 1));
+    transfer_tx.vout.push_back(
+        TokenOutput(COIN / 2, coinbase_script,
+                    token::OutputData(category, TokenAmount(600))));
+    transfer_tx.vout.push_back(
+        TokenOutput(COIN / 2, coinbase_script,
+                    token::OutputData(category, TokenAmount(300))));
+    transfer_tx.vout.push_back(
+        TokenOutput(COIN / 4, coinbase_script,
+                    token::OutputData(category, TokenAmount(0), {}, true,
+                                      false, true)));
+    transfer_tx.vout.push_back(
+        TokenOutput(COIN / 4, coinbase_script,
+                    token::OutputData(category, TokenAmount(0), commitment,
+                                      true, true, false)));
+    transfer_tx.vout.push_back(
+        TokenOutput(COIN / 4, coinbase_script,
+                    token::OutputData(category, TokenAmount(0), commitment,
+                                      true)));
+    SignAll(CTransaction(genesis_tx), coinbaseKey, transfer_tx);
+    CreateAndProcessBlock({transfer_tx}, coinbase_script);
+    BOOST_CHECK(token_index.BlockUntilSyncedToCurrentChain());
+
+    CheckStats(token_index, category, 900, 5, 1, 1, 1);
+    BOOST_REQUIRE(token_index.FindUnspent(category, unspent));
+    BOOST_REQUIRE_EQUAL(unspent.size(), 5U);
+    for (uint32_t n = 0; n < unspent.size(); ++n) {
+        BOOST_CHECK_EQUAL(unspent[n].height, 102);
+        BOOST_CHECK(unspent[n].outpoint == COutPoint(transfer_tx.GetId(), n));
+        BOOST_CHECK(unspent[n].txout == transfer_tx.vout[n]);
+    }
+
+    // Replace blocks 101 and 102 by empty blocks: the index rewinds both at
+    // once when the first replacement connects, and the category is gone.
+    InvalidateBlockAndClearMempool(
+        GetConfig(),
+        WITH_LOCK(cs_main, return ::ChainActive().Tip()->GetAncestor(101)));
+    CreateAndProcessBlock({}, CScript() << OP_2);
+    CreateAndProcessBlock({}, CScript() << OP_2);
+    BOOST_CHECK_EQUAL(WITH_LOCK(cs_main, return ::ChainActive().Height()), 102);
+    BOOST_CHECK(token_index.BlockUntilSyncedToCurrentChain());
+
+    TokenIndex::CategoryStats stats;
+    BOOST_CHECK(!token_index.FindCategoryStats(category, stats));
+    BOOST_REQUIRE(token_index.FindUnspent(category, unspent));
+    BOOST_CHECK(unspent.empty());
+
+    token_index.Stop();
+}
+
+BOOST_AUTO_TEST_CASE(tokenindex_category_stats_serialization) {
+    TokenIndex::CategoryStats stats;
+    stats.fungible_amount = std::numeric_limits<int64_t>::max();
+    stats.utxo_count = 3;
+    stats.nft_immutable = 1;
+    stats.nft_mutable = 0;
+    stats.nft_minting = 2;
+
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << stats;
+    TokenIndex::CategoryStats read;
+    ss >> read;
+    BOOST_CHECK(ss.empty());
+    BOOST_CHECK_EQUAL(read.fungible_amount, stats.fungible_amount);
+    BOOST_CHECK_EQUAL(read.utxo_count, stats.utxo_count);
+    BOOST_CHECK_EQUAL(read.nft_immutable, stats.nft_immutable);
+    BOOST_CHECK_EQUAL(read.nft_mutable, stats.nft_mutable);
+    BOOST_CHECK_EQUAL(read.nft_minting, stats.nft_minting);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -6,9 +6,15 @@
 #include <amount.h>
 #include <config.h>
 #include <consensus/validation.h>
+#include <key.h>
 #include <primitives/transaction.h>
+#include <script/interpreter.h>
 #include <script/script.h>
+#include <script/sighashtype.h>
+#include <script/sigcache.h>
+#include <shutdown.h>
 #include <test/setup_common.h>
+#include <test/sigutil.h>
 #include <txmempool.h>
 #include <validation.h>
 #include <consensus/tx_check.h>
@@ -16,6 +22,9 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <optional>
+#include <string>
+
 BOOST_AUTO_TEST_SUITE(txvalidation_tests)
 
 /**
@@ -112,4 +121,175 @@ BOOST_FIXTURE_TEST_CASE(tx_mempool_reject_dup_txin, TestChain100Setup) {
     }
 }
 
+/**
+ * Ensure that verifying transactions ahead of AcceptToMemoryPool, without the
+ * locks, does not change which of them are accepted.
+ */
+BOOST_FIXTURE_TEST_CASE(tx_mempool_preverify, TestingSetup) {
+    CKey key, otherKey;
+    key.MakeNewKey(true);
+    otherKey.MakeNewKey(true);
+    const CScript scriptPubKey = CScript() << ToByteVector(key.GetPubKey()) << OP_CHECKSIG;
+
+    const auto Spend = [&](const CTransaction &txFrom, uint32_t n, const CKey &signingKey,
+                           Amount fee = 10000 * SATOSHI) {
+        CMutableTransaction tx;
+        tx.nVersion = 1;
+        tx.vin.resize(1);
+        tx.vin[0].prevout = COutPoint(txFrom.GetId(), n);
+        tx.vout.resize(1);
+        tx.vout[0].nValue = txFrom.vout[n].nValue - fee;
+        tx.vout[0].scriptPubKey = scriptPubKey;
+        std::vector<uint8_t> vchSig;
+        const uint256 hash = SignatureHash(scriptPubKey, ScriptExecutionContext{0, txFrom.vout[n], tx},
+                                           SigHashType().withFork(), nullptr, STANDARD_SCRIPT_VERIFY_FLAGS);
+        BOOST_CHECK(signingKey.SignECDSA(hash, vchSig));
+        vchSig.push_back(uint8_t(SIGHASH_ALL | SIGHASH_FORKID));
+        tx.vin[0].scriptSig << vchSig;
+        return MakeTransactionRef(tx);
+    };
+
+    // The coins are those of a transaction in the mempool.
+    CMutableTransaction parent;
+    parent.nVersion = 1;
+    parent.vin.resize(1);
+    parent.vin[0].prevout = COutPoint(TxId(InsecureRand256()), 0);
+    parent.vout.resize(4);
+    for (auto &txout : parent.vout) {
+        txout.nValue = 100000 * SATOSHI;
+        txout.scriptPubKey = scriptPubKey;
+    }
+    const CTransactionRef parentRef = MakeTransactionRef(parent);
+    {
+        LOCK2(cs_main, g_mempool.cs);
+        g_mempool.addUnchecked(TestMemPoolEntryHelper().Time(GetTime()).FromTx(parentRef));
+    }
+
+    const CTransactionRef child0 = Spend(*parentRef, 0, key);
+    const CTransactionRef child1 = Spend(*parentRef, 1, key);
+    const CTransactionRef badChild = Spend(*parentRef, 2, otherKey);
+    // Pays no fee, so is rejected before its scripts are checked.
+    const CTransactionRef freeChild = Spend(*parentRef, 3, key, Amount::zero());
+    // Spends a transaction of the same batch.
+    const CTransactionRef grandChild = Spend(*child0, 0, key);
+    // Spends coins nobody has.
+    const CTransactionRef orphan = Spend(*Spend(*grandChild, 0, key), 0, key);
+    const std::vector<CTransactionRef> txs{child0, child1, badChild, freeChild, grandChild, orphan, parentRef};
+
+    // Whether the signature of the input of tx, spending output n of txFrom
+    // signed by signingKey, is in the signature cache.
+    const auto IsSigCached = [&](const CTransaction &txFrom, uint32_t n, const CTransaction &tx,
+                                 const CKey &signingKey) {
+        const ScriptExecutionContext context{0, txFrom.vout[n], tx};
+        const uint256 hash =
+            SignatureHash(scriptPubKey, context, SigHashType().withFork(), nullptr, STANDARD_SCRIPT_VERIFY_FLAGS);
+        std::vector<uint8_t> vchSig;
+        BOOST_CHECK(signingKey.SignECDSA(hash, vchSig));
+        PrecomputedTransactionData txdata(context);
+        CachingTransactionSignatureChecker checker(context, false /* store */, txdata);
+        return TestCachingTransactionSignatureChecker(checker).IsCached(vchSig, key.GetPubKey(), hash);
+    };
+    BOOST_CHECK(!IsSigCached(*parentRef, 0, *child0, key));
+    BOOST_CHECK(!IsSigCached(*parentRef, 1, *child1, key));
+    BOOST_CHECK(!IsSigCached(*child0, 0, *grandChild, key));
+
+    // child1 is turned down by the caller, as if AcceptToMemoryPool() had
+    // rejected it for a reason found after its scripts were verified.
+    // '+' for a transaction found valid, '-' for one found invalid, and ' '
+    // for one not verified.
+    std::string preverifiedResults(txs.size(), '?');
+    std::vector<bool> accepted(txs.size());
+    std::optional<PreVerifiedTx> badChildResult;
+    StartTxPreVerifyThreads(2);
+    PreVerifyTransactions(GetConfig(), g_mempool, txs, [&](size_t i, const PreVerifiedTx *preverified) -> bool {
+        preverifiedResults[i] = !preverified ? ' ' : preverified->valid ? '+' : '-';
+        if (i == 0) {
+            // The valid signatures are cached before AcceptToMemoryPool()
+            // runs, and the invalid one failed verification, so it is not.
+            BOOST_CHECK(IsSigCached(*parentRef, 0, *child0, key));
+            BOOST_CHECK(IsSigCached(*parentRef, 1, *child1, key));
+            BOOST_CHECK(IsSigCached(*child0, 0, *grandChild, key));
+            BOOST_CHECK(!IsSigCached(*parentRef, 2, *badChild, otherKey));
+            BOOST_CHECK(!IsSigCached(*parentRef, 3, *freeChild, key));
+        }
+        if (preverified) {
+            BOOST_CHECK(preverified->txid == txs[i]->GetId());
+        }
+        if (txs[i] == badChild) {
+            badChildResult = *preverified;
+        }
+        if (txs[i] == child1) {
+            return false;
+        }
+        LOCK(cs_main);
+        CValidationState state;
+        bool fMissingInputs = false;
+        accepted[i] = AcceptToMemoryPool(GetConfig(), g_mempool, state, txs[i], &fMissingInputs,
+                                         false /* bypass_limits */, Amount::zero() /* nAbsurdFee */,
+                                         false /* test_accept */, preverified);
+        if (txs[i] == freeChild) {
+            BOOST_CHECK_EQUAL(state.GetRejectReason(), "min relay fee not met");
+        } else if (txs[i] == orphan) {
+            BOOST_CHECK(fMissingInputs);
+        } else if (txs[i] == badChild) {
+            // Rejected as AcceptToMemoryPool() would have rejected it.
+            int nDoS = 0;
+            BOOST_CHECK(state.IsInvalid(nDoS));
+            BOOST_CHECK_EQUAL(nDoS, 100);
+            BOOST_CHECK_EQUAL(state.GetRejectReason().rfind("mandatory-script-verify-flag-failed", 0), 0U);
+        }
+        return accepted[i];
+    });
+
+    BOOST_CHECK_EQUAL(preverifiedResults, "++- +  ");
+    BOOST_CHECK(accepted == std::vector<bool>({true, false, false, false, true, false, false}));
+    // The fee of the free transaction was checked before its scripts.
+    BOOST_CHECK(!IsSigCached(*parentRef, 3, *freeChild, key));
+    BOOST_CHECK_EQUAL(g_mempool.size(), 3U);
+
+    // AcceptToMemoryPool() does not verify the scripts again: it takes a
+    // result claiming the invalid transaction is valid, unless the script
+    // flags changed since it was found.
+    BOOST_REQUIRE(badChildResult);
+    PreVerifiedTx forged = *badChildResult;
+    forged.valid = true;
+    forged.state = CValidationState();
+    {
+        LOCK(cs_main);
+        CValidationState state;
+        BOOST_CHECK(AcceptToMemoryPool(GetConfig(), g_mempool, state, badChild, nullptr, false /* bypass_limits */,
+                                       Amount::zero() /* nAbsurdFee */, true /* test_accept */, &forged));
+        forged.scriptVerifyFlags ^= SCRIPT_VERIFY_NULLFAIL;
+        BOOST_CHECK(!AcceptToMemoryPool(GetConfig(), g_mempool, state, badChild, nullptr, false /* bypass_limits */,
+                                        Amount::zero() /* nAbsurdFee */, true /* test_accept */, &forged));
+        BOOST_CHECK(state.IsInvalid());
+    }
+
+    // A caller may keep the results for later, as is done for the relayed
+    // transactions, which leaves the signatures in the cache, unless shutdown
+    // was requested.
+    const CTransactionRef relayed = Spend(*grandChild, 0, key);
+    const CTransactionRef relayedAtShutdown = Spend(*grandChild, 0, key, 20000 * SATOSHI);
+    std::vector<PreVerifiedTx> kept;
+    const auto keep = [&](size_t i, const PreVerifiedTx *preverified) {
+        if (preverified) {
+            kept.push_back(*preverified);
+        }
+        return true;
+    };
+    PreVerifyTransactions(GetConfig(), g_mempool, {relayed}, keep);
+    BOOST_CHECK(IsSigCached(*grandChild, 0, *relayed, key));
+    BOOST_REQUIRE_EQUAL(kept.size(), 1U);
+    BOOST_CHECK(kept[0].valid);
+    BOOST_CHECK(kept[0].txid == relayed->GetId());
+    StartShutdown();
+    PreVerifyTransactions(GetConfig(), g_mempool, {relayedAtShutdown}, keep);
+    AbortShutdown();
+    BOOST_CHECK(!IsSigCached(*grandChild, 0, *relayedAtShutdown, key));
+    BOOST_CHECK_EQUAL(kept.size(), 1U);
+    StopTxPreVerifyThreads();
+
+    g_mempool.clear();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
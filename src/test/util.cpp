@@ -9,10 +9,18 @@
 #include <chainparams.h>
 #include <config.h>
 #include <consensus/merkle.h>
+#include <consensus/validation.h>
+#include <index/base.h>
 #include <miner.h>
 #include <pow.h>
+#include <shutdown.h>
+#include <tinyformat.h>
+#include <txmempool.h>
+#include <util/time.h>
 #include <validation.h>
 
+#include <stdexcept>
+
 CTxIn MineBlock(const Config &config, const CScript &coinbase_scriptPubKey) {
     auto block = PrepareBlock(config, coinbase_scriptPubKey);
 
@@ -40,3 +48,20 @@ std::shared_ptr<CBlock> PrepareBlock(const Config &config,
 
     return block;
 }
+
+void WaitForIndexSync(BaseIndex &index) {
+    while (!index.BlockUntilSyncedToCurrentChain()) {
+        if (ShutdownRequested()) {
+            throw std::runtime_error("The index failed to sync.");
+        }
+        MilliSleep(10);
+    }
+}
+
+void InvalidateBlockAndClearMempool(const Config &config, CBlockIndex *pindex) {
+    CValidationState state;
+    if (!InvalidateBlock(config, state, pindex)) {
+        throw std::runtime_error(strprintf("InvalidateBlock failed. (%s)", FormatStateMessage(state)));
+    }
+    ::g_mempool.clear();
+}
@@ -5,9 +5,14 @@
 
 #pragma once
 
+#include <net.h>
+
 #include <memory>
+#include <thread>
 
+class BaseIndex;
 class CBlock;
+class CBlockIndex;
 class Config;
 class CScript;
 class CTxIn;
@@ -20,3 +25,49 @@ CTxIn MineBlock(const Config &config, const CScript &coinbase_scriptPubKey);
 /** Prepare a block to be mined */
 std::shared_ptr<CBlock> PrepareBlock(const Config &config,
                                      const CScript &coinbase_scriptPubKey);
+
+/**
+ * Wait for index to catch up with the block index, however long it takes. It
+ * only stops short of it on a fatal error, which requests shutdown: throws
+ * then.
+ */
+void WaitForIndexSync(BaseIndex &index);
+
+/**
+ * Invalidate pindex, disconnecting it and the blocks after it, and clear the
+ * mempool, to which their transactions went back: the next block mined would
+ * include them otherwise, and its coinbase claim their fees.
+ */
+void InvalidateBlockAndClearMempool(const Config &config, CBlockIndex *pindex);
+
+/** Access to the internals of CConnman. */
+struct CConnmanTest : public CConnman {
+    using CConnman::CConnman;
+    void AddNode(CNode &node) {
+        AddSocketEvents(&node);
+        LOCK(cs_vNodes);
+        vNodes.push_back(&node);
+    }
+    void ClearNodes() {
+        LOCK(cs_vNodes);
+        for (CNode *node : vNodes) {
+            delete node;
+        }
+        vNodes.clear();
+    }
+    void SocketHandler() { CConnman::SocketHandler(); }
+    void StartMessageHandlers() {
+        flagInterruptMsgProc = false;
+        for (int i = 0; i < nMessageHandlerThreads; ++i) {
+            messageHandlers[i].thread = std::thread(&CConnman::ThreadMessageHandler, this, i);
+        }
+    }
+    void StopMessageHandlers() {
+        Interrupt();
+        for (MessageHandler &handler : messageHandlers) {
+            if (handler.thread.joinable()) {
+                handler.thread.join();
+            }
+        }
+    }
+};
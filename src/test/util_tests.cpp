@@ -161,6 +161,66 @@ BOOST_AUTO_TEST_CASE(util_HexStr) {
     BOOST_CHECK_EQUAL(HexStr(ParseHex_expected + 10, ParseHex_expected + 1, true), "");
 }
 
+BOOST_AUTO_TEST_CASE(util_HexEncode) {
+    // Encoding piece by piece gives the same as HexStr.
+    std::string hex(2 * sizeof(ParseHex_expected), '\0');
+    const Span<const uint8_t> input(ParseHex_expected);
+    for (size_t pos = 0; pos < input.size(); pos += 7) {
+        HexEncode(input.subspan(pos, std::min<size_t>(7, input.size() - pos)), &hex[2 * pos]);
+    }
+    BOOST_CHECK_EQUAL(hex, HexStr(input));
+
+    HexEncode(input.first(0), nullptr);
+}
+
+namespace {
+/** The byte at a time ParseHex, to compare the block kernels with. */
+std::vector<uint8_t> ParseHexReference(const char *psz) {
+    std::vector<uint8_t> vch;
+    while (true) {
+        while (IsSpace(*psz)) {
+            psz++;
+        }
+        const signed char high = HexDigit(*psz++);
+        if (high < 0) {
+            break;
+        }
+        const signed char low = HexDigit(*psz++);
+        if (low < 0) {
+            break;
+        }
+        vch.push_back(uint8_t(high << 4) | uint8_t(low));
+    }
+    return vch;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(util_Hex_kernels) {
+    BOOST_TEST_MESSAGE("Using the '" << HexAutoDetect() << "' hex implementation");
+    for (size_t size = 0; size < 300; size += 1 + size / 16) {
+        const std::vector<uint8_t> bytes = g_insecure_rand_ctx.randbytes(size);
+        const std::string hex = HexStr(bytes);
+        // Compare with the byte at a time HexStr.
+        BOOST_CHECK_EQUAL(hex, HexStr(bytes.begin(), bytes.end()));
+        BOOST_CHECK(ParseHex(hex) == bytes);
+        BOOST_CHECK(ParseHex(ToUpper(hex)) == bytes);
+        if (size == 0) {
+            continue;
+        }
+
+        // Decoding stops at any character which is not a hex digit, whether
+        // or not it is whitespace, wherever it is.
+        for (const char c : {' ', '\n', 'g', 'G', '/', ':', '@', '`', '\x80', '\xe1'}) {
+            std::string bad = hex;
+            bad[InsecureRandRange(bad.size())] = c;
+            BOOST_CHECK(ParseHex(bad) == ParseHexReference(bad.c_str()));
+            BOOST_CHECK(ParseHex(bad.c_str()) == ParseHexReference(bad.c_str()));
+        }
+        // Odd lengths leave out the last digit.
+        BOOST_CHECK(ParseHex(hex.substr(1)) == ParseHexReference(hex.c_str() + 1));
+    }
+}
+
 /// Test string utility functions: trim
 BOOST_AUTO_TEST_CASE(util_TrimString, *boost::unit_test::timeout(5)) {
     static const std::string pattern = " \t\r\n";
@@ -0,0 +1,97 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <util/threadpool.h>
+
+#include <test/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(util_threadpool_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(for_each) {
+    ThreadPool pool("test");
+
+    // Not started: the calling thread does everything.
+    const std::thread::id caller = std::this_thread::get_id();
+    std::vector<int> calls(1000);
+    pool.ForEach(calls.size(), [&](size_t i) {
+        BOOST_CHECK(std::this_thread::get_id() == caller);
+        ++calls[i];
+    });
+    BOOST_CHECK(calls == std::vector<int>(1000, 1));
+
+    pool.Start(4);
+    BOOST_CHECK_EQUAL(pool.Size(), 4U);
+    for (const size_t max_workers : {size_t(0), size_t(1), size_t(100)}) {
+        std::vector<std::atomic<int>> counts(1000);
+        std::mutex mutex;
+        std::set<std::thread::id> threads;
+        pool.ForEach(counts.size(), [&](size_t i) {
+            ++counts[i];
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.insert(std::this_thread::get_id());
+        }, max_workers);
+        for (const auto &count : counts) {
+            BOOST_CHECK_EQUAL(count, 1);
+        }
+        BOOST_CHECK_LE(threads.size(), 1 + std::min<size_t>(max_workers, 4));
+    }
+
+    // Nothing to do.
+    pool.ForEach(0, [](size_t) { BOOST_ERROR("called"); });
+
+    // Nested calls from all the workers make progress.
+    std::atomic<int> total{0};
+    pool.ForEach(8, [&](size_t) {
+        pool.ForEach(100, [&](size_t) { ++total; });
+    });
+    BOOST_CHECK_EQUAL(total, 800);
+
+    // The first exception is rethrown, once every call has returned.
+    std::atomic<int> running{0};
+    BOOST_CHECK_THROW(pool.ForEach(1000, [&](size_t i) {
+        ++running;
+        if (i == 10) {
+            --running;
+            throw std::runtime_error("failed");
+        }
+        --running;
+    }), std::runtime_error);
+    BOOST_CHECK_EQUAL(running, 0);
+
+    pool.Stop();
+    BOOST_CHECK_EQUAL(pool.Size(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(submit) {
+    ThreadPool pool("test");
+    pool.Start(2);
+    std::promise<std::thread::id> promise;
+    pool.Submit([&]() { promise.set_value(std::this_thread::get_id()); });
+    BOOST_CHECK(promise.get_future().get() != std::this_thread::get_id());
+
+    // Stopping runs the queued tasks first.
+    std::atomic<int> count{0};
+    for (int i = 0; i < 100; ++i) {
+        pool.Submit([&]() { ++count; });
+    }
+    pool.Stop();
+    BOOST_CHECK_EQUAL(count, 100);
+
+    // Without workers, tasks are run right away.
+    pool.Submit([&]() { ++count; });
+    BOOST_CHECK_EQUAL(count, 101);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
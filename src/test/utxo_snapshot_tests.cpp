@@ -0,0 +1,124 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <utxo_snapshot.h>
+
+#include <chainparams.h>
+#include <config.h>
+#include <fs.h>
+#include <random.h>
+#include <script/script.h>
+#include <txdb.h>
+#include <util/system.h>
+
+#include <test/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <functional>
+#include <utility>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(utxo_snapshot_tests, TestingSetup)
+
+namespace {
+std::vector<std::pair<COutPoint, Coin>> MakeCoins(size_t count) {
+    FastRandomContext rng(true);
+    std::vector<std::pair<COutPoint, Coin>> coins;
+    for (size_t i = 0; i < count; ++i) {
+        const CTxOut out(int64_t(rng.randrange(1000000)) * SATOSHI, CScript() << rng.randbytes(20) << OP_DROP);
+        coins.emplace_back(COutPoint(TxId(rng.rand256()), rng.randrange(4)),
+                           Coin(out, rng.randrange(1000), rng.randbool()));
+    }
+    return coins;
+}
+
+void FlipByte(const fs::path &path, long offset) {
+    FILE *file = fsbridge::fopen(path, "rb+");
+    BOOST_REQUIRE(file);
+    BOOST_REQUIRE_EQUAL(std::fseek(file, offset, offset < 0 ? SEEK_END : SEEK_SET), 0);
+    const int c = std::fgetc(file);
+    BOOST_REQUIRE_EQUAL(std::fseek(file, -1, SEEK_CUR), 0);
+    std::fputc(c ^ 0x01, file);
+    std::fclose(file);
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(coin_hash) {
+    const auto coins = MakeCoins(10);
+    ECMultiSet set, reordered;
+    for (const auto &[outpoint, coin] : coins) {
+        ApplyCoinHash(set, outpoint, coin);
+    }
+    for (auto it = coins.rbegin(); it != coins.rend(); ++it) {
+        ApplyCoinHash(reordered, it->first, it->second);
+    }
+    BOOST_CHECK(set == reordered);
+    BOOST_CHECK(!set.IsEmpty());
+
+    // The height and the coinbase flag are committed to.
+    const auto &[outpoint, coin] = coins[0];
+    ECMultiSet other = set;
+    RemoveCoinHash(other, outpoint, coin);
+    ApplyCoinHash(other, outpoint, Coin(coin.GetTxOut(), coin.GetHeight() + 1, coin.IsCoinBase()));
+    BOOST_CHECK(other != set);
+
+    for (const auto &[outpoint_, coin_] : coins) {
+        RemoveCoinHash(set, outpoint_, coin_);
+    }
+    BOOST_CHECK(set.IsEmpty());
+}
+
+BOOST_AUTO_TEST_CASE(write_and_check) {
+    const Config &config = GetConfig();
+    const BlockHash genesis = config.GetChainParams().GetConsensus().hashGenesisBlock;
+    const auto coins = MakeCoins(1000);
+    CCoinsViewDB db(1 << 20, true);
+    BOOST_REQUIRE(db.WriteSnapshotCoins({coins.begin(), coins.begin() + 500}, genesis, false));
+    // Not a valid chainstate until the last coins are written.
+    BOOST_CHECK(db.GetBestBlock().IsNull());
+    BOOST_CHECK_EQUAL(db.GetHeadBlocks().size(), 2U);
+    BOOST_REQUIRE(db.WriteSnapshotCoins({coins.begin() + 500, coins.end()}, genesis, true));
+    BOOST_CHECK(db.GetBestBlock() == genesis);
+    BOOST_CHECK(db.GetHeadBlocks().empty());
+
+    ECMultiSet expected;
+    for (const auto &[outpoint, coin] : coins) {
+        ApplyCoinHash(expected, outpoint, coin);
+    }
+
+    const fs::path path = GetDataDir() / "utxo.dat";
+    SnapshotMetadata written;
+    std::string error;
+    BOOST_REQUIRE(WriteUTXOSnapshot(config, db, path, written, [] {}, error));
+    BOOST_CHECK(written.base_hash == genesis);
+    BOOST_CHECK_EQUAL(written.base_height, 0);
+    BOOST_CHECK_EQUAL(written.coins_count, coins.size());
+    BOOST_CHECK(written.commitment == expected);
+    BOOST_CHECK(!fs::exists(GetDataDir() / "utxo.dat.incomplete"));
+
+    SnapshotMetadata read;
+    BOOST_CHECK(CheckUTXOSnapshot(config, path, read, error));
+    BOOST_CHECK(read.base_hash == genesis);
+    BOOST_CHECK_EQUAL(read.coins_count, coins.size());
+    BOOST_CHECK(read.commitment == expected);
+
+    // A coin which does not match the commitment.
+    FlipByte(path, -2);
+    BOOST_CHECK(!CheckUTXOSnapshot(config, path, read, error));
+    FlipByte(path, -2);
+    BOOST_CHECK(CheckUTXOSnapshot(config, path, read, error));
+
+    // A truncated snapshot.
+    fs::resize_file(path, fs::file_size(path) - 1);
+    BOOST_CHECK(!CheckUTXOSnapshot(config, path, read, error));
+
+    // A snapshot of another network.
+    BOOST_REQUIRE(WriteUTXOSnapshot(config, db, path, written, [] {}, error));
+    FlipByte(path, 8);
+    BOOST_CHECK(!CheckUTXOSnapshot(config, path, read, error));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,134 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <utxostats.h>
+
+#include <primitives/block.h>
+#include <random.h>
+#include <script/script.h>
+#include <txdb.h>
+#include <undo.h>
+#include <validation.h>
+
+#include <test/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(utxostats_tests, BasicTestingSetup)
+
+namespace {
+void CheckEqual(const CUTXOStats &a, const CUTXOStats &b) {
+    BOOST_CHECK(a.commitment == b.commitment);
+    BOOST_CHECK_EQUAL(a.nTransactionOutputs, b.nTransactionOutputs);
+    BOOST_CHECK_EQUAL(a.nBogoSize, b.nBogoSize);
+    BOOST_CHECK_EQUAL(a.nTotalAmount, b.nTotalAmount);
+    BOOST_CHECK(a.tokenAmounts == b.tokenAmounts);
+}
+
+CUTXOStats Compute(const CCoinsView &view) {
+    CUTXOStats stats;
+    BOOST_REQUIRE(ComputeUTXOStats(view, stats, [] {}));
+    return stats;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(connect_and_disconnect) {
+    FastRandomContext rng(true);
+    const token::Id category{rng.rand256()};
+    CCoinsViewDB db(1 << 20, true);
+
+    // A UTXO set with some token outputs.
+    std::vector<COutPoint> outpoints;
+    {
+        CCoinsViewCache cache(&db);
+        for (int i = 0; i < 20; ++i) {
+            CTxOut out(int64_t(1000 + i) * SATOSHI, CScript() << OP_TRUE);
+            if (i % 4 == 0) {
+                out.tokenDataPtr.emplace(category, token::SafeAmount::fromIntUnchecked(100 + i));
+            }
+            outpoints.emplace_back(TxId(rng.rand256()), i % 3);
+            cache.AddCoin(outpoints.back(), Coin(out, 1, false), false);
+        }
+        cache.SetBestBlock(BlockHash(rng.rand256()));
+        BOOST_REQUIRE(cache.Flush());
+    }
+    const CUTXOStats before = Compute(db);
+    BOOST_CHECK_EQUAL(before.nTransactionOutputs, 20U);
+    BOOST_CHECK_EQUAL(before.tokenAmounts.size(), 1U);
+
+    // A block spending half of them, burning tokens and creating an
+    // unspendable output, which is not part of the UTXO set.
+    CBlock block;
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vout.emplace_back(50 * COIN, CScript() << OP_TRUE);
+    coinbase.vout.emplace_back(Amount::zero(), CScript() << OP_RETURN);
+    block.vtx.push_back(MakeTransactionRef(coinbase));
+    for (size_t i = 0; i < outpoints.size() / 2; ++i) {
+        CMutableTransaction tx;
+        tx.vin.emplace_back(outpoints[i]);
+        tx.vout.emplace_back(500 * SATOSHI, CScript() << OP_TRUE << OP_DROP);
+        if (i == 4) {
+            tx.vout[0].tokenDataPtr.emplace(category, token::SafeAmount::fromIntUnchecked(1));
+        }
+        block.vtx.push_back(MakeTransactionRef(tx));
+    }
+
+    const int height = 2;
+    CBlockUndo blockundo;
+    {
+        CCoinsViewCache cache(&db);
+        for (const auto &tx : block.vtx) {
+            if (tx->IsCoinBase()) {
+                UpdateCoins(cache, *tx, height);
+            } else {
+                UpdateCoins(cache, *tx, blockundo.vtxundo.emplace_back(), height);
+            }
+        }
+        cache.SetBestBlock(BlockHash(rng.rand256()));
+        BOOST_REQUIRE(cache.Flush());
+    }
+    const CUTXOStats after = Compute(db);
+    BOOST_CHECK_EQUAL(after.nTransactionOutputs, 21U);
+
+    CUTXOStats change;
+    change.ConnectBlock(block, blockundo, height);
+    CUTXOStats connected = before;
+    connected += change;
+    CheckEqual(connected, after);
+
+    CUTXOStats disconnected = after;
+    disconnected.DisconnectBlock(block, blockundo, height);
+    CheckEqual(disconnected, before);
+
+    // The tokens of 3 outputs are spent, and 1 of them recreated.
+    BOOST_CHECK_EQUAL(change.tokenAmounts.at(category), 1 - (100 + 104 + 108));
+    BOOST_CHECK_EQUAL(after.tokenAmounts.at(category), 112 + 116 + 1);
+}
+
+BOOST_AUTO_TEST_CASE(persist_with_coins) {
+    FastRandomContext rng(true);
+    CCoinsViewDB db(1 << 20, true);
+    CUTXOStats stats;
+    stats.AddCoin(COutPoint(TxId(rng.rand256()), 0), Coin(CTxOut(5 * COIN, CScript() << OP_TRUE), 1, true));
+
+    BlockHash hashStats;
+    CUTXOStats read;
+    BOOST_CHECK(!db.ReadUTXOStats(hashStats, read));
+
+    // Only written along with the coins of the block they are for.
+    const BlockHash block1(rng.rand256()), block2(rng.rand256());
+    db.SetUTXOStats(block2, stats);
+    CCoinsMap coins;
+    BOOST_REQUIRE(db.WriteCoins(coins, block1));
+    BOOST_CHECK(!db.ReadUTXOStats(hashStats, read));
+    BOOST_REQUIRE(db.WriteCoins(coins, block2));
+    BOOST_REQUIRE(db.ReadUTXOStats(hashStats, read));
+    BOOST_CHECK(hashStats == block2);
+    CheckEqual(read, stats);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -28,6 +28,7 @@ static const char DB_HEAD_BLOCKS = 'H';
 static const char DB_FLAG = 'F';
 static const char DB_REINDEX_FLAG = 'R';
 static const char DB_LAST_BLOCK = 'l';
+static const char DB_UTXO_STATS = 'S';
 
 namespace {
 
@@ -74,6 +75,16 @@ std::vector<BlockHash> CCoinsViewDB::GetHeadBlocks() const {
 }
 
 bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) {
+    return DoBatchWrite(mapCoins, hashBlock, &mapCoins);
+}
+
+bool CCoinsViewDB::WriteCoins(const CCoinsMap &mapCoins, const BlockHash &hashBlock) {
+    return DoBatchWrite(mapCoins, hashBlock, nullptr);
+}
+
+bool CCoinsViewDB::DoBatchWrite(const CCoinsMap &mapCoins, const BlockHash &hashBlock,
+                                CCoinsMap *pmapErase) {
+    assert(!pmapErase || pmapErase == &mapCoins);
     CDBBatch batch(db);
     size_t count = 0;
     size_t changed = 0;
@@ -99,7 +110,7 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) {
     batch.Erase(DB_BEST_BLOCK);
     batch.Write(DB_HEAD_BLOCKS, Vector(hashBlock, old_tip));
 
-    for (CCoinsMap::iterator it = mapCoins.begin(); it != mapCoins.end();) {
+    for (CCoinsMap::const_iterator it = mapCoins.begin(); it != mapCoins.end();) {
         if (it->second.flags & CCoinsCacheEntry::DIRTY) {
             CoinEntry entry(&it->first);
             if (it->second.coin.IsSpent()) {
@@ -110,8 +121,10 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) {
             changed++;
         }
         count++;
-        CCoinsMap::iterator itOld = it++;
-        mapCoins.erase(itOld);
+        CCoinsMap::const_iterator itOld = it++;
+        if (pmapErase) {
+            pmapErase->erase(itOld);
+        }
         if (batch.SizeEstimate() > batch_size) {
             LogPrint(BCLog::COINDB, "Writing partial batch of %.2f MiB\n",
                      batch.SizeEstimate() * (1.0 / 1048576.0));
@@ -130,6 +143,14 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) {
     // In the last batch, mark the database as consistent with hashBlock again.
     batch.Erase(DB_HEAD_BLOCKS);
     batch.Write(DB_BEST_BLOCK, hashBlock);
+    {
+        LOCK(m_stats_mutex);
+        const auto it = m_pending_stats.find(hashBlock);
+        if (it != m_pending_stats.end()) {
+            batch.Write(DB_UTXO_STATS, std::make_pair(hashBlock, it->second));
+            m_pending_stats.erase(it);
+        }
+    }
 
     LogPrint(BCLog::COINDB, "Writing final batch of %.2f MiB\n",
              batch.SizeEstimate() * (1.0 / 1048576.0));
@@ -141,6 +162,44 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) {
     return ret;
 }
 
+bool CCoinsViewDB::WriteSnapshotCoins(
+    const std::vector<std::pair<COutPoint, Coin>> &coins,
+    const BlockHash &hashBlock, bool fFinal) {
+    CDBBatch batch(db);
+    assert(!hashBlock.IsNull());
+
+    // There is no old tip to roll forward from: an interrupted load leaves a
+    // database that ReplayBlocks() refuses.
+    batch.Erase(DB_BEST_BLOCK);
+    batch.Write(DB_HEAD_BLOCKS, Vector(hashBlock, BlockHash()));
+    for (const auto &[outpoint, coin] : coins) {
+        batch.Write(CoinEntry(&outpoint), coin);
+    }
+    if (fFinal) {
+        batch.Erase(DB_HEAD_BLOCKS);
+        batch.Write(DB_BEST_BLOCK, hashBlock);
+    }
+
+    LogPrint(BCLog::COINDB, "Writing %u snapshot coins (%.2f MiB)\n",
+             coins.size(), batch.SizeEstimate() * (1.0 / 1048576.0));
+    return db.WriteBatch(batch);
+}
+
+void CCoinsViewDB::SetUTXOStats(const BlockHash &hashBlock, const CUTXOStats &stats) {
+    LOCK(m_stats_mutex);
+    m_pending_stats.insert_or_assign(hashBlock, stats);
+}
+
+bool CCoinsViewDB::ReadUTXOStats(BlockHash &hashBlock, CUTXOStats &stats) const {
+    std::pair<BlockHash, CUTXOStats> entry;
+    if (!db.Read(DB_UTXO_STATS, entry)) {
+        return false;
+    }
+    hashBlock = entry.first;
+    stats = std::move(entry.second);
+    return true;
+}
+
 size_t CCoinsViewDB::EstimateSize() const {
     return db.EstimateSize(DB_COIN, char(DB_COIN + 1));
 }
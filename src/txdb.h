@@ -11,6 +11,8 @@
 #include <dbwrapper.h>
 #include <flatfile.h>
 #include <primitives/block.h>
+#include <sync.h>
+#include <utxostats.h>
 
 #include <map>
 #include <memory>
@@ -43,6 +45,14 @@ static const int64_t nMaxBlockDBCache = 2;
 // a meaningful difference:
 // https://github.com/fittexxcoin/fittexxcoin/pull/8273#issuecomment-229601991
 static const int64_t nMaxTxIndexCache = 1024;
+//! Max memory allocated to all block filter index caches combined (MiB)
+static const int64_t nMaxFilterIndexCache = 1024;
+//! Max memory allocated to script hash index DB specific cache (MiB)
+static const int64_t nMaxScriptHashIndexCache = 1024;
+//! Max memory allocated to spent index DB specific cache (MiB)
+static const int64_t nMaxSpentIndexCache = 1024;
+//! Max memory allocated to token index DB specific cache (MiB)
+static const int64_t nMaxTokenIndexCache = 256;
 //! Max memory allocated to coin DB specific cache (MiB)
 static const int64_t nMaxCoinsDBCache = 8;
 
@@ -60,12 +70,35 @@ public:
     BlockHash GetBestBlock() const override;
     std::vector<BlockHash> GetHeadBlocks() const override;
     bool BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock) override;
+    //! Like BatchWrite, but leave mapCoins untouched, so that other threads
+    //! may keep reading it while it is being written.
+    bool WriteCoins(const CCoinsMap &mapCoins, const BlockHash &hashBlock);
+    //! Write a part of the UTXO set of hashBlock to an empty database. Until
+    //! the final part is written, the database is left marked as being in the
+    //! middle of a transition to hashBlock.
+    bool WriteSnapshotCoins(const std::vector<std::pair<COutPoint, Coin>> &coins,
+                            const BlockHash &hashBlock, bool fFinal);
     CCoinsViewCursor *Cursor(bool snapshot = false) const override;
 
+    //! Have the statistics of the UTXO set of hashBlock written along with
+    //! the final batch of the next write of that UTXO set.
+    void SetUTXOStats(const BlockHash &hashBlock, const CUTXOStats &stats);
+    //! Read the last statistics written, and the block they are for.
+    bool ReadUTXOStats(BlockHash &hashBlock, CUTXOStats &stats) const;
+
     //! Attempt to update from an older database format.
     //! Returns whether an error occurred.
     bool Upgrade();
     size_t EstimateSize() const override;
+
+private:
+    mutable Mutex m_stats_mutex;
+    std::map<BlockHash, CUTXOStats> m_pending_stats GUARDED_BY(m_stats_mutex);
+
+    //! Write mapCoins, erasing the written entries from pmapErase (which is
+    //! mapCoins itself, or nullptr) as it goes.
+    bool DoBatchWrite(const CCoinsMap &mapCoins, const BlockHash &hashBlock,
+                      CCoinsMap *pmapErase);
 };
 
 /** Specialization of CCoinsViewCursor to iterate over a CCoinsViewDB */
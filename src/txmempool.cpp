@@ -31,6 +31,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <iterator>
 #include <optional>
 #include <stdexcept>
 #include <tuple>
@@ -168,8 +169,6 @@ void CTxMemPool::addUnchecked(CTxMemPoolEntry &&entry) {
         entry.UpdateFeeDelta(feeDelta);
     }
 
-    NotifyEntryAdded(entry.GetSharedTx());
-
     // Add to memory pool without checking anything.
     // Used by AcceptToMemoryPool(), which DOES do all the appropriate checks.
     auto [newit, inserted] = mapTx.insert(entry);
@@ -202,7 +201,12 @@ void CTxMemPool::addUnchecked(CTxMemPoolEntry &&entry) {
     UpdateParentsOf(true, newit);
 
     nTransactionsUpdated++;
+    ++nVersion;
+    SnapshotEntryChanged(newit);
     totalTxSize += entry.GetTxSize();
+
+    // Listeners may look the entry up, with its parents.
+    NotifyEntryAdded(newit->GetSharedTx());
 }
 
 void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason) {
@@ -216,6 +220,7 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason) {
         mapNextTx.erase(txin.prevout);
     }
 
+    SnapshotEntryChanged(it);
     totalTxSize -= it->GetTxSize();
     cachedInnerUsage -= it->DynamicMemoryUsage();
     if (const auto linksiter = mapLinks.find(it); linksiter != mapLinks.end()) {
@@ -225,6 +230,7 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason) {
     }
     mapTx.erase(it);
     nTransactionsUpdated++;
+    ++nVersion;
 }
 
 // Calculates descendants of entry that are not already in setDescendants, and
@@ -351,6 +357,10 @@ void CTxMemPool::_clear(bool clearDspOrphans /*= true*/) {
     rollingMinimumFeeRate = 0;
     m_dspStorage->clear(clearDspOrphans);
     ++nTransactionsUpdated;
+    ++nVersion;
+    snapshotChanged.clear();
+    snapshotFromEmpty = true;
+    snapshotCopyAll = false;
 }
 
 void CTxMemPool::clear(bool clearDspOrphans /*= true*/) {
@@ -489,6 +499,117 @@ bool CTxMemPool::CompareTopologically(const TxId &txida, const TxId &txidb) cons
     return it1->GetEntryId() < it2->GetEntryId();
 }
 
+MempoolSnapshot::Entry CTxMemPool::GetSnapshotEntry(txiter it) const {
+    AssertLockHeld(cs);
+    MempoolSnapshot::Entry entry;
+    entry.tx = it->GetSharedTx();
+    entry.fee = it->GetFee();
+    entry.modifiedFee = it->GetModifiedFee();
+    entry.size = it->GetTxSize();
+    entry.time = it->GetTime();
+    entry.entryId = it->GetEntryId();
+    for (const CTxIn &txin : entry.tx->vin) {
+        if (mapTx.count(txin.prevout.GetTxId())) {
+            entry.depends.push_back(txin.prevout.GetTxId());
+        }
+    }
+    std::sort(entry.depends.begin(), entry.depends.end());
+    entry.depends.erase(std::unique(entry.depends.begin(), entry.depends.end()), entry.depends.end());
+    const setEntries &children = GetMemPoolChildren(it);
+    entry.spentBy.reserve(children.size());
+    for (const txiter child : children) {
+        entry.spentBy.push_back(child->GetTx().GetId());
+    }
+    return entry;
+}
+
+void CTxMemPool::SnapshotEntryChanged(txiter it) {
+    AssertLockHeld(cs);
+    if (snapshotCopyAll) {
+        return;
+    }
+    snapshotChanged.insert(it->GetTx().GetId());
+    // Past this, copying every entry is cheaper than copying the changed ones,
+    // and the transactions removed are no longer remembered.
+    if (snapshotChanged.size() > 2 * mapTx.size() + 1000) {
+        snapshotChanged.clear();
+        snapshotCopyAll = true;
+    }
+}
+
+MempoolSnapshotRef CTxMemPool::GetSnapshot() const {
+    MempoolSnapshotRef snapshot = std::atomic_load(&lastSnapshot);
+    if (snapshot && snapshot->version == nVersion) {
+        return snapshot;
+    }
+
+    LOCK(cs_snapshot);
+    // Someone else may have made it while we were waiting for the lock.
+    snapshot = std::atomic_load(&lastSnapshot);
+    if (snapshot && snapshot->version == nVersion) {
+        return snapshot;
+    }
+
+    auto newSnapshot = std::make_shared<MempoolSnapshot>();
+    // The entries which changed since snapshot, in topological order.
+    std::vector<MempoolSnapshot::Entry> changedEntries;
+    std::unordered_set<TxId, SaltedTxIdHasher> changed;
+    bool fromEmpty;
+    {
+        LOCK(cs);
+        newSnapshot->version = nVersion;
+        newSnapshot->loaded = m_is_loaded;
+        newSnapshot->totalTxSize = totalTxSize;
+        newSnapshot->usage = DynamicMemoryUsage();
+
+        if (snapshotCopyAll) {
+            newSnapshot->entries.reserve(mapTx.size());
+            const auto &index = mapTx.get<entry_id>();
+            for (auto it = index.begin(); it != index.end(); ++it) {
+                newSnapshot->entries.push_back(GetSnapshotEntry(mapTx.project<0>(it)));
+            }
+            snapshotCopyAll = false;
+            snapshotFromEmpty = false;
+            snapshot = std::move(newSnapshot);
+            std::atomic_store(&lastSnapshot, snapshot);
+            return snapshot;
+        }
+
+        fromEmpty = snapshotFromEmpty || !snapshot;
+        snapshotFromEmpty = false;
+        changed.swap(snapshotChanged);
+        changedEntries.reserve(changed.size());
+        for (const TxId &txid : changed) {
+            if (const auto it = mapTx.find(txid); it != mapTx.end()) {
+                changedEntries.push_back(GetSnapshotEntry(it));
+            }
+        }
+    } // release cs
+
+    std::sort(changedEntries.begin(), changedEntries.end(),
+              [](const MempoolSnapshot::Entry &a, const MempoolSnapshot::Entry &b) { return a.entryId < b.entryId; });
+    // Merge the entries of the last snapshot which did not change with those
+    // which did, by entry id.
+    const size_t nKept = fromEmpty ? 0 : snapshot->entries.size();
+    newSnapshot->entries.reserve(nKept + changedEntries.size());
+    auto itChanged = changedEntries.begin();
+    for (size_t i = 0; i < nKept; ++i) {
+        const MempoolSnapshot::Entry &entry = snapshot->entries[i];
+        if (changed.count(entry.tx->GetId())) {
+            continue;
+        }
+        for (; itChanged != changedEntries.end() && itChanged->entryId < entry.entryId; ++itChanged) {
+            newSnapshot->entries.push_back(std::move(*itChanged));
+        }
+        newSnapshot->entries.push_back(entry);
+    }
+    std::move(itChanged, changedEntries.end(), std::back_inserter(newSnapshot->entries));
+
+    snapshot = std::move(newSnapshot);
+    std::atomic_store(&lastSnapshot, snapshot);
+    return snapshot;
+}
+
 void CTxMemPool::queryHashes(std::vector<uint256> &vtxid) const {
     LOCK(cs);
 
@@ -563,7 +684,12 @@ void CTxMemPool::PrioritiseTransaction(const TxId &txid,
         if (it != mapTx.end()) {
             mapTx.modify(it, update_fee_delta(delta));
             ++nTransactionsUpdated;
+            SnapshotEntryChanged(it);
+            NotifyEntryPrioritised(it->GetSharedTx());
         }
+        // Even when the transaction is not in the pool, mapDeltas counts in
+        // its memory usage.
+        ++nVersion;
     }
     LogPrintf("PrioritiseTransaction: %s fee += %s\n", txid.ToString(),
               FormatMoney(nFeeDelta));
@@ -580,6 +706,8 @@ void CTxMemPool::ApplyDelta(const TxId &txid, Amount &nFeeDelta) const {
 void CTxMemPool::ClearPrioritisation(const TxId &txid) {
     LOCK(cs);
     mapDeltas.erase(txid);
+    // The memory usage changed.
+    ++nVersion;
 }
 
 const CTransaction *CTxMemPool::GetConflictTx(const COutPoint &prevout) const {
@@ -697,16 +825,20 @@ inline constexpr size_t setEntriesIncrementalUsage =
 void CTxMemPool::UpdateChild(txiter entry, txiter child, bool add) {
     if (add && mapLinks[entry].children.insert(child).second) {
         cachedInnerUsage += setEntriesIncrementalUsage;
+        SnapshotEntryChanged(entry);
     } else if (!add && mapLinks[entry].children.erase(child)) {
         cachedInnerUsage -= setEntriesIncrementalUsage;
+        SnapshotEntryChanged(entry);
     }
 }
 
 void CTxMemPool::UpdateParent(txiter entry, txiter parent, bool add) {
     if (add && mapLinks[entry].parents.insert(parent).second) {
         cachedInnerUsage += setEntriesIncrementalUsage;
+        SnapshotEntryChanged(entry);
     } else if (!add && mapLinks[entry].parents.erase(parent)) {
         cachedInnerUsage -= setEntriesIncrementalUsage;
+        SnapshotEntryChanged(entry);
     }
 }
 
@@ -1071,6 +1203,7 @@ bool CTxMemPool::IsLoaded() const {
 void CTxMemPool::SetIsLoaded(bool loaded) {
     LOCK(cs);
     m_is_loaded = loaded;
+    ++nVersion;
 }
 
 /* static */ uint64_t DisconnectedBlockTransactions::maxDynamicUsage() {
@@ -22,6 +22,7 @@
 #include <boost/multi_index_container.hpp>
 #include <boost/signals2/signal.hpp>
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <optional>
@@ -29,6 +30,7 @@
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -220,6 +222,36 @@ struct TxMempoolInfo {
     Amount nFeeDelta;
 };
 
+/**
+ * An immutable copy of the mempool contents, which read-only queries (RPC,
+ * REST) walk without holding CTxMemPool::cs. See CTxMemPool::GetSnapshot().
+ */
+struct MempoolSnapshot {
+    struct Entry {
+        CTransactionRef tx;
+        Amount fee;
+        Amount modifiedFee;
+        size_t size;
+        int64_t time;
+        //! The in-mempool transactions this one spends, sorted
+        std::vector<TxId> depends;
+        //! The in-mempool transactions spending this one, in topological order
+        std::vector<TxId> spentBy;
+        //! CTxMemPoolEntry::GetEntryId(), which orders the entries topologically
+        uint64_t entryId;
+    };
+
+    //! The CTxMemPool::GetVersion() this is a copy of.
+    uint64_t version = 0;
+    //! In topological order.
+    std::vector<Entry> entries;
+    bool loaded = false;
+    size_t totalTxSize = 0;
+    size_t usage = 0;
+};
+
+using MempoolSnapshotRef = std::shared_ptr<const MempoolSnapshot>;
+
 /**
  * Reason why a transaction was removed from the mempool, this is passed to the
  * notification signal.
@@ -316,6 +348,19 @@ private:
     //! Used by addUnchecked to generate ever-increasing CTxMemPoolEntry::entryId's
     uint64_t nextEntryId GUARDED_BY(cs) = 1;
 
+    //! Bumped, with cs held, on every change that a snapshot reflects
+    std::atomic<uint64_t> nVersion{0};
+    //! Only accessed through std::atomic_load() and std::atomic_store()
+    mutable MempoolSnapshotRef lastSnapshot;
+    //! Held by the reader making the next snapshot, before cs
+    mutable Mutex cs_snapshot;
+    //! The transactions added, changed or removed since lastSnapshot was made
+    mutable std::unordered_set<TxId, SaltedTxIdHasher> snapshotChanged GUARDED_BY(cs);
+    //! Whether the next snapshot starts from an empty mempool, rather than lastSnapshot
+    mutable bool snapshotFromEmpty GUARDED_BY(cs){true};
+    //! Whether snapshotChanged was given up on, and the next snapshot copies every entry
+    mutable bool snapshotCopyAll GUARDED_BY(cs){false};
+
 public:
     // public only for testing
     static const int ROLLING_FEE_HALFLIFE = 60 * 60 * 12;
@@ -496,8 +541,10 @@ private:
     using txlinksMap = std::map<txiter, TxLinks, CompareIteratorByEntryId>;
     txlinksMap mapLinks;
 
-    void UpdateParent(txiter entry, txiter parent, bool add);
-    void UpdateChild(txiter entry, txiter child, bool add);
+    void UpdateParent(txiter entry, txiter parent, bool add) EXCLUSIVE_LOCKS_REQUIRED(cs);
+    void UpdateChild(txiter entry, txiter child, bool add) EXCLUSIVE_LOCKS_REQUIRED(cs);
+    //! Record that the snapshot entry of it changed, for GetSnapshot()
+    void SnapshotEntryChanged(txiter it) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
 public:
     indirectmap<COutPoint, const CTransaction *> mapNextTx GUARDED_BY(cs);
@@ -543,6 +590,20 @@ public:
     bool isSpent(const COutPoint &outpoint) const;
     unsigned int GetTransactionsUpdated() const;
     void AddTransactionsUpdated(unsigned int n);
+
+    //! Changes whenever the contents of the mempool change.
+    uint64_t GetVersion() const { return nVersion.load(); }
+    /**
+     * A copy of the current contents. It is made by the first call after the
+     * mempool changed, and shared with the other callers until the next
+     * change; if nothing changed, this does not take cs.
+     *
+     * Only the entries which changed since the last snapshot are copied with
+     * cs held; they are merged with the last snapshot without. Every entry is
+     * copied with cs held only if there were more changes than entries since.
+     */
+    MempoolSnapshotRef GetSnapshot() const;
+    MempoolSnapshot::Entry GetSnapshotEntry(txiter it) const EXCLUSIVE_LOCKS_REQUIRED(cs);
     /**
      * Check that none of this transactions inputs are in the mempool, and thus
      * the tx is not dependent on other mempool transactions to be included in a
@@ -676,6 +737,8 @@ public:
     boost::signals2::signal<void(CTransactionRef)> NotifyEntryAdded;
     boost::signals2::signal<void(CTransactionRef, MemPoolRemovalReason)>
         NotifyEntryRemoved;
+    //! The modified fee of an entry changed (see PrioritiseTransaction()).
+    boost::signals2::signal<void(CTransactionRef)> NotifyEntryPrioritised;
 
 private:
     /**
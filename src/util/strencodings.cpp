@@ -7,6 +7,7 @@
 #include <util/strencodings.h>
 #include <util/string.h>
 
+#include <compat/cpuid.h>
 #include <tinyformat.h>
 
 #include <algorithm>
@@ -26,6 +27,85 @@ const char hexmap[513] =
     "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
 } // namespace strencodings
 
+#if defined(__SSE2__)
+namespace hex_sse2 {
+size_t Encode(const uint8_t *in, size_t size, char *out);
+size_t Decode(const char *in, size_t size, uint8_t *out);
+} // namespace hex_sse2
+#endif
+
+#if defined(ENABLE_AVX2)
+namespace hex_avx2 {
+size_t Encode(const uint8_t *in, size_t size, char *out);
+size_t Decode(const char *in, size_t size, uint8_t *out);
+} // namespace hex_avx2
+#endif
+
+namespace {
+/**
+ * The kernels encoding and decoding hex in blocks, as many blocks as there are
+ * in the input, which return the number of bytes done. The remainder is left to
+ * the generic implementation. Decoding stops at the first block that is not all
+ * hex digits.
+ */
+#if defined(__SSE2__)
+size_t (*HexEncodeBlocks)(const uint8_t *, size_t, char *) = hex_sse2::Encode;
+size_t (*HexDecodeBlocks)(const char *, size_t, uint8_t *) = hex_sse2::Decode;
+#else
+size_t (*HexEncodeBlocks)(const uint8_t *, size_t, char *) = nullptr;
+size_t (*HexDecodeBlocks)(const char *, size_t, uint8_t *) = nullptr;
+#endif
+
+/**
+ * Decode the hex digits at in to up to size bytes at out, stopping at the first
+ * pair of characters that are not both hex digits. Returns the number of bytes
+ * decoded.
+ */
+size_t HexDecode(const char *in, size_t size, uint8_t *out) {
+    size_t done = HexDecodeBlocks ? HexDecodeBlocks(in, size, out) : 0;
+    for (; done < size; ++done) {
+        const signed char high = HexDigit(in[2 * done]);
+        const signed char low = HexDigit(in[2 * done + 1]);
+        if (high < 0 || low < 0) {
+            break;
+        }
+        out[done] = uint8_t(high << 4) | uint8_t(low);
+    }
+    return done;
+}
+} // namespace
+
+std::string HexAutoDetect() {
+    std::string ret = HexEncodeBlocks ? "sse2" : "standard";
+#if defined(ENABLE_AVX2) && defined(HAVE_GETCPUID)
+    if (HaveAVX2()) {
+        HexEncodeBlocks = hex_avx2::Encode;
+        HexDecodeBlocks = hex_avx2::Decode;
+        ret = "avx2";
+    }
+#endif
+    return ret;
+}
+
+void HexEncode(Span<const uint8_t> input, char *output) {
+    using strencodings::hexmap;
+    size_t done = HexEncodeBlocks ? HexEncodeBlocks(input.data(), input.size(), output) : 0;
+    for (; done < input.size(); ++done) {
+        const char *hex = &hexmap[input[done] * 2];
+        output[2 * done] = hex[0];
+        output[2 * done + 1] = hex[1];
+    }
+}
+
+std::string HexStr(const Span<const uint8_t> input, bool fSpaces) {
+    if (fSpaces) {
+        return HexStr(input.begin(), input.end(), fSpaces);
+    }
+    std::string rv(input.size() * 2, '\0');
+    HexEncode(input, rv.data());
+    return rv;
+}
+
 static const std::string CHARS_ALPHA_NUM =
     "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
 
@@ -96,10 +176,18 @@ bool IsHexNumber(const std::string &str) {
     return (str.size() > starting_location);
 }
 
-std::vector<uint8_t> ParseHex(const char *psz) {
+/** Parse the hex dump of len characters at psz, which is null-terminated. */
+static std::vector<uint8_t> ParseHex(const char *psz, size_t len) {
     // convert hex dump to vector
-    std::vector<uint8_t> vch;
+    std::vector<uint8_t> vch(len / 2);
+    size_t n = 0;
+    const char *end = psz + len;
     while (true) {
+        // Decode hex digits in bulk, until the next whitespace (or the end)
+        const size_t decoded = HexDecode(psz, (end - psz) / 2, vch.data() + n);
+        psz += 2 * decoded;
+        n += decoded;
+
         while (IsSpace(*psz)) {
             psz++;
         }
@@ -107,19 +195,24 @@ std::vector<uint8_t> ParseHex(const char *psz) {
         if (c == (signed char)-1) {
             break;
         }
-        uint8_t n = (c << 4);
+        uint8_t b = (c << 4);
         c = HexDigit(*psz++);
         if (c == (signed char)-1) {
             break;
         }
-        n |= c;
-        vch.push_back(n);
+        b |= c;
+        vch[n++] = b;
     }
+    vch.resize(n);
     return vch;
 }
 
+std::vector<uint8_t> ParseHex(const char *psz) {
+    return ParseHex(psz, std::strlen(psz));
+}
+
 std::vector<uint8_t> ParseHex(const std::string &str) {
-    return ParseHex(str.c_str());
+    return ParseHex(str.c_str(), str.size());
 }
 
 void SplitHostPort(std::string in, int &portOut, std::string &hostOut) {
@@ -200,14 +200,26 @@ std::string HexStr(const T itbegin, const T itend, bool fSpaces = false) {
 /**
  * Convert a span of bytes to a lower-case hexadecimal string.
  */
-inline std::string HexStr(const Span<const uint8_t> input, bool fSpaces = false) {
-    return HexStr(input.begin(), input.end(), fSpaces);
-}
+std::string HexStr(const Span<const uint8_t> input, bool fSpaces = false);
 
 inline std::string HexStr(const Span<const char> input, bool fSpaces = false) {
     return HexStr(MakeUInt8Span(input), fSpaces);
 }
 
+/**
+ * Write the lower-case hexadecimal encoding of input to output, which must have
+ * room for 2 * input.size() characters. This allows encoding a large input
+ * piece by piece into a buffer of one's own, rather than into a new string.
+ */
+void HexEncode(Span<const uint8_t> input, char *output);
+
+/**
+ * Select the fastest hex encoding and decoding implementation for this CPU, as
+ * used by HexStr(), HexEncode() and ParseHex(), and return its name. Without
+ * it, SSE2 is used where the build targets it.
+ */
+std::string HexAutoDetect();
+
 /**
  * Format a paragraph of text to a fixed width, optionally adding spaces for indentation to every line.
  */
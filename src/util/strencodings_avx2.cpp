@@ -0,0 +1,84 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// AVX2 hex encoding and decoding of 32 bytes at a time.
+
+#ifdef ENABLE_AVX2
+
+#include <cstddef>
+#include <cstdint>
+
+#include <immintrin.h>
+
+namespace hex_avx2 {
+namespace {
+//! Convert 32 nibbles to lower-case hex digits.
+inline __m256i NibblesToHex(__m256i nibbles) {
+    // '0' + n, and 'a' - '0' - 10 more for n > 9
+    const __m256i letter = _mm256_cmpgt_epi8(nibbles, _mm256_set1_epi8(9));
+    return _mm256_add_epi8(_mm256_add_epi8(nibbles, _mm256_set1_epi8('0')),
+                           _mm256_and_si256(letter, _mm256_set1_epi8('a' - '0' - 10)));
+}
+
+/**
+ * Convert 32 characters to the values of the hex digits they are, and set
+ * valid to whether they all are hex digits.
+ */
+inline __m256i HexToNibbles(__m256i chars, bool &valid) {
+    // Characters below '0' or 'a' wrap around to large (unsigned) values.
+    const __m256i digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+    const __m256i letter =
+        _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    const __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    const __m256i is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+    valid = _mm256_movemask_epi8(_mm256_or_si256(is_digit, is_letter)) == -1;
+    return _mm256_or_si256(_mm256_and_si256(is_digit, digit),
+                           _mm256_and_si256(is_letter, _mm256_add_epi8(letter, _mm256_set1_epi8(10))));
+}
+
+//! Combine the pairs of nibbles (high first) in each 16-bit lane into a byte value.
+inline __m256i PackNibbles(__m256i nibbles) {
+    return _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(nibbles, _mm256_set1_epi16(0x00ff)), 4),
+                           _mm256_srli_epi16(nibbles, 8));
+}
+} // namespace
+
+size_t Encode(const uint8_t *in, size_t size, char *out) {
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    size_t done = 0;
+    for (; size - done >= 32; done += 32) {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + done));
+        const __m256i high = NibblesToHex(_mm256_and_si256(_mm256_srli_epi16(bytes, 4), mask));
+        const __m256i low = NibblesToHex(_mm256_and_si256(bytes, mask));
+        // Unpacking works within each 128-bit lane: put the lanes back in order.
+        const __m256i first = _mm256_unpacklo_epi8(high, low);
+        const __m256i second = _mm256_unpackhi_epi8(high, low);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 2 * done),
+                            _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 2 * done + 32),
+                            _mm256_permute2x128_si256(first, second, 0x31));
+    }
+    return done;
+}
+
+size_t Decode(const char *in, size_t size, uint8_t *out) {
+    size_t done = 0;
+    for (; size - done >= 32; done += 32) {
+        bool valid1, valid2;
+        const __m256i nibbles1 =
+            HexToNibbles(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + 2 * done)), valid1);
+        const __m256i nibbles2 =
+            HexToNibbles(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + 2 * done + 32)), valid2);
+        if (!valid1 || !valid2) {
+            break;
+        }
+        // Packing works within each 128-bit lane: put the quarters back in order.
+        const __m256i packed = _mm256_packus_epi16(PackNibbles(nibbles1), PackNibbles(nibbles2));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + done), _mm256_permute4x64_epi64(packed, 0xd8));
+    }
+    return done;
+}
+} // namespace hex_avx2
+
+#endif
@@ -0,0 +1,77 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// SSE2 hex encoding and decoding of 16 bytes at a time.
+
+#if defined(__SSE2__)
+
+#include <cstddef>
+#include <cstdint>
+
+#include <emmintrin.h>
+
+namespace hex_sse2 {
+namespace {
+//! Convert 16 nibbles to lower-case hex digits.
+inline __m128i NibblesToHex(__m128i nibbles) {
+    // '0' + n, and 'a' - '0' - 10 more for n > 9
+    const __m128i letter = _mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9));
+    return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')),
+                        _mm_and_si128(letter, _mm_set1_epi8('a' - '0' - 10)));
+}
+
+/**
+ * Convert 16 characters to the values of the hex digits they are, and set
+ * valid to whether they all are hex digits.
+ */
+inline __m128i HexToNibbles(__m128i chars, bool &valid) {
+    // Characters below '0' or 'a' wrap around to large (unsigned) values.
+    const __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    const __m128i letter = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    const __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+    valid = _mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)) == 0xffff;
+    return _mm_or_si128(_mm_and_si128(is_digit, digit),
+                        _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+}
+
+//! Combine the pairs of nibbles (high first) in each 16-bit lane into a byte value.
+inline __m128i PackNibbles(__m128i nibbles) {
+    return _mm_or_si128(_mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00ff)), 4),
+                        _mm_srli_epi16(nibbles, 8));
+}
+} // namespace
+
+size_t Encode(const uint8_t *in, size_t size, char *out) {
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    size_t done = 0;
+    for (; size - done >= 16; done += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + done));
+        const __m128i high = NibblesToHex(_mm_and_si128(_mm_srli_epi16(bytes, 4), mask));
+        const __m128i low = NibblesToHex(_mm_and_si128(bytes, mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * done), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * done + 16), _mm_unpackhi_epi8(high, low));
+    }
+    return done;
+}
+
+size_t Decode(const char *in, size_t size, uint8_t *out) {
+    size_t done = 0;
+    for (; size - done >= 16; done += 16) {
+        bool valid1, valid2;
+        const __m128i nibbles1 =
+            HexToNibbles(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 2 * done)), valid1);
+        const __m128i nibbles2 =
+            HexToNibbles(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 2 * done + 16)), valid2);
+        if (!valid1 || !valid2) {
+            break;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + done),
+                         _mm_packus_epi16(PackNibbles(nibbles1), PackNibbles(nibbles2)));
+    }
+    return done;
+}
+} // namespace hex_sse2
+
+#endif
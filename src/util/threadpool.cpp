@@ -0,0 +1,151 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <util/threadpool.h>
+
+#include <util/threadnames.h>
+
+#include <tinyformat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <exception>
+#include <memory>
+
+ThreadPool::ThreadPool(std::string name) : m_name(std::move(name)) {}
+
+ThreadPool::~ThreadPool() {
+    Stop();
+}
+
+void ThreadPool::Start(int num_threads) {
+    LOCK(m_mutex);
+    assert(m_threads.empty());
+    m_request_stop = false;
+    for (int n = 0; n < num_threads; ++n) {
+        m_threads.emplace_back([this, n]() {
+            util::ThreadRename(strprintf("%s.%i", m_name, n));
+            ThreadWorker();
+        });
+    }
+}
+
+void ThreadPool::Stop() {
+    std::vector<std::thread> threads;
+    {
+        LOCK(m_mutex);
+        m_request_stop = true;
+        threads.swap(m_threads);
+    }
+    m_cv.notify_all();
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+size_t ThreadPool::Size() const {
+    LOCK(m_mutex);
+    return m_threads.size();
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    {
+        LOCK(m_mutex);
+        if (m_threads.empty()) {
+            // Nobody would run it.
+            task();
+            return;
+        }
+        m_queue.push_back(std::move(task));
+    }
+    m_cv.notify_one();
+}
+
+void ThreadPool::ThreadWorker() {
+    WAIT_LOCK(m_mutex, lock);
+    while (true) {
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_request_stop || !m_queue.empty(); });
+        if (m_queue.empty()) {
+            return;
+        }
+        std::function<void()> task = std::move(m_queue.front());
+        m_queue.pop_front();
+        REVERSE_LOCK(lock);
+        task();
+    }
+}
+
+namespace {
+/** What the threads taking part in a ThreadPool::ForEach() call share. */
+struct ForEachState {
+    const size_t count;
+    const std::function<void(size_t)> &fn;
+    std::atomic<size_t> next{0};
+
+    Mutex mutex;
+    std::condition_variable cv;
+    //! The number of workers taking indexes.
+    size_t active GUARDED_BY(mutex){0};
+    std::exception_ptr error GUARDED_BY(mutex);
+
+    ForEachState(size_t countIn, const std::function<void(size_t)> &fnIn) : count(countIn), fn(fnIn) {}
+
+    void Run() {
+        while (true) {
+            const size_t i = next++;
+            if (i >= count) {
+                return;
+            }
+            try {
+                fn(i);
+            } catch (...) {
+                next = count;
+                LOCK(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    }
+};
+} // namespace
+
+void ThreadPool::ForEach(size_t count, const std::function<void(size_t)> &fn, size_t max_workers) {
+    const size_t num_workers = count ? std::min({max_workers, Size(), count - 1}) : 0;
+    if (num_workers == 0) {
+        for (size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    // The tasks may only be run after this returns, when fn is gone; they do
+    // nothing then, as all the indexes have been taken.
+    auto state = std::make_shared<ForEachState>(count, fn);
+    for (size_t n = 0; n < num_workers; ++n) {
+        Submit([state]() {
+            {
+                LOCK(state->mutex);
+                if (state->next >= state->count) {
+                    return;
+                }
+                ++state->active;
+            }
+            state->Run();
+            {
+                LOCK(state->mutex);
+                --state->active;
+            }
+            state->cv.notify_all();
+        });
+    }
+    state->Run();
+
+    WAIT_LOCK(state->mutex, lock);
+    state->cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(state->mutex) { return state->active == 0; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
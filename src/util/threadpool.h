@@ -0,0 +1,65 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <sync.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * A fixed number of worker threads running tasks from a queue.
+ *
+ * The pool may be used without being started, or with no threads: ForEach()
+ * then does all the work on the calling thread.
+ */
+class ThreadPool {
+public:
+    //! The workers are named "<name>.<n>".
+    explicit ThreadPool(std::string name);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void Start(int num_threads);
+    //! Wait for the queued tasks to be run, and stop the workers.
+    void Stop();
+
+    //! The number of worker threads (not counting the callers of ForEach()).
+    size_t Size() const;
+
+    //! Queue a task to be run by one of the workers. The task must not throw.
+    void Submit(std::function<void()> task);
+
+    /**
+     * Call fn(i) for every i in [0, count), from the calling thread and from
+     * up to max_workers of the workers, which each take the next index in
+     * turn. Returns once all the calls have returned; if any of them threw,
+     * the remaining indexes are skipped and the first exception is rethrown.
+     *
+     * The calling thread never waits for an index that is not being worked on,
+     * so it is safe to call this from a worker of the same pool.
+     */
+    void ForEach(size_t count, const std::function<void(size_t)> &fn,
+                 size_t max_workers = std::numeric_limits<size_t>::max());
+
+private:
+    const std::string m_name;
+
+    mutable Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::function<void()>> m_queue GUARDED_BY(m_mutex);
+    bool m_request_stop GUARDED_BY(m_mutex){false};
+    std::vector<std::thread> m_threads GUARDED_BY(m_mutex);
+
+    void ThreadWorker();
+};
@@ -0,0 +1,320 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <utxo_snapshot.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <clientversion.h>
+#include <coins.h>
+#include <config.h>
+#include <consensus/validation.h>
+#include <logging.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <shutdown.h>
+#include <streams.h>
+#include <sync.h>
+#include <tinyformat.h>
+#include <txdb.h>
+#include <util/system.h>
+#include <validation.h>
+#include <version.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace {
+
+//! The number of coins written to the coins database at once by a load.
+constexpr size_t SNAPSHOT_LOAD_BATCH_SIZE = 100000;
+
+CDataStream CoinElement(const COutPoint &outpoint, const Coin &coin) {
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << outpoint << uint32_t((coin.GetHeight() << 1) | coin.IsCoinBase()) << coin.GetTxOut();
+    return ss;
+}
+
+/**
+ * Read the snapshot file at path, and check its coins against the count and
+ * the commitment of its metadata. When onCoins is set, the coins are also
+ * handed to it, with the last of them only once they have been checked.
+ */
+bool ReadSnapshot(const Config &config, const fs::path &path, SnapshotMetadata &metadata,
+                  std::vector<CBlockHeader> *headers, std::vector<uint32_t> *txCounts,
+                  const std::function<bool(std::vector<std::pair<COutPoint, Coin>> &)> &onCoins,
+                  std::string &error) {
+    CAutoFile file(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+    if (file.IsNull()) {
+        error = strprintf("Unable to open %s", path.string());
+        return false;
+    }
+
+    const CChainParams &chainparams = config.GetChainParams();
+    try {
+        file >> metadata;
+        if (metadata.network_magic != chainparams.DiskMagic()) {
+            error = "The snapshot is for another network";
+            return false;
+        }
+        if (metadata.base_height < 0) {
+            error = "The snapshot has an invalid base height";
+            return false;
+        }
+
+        BlockHash hashPrev = chainparams.GetConsensus().hashGenesisBlock;
+        if (headers) {
+            headers->clear();
+            headers->reserve(metadata.base_height);
+        }
+        if (txCounts) {
+            txCounts->clear();
+            txCounts->reserve(metadata.base_height);
+        }
+        for (int32_t height = 1; height <= metadata.base_height; ++height) {
+            CBlockHeader header;
+            uint32_t nTx;
+            file >> header >> nTx;
+            if (header.hashPrevBlock != hashPrev || nTx == 0) {
+                error = strprintf("The snapshot has an invalid header at height %d", height);
+                return false;
+            }
+            hashPrev = header.GetHash();
+            if (headers) {
+                headers->push_back(header);
+            }
+            if (txCounts) {
+                txCounts->push_back(nTx);
+            }
+        }
+        if (hashPrev != metadata.base_hash) {
+            error = "The snapshot headers do not lead to its base block";
+            return false;
+        }
+
+        ECMultiSet commitment;
+        std::vector<std::pair<COutPoint, Coin>> coins;
+        for (uint64_t i = 0; i < metadata.coins_count; ++i) {
+            if (ShutdownRequested()) {
+                error = "Interrupted";
+                return false;
+            }
+            COutPoint outpoint;
+            Coin coin;
+            file >> outpoint >> coin;
+            if (coin.IsSpent()) {
+                error = "The snapshot has a spent coin";
+                return false;
+            }
+            ApplyCoinHash(commitment, outpoint, coin);
+            if (!onCoins) {
+                continue;
+            }
+            coins.emplace_back(outpoint, std::move(coin));
+            if (coins.size() == SNAPSHOT_LOAD_BATCH_SIZE && i + 1 < metadata.coins_count && !onCoins(coins)) {
+                return false;
+            }
+        }
+        if (std::fgetc(file.Get()) != EOF) {
+            error = "The snapshot has more coins than announced";
+            return false;
+        }
+        if (commitment != metadata.commitment) {
+            error = "The snapshot coins do not match its commitment";
+            return false;
+        }
+        if (onCoins) {
+            return onCoins(coins);
+        }
+    } catch (const std::exception &e) {
+        error = strprintf("Error reading %s: %s", path.string(), e.what());
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+void ApplyCoinHash(ECMultiSet &set, const COutPoint &outpoint, const Coin &coin) {
+    set.Add(MakeUInt8Span(CoinElement(outpoint, coin)));
+}
+
+void RemoveCoinHash(ECMultiSet &set, const COutPoint &outpoint, const Coin &coin) {
+    set.Remove(MakeUInt8Span(CoinElement(outpoint, coin)));
+}
+
+UTXOSnapshotSource::UTXOSnapshotSource() = default;
+UTXOSnapshotSource::~UTXOSnapshotSource() = default;
+
+bool OpenUTXOSnapshotSource(const Config &config, const CCoinsView &view, UTXOSnapshotSource &source,
+                            std::string &error) {
+    AssertLockHeld(cs_main);
+    source.metadata = SnapshotMetadata();
+    source.metadata.network_magic = config.GetChainParams().DiskMagic();
+    source.cursor.reset(view.Cursor(true));
+    assert(source.cursor);
+    source.metadata.base_hash = source.cursor->GetBestBlock();
+    const CBlockIndex *pindexBase = LookupBlockIndex(source.metadata.base_hash);
+    if (!pindexBase) {
+        error = "The UTXO set is being written, or has no known best block";
+        return false;
+    }
+    source.metadata.base_height = pindexBase->nHeight;
+    source.headers.resize(pindexBase->nHeight);
+    for (const CBlockIndex *pindex = pindexBase; pindex->pprev; pindex = pindex->pprev) {
+        source.headers[pindex->nHeight - 1] = {pindex->GetBlockHeader(), pindex->nTx};
+    }
+    return true;
+}
+
+bool WriteUTXOSnapshot(const Config &config, const CCoinsView &view, const fs::path &path,
+                       SnapshotMetadata &metadata, const std::function<void()> &interruption_point,
+                       std::string &error) {
+    UTXOSnapshotSource source;
+    if (!WITH_LOCK(cs_main, return OpenUTXOSnapshotSource(config, view, source, error))) {
+        return false;
+    }
+    return WriteUTXOSnapshot(source, path, metadata, interruption_point, error);
+}
+
+bool WriteUTXOSnapshot(UTXOSnapshotSource &source, const fs::path &path, SnapshotMetadata &metadata,
+                       const std::function<void()> &interruption_point, std::string &error) {
+    CCoinsViewCursor *const pcursor = source.cursor.get();
+    metadata = source.metadata;
+
+    fs::path pathTmp = path;
+    pathTmp += ".incomplete";
+    CAutoFile file(fsbridge::fopen(pathTmp, "wb"), SER_DISK, CLIENT_VERSION);
+    if (file.IsNull()) {
+        error = strprintf("Unable to create %s", pathTmp.string());
+        return false;
+    }
+
+    try {
+        // The count and the commitment are only known at the end: write the
+        // metadata again then.
+        file << metadata;
+        for (const auto &[header, nTx] : source.headers) {
+            file << header << nTx;
+        }
+        while (pcursor->Valid()) {
+            interruption_point();
+            COutPoint outpoint;
+            Coin coin;
+            if (!pcursor->GetKey(outpoint) || !pcursor->GetValue(coin)) {
+                error = "Unable to read the UTXO set";
+                return false;
+            }
+            file << outpoint << coin;
+            ApplyCoinHash(metadata.commitment, outpoint, coin);
+            ++metadata.coins_count;
+            pcursor->Next();
+        }
+        if (std::fseek(file.Get(), 0, SEEK_SET) != 0) {
+            error = strprintf("Unable to write to %s", pathTmp.string());
+            return false;
+        }
+        file << metadata;
+    } catch (const std::exception &e) {
+        error = strprintf("Error writing %s: %s", pathTmp.string(), e.what());
+        return false;
+    }
+
+    if (!FileCommit(file.Get())) {
+        error = strprintf("Unable to write to %s", pathTmp.string());
+        return false;
+    }
+    file.fclose();
+    if (!RenameOver(pathTmp, path)) {
+        error = strprintf("Unable to rename %s to %s", pathTmp.string(), path.string());
+        return false;
+    }
+    return true;
+}
+
+bool CheckUTXOSnapshot(const Config &config, const fs::path &path, SnapshotMetadata &metadata, std::string &error) {
+    return ReadSnapshot(config, path, metadata, nullptr, nullptr, nullptr, error);
+}
+
+bool LoadUTXOSnapshot(const Config &config, const fs::path &path, const uint256 &expected_commitment,
+                      std::string &error) {
+    AssertLockHeld(cs_main);
+    if (!pcoinsdbview->GetBestBlock().IsNull() || !pcoinsdbview->GetHeadBlocks().empty()) {
+        error = "The chainstate is not empty";
+        return false;
+    }
+
+    // First check the whole snapshot, so that nothing is written from a bad one.
+    SnapshotMetadata metadata;
+    std::vector<CBlockHeader> headers;
+    std::vector<uint32_t> txCounts;
+    if (!ReadSnapshot(config, path, metadata, &headers, &txCounts, nullptr, error)) {
+        return false;
+    }
+    const uint256 commitment = metadata.commitment.GetHash();
+    if (expected_commitment.IsNull()) {
+        const MapAssumeutxo &assumeutxo = config.GetChainParams().Assumeutxo();
+        const auto it = assumeutxo.find(metadata.base_height);
+        if (it == assumeutxo.end() || it->second.base_hash != metadata.base_hash ||
+            it->second.commitment != commitment) {
+            error = strprintf("The snapshot commitment %s is not a known one, and no -loadutxosethash was given",
+                              commitment.ToString());
+            return false;
+        }
+    } else if (commitment != expected_commitment) {
+        error = strprintf("The snapshot commitment %s is not the expected one", commitment.ToString());
+        return false;
+    }
+    LogPrintf("Loading UTXO snapshot of block %s (height %d): %u coins, commitment %s\n",
+              metadata.base_hash.ToString(), metadata.base_height, metadata.coins_count, commitment.ToString());
+
+    for (size_t i = 0; i < headers.size(); i += MAX_HEADERS_RESULTS) {
+        const std::vector<CBlockHeader> chunk(headers.begin() + i,
+                                              headers.begin() + std::min(headers.size(), i + MAX_HEADERS_RESULTS));
+        CValidationState state;
+        if (!ProcessNewBlockHeaders(config, chunk, state)) {
+            error = strprintf("The snapshot has an invalid header: %s", FormatStateMessage(state));
+            return false;
+        }
+    }
+    CBlockIndex *pindexBase = LookupBlockIndex(metadata.base_hash);
+    if (!pindexBase) {
+        error = "The snapshot base block is unknown";
+        return false;
+    }
+
+    // The coins are checked again as they are written, against the metadata
+    // checked above, in case the file has changed since.
+    SnapshotMetadata written_metadata;
+    uint64_t written = 0;
+    const auto writeCoins = [&](std::vector<std::pair<COutPoint, Coin>> &coins) {
+        if (written_metadata.base_hash != metadata.base_hash ||
+            written_metadata.coins_count != metadata.coins_count ||
+            written_metadata.commitment != metadata.commitment) {
+            error = "The snapshot has changed while being loaded";
+            return false;
+        }
+        written += coins.size();
+        if (!pcoinsdbview->WriteSnapshotCoins(coins, metadata.base_hash, written == metadata.coins_count)) {
+            error = "Failed to write to coin database";
+            return false;
+        }
+        coins.clear();
+        return true;
+    };
+    if (!ReadSnapshot(config, path, written_metadata, nullptr, nullptr, writeCoins, error)) {
+        return false;
+    }
+
+    if (!LoadSnapshotChain(pindexBase, txCounts)) {
+        error = "Failed to load the snapshot chain";
+        return false;
+    }
+    FlushStateToDisk();
+    return true;
+}
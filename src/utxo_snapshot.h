@@ -0,0 +1,126 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <ec_multiset.h>
+#include <fs.h>
+#include <primitives/block.h>
+#include <primitives/blockhash.h>
+#include <protocol.h>
+#include <serialize.h>
+#include <sync.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern RecursiveMutex cs_main;
+
+class CCoinsView;
+class CCoinsViewCursor;
+class COutPoint;
+class Coin;
+class Config;
+
+/**
+ * The element a coin contributes to the ECMultiSet commitment of a UTXO set:
+ * its outpoint, its height and coinbase flag, and its output (with any token
+ * data), serialized as on the network.
+ */
+void ApplyCoinHash(ECMultiSet &set, const COutPoint &outpoint, const Coin &coin);
+void RemoveCoinHash(ECMultiSet &set, const COutPoint &outpoint, const Coin &coin);
+
+/**
+ * The start of a UTXO snapshot file.
+ *
+ * It is followed by the header and the transaction count of every block from
+ * height 1 to the base block, and then by the coins of the UTXO set as of the
+ * base block, as (COutPoint, Coin) pairs in database order.
+ */
+class SnapshotMetadata {
+public:
+    static constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+    //! The disk magic of the network the snapshot is for.
+    CMessageHeader::MessageMagic network_magic{};
+    BlockHash base_hash;
+    int32_t base_height = 0;
+    uint64_t coins_count = 0;
+    ECMultiSet commitment;
+
+    SERIALIZE_METHODS(SnapshotMetadata, obj) {
+        uint8_t file_magic[4] = {'u', 't', 'x', 'o'};
+        uint32_t version = SNAPSHOT_VERSION;
+        READWRITE(file_magic, version);
+        if constexpr (ser_action.ForRead()) {
+            if (file_magic[0] != 'u' || file_magic[1] != 't' || file_magic[2] != 'x' || file_magic[3] != 'o') {
+                throw std::ios_base::failure("Not a UTXO snapshot file");
+            }
+            if (version != SNAPSHOT_VERSION) {
+                throw std::ios_base::failure("Unsupported UTXO snapshot version");
+            }
+        }
+        READWRITE(obj.network_magic, obj.base_hash, obj.base_height, obj.coins_count, obj.commitment);
+    }
+};
+
+/**
+ * What a snapshot is written from: a cursor on a database snapshot of the
+ * coins, and the metadata and the block headers of its best block.
+ */
+struct UTXOSnapshotSource {
+    std::unique_ptr<CCoinsViewCursor> cursor;
+    SnapshotMetadata metadata;
+    std::vector<std::pair<CBlockHeader, uint32_t>> headers;
+
+    UTXOSnapshotSource();
+    ~UTXOSnapshotSource();
+};
+
+/**
+ * Capture the UTXO set of view, as of its best block, into source. This is
+ * cheap, and only this needs cs_main: the coins are read from a database
+ * snapshot when written, so view may keep being written to meanwhile.
+ */
+bool OpenUTXOSnapshotSource(const Config &config, const CCoinsView &view, UTXOSnapshotSource &source,
+                            std::string &error) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+/**
+ * Write the coins of source to path (going through a temporary file, so that
+ * path only ever holds a whole snapshot), and return its metadata.
+ */
+bool WriteUTXOSnapshot(UTXOSnapshotSource &source, const fs::path &path, SnapshotMetadata &metadata,
+                       const std::function<void()> &interruption_point, std::string &error);
+
+/** Capture the UTXO set of view, and write it to path. */
+bool WriteUTXOSnapshot(const Config &config, const CCoinsView &view, const fs::path &path,
+                       SnapshotMetadata &metadata, const std::function<void()> &interruption_point,
+                       std::string &error);
+
+/**
+ * Read a whole snapshot file, and check that its coins match the count and the
+ * commitment of its metadata, which are returned.
+ */
+bool CheckUTXOSnapshot(const Config &config, const fs::path &path, SnapshotMetadata &metadata, std::string &error);
+
+/**
+ * Bootstrap the empty chainstate of a pruning node from a snapshot file: check
+ * it, and its commitment against expected_commitment or, if that is null, the
+ * one the chain parameters give for its base block (see
+ * CChainParams::Assumeutxo()), accept the headers it carries, write its coins,
+ * and mark the blocks up to its base as pruned and assumed valid (see
+ * LoadSnapshotChain()). The base block becomes the tip when the chainstate is
+ * next loaded (LoadChainTip()).
+ *
+ * The history below the base is not validated, neither now nor in the
+ * background later: the chainstate keeps trusting the snapshot, and its
+ * commitment is only checked against the coins of the file. The blocks stay
+ * below BlockValidity::SCRIPTS to tell so.
+ */
+bool LoadUTXOSnapshot(const Config &config, const fs::path &path, const uint256 &expected_commitment,
+                      std::string &error);
@@ -0,0 +1,125 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <utxostats.h>
+
+#include <coins.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <undo.h>
+#include <utxo_snapshot.h>
+
+#include <cassert>
+#include <memory>
+
+namespace {
+//! The size GetUTXOStats() has always reported for an output.
+uint64_t BogoSize(const CTxOut &out) {
+    return 32 /* txid */ + 4 /* vout index */ + 4 /* height + coinbase */ + 8 /* amount */ +
+           2 /* scriptPubKey len */ + out.scriptPubKey.size() /* scriptPubKey */;
+}
+
+void AddTokenAmount(std::map<token::Id, int64_t> &amounts, const token::Id &id, int64_t amount) {
+    if (amount == 0) {
+        return;
+    }
+    const auto [it, inserted] = amounts.try_emplace(id, 0);
+    // Wrap around like the other counters, within a block's change.
+    it->second = int64_t(uint64_t(it->second) + uint64_t(amount));
+    if (it->second == 0) {
+        amounts.erase(it);
+    }
+}
+} // namespace
+
+void CUTXOStats::AddCoin(const COutPoint &outpoint, const Coin &coin) {
+    const CTxOut &out = coin.GetTxOut();
+    ApplyCoinHash(commitment, outpoint, coin);
+    ++nTransactionOutputs;
+    nBogoSize += BogoSize(out);
+    nTotalAmount += out.nValue;
+    if (out.tokenDataPtr) {
+        AddTokenAmount(tokenAmounts, out.tokenDataPtr->GetId(), out.tokenDataPtr->GetAmount().getint64());
+    }
+}
+
+void CUTXOStats::RemoveCoin(const COutPoint &outpoint, const Coin &coin) {
+    const CTxOut &out = coin.GetTxOut();
+    RemoveCoinHash(commitment, outpoint, coin);
+    --nTransactionOutputs;
+    nBogoSize -= BogoSize(out);
+    nTotalAmount -= out.nValue;
+    if (out.tokenDataPtr) {
+        AddTokenAmount(tokenAmounts, out.tokenDataPtr->GetId(), -out.tokenDataPtr->GetAmount().getint64());
+    }
+}
+
+void CUTXOStats::ConnectBlock(const CBlock &block, const CBlockUndo &blockundo, int height) {
+    assert(blockundo.vtxundo.size() + 1 == block.vtx.size());
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        const CTransaction &tx = *block.vtx[i];
+        if (i > 0) {
+            const CTxUndo &txundo = blockundo.vtxundo[i - 1];
+            for (size_t j = 0; j < tx.vin.size(); ++j) {
+                RemoveCoin(tx.vin[j].prevout, txundo.vprevout[j]);
+            }
+        }
+        // Like AddCoins(), which leaves the unspendable outputs out.
+        for (size_t o = 0; o < tx.vout.size(); ++o) {
+            if (!tx.vout[o].scriptPubKey.IsUnspendable()) {
+                AddCoin(COutPoint(tx.GetId(), o), Coin(tx.vout[o], height, tx.IsCoinBase()));
+            }
+        }
+    }
+}
+
+void CUTXOStats::DisconnectBlock(const CBlock &block, const CBlockUndo &blockundo, int height) {
+    assert(blockundo.vtxundo.size() + 1 == block.vtx.size());
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        const CTransaction &tx = *block.vtx[i];
+        if (i > 0) {
+            const CTxUndo &txundo = blockundo.vtxundo[i - 1];
+            for (size_t j = 0; j < tx.vin.size(); ++j) {
+                AddCoin(tx.vin[j].prevout, txundo.vprevout[j]);
+            }
+        }
+        for (size_t o = 0; o < tx.vout.size(); ++o) {
+            if (!tx.vout[o].scriptPubKey.IsUnspendable()) {
+                RemoveCoin(COutPoint(tx.GetId(), o), Coin(tx.vout[o], height, tx.IsCoinBase()));
+            }
+        }
+    }
+}
+
+CUTXOStats &CUTXOStats::operator+=(const CUTXOStats &other) {
+    commitment += other.commitment;
+    nTransactionOutputs += other.nTransactionOutputs;
+    nBogoSize += other.nBogoSize;
+    nTotalAmount += other.nTotalAmount;
+    for (const auto &[id, amount] : other.tokenAmounts) {
+        AddTokenAmount(tokenAmounts, id, amount);
+    }
+    return *this;
+}
+
+bool ComputeUTXOStats(const CCoinsView &view, CUTXOStats &stats, const std::function<void()> &interruption_point) {
+    std::unique_ptr<CCoinsViewCursor> pcursor(view.Cursor());
+    assert(pcursor);
+    return ComputeUTXOStats(*pcursor, stats, interruption_point);
+}
+
+bool ComputeUTXOStats(CCoinsViewCursor &cursor, CUTXOStats &stats, const std::function<void()> &interruption_point) {
+    stats = CUTXOStats();
+    while (cursor.Valid()) {
+        interruption_point();
+        COutPoint outpoint;
+        Coin coin;
+        if (!cursor.GetKey(outpoint) || !cursor.GetValue(coin)) {
+            return false;
+        }
+        stats.AddCoin(outpoint, coin);
+        cursor.Next();
+    }
+    return true;
+}
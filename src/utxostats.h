@@ -0,0 +1,66 @@
+// Copyright (c) 2024 The Fittexxcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <amount.h>
+#include <ec_multiset.h>
+#include <primitives/token.h>
+#include <serialize.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+
+class CBlock;
+class CBlockUndo;
+class CCoinsView;
+class CCoinsViewCursor;
+class COutPoint;
+class Coin;
+
+/** Default for -utxostats */
+static constexpr bool DEFAULT_UTXO_STATS = false;
+
+/**
+ * Statistics of a UTXO set that can be kept up to date block by block, so that
+ * they are reported without scanning the coins database: the ECMultiSet
+ * commitment to its coins (see ApplyCoinHash()), the number, size and value of
+ * its outputs, and the fungible token amount of every token category.
+ *
+ * The statistics of a block are the change it makes to the UTXO set, which is
+ * added to those of the UTXO set it is connected to. The counters wrap around
+ * when a block removes more outputs than it creates, which the addition undoes.
+ */
+class CUTXOStats {
+public:
+    ECMultiSet commitment;
+    uint64_t nTransactionOutputs = 0;
+    uint64_t nBogoSize = 0;
+    Amount nTotalAmount = Amount::zero();
+    //! The categories whose amount sums to zero are left out.
+    std::map<token::Id, int64_t> tokenAmounts;
+
+    void AddCoin(const COutPoint &outpoint, const Coin &coin);
+    void RemoveCoin(const COutPoint &outpoint, const Coin &coin);
+
+    //! The coins created by block, at height, and spent as recorded by blockundo.
+    void ConnectBlock(const CBlock &block, const CBlockUndo &blockundo, int height);
+    void DisconnectBlock(const CBlock &block, const CBlockUndo &blockundo, int height);
+
+    CUTXOStats &operator+=(const CUTXOStats &other);
+
+    SERIALIZE_METHODS(CUTXOStats, obj) {
+        READWRITE(obj.commitment, obj.nTransactionOutputs, obj.nBogoSize, obj.nTotalAmount, obj.tokenAmounts);
+    }
+};
+
+/**
+ * Compute the statistics of the coins of view by scanning them. Returns false
+ * if the coins could not be read.
+ */
+bool ComputeUTXOStats(const CCoinsView &view, CUTXOStats &stats, const std::function<void()> &interruption_point);
+
+/** Likewise, from the coins the cursor is at onwards. */
+bool ComputeUTXOStats(CCoinsViewCursor &cursor, CUTXOStats &stats, const std::function<void()> &interruption_point);
@@ -8,10 +8,13 @@
 
 #include <arith_uint256.h>
 #include <blockindexworkcomparator.h>
+#include <blockprefetch.h>
 #include <blockvalidity.h>
 #include <chainparams.h>
 #include <checkpoints.h>
 #include <checkqueue.h>
+#include <coinsflush.h>
+#include <coinsprefetch.h>
 #include <config.h>
 #include <consensus/activation.h>
 #include <consensus/consensus.h>
@@ -20,6 +23,7 @@
 #include <consensus/tx_check.h>
 #include <consensus/tx_verify.h>
 #include <consensus/validation.h>
+#include <crypto/common.h>
 #include <dsproof/dsproof.h>
 #include <dsproof/storage.h>
 #include <flatfile.h>
@@ -51,7 +55,9 @@
 #include <util/strencodings.h>
 #include <util/string.h>
 #include <util/system.h>
+#include <util/threadpool.h>
 #include <util/time.h>
+#include <utxostats.h>
 #include <validationinterface.h>
 #include <warnings.h>
 
@@ -62,6 +68,7 @@
 #include <optional>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <utility>
 #include <deque>
 
@@ -162,13 +169,16 @@ public:
         EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     // Block (dis)connection on a given view:
+    // The change to the UTXO set statistics is added to pstats, if set.
     DisconnectResult DisconnectBlock(const CBlock &block,
                                      const CBlockIndex *pindex,
-                                     CCoinsViewCache &view);
+                                     CCoinsViewCache &view,
+                                     CUTXOStats *pstats = nullptr);
     bool ConnectBlock(const CBlock &block, CValidationState &state,
                       CBlockIndex *pindex, CCoinsViewCache &view,
                       const CChainParams &params,
-                      BlockValidationOptions options, bool fJustCheck = false)
+                      BlockValidationOptions options, bool fJustCheck = false,
+                      CUTXOStats *pstats = nullptr)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     // Block disconnection on our pcoinsTip:
@@ -196,6 +206,9 @@ public:
 
     bool ReplayBlocks(const Consensus::Params &params, CCoinsView *view);
     bool LoadGenesisBlock(const CChainParams &chainparams);
+    bool LoadSnapshotChain(CBlockIndex *pindexBase,
+                           const std::vector<uint32_t> &txCounts)
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     void PruneBlockIndexCandidates();
 
@@ -268,6 +281,7 @@ bool fHavePruned = false;
 bool fPruneMode = false;
 bool fIsBareMultisigStd = DEFAULT_PERMIT_BAREMULTISIG;
 bool fRequireStandard = true;
+bool fTxPreVerify = DEFAULT_TX_PREVERIFY;
 bool fCheckBlockIndex = false;
 bool fCheckBlockReads = false;
 bool fCheckpointsEnabled = DEFAULT_CHECKPOINTS_ENABLED;
@@ -347,7 +361,9 @@ CBlockIndex *FindForkInGlobalIndex(const CChain &chain,
 }
 
 std::unique_ptr<CCoinsViewDB> pcoinsdbview;
+std::unique_ptr<CCoinsViewFlusher> pcoinsflusher;
 std::unique_ptr<CCoinsViewCache> pcoinsTip;
+std::unique_ptr<CUTXOStats> g_utxo_stats;
 std::unique_ptr<CBlockTreeDB> pblocktree;
 
 enum class FlushStateMode { NONE, IF_NEEDED, PERIODIC, ALWAYS };
@@ -511,7 +527,8 @@ AcceptToMemoryPoolWorker(const Config &config, CTxMemPool &pool,
                          bool *pfMissingInputs, int64_t nAcceptTime,
                          bool bypass_limits, const Amount nAbsurdFee,
                          std::vector<COutPoint> &coins_to_uncache,
-                         bool test_accept) EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+                         bool test_accept, const PreVerifiedTx *preverified)
+    EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
     AssertLockHeld(cs_main);
 
     const Consensus::Params &consensusParams =
@@ -738,9 +755,22 @@ AcceptToMemoryPoolWorker(const Config &config, CTxMemPool &pool,
             }
         }
 
+        // The scripts PreVerifyTransactions() verified with the same flags are
+        // not verified again: the coins they spend are those looked up above.
+        if (preverified && (preverified->txid != txid || preverified->scriptVerifyFlags != scriptVerifyFlags ||
+                            preverified->nextBlockScriptVerifyFlags != nextBlockScriptVerifyFlags)) {
+            preverified = nullptr;
+        }
+        if (preverified && !preverified->valid) {
+            state = preverified->state;
+            return false;
+        }
+
         int nSigChecksStandard;
         PrecomputedTransactionData txdata;
-        if (!CheckInputs(tx, state, view, true, scriptVerifyFlags, true, false, txdata, nSigChecksStandard)) {
+        if (preverified) {
+            nSigChecksStandard = preverified->nSigChecks;
+        } else if (!CheckInputs(tx, state, view, true, scriptVerifyFlags, true, false, txdata, nSigChecksStandard)) {
             // State filled in by CheckInputs.
             return false;
         }
@@ -769,9 +799,13 @@ AcceptToMemoryPoolWorker(const Config &config, CTxMemPool &pool,
         // invalid blocks (using TestBlockValidity), however allowing such
         // transactions into the mempool can be exploited as a DoS attack.
         int nSigChecksConsensus;
-        if (!CheckInputsFromMempoolAndCache(tx, state, view, pool,
-                                            nextBlockScriptVerifyFlags, true,
-                                            txdata, nSigChecksConsensus)) {
+        if (preverified) {
+            // PreVerifyTransactions() checked them too.
+            nSigChecksConsensus = preverified->nSigChecks;
+            AddKeyInScriptCache(ScriptCacheKey(tx, nextBlockScriptVerifyFlags), nSigChecksConsensus);
+        } else if (!CheckInputsFromMempoolAndCache(tx, state, view, pool,
+                                                   nextBlockScriptVerifyFlags, true,
+                                                   txdata, nSigChecksConsensus)) {
             // This can occur under some circumstances, if the node receives an
             // unrequested tx which is invalid due to new consensus rules not
             // being activated yet (during IBD).
@@ -884,12 +918,13 @@ AcceptToMemoryPoolWithTime(const Config &config, CTxMemPool &pool,
                            CValidationState &state, const CTransactionRef &tx,
                            bool *pfMissingInputs, int64_t nAcceptTime,
                            bool bypass_limits, const Amount nAbsurdFee,
-                           bool test_accept) EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+                           bool test_accept, const PreVerifiedTx *preverified)
+    EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
     AssertLockHeld(cs_main);
     std::vector<COutPoint> coins_to_uncache;
     bool res = AcceptToMemoryPoolWorker(
         config, pool, state, tx, pfMissingInputs, nAcceptTime, bypass_limits,
-        nAbsurdFee, coins_to_uncache, test_accept);
+        nAbsurdFee, coins_to_uncache, test_accept, preverified);
     if (!res) {
         for (const COutPoint &outpoint : coins_to_uncache) {
             pcoinsTip->Uncache(outpoint);
@@ -907,10 +942,11 @@ AcceptToMemoryPoolWithTime(const Config &config, CTxMemPool &pool,
 bool AcceptToMemoryPool(const Config &config, CTxMemPool &pool,
                         CValidationState &state, const CTransactionRef &tx,
                         bool *pfMissingInputs, bool bypass_limits,
-                        const Amount nAbsurdFee, bool test_accept) {
+                        const Amount nAbsurdFee, bool test_accept,
+                        const PreVerifiedTx *preverified) {
     return AcceptToMemoryPoolWithTime(config, pool, state, tx, pfMissingInputs,
                                       GetTime(), bypass_limits, nAbsurdFee,
-                                      test_accept);
+                                      test_accept, preverified);
 }
 
 /**
@@ -991,23 +1027,83 @@ static bool WriteBlockToDisk(const CBlock &block, FlatFilePos &pos,
     return true;
 }
 
+//! Memory mappings of the block and undo files, to read from.
+static FlatFileMapCache g_block_file_maps{DEFAULT_BLOCK_MAP_FILES};
+static FlatFileMapCache g_undo_file_maps{DEFAULT_BLOCK_MAP_FILES};
+
+void SetBlockMapFiles(size_t max_files) {
+    g_block_file_maps.SetMaxFiles(max_files);
+    g_undo_file_maps.SetMaxFiles(max_files);
+}
+
+/**
+ * Get the record at pos in a block or undo file from a mapping of the file.
+ * Records are written after the disk magic and their size, which are checked,
+ * and may be followed by extra_size bytes (such as a checksum). On success,
+ * data spans the record and the extra bytes, and remains valid as long as file
+ * is held on to. Otherwise, the record should be read from the file as usual.
+ */
+static bool GetMappedRecord(FlatFileMapCache &maps, const FlatFileSeq &seq,
+                            const FlatFilePos &pos,
+                            const CMessageHeader::MessageMagic &magic,
+                            size_t extra_size,
+                            std::shared_ptr<const MappedFlatFile> &file,
+                            Span<const uint8_t> &data) {
+    uint32_t size;
+    const size_t header_size = magic.size() + sizeof(size);
+    if (pos.IsNull() || pos.nPos < header_size) {
+        return false;
+    }
+    const FlatFilePos header_pos(pos.nFile, pos.nPos - header_size);
+    file = maps.Get(seq, header_pos, header_size);
+    if (!file) {
+        return false;
+    }
+    const Span<const uint8_t> header =
+        file->Data().subspan(header_pos.nPos, header_size);
+    if (!std::equal(magic.begin(), magic.end(), header.begin())) {
+        return false;
+    }
+    size = ReadLE32(header.data() + magic.size());
+
+    // The file may have been appended to since it was mapped.
+    file = maps.Get(seq, pos, size_t(size) + extra_size);
+    if (!file) {
+        return false;
+    }
+    data = file->Data().subspan(pos.nPos, size_t(size) + extra_size);
+    return true;
+}
+
 bool ReadBlockFromDisk(CBlock &block, const FlatFilePos &pos,
                        const Consensus::Params &params) {
     block.SetNull();
 
-    // Open history file to read
-    CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
-    if (filein.IsNull()) {
-        return error("ReadBlockFromDisk: OpenBlockFile failed for %s",
-                     pos.ToString());
-    }
+    std::shared_ptr<const MappedFlatFile> file;
+    Span<const uint8_t> data;
+    if (GetMappedRecord(g_block_file_maps, BlockFileSeq(), pos, Params().DiskMagic(), 0, file, data)) {
+        // Deserialize straight from the mapping
+        try {
+            GenericVectorReader(SER_DISK, CLIENT_VERSION, data, 0) >> block;
+        } catch (const std::exception &e) {
+            return error("%s: Deserialize or I/O error - %s at %s", __func__,
+                         e.what(), pos.ToString());
+        }
+    } else {
+        // Open history file to read
+        CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
+        if (filein.IsNull()) {
+            return error("ReadBlockFromDisk: OpenBlockFile failed for %s",
+                         pos.ToString());
+        }
 
-    // Read block
-    try {
-        filein >> block;
-    } catch (const std::exception &e) {
-        return error("%s: Deserialize or I/O error - %s at %s", __func__,
-                     e.what(), pos.ToString());
+        // Read block
+        try {
+            filein >> block;
+        } catch (const std::exception &e) {
+            return error("%s: Deserialize or I/O error - %s at %s", __func__,
+                         e.what(), pos.ToString());
+        }
     }
 
     // Check the header
@@ -1040,6 +1136,46 @@ bool ReadBlockFromDisk(CBlock &block, const CBlockIndex *pindex,
     return true;
 }
 
+/** The -checkblockreads sanity checks of the raw block data of pindex, read from blockPos. */
+static bool CheckRawBlock(Span<const uint8_t> rawBlock, const CBlockIndex *pindex, const FlatFilePos &blockPos,
+                          int nType, int nVersion) {
+    // This is normally only enabled for regtest and is provided in order to guarantee additional sanity checks
+    // when returning raw blocks in this manner. For real networks, we prefer the performance benefit of not
+    // deserializing and not doing these slower checks here.
+    Tic elapsed;
+    CBlock block;
+    std::vector<uint8_t> rawBlock2;
+    rawBlock2.reserve(rawBlock.size());
+
+    try {
+        GenericVectorReader(nType, nVersion, rawBlock, 0) >> block;
+        CVectorWriter(nType, nVersion, rawBlock2, 0) << block;
+    } catch (const std::exception &e) {
+        return error("%s: Consistency check failed; ser/deser error for block data for %s, exception was: %s",
+                     __func__, blockPos.ToString(), e.what());
+    }
+
+    // Ensure the block, when re-serialized with nType and nVersion matches what we had on disk. This defends
+    // against block serialization being sensitive to the caller's nType/nVersion flags. Block serialization
+    // should always be the same irrespective of flags provided, otherwise this ReadRawBlockFromDisk() function
+    // cannot be used and caller should be using ReadBlockFromDisk() instead (see net_processing.cpp where this
+    // function is called).
+    if (!std::equal(rawBlock.begin(), rawBlock.end(), rawBlock2.begin(), rawBlock2.end())) {
+        return error("%s: Consistency check failed; block raw data mismatches re-serialized version for block %s at"
+                     " %s, nType: %i, nVersion: %i", __func__, pindex->ToString(), blockPos.ToString(), nType,
+                     nVersion);
+    }
+    // Check the header (detects possible corruption; unlikely)
+    if (block.GetHash() != pindex->GetBlockHash()) {
+        return error("%s: Consistency check failed; GetHash() doesn't match index for %s at %s",
+                     __func__, pindex->ToString(), blockPos.ToString());
+    }
+    LogPrint(BCLog::BENCH, "%s: checks passed for block %s (%i bytes) in %s msec\n", __func__,
+             block.GetHash().ToString(), rawBlock2.size(), elapsed.msecStr());
+
+    return true;
+}
+
 bool ReadRawBlockFromDisk(std::vector<uint8_t> &rawBlock, const CBlockIndex *pindex,
                           const CChainParams &chainParams, int nType, int nVersion) {
     FlatFilePos blockPos;
@@ -1048,75 +1184,78 @@ bool ReadRawBlockFromDisk(std::vector<uint8_t> &rawBlock, const CBlockIndex *pin
         blockPos = pindex->GetBlockPos();
     }
 
-    CAutoFile filein(OpenBlockFile(blockPos, true), SER_DISK, CLIENT_VERSION);
-    if (filein.IsNull()) {
-        return error("%s: OpenBlockFile failed for %s", __func__, blockPos.ToString());
-    }
-
-    unsigned int blockSize = 0;
-    const size_t headerSize = CMessageHeader::MESSAGE_START_SIZE + sizeof(blockSize);
-    if (std::fseek(filein.Get(), -static_cast<long>(headerSize), SEEK_CUR)) {
-        return error("%s: failed to seek to the block data for %s", __func__, blockPos.ToString());
-    }
-
-    try {
-        // read the disk magic and block size
-        CMessageHeader::MessageMagic magic;
-        filein >> magic >> blockSize;
-
-        // verify disk magic to validate block position inside the file
-        if (magic != chainParams.DiskMagic()) {
-            return error("%s: block DiskMagic verification failed for %s", __func__, blockPos.ToString());
-        }
-
-        // check the block size for sanity
-        if (blockSize < BLOCK_HEADER_SIZE || blockSize > MAX_EXCESSIVE_BLOCK_SIZE) {
+    std::shared_ptr<const MappedFlatFile> file;
+    Span<const uint8_t> data;
+    if (GetMappedRecord(g_block_file_maps, BlockFileSeq(), blockPos, chainParams.DiskMagic(), 0, file, data)) {
+        // The disk magic was verified; check the block size for sanity
+        if (data.size() < BLOCK_HEADER_SIZE || data.size() > MAX_EXCESSIVE_BLOCK_SIZE) {
             return error("%s: block size verification failed for %s", __func__, blockPos.ToString());
         }
-        // populate data
-        rawBlock.resize(blockSize);
-        filein >> Span{rawBlock};
-    } catch (const std::exception &e) {
-        return error("%s: failed to read block data from disk for %s. Original exception: %s",
-                     __func__, blockPos.ToString(), e.what());
-    }
+        rawBlock.assign(data.begin(), data.end());
+    } else {
+        CAutoFile filein(OpenBlockFile(blockPos, true), SER_DISK, CLIENT_VERSION);
+        if (filein.IsNull()) {
+            return error("%s: OpenBlockFile failed for %s", __func__, blockPos.ToString());
+        }
 
-    if (fCheckBlockReads) {
-        // This is normally only enabled for regtest and is provided in order to guarantee additional sanity checks
-        // when returning raw blocks in this manner. For real networks, we prefer the performance benefit of not
-        // deserializing and not doing these slower checks here.
-        Tic elapsed;
-        CBlock block;
-        std::vector<uint8_t> rawBlock2;
-        rawBlock2.reserve(rawBlock.size());
+        unsigned int blockSize = 0;
+        const size_t headerSize = CMessageHeader::MESSAGE_START_SIZE + sizeof(blockSize);
+        if (std::fseek(filein.Get(), -static_cast<long>(headerSize), SEEK_CUR)) {
+            return error("%s: failed to seek to the block data for %s", __func__, blockPos.ToString());
+        }
 
         try {
-            VectorReader(nType, nVersion, rawBlock, 0) >> block;
-            CVectorWriter(nType, nVersion, rawBlock2, 0) << block;
+            // read the disk magic and block size
+            CMessageHeader::MessageMagic magic;
+            filein >> magic >> blockSize;
+
+            // verify disk magic to validate block position inside the file
+            if (magic != chainParams.DiskMagic()) {
+                return error("%s: block DiskMagic verification failed for %s", __func__, blockPos.ToString());
+            }
+
+            // check the block size for sanity
+            if (blockSize < BLOCK_HEADER_SIZE || blockSize > MAX_EXCESSIVE_BLOCK_SIZE) {
+                return error("%s: block size verification failed for %s", __func__, blockPos.ToString());
+            }
+            // populate data
+            rawBlock.resize(blockSize);
+            filein >> Span{rawBlock};
         } catch (const std::exception &e) {
-            return error("%s: Consistency check failed; ser/deser error for block data for %s, exception was: %s",
+            return error("%s: failed to read block data from disk for %s. Original exception: %s",
                          __func__, blockPos.ToString(), e.what());
         }
+    }
 
-        // Ensure the block, when re-serialized with nType and nVersion matches what we had on disk. This defends
-        // against block serialization being sensitive to the caller's nType/nVersion flags. Block serialization
-        // should always be the same irrespective of flags provided, otherwise this ReadRawBlockFromDisk() function
-        // cannot be used and caller should be using ReadBlockFromDisk() instead (see net_processing.cpp where this
-        // function is called).
-        if (rawBlock != rawBlock2) {
-            return error("%s: Consistency check failed; block raw data mismatches re-serialized version for block %s at"
-                         " %s, nType: %i, nVersion: %i", __func__, pindex->ToString(), blockPos.ToString(), nType,
-                         nVersion);
-        }
-        // Check the header (detects possible corruption; unlikely)
-        if (block.GetHash() != pindex->GetBlockHash()) {
-            return error("%s: Consistency check failed; GetHash() doesn't match index for %s at %s",
-                         __func__, pindex->ToString(), blockPos.ToString());
+    return !fCheckBlockReads || CheckRawBlock(rawBlock, pindex, blockPos, nType, nVersion);
+}
+
+bool ReadRawBlockFromDisk(Span<const uint8_t> &rawBlock, std::shared_ptr<const void> &owner, const CBlockIndex *pindex,
+                          const CChainParams &chainParams, int nType, int nVersion) {
+    FlatFilePos blockPos;
+    {
+        LOCK(cs_main);
+        blockPos = pindex->GetBlockPos();
+    }
+
+    std::shared_ptr<const MappedFlatFile> file;
+    if (GetMappedRecord(g_block_file_maps, BlockFileSeq(), blockPos, chainParams.DiskMagic(), 0, file, rawBlock)) {
+        // The disk magic was verified; check the block size for sanity
+        if (rawBlock.size() < BLOCK_HEADER_SIZE || rawBlock.size() > MAX_EXCESSIVE_BLOCK_SIZE) {
+            rawBlock = {};
+            return error("%s: block size verification failed for %s", __func__, blockPos.ToString());
         }
-        LogPrint(BCLog::BENCH, "%s: checks passed for block %s (%i bytes) in %s msec\n", __func__,
-                 block.GetHash().ToString(), rawBlock2.size(), elapsed.msecStr());
+        owner = std::move(file);
+        return !fCheckBlockReads || CheckRawBlock(rawBlock, pindex, blockPos, nType, nVersion);
     }
 
+    // Read the block into a buffer of its own instead
+    auto buffer = std::make_shared<std::vector<uint8_t>>();
+    if (!ReadRawBlockFromDisk(*buffer, pindex, chainParams, nType, nVersion)) {
+        return false;
+    }
+    rawBlock = *buffer;
+    owner = std::move(buffer);
     return true;
 }
 
@@ -1342,12 +1481,23 @@ void UpdateCoins(CCoinsViewCache &view, const CTransaction &tx, int nHeight) {
 }
 
 bool CScriptCheck::operator()() {
+    return Run(nullptr, 0);
+}
+
+bool CScriptCheck::Run(SchnorrSigBatch *batch, size_t tag) {
     assert(bool(context));
     assert(bool(context->tx().constantTx()));
 
-    if ( ! VerifyScript(context->scriptSig(), context->coinScriptPubKey(), nFlags,
-                        CachingTransactionSignatureChecker(*context, cacheStore, txdata),
-                        metrics, &error)) {
+    // Deferring Schnorr signatures is only sound if any invalid signature
+    // would have made the script fail (see BatchingTransactionSignatureChecker).
+    const bool verified = batch && (nFlags & SCRIPT_VERIFY_NULLFAIL)
+        ? VerifyScript(context->scriptSig(), context->coinScriptPubKey(), nFlags,
+                       BatchingTransactionSignatureChecker(*context, cacheStore, txdata, *batch, tag),
+                       metrics, &error)
+        : VerifyScript(context->scriptSig(), context->coinScriptPubKey(), nFlags,
+                       CachingTransactionSignatureChecker(*context, cacheStore, txdata),
+                       metrics, &error);
+    if (!verified) {
         return false;
     }
     if ((pTxLimitSigChecks &&
@@ -1363,12 +1513,74 @@ bool CScriptCheck::operator()() {
     return true;
 }
 
+bool CScriptCheck::RunBatch(std::vector<CScriptCheck> &checks) {
+    SchnorrSigBatch batch;
+    for (size_t i = 0; i < checks.size(); ++i) {
+        if (!checks[i].Run(&batch, i)) {
+            return false;
+        }
+    }
+    if (batch.Verify()) {
+        return true;
+    }
+    // At least one deferred signature is invalid: find the check it belongs
+    // to, which would have failed on its own with a NULLFAIL error.
+    const std::optional<size_t> invalid = batch.FindInvalid();
+    if (!invalid) {
+        // Every signature verifies individually, so the batch is valid.
+        return true;
+    }
+    checks[*invalid].error = ScriptError::SIG_NULLFAIL;
+    return false;
+}
+
 int GetSpendHeight(const CCoinsViewCache &inputs) {
     LOCK(cs_main);
     CBlockIndex *pindexPrev = LookupBlockIndex(inputs.GetBestBlock());
     return pindexPrev->nHeight + 1;
 }
 
+/**
+ * Fill in state with why check, verifying the input of context with flags,
+ * failed, and return false.
+ */
+static bool InvalidScript(CValidationState &state, const CScriptCheck &check,
+                          const ScriptExecutionContext &context, uint32_t flags,
+                          bool sigCacheStore, const PrecomputedTransactionData &txdata) {
+    ScriptError scriptError = check.GetScriptError();
+    // Compute flags without the optional standardness flags.
+    // This differs from MANDATORY_SCRIPT_VERIFY_FLAGS as it contains
+    // additional upgrade flags (see AcceptToMemoryPoolWorker variable
+    // extraFlags).
+    uint32_t mandatoryFlags = flags & ~STANDARD_NOT_MANDATORY_VERIFY_FLAGS;
+    if (flags != mandatoryFlags) {
+        // Check whether the failure was caused by a non-mandatory
+        // script verification check. If so, don't trigger DoS
+        // protection to avoid splitting the network on the basis of
+        // relay policy disagreements.
+        CScriptCheck check2(context, mandatoryFlags, sigCacheStore, txdata);
+        if (check2()) {
+            return state.Invalid(
+                false, REJECT_NONSTANDARD,
+                strprintf("non-mandatory-script-verify-flag (%s)",
+                          ScriptErrorString(scriptError)));
+        }
+        // update the error message to reflect the mandatory violation.
+        scriptError = check2.GetScriptError();
+    }
+
+    // Failures of other flags indicate a transaction that is invalid in
+    // new blocks, e.g. a invalid P2SH. We DoS ban such nodes as they
+    // are not following the protocol. That said during an upgrade
+    // careful thought should be taken as to the correct behavior - we
+    // may want to continue peering with non-upgraded nodes even after
+    // soft-fork super-majority signaling has occurred.
+    return state.DoS(
+        100, false, REJECT_INVALID,
+        strprintf("mandatory-script-verify-flag-failed (%s)",
+                  ScriptErrorString(scriptError)));
+}
+
 bool CheckInputs(const CTransaction &tx, CValidationState &state,
                  const CCoinsViewCache &view, bool fScriptChecks,
                  const uint32_t flags, bool sigCacheStore, bool scriptCacheStore,
@@ -1428,39 +1640,7 @@ bool CheckInputs(const CTransaction &tx, CValidationState &state,
         if (pvChecks) {
             pvChecks->push_back(std::move(check));
         } else if (!check()) {
-            ScriptError scriptError = check.GetScriptError();
-            // Compute flags without the optional standardness flags.
-            // This differs from MANDATORY_SCRIPT_VERIFY_FLAGS as it contains
-            // additional upgrade flags (see AcceptToMemoryPoolWorker variable
-            // extraFlags).
-            uint32_t mandatoryFlags =
-                flags & ~STANDARD_NOT_MANDATORY_VERIFY_FLAGS;
-            if (flags != mandatoryFlags) {
-                // Check whether the failure was caused by a non-mandatory
-                // script verification check. If so, don't trigger DoS
-                // protection to avoid splitting the network on the basis of
-                // relay policy disagreements.
-                CScriptCheck check2(contextVec[i], mandatoryFlags, sigCacheStore, txdata);
-                if (check2()) {
-                    return state.Invalid(
-                        false, REJECT_NONSTANDARD,
-                        strprintf("non-mandatory-script-verify-flag (%s)",
-                                  ScriptErrorString(scriptError)));
-                }
-                // update the error message to reflect the mandatory violation.
-                scriptError = check2.GetScriptError();
-            }
-
-            // Failures of other flags indicate a transaction that is invalid in
-            // new blocks, e.g. a invalid P2SH. We DoS ban such nodes as they
-            // are not following the protocol. That said during an upgrade
-            // careful thought should be taken as to the correct behavior - we
-            // may want to continue peering with non-upgraded nodes even after
-            // soft-fork super-majority signaling has occurred.
-            return state.DoS(
-                100, false, REJECT_INVALID,
-                strprintf("mandatory-script-verify-flag-failed (%s)",
-                          ScriptErrorString(scriptError)));
+            return InvalidScript(state, check, contextVec[i], flags, sigCacheStore, txdata);
         }
 
         nSigChecksTotal += check.GetScriptExecutionMetrics().nSigChecks;
@@ -1507,38 +1687,53 @@ static bool UndoWriteToDisk(const CBlockUndo &blockundo, FlatFilePos &pos,
     return true;
 }
 
-bool UndoReadFromDisk(CBlockUndo &blockundo, const CBlockIndex *pindex) {
-    FlatFilePos pos = pindex->GetUndoPos();
-    if (pos.IsNull()) {
-        return error("%s: no undo data available", __func__);
-    }
-
-    // Open history file to read
-    CAutoFile filein(OpenUndoFile(pos, true), SER_DISK, CLIENT_VERSION);
-    if (filein.IsNull()) {
-        return error("%s: OpenUndoFile failed", __func__);
-    }
-
+/** Read and verify the undo data of pindex, followed by its checksum. */
+template <typename Stream>
+static bool ReadUndo(CBlockUndo &blockundo, const CBlockIndex *pindex,
+                     Stream &filein) {
     // Read block
     uint256 hashChecksum;
     // We need a CHashVerifier as reserializing may lose data
-    CHashVerifier<CAutoFile> verifier(&filein);
+    CHashVerifier<Stream> verifier(&filein);
     try {
         verifier << pindex->pprev->GetBlockHash();
         verifier >> blockundo;
         filein >> hashChecksum;
     } catch (const std::exception &e) {
-        return error("%s: Deserialize or I/O error - %s", __func__, e.what());
+        return error("UndoReadFromDisk: Deserialize or I/O error - %s",
+                     e.what());
     }
 
     // Verify checksum
     if (hashChecksum != verifier.GetHash()) {
-        return error("%s: Checksum mismatch", __func__);
+        return error("UndoReadFromDisk: Checksum mismatch");
     }
 
     return true;
 }
 
+bool UndoReadFromDisk(CBlockUndo &blockundo, const CBlockIndex *pindex) {
+    FlatFilePos pos = pindex->GetUndoPos();
+    if (pos.IsNull()) {
+        return error("%s: no undo data available", __func__);
+    }
+
+    std::shared_ptr<const MappedFlatFile> file;
+    Span<const uint8_t> data;
+    if (GetMappedRecord(g_undo_file_maps, UndoFileSeq(), pos, Params().DiskMagic(), uint256::size(), file, data)) {
+        // Read straight from the mapping
+        GenericVectorReader<Span<const uint8_t>> reader(SER_DISK, CLIENT_VERSION, data, 0);
+        return ReadUndo(blockundo, pindex, reader);
+    }
+
+    // Open history file to read
+    CAutoFile filein(OpenUndoFile(pos, true), SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull()) {
+        return error("%s: OpenUndoFile failed", __func__);
+    }
+    return ReadUndo(blockundo, pindex, filein);
+}
+
 /** Abort with a message */
 static bool AbortNode(const std::string &strMessage,
                       const std::string &userMessage = "") {
@@ -1602,14 +1797,19 @@ DisconnectResult UndoCoinSpend(const Coin &undo, CCoinsViewCache &view,
  */
 DisconnectResult CChainState::DisconnectBlock(const CBlock &block,
                                               const CBlockIndex *pindex,
-                                              CCoinsViewCache &view) {
+                                              CCoinsViewCache &view,
+                                              CUTXOStats *pstats) {
     CBlockUndo blockUndo;
     if (!UndoReadFromDisk(blockUndo, pindex)) {
         error("DisconnectBlock(): failure reading undo data");
         return DISCONNECT_FAILED;
     }
 
-    return ApplyBlockUndo(blockUndo, block, pindex, view);
+    const DisconnectResult res = ApplyBlockUndo(blockUndo, block, pindex, view);
+    if (pstats && res == DISCONNECT_OK) {
+        pstats->DisconnectBlock(block, blockUndo, pindex->nHeight);
+    }
+    return res;
 }
 
 DisconnectResult ApplyBlockUndo(const CBlockUndo &blockUndo,
@@ -1684,6 +1884,11 @@ static void FlushBlockFile(bool fFinalize = false) {
     bool status = true;
     status &= BlockFileSeq().Flush(block_pos_old, fFinalize);
     status &= UndoFileSeq().Flush(undo_pos_old, fFinalize);
+    if (fFinalize) {
+        // Don't map the truncated files past their end anymore.
+        g_block_file_maps.Remove(nLastBlockFile);
+        g_undo_file_maps.Remove(nLastBlockFile);
+    }
     if (!status) {
         AbortNode("Flushing block file to disk failed. This is likely the "
                   "result of an I/O error.");
@@ -1718,13 +1923,198 @@ static bool WriteUndoDataForBlock(const CBlockUndo &blockundo,
 }
 
 static CCheckQueue<CScriptCheck> scriptcheckqueue(128);
+static CWorkStealingCheckQueue<CScriptCheck> workstealingscriptcheckqueue(128);
+//! The script check queue in use, selected by StartScriptCheckWorkerThreads()
+static CCheckQueueBase<CScriptCheck> *pscriptcheckqueue = &scriptcheckqueue;
+
+static CCheckQueueBase<CScriptCheck> *GetScriptCheckQueue(CheckQueueEngine engine) {
+    switch (engine) {
+        case CheckQueueEngine::LEGACY: return &scriptcheckqueue;
+        case CheckQueueEngine::WORKSTEALING: return &workstealingscriptcheckqueue;
+    }
+    assert(false);
+    return nullptr;
+}
+
+//! Reads the blocks ConnectTip is about to connect ahead of time.
+static CBlockPrefetcher g_block_prefetcher([](CBlock &block, const FlatFilePos &pos) {
+    return ReadBlockFromDisk(block, pos, Params().GetConsensus());
+});
+
+//! Fetches the coins spent by a block from the database before ConnectBlock.
+static CCoinsPrefetcher g_coins_prefetcher;
+
+void StartCoinsPrefetchThreads(int threads_num) {
+    g_coins_prefetcher.Start(threads_num);
+}
+
+void StopCoinsPrefetchThreads() {
+    g_coins_prefetcher.Stop();
+}
+
+//! Verifies the scripts of transactions for PreVerifyTransactions().
+static ThreadPool g_tx_preverify_pool("txverify");
+
+void StartTxPreVerifyThreads(int threads_num) {
+    g_tx_preverify_pool.Start(threads_num);
+}
+
+void StopTxPreVerifyThreads() {
+    g_tx_preverify_pool.Stop();
+}
+
+void PreVerifyTransactions(const Config &config, const CTxMemPool &pool,
+                           const std::vector<CTransactionRef> &txs,
+                           const std::function<bool(size_t i, const PreVerifiedTx *preverified)> &accept) {
+    AssertLockNotHeld(cs_main);
+
+    // The contexts of the inputs of every transaction to verify, which hold
+    // copies of the coins they spend; empty for the transactions skipped.
+    std::vector<std::vector<ScriptExecutionContext>> contexts(txs.size());
+    std::vector<bool> checked(txs.size());
+    for (size_t i = 0; i < txs.size(); ++i) {
+        CValidationState state;
+        checked[i] = CheckRegularTransaction(*txs[i], state);
+    }
+
+    uint32_t scriptVerifyFlags, nextBlockScriptVerifyFlags;
+    {
+        LOCK2(cs_main, pool.cs);
+        scriptVerifyFlags = GetMemPoolScriptFlags(config.GetChainParams().GetConsensus(), ::ChainActive().Tip(),
+                                                  &nextBlockScriptVerifyFlags);
+        const int nSpendHeight = ::ChainActive().Height() + 1;
+        const CFeeRate mempoolMinFeeRate = pool.GetMinFee(config.GetMaxMemPoolSize());
+
+        const CCoinsViewMemPool viewMemPool(pcoinsTip.get(), pool);
+        // The earlier transactions of txs, whose outputs the later ones may spend.
+        std::unordered_map<TxId, const CTransaction *, SaltedTxIdHasher> batchTxs;
+        for (size_t i = 0; i < txs.size(); ++i) {
+            const CTransaction &tx = *txs[i];
+            if (std::string reason; !checked[i] || pool.exists(tx.GetId()) ||
+                                    (fRequireStandard && !IsStandardTx(tx, reason, scriptVerifyFlags))) {
+                continue;
+            }
+
+            CCoinsView dummy;
+            CCoinsViewCache view(&dummy);
+            bool fHaveInputs = true;
+            for (const CTxIn &txin : tx.vin) {
+                if (pool.GetConflictTx(txin.prevout)) {
+                    fHaveInputs = false;
+                    break;
+                }
+                // Leave the coins cache as we found it: AcceptToMemoryPool()
+                // only keeps the coins it fetches if it accepts the transaction.
+                const bool fCached = pcoinsTip->HaveCoinInCache(txin.prevout);
+                Coin coin;
+                if (viewMemPool.GetCoin(txin.prevout, coin)) {
+                    if (!fCached) {
+                        pcoinsTip->Uncache(txin.prevout);
+                    }
+                } else if (const auto it = batchTxs.find(txin.prevout.GetTxId());
+                           it != batchTxs.end() && txin.prevout.GetN() < it->second->vout.size()) {
+                    coin = Coin(it->second->vout[txin.prevout.GetN()], MEMPOOL_HEIGHT, false);
+                } else {
+                    fHaveInputs = false;
+                    break;
+                }
+                view.AddCoin(txin.prevout, std::move(coin), false);
+            }
+            if (!fHaveInputs) {
+                continue;
+            }
+
+            // The cheap checks AcceptToMemoryPool() makes before the scripts:
+            // nothing is verified for a transaction it rejects anyway. The fee
+            // is checked against the size, which is at most the virtual size.
+            CValidationState state;
+            Amount nFees = Amount::zero();
+            if (!Consensus::CheckTxInputs(tx, state, view, nSpendHeight, nFees) ||
+                (fRequireStandard && !AreInputsStandard(tx, view, nextBlockScriptVerifyFlags))) {
+                continue;
+            }
+            pool.ApplyDelta(tx.GetId(), nFees);
+            const size_t nSize = tx.GetTotalSize();
+            if (nFees < minRelayTxFee.GetFee(nSize) || nFees < mempoolMinFeeRate.GetFee(nSize)) {
+                continue;
+            }
+
+            contexts[i] = ScriptExecutionContext::createForAllInputs(tx, view);
+            batchTxs.emplace(tx.GetId(), &tx);
+        }
+    }
+
+    std::vector<std::optional<PreVerifiedTx>> results(txs.size());
+    g_tx_preverify_pool.ForEach(txs.size(), [&](size_t i) {
+        if (contexts[i].empty() || ShutdownRequested()) {
+            return;
+        }
+        PreVerifiedTx result;
+        result.txid = txs[i]->GetId();
+        result.scriptVerifyFlags = scriptVerifyFlags;
+        result.nextBlockScriptVerifyFlags = nextBlockScriptVerifyFlags;
+        PrecomputedTransactionData txdata(contexts[i].front());
+        TxSigCheckLimiter txLimitSigChecks;
+        for (const ScriptExecutionContext &context : contexts[i]) {
+            CScriptCheck check(context, scriptVerifyFlags, true /* cacheStore */, txdata, &txLimitSigChecks);
+            if (!check()) {
+                InvalidScript(result.state, check, context, scriptVerifyFlags, true /* sigCacheStore */, txdata);
+                results[i] = std::move(result);
+                return;
+            }
+            result.nSigChecks += check.GetScriptExecutionMetrics().nSigChecks;
+        }
+        // As AcceptToMemoryPool() does, check them again with the flags of the
+        // next block, finding the signatures in the cache. It reports the
+        // transactions which fail this itself.
+        int nSigChecksConsensus = 0;
+        for (const ScriptExecutionContext &context : contexts[i]) {
+            CScriptCheck check(context, nextBlockScriptVerifyFlags, true /* cacheStore */, txdata);
+            if (!check()) {
+                return;
+            }
+            nSigChecksConsensus += check.GetScriptExecutionMetrics().nSigChecks;
+        }
+        if (nSigChecksConsensus == result.nSigChecks) {
+            result.valid = true;
+            results[i] = std::move(result);
+        }
+    });
+
+    for (size_t i = 0; i < txs.size() && !ShutdownRequested(); ++i) {
+        const PreVerifiedTx *preverified = results[i] ? &*results[i] : nullptr;
+        if (accept(i, preverified) || !preverified || !preverified->valid) {
+            continue;
+        }
+        // Checking the scripts again without storing finds the signatures in
+        // the cache, and flags them to be evicted first.
+        PrecomputedTransactionData txdata(contexts[i].front());
+        for (const ScriptExecutionContext &context : contexts[i]) {
+            CScriptCheck check(context, scriptVerifyFlags, false /* cacheStore */, txdata);
+            check();
+        }
+    }
+}
+
+void StartBlockPrefetchThreads(int depth) {
+    g_block_prefetcher.Start(BLOCK_PREFETCH_THREADS, depth);
+}
+
+void StopBlockPrefetchThreads() {
+    g_block_prefetcher.Stop();
+}
 
-void StartScriptCheckWorkerThreads(int threads_num) {
-    scriptcheckqueue.StartWorkerThreads(threads_num);
+void StartScriptCheckWorkerThreads(int threads_num, CheckQueueEngine engine) {
+    pscriptcheckqueue = GetScriptCheckQueue(engine);
+    pscriptcheckqueue->StartWorkerThreads(threads_num);
 }
 
 void StopScriptCheckWorkerThreads() {
-    scriptcheckqueue.StopWorkerThreads();
+    // Those of either engine, should the engine have changed since they were
+    // started: no queue may be destroyed with threads still running.
+    for (const CheckQueueEngine engine : {CheckQueueEngine::LEGACY, CheckQueueEngine::WORKSTEALING}) {
+        GetScriptCheckQueue(engine)->StopWorkerThreads();
+    }
 }
 
 int32_t ComputeBlockVersion(const CBlockIndex *pindexPrev,
@@ -1831,7 +2221,7 @@ bool CChainState::ConnectBlock(const CBlock &block, CValidationState &state,
                                CBlockIndex *pindex, CCoinsViewCache &view,
                                const CChainParams &params,
                                BlockValidationOptions options,
-                               bool fJustCheck) {
+                               bool fJustCheck, CUTXOStats *pstats) {
     AssertLockHeld(cs_main);
     assert(pindex);
     assert(*pindex->phashBlock == block.GetHash());
@@ -2008,7 +2398,7 @@ bool CChainState::ConnectBlock(const CBlock &block, CValidationState &state,
     CBlockUndo blockundo;
     blockundo.vtxundo.resize(block.vtx.size() - 1);
 
-    CCheckQueueControl<CScriptCheck> control(fScriptChecks ? &scriptcheckqueue
+    CCheckQueueControl<CScriptCheck> control(fScriptChecks ? pscriptcheckqueue
                                                            : nullptr);
 
     // Add all outputs
@@ -2172,6 +2562,10 @@ bool CChainState::ConnectBlock(const CBlock &block, CValidationState &state,
         return false;
     }
 
+    if (pstats) {
+        pstats->ConnectBlock(block, blockundo, pindex->nHeight);
+    }
+
     if (!pindex->IsValid(BlockValidity::SCRIPTS)) {
         pindex->RaiseValidity(BlockValidity::SCRIPTS);
         setDirtyBlockIndex.insert(pindex);
@@ -2212,10 +2606,24 @@ static bool FlushStateToDisk(const CChainParams &chainparams,
     LOCK(cs_main);
     static int64_t nLastWrite = 0;
     static int64_t nLastFlush = 0;
+    // The block at which the chainstate is being written in the background
+    // by pcoinsflusher, and the memory the coins being written take.
+    static const CBlockIndex *pindexFlushing = nullptr;
+    static int64_t nFlushingCacheUsage = 0;
     std::set<int> setFilesToPrune;
-    bool full_flush_completed = false;
+    const CBlockIndex *pindexFlushed = nullptr;
     try {
         {
+            // Release the coins written in the background since last time.
+            if (pindexFlushing && pcoinsflusher->IsWriteComplete()) {
+                if (!pcoinsflusher->Wait()) {
+                    return AbortNode(state, "Failed to write to coin database");
+                }
+                pindexFlushed = pindexFlushing;
+                pindexFlushing = nullptr;
+                nFlushingCacheUsage = 0;
+            }
+
             bool fFlushForPrune = false;
             bool fDoFullFlush = false;
             LOCK(cs_LastBlockFile);
@@ -2252,14 +2660,18 @@ static bool FlushStateToDisk(const CChainParams &chainparams,
                 std::max<int64_t>(nMempoolSizeMax - nMempoolUsage, 0);
             // The cache is large and we're within 10% and 10 MiB of the limit,
             // but we have time now (not in the middle of a block processing).
+            // While the previous flush is being written, let it complete
+            // rather than wait for it here.
             bool fCacheLarge =
-                mode == FlushStateMode::PERIODIC &&
+                mode == FlushStateMode::PERIODIC && !pindexFlushing &&
                 cacheSize > std::max((9 * nTotalSpace) / 10,
                                      nTotalSpace -
                                          MAX_BLOCK_COINSDB_USAGE * 1024 * 1024);
-            // The cache is over the limit, we have to write now.
+            // The cache (with the coins still being written) is over the
+            // limit, we have to write now.
             bool fCacheCritical =
-                mode == FlushStateMode::IF_NEEDED && cacheSize > nTotalSpace;
+                mode == FlushStateMode::IF_NEEDED &&
+                cacheSize + nFlushingCacheUsage > nTotalSpace;
             // It's been a while since we wrote the block index to disk. Do this
             // frequently, so we don't need to redownload after a crash.
             bool fPeriodicWrite =
@@ -2273,6 +2685,11 @@ static bool FlushStateToDisk(const CChainParams &chainparams,
             // Combine all conditions that result in a full cache flush.
             fDoFullFlush = (mode == FlushStateMode::ALWAYS) || fCacheLarge ||
                            fCacheCritical || fPeriodicFlush || fFlushForPrune;
+            // Whether the chainstate must be on disk when we return, rather
+            // than being written in the background: when asked to, and when
+            // pruning the blocks it would otherwise be recovered from.
+            const bool fSyncFlush =
+                (mode == FlushStateMode::ALWAYS) || fFlushForPrune;
             // Write blocks and block index to disk.
             if (fDoFullFlush || fPeriodicWrite) {
                 // Depend on nMinDiskSpace to ensure we can write block index
@@ -2331,18 +2748,39 @@ static bool FlushStateToDisk(const CChainParams &chainparams,
                 }
 
                 // Flush the chainstate (which may refer to block index
-                // entries).
+                // entries). If pcoinsflusher was started, this only hands
+                // the coins over to it.
+                const CBlockIndex *pindexBest =
+                    LookupBlockIndex(pcoinsTip->GetBestBlock());
+                if (g_utxo_stats) {
+                    pcoinsdbview->SetUTXOStats(pcoinsTip->GetBestBlock(),
+                                               *g_utxo_stats);
+                }
                 if (!pcoinsTip->Flush()) {
                     return AbortNode(state, "Failed to write to coin database");
                 }
                 nLastFlush = nNow;
-                full_flush_completed = true;
+                if (pcoinsflusher && pcoinsflusher->IsFlushing()) {
+                    pindexFlushing = pindexBest;
+                    nFlushingCacheUsage = cacheSize;
+                } else {
+                    pindexFlushed = pindexBest;
+                }
+            }
+            if (fSyncFlush && pindexFlushing) {
+                if (!pcoinsflusher->Wait()) {
+                    return AbortNode(state, "Failed to write to coin database");
+                }
+                pindexFlushed = pindexFlushing;
+                pindexFlushing = nullptr;
+                nFlushingCacheUsage = 0;
             }
         }
 
-        if (full_flush_completed) {
+        if (pindexFlushed) {
             // Update best block in wallet (so we can detect restored wallets).
-            GetMainSignals().ChainStateFlushed(::ChainActive().GetLocator());
+            GetMainSignals().ChainStateFlushed(
+                ::ChainActive().GetLocator(pindexFlushed));
         }
     } catch (const std::runtime_error &e) {
         return AbortNode(state, std::string("System error while flushing: ") +
@@ -2425,13 +2863,22 @@ bool CChainState::DisconnectTip(const CChainParams &params,
     {
         CCoinsViewCache view(pcoinsTip.get());
         assert(view.GetBestBlock() == pindexDelete->GetBlockHash());
-        if (DisconnectBlock(block, pindexDelete, view) != DISCONNECT_OK) {
+        std::optional<CUTXOStats> statsChange;
+        if (g_utxo_stats) {
+            statsChange.emplace();
+        }
+        if (DisconnectBlock(block, pindexDelete, view,
+                            statsChange ? &*statsChange : nullptr) !=
+            DISCONNECT_OK) {
             return error("DisconnectTip(): DisconnectBlock %s failed",
                          pindexDelete->GetBlockHash().ToString());
         }
 
         bool flushed = view.Flush();
         assert(flushed);
+        if (statsChange) {
+            *g_utxo_stats += *statsChange;
+        }
     }
 
     LogPrint(BCLog::BENCH, "- Disconnect block: %.2fms\n",
@@ -2479,6 +2926,7 @@ bool CChainState::DisconnectTip(const CChainParams &params,
 }
 
 static int64_t nTimeReadFromDisk = 0;
+static int64_t nTimePrefetchCoins = 0;
 static int64_t nTimeConnectTotal = 0;
 static int64_t nTimeFlush = 0;
 static int64_t nTimeChainState = 0;
@@ -2659,12 +3107,17 @@ bool CChainState::ConnectTip(const Config &config, CValidationState &state,
     // Read block from disk.
     int64_t nTime1 = GetTimeMicros();
     std::shared_ptr<const CBlock> pthisBlock;
+    bool fPrefetched = false;
     if (!pblock) {
-        std::shared_ptr<CBlock> pblockNew = std::make_shared<CBlock>();
-        if (!ReadBlockFromDisk(*pblockNew, pindexNew, consensusParams)) {
-            return AbortNode(state, "Failed to read block");
+        pthisBlock = g_block_prefetcher.Take(pindexNew);
+        fPrefetched = bool(pthisBlock);
+        if (!pthisBlock) {
+            std::shared_ptr<CBlock> pblockNew = std::make_shared<CBlock>();
+            if (!ReadBlockFromDisk(*pblockNew, pindexNew, consensusParams)) {
+                return AbortNode(state, "Failed to read block");
+            }
+            pthisBlock = pblockNew;
         }
-        pthisBlock = pblockNew;
     } else {
         pthisBlock = pblock;
     }
@@ -2675,12 +3128,43 @@ bool CChainState::ConnectTip(const Config &config, CValidationState &state,
     int64_t nTime2 = GetTimeMicros();
     nTimeReadFromDisk += nTime2 - nTime1;
     int64_t nTime3;
-    LogPrint(BCLog::BENCH, "  - Load block from disk: %.2fms [%.2fs]\n",
-             (nTime2 - nTime1) * MILLI, nTimeReadFromDisk * MICRO);
+    LogPrint(BCLog::BENCH, "  - Load block from disk: %.2fms [%.2fs] (%s, prefetch hits %u/%u)\n",
+             (nTime2 - nTime1) * MILLI, nTimeReadFromDisk * MICRO,
+             pblock ? "received" : fPrefetched ? "prefetched" : "read",
+             g_block_prefetcher.GetHits(), g_block_prefetcher.GetHits() + g_block_prefetcher.GetMisses());
     {
-        CCoinsViewCache view(pcoinsTip.get());
+        // Fetch the coins spent by the block that are not cached yet from the
+        // database in parallel, instead of one at a time in ConnectBlock.
+        CCoinsViewPrefetched prefetched(pcoinsTip.get());
+        if (g_coins_prefetcher.IsActive()) {
+            const std::vector<COutPoint> outpoints =
+                CCoinsPrefetcher::GetUncachedOutpoints(blockConnecting, *pcoinsTip);
+            if (outpoints.size() >= COINS_PREFETCH_MIN_OUTPOINTS) {
+                // Go through pcoinsflusher, which has the coins of a flush
+                // that may not be in the database yet.
+                g_coins_prefetcher.Fetch(pcoinsflusher ? static_cast<const CCoinsView &>(*pcoinsflusher)
+                                                       : *pcoinsdbview,
+                                         outpoints, prefetched);
+            }
+            const int64_t nTimePrefetched = GetTimeMicros();
+            nTimePrefetchCoins += nTimePrefetched - nTime2;
+            LogPrint(BCLog::BENCH, "    - Prefetch coins: %u uncached inputs: %.2fms [%.2fs]\n",
+                     prefetched.GetStagedCount(), (nTimePrefetched - nTime2) * MILLI,
+                     nTimePrefetchCoins * MICRO);
+        }
+
+        CCoinsViewCache view(&prefetched);
+        std::optional<CUTXOStats> statsChange;
+        if (g_utxo_stats) {
+            statsChange.emplace();
+        }
         bool rv = ConnectBlock(blockConnecting, state, pindexNew, view, params,
-                               BlockValidationOptions(config));
+                               BlockValidationOptions(config), false,
+                               statsChange ? &*statsChange : nullptr);
+        if (prefetched.GetStagedCount()) {
+            LogPrint(BCLog::BENCH, "    - Prefetched coins hit rate: %u/%u lookups below the block's cache\n",
+                     prefetched.GetHits(), prefetched.GetHits() + prefetched.GetMisses());
+        }
         GetMainSignals().BlockChecked(blockConnecting, state);
         if (!rv) {
             if (state.IsInvalid()) {
@@ -2718,6 +3202,9 @@ bool CChainState::ConnectTip(const Config &config, CValidationState &state,
                  nTimeConnectTotal * MILLI / nBlocksTotal);
         bool flushed = view.Flush();
         assert(flushed);
+        if (statsChange) {
+            *g_utxo_stats += *statsChange;
+        }
     }
 
     int64_t nTime4 = GetTimeMicros();
@@ -3013,6 +3500,9 @@ bool CChainState::ActivateBestChainStep(
 
         // Connect new blocks.
         for (CBlockIndex *pindexConnect : reverse_iterate(vpindexToConnect)) {
+            // Keep the blocks that follow this one being read in the
+            // background while this one is connected.
+            g_block_prefetcher.Schedule(m_chain.Tip(), pindexMostWork);
             if (!ConnectTip(config, state, pindexConnect,
                             pindexConnect == pindexMostWork
                                 ? pblock
@@ -4596,6 +5086,8 @@ void PruneOneBlockFile(const int fileNumber) {
 void UnlinkPrunedFiles(const std::set<int> &setFilesToPrune) {
     for (const int i : setFilesToPrune) {
         FlatFilePos pos(i, 0);
+        g_block_file_maps.Remove(i);
+        g_undo_file_maps.Remove(i);
         fs::remove(BlockFileSeq().FileName(pos));
         fs::remove(UndoFileSeq().FileName(pos));
         LogPrintf("Prune: %s deleted blk/rev (%05u)\n", __func__, i);
@@ -4948,6 +5440,38 @@ bool LoadChainTip(const Config &config) {
     return true;
 }
 
+bool InitUTXOStats() {
+    LOCK(cs_main);
+    auto stats = std::make_unique<CUTXOStats>();
+    const BlockHash hashBest = pcoinsdbview->GetBestBlock();
+    BlockHash hashStats;
+    if (hashBest.IsNull()) {
+        // The chainstate is empty, or will be rebuilt from scratch.
+    } else if (pcoinsdbview->ReadUTXOStats(hashStats, *stats) &&
+               hashStats == hashBest) {
+        LogPrintf("Loaded UTXO set statistics of block %s\n",
+                  hashBest.ToString());
+    } else {
+        LogPrintf("Computing UTXO set statistics of block %s, this may take "
+                  "a while...\n",
+                  hashBest.ToString());
+        uiInterface.InitMessage(_("Computing UTXO set statistics..."));
+        try {
+            if (!ComputeUTXOStats(*pcoinsdbview, *stats, [] {
+                    if (ShutdownRequested()) {
+                        throw std::runtime_error("Shutdown requested");
+                    }
+                })) {
+                return error("%s: unable to read the UTXO set", __func__);
+            }
+        } catch (const std::runtime_error &e) {
+            return error("%s: %s", __func__, e.what());
+        }
+    }
+    g_utxo_stats = std::move(stats);
+    return true;
+}
+
 CVerifyDB::CVerifyDB() {
     uiInterface.ShowProgress(_("Verifying blocks..."), 0, false);
 }
@@ -5261,6 +5785,9 @@ void CChainState::UnloadBlockIndex() {
 // block index state
 void UnloadBlockIndex() {
     LOCK(cs_main);
+    g_block_prefetcher.Clear();
+    g_block_file_maps.Clear();
+    g_undo_file_maps.Clear();
     ::ChainActive().SetTip(nullptr);
     pindexFinalized = nullptr;
     pindexBestInvalid = nullptr;
@@ -5342,6 +5869,54 @@ bool LoadGenesisBlock(const CChainParams &chainparams) {
     return g_chainstate.LoadGenesisBlock(chainparams);
 }
 
+bool CChainState::LoadSnapshotChain(CBlockIndex *pindexBase,
+                                    const std::vector<uint32_t> &txCounts) {
+    AssertLockHeld(cs_main);
+    if (pindexBase->nHeight < 0 ||
+        size_t(pindexBase->nHeight) != txCounts.size()) {
+        return error("%s: %u transaction counts for a base block at height %d",
+                     __func__, txCounts.size(), pindexBase->nHeight);
+    }
+
+    std::vector<CBlockIndex *> vChain(pindexBase->nHeight);
+    for (CBlockIndex *pindex = pindexBase; pindex->pprev;
+         pindex = pindex->pprev) {
+        vChain[pindex->nHeight - 1] = pindex;
+    }
+    if (pindexBase->nHeight > 0 && !vChain[0]->pprev->HaveTxsDownloaded()) {
+        return error("%s: genesis block not loaded", __func__);
+    }
+
+    // The blocks are never downloaded nor validated: the snapshot commitment
+    // is trusted in their place. They are only marked as having their
+    // transactions, like blocks which have been pruned, and flagged as
+    // assumed valid rather than raised to BlockValidity::SCRIPTS.
+    for (size_t i = 0; i < vChain.size(); ++i) {
+        CBlockIndex *pindex = vChain[i];
+        if (pindex->nStatus.isInvalid() || txCounts[i] == 0) {
+            return error("%s: block %s cannot be part of the snapshot chain",
+                         __func__, pindex->GetBlockHash().ToString());
+        }
+        pindex->nTx = txCounts[i];
+        pindex->nChainTx = pindex->pprev->nChainTx + pindex->nTx;
+        pindex->RaiseValidity(BlockValidity::TRANSACTIONS);
+        pindex->nStatus = pindex->nStatus.withAssumedValid();
+        setDirtyBlockIndex.insert(pindex);
+    }
+    setBlockIndexCandidates.insert(pindexBase);
+
+    if (!fHavePruned) {
+        pblocktree->WriteFlag("prunedblockfiles", true);
+        fHavePruned = true;
+    }
+    return true;
+}
+
+bool LoadSnapshotChain(CBlockIndex *pindexBase,
+                       const std::vector<uint32_t> &txCounts) {
+    return g_chainstate.LoadSnapshotChain(pindexBase, txCounts);
+}
+
 void LoadExternalBlockFile(const Config &config, FILE *fileIn,
                            FlatFilePos *dbp) {
     // Map of disk positions for blocks with unknown parent (only used for
@@ -5582,12 +6157,16 @@ void CChainState::CheckBlockIndex(const Consensus::Params &consensusParams) {
             pindex->nStatus.getValidity() < BlockValidity::TRANSACTIONS) {
             pindexFirstNotTransactionsValid = pindex;
         }
+        // The blocks of a snapshot chain are not validated, but the blocks
+        // connected on top of it are validated as if they were.
         if (pindex->pprev != nullptr && pindexFirstNotChainValid == nullptr &&
-            pindex->nStatus.getValidity() < BlockValidity::CHAIN) {
+            pindex->nStatus.getValidity() < BlockValidity::CHAIN &&
+            !pindex->nStatus.isAssumedValid()) {
             pindexFirstNotChainValid = pindex;
         }
         if (pindex->pprev != nullptr && pindexFirstNotScriptsValid == nullptr &&
-            pindex->nStatus.getValidity() < BlockValidity::SCRIPTS) {
+            pindex->nStatus.getValidity() < BlockValidity::SCRIPTS &&
+            !pindex->nStatus.isAssumedValid()) {
             pindexFirstNotScriptsValid = pindex;
         }
 
@@ -5834,6 +6413,8 @@ CBlockFileInfo *GetBlockFileInfo(size_t n) {
 }
 
 static const uint64_t MEMPOOL_DUMP_VERSION = 1;
+//! The number of transactions LoadMempool() verifies together.
+static constexpr size_t LOAD_MEMPOOL_BATCH_SIZE = 1000;
 
 bool LoadMempool(const Config &config, CTxMemPool &pool) {
     Tic start;
@@ -5863,40 +6444,66 @@ bool LoadMempool(const Config &config, CTxMemPool &pool) {
 
         uint64_t num;
         file >> num;
-        while (num--) {
-            CTransactionRef tx;
-            int64_t nTime;
-            int64_t nFeeDelta;
-            file >> tx;
-            file >> nTime;
-            file >> nFeeDelta;
-
-            Amount amountdelta = nFeeDelta * SATOSHI;
-            if (amountdelta != Amount::zero()) {
-                pool.PrioritiseTransaction(tx->GetId(), amountdelta);
+        while (num) {
+            // Read the transactions by batches, to verify their signatures in
+            // parallel before adding them to the mempool one at a time.
+            std::vector<CTransactionRef> txs;
+            std::vector<int64_t> times;
+            for (; num && txs.size() < LOAD_MEMPOOL_BATCH_SIZE; --num) {
+                CTransactionRef tx;
+                int64_t nTime;
+                int64_t nFeeDelta;
+                file >> tx;
+                file >> nTime;
+                file >> nFeeDelta;
+
+                Amount amountdelta = nFeeDelta * SATOSHI;
+                if (amountdelta != Amount::zero()) {
+                    pool.PrioritiseTransaction(tx->GetId(), amountdelta);
+                }
+                if (nTime + nExpiryTimeout > nNow) {
+                    txs.push_back(std::move(tx));
+                    times.push_back(nTime);
+                } else {
+                    ++expired;
+                }
             }
-            CValidationState state;
-            if (nTime + nExpiryTimeout > nNow) {
-                LOCK(cs_main);
-                AcceptToMemoryPoolWithTime(
-                    config, pool, state, tx, nullptr /* pfMissingInputs */,
-                    nTime, false /* bypass_limits */,
-                    Amount::zero() /* nAbsurdFee */, false /* test_accept */);
+
+            const auto accept = [&](size_t i, const PreVerifiedTx *preverified) {
+                const CTransactionRef &tx = txs[i];
+                if (ShutdownRequested()) {
+                    return false;
+                }
+                CValidationState state;
+                {
+                    LOCK(cs_main);
+                    AcceptToMemoryPoolWithTime(
+                        config, pool, state, tx, nullptr /* pfMissingInputs */,
+                        times[i], false /* bypass_limits */,
+                        Amount::zero() /* nAbsurdFee */, false /* test_accept */,
+                        preverified);
+                }
                 if (state.IsValid()) {
                     ++count;
+                    return true;
+                }
+                // mempool may contain the transaction already, e.g. from
+                // wallet(s) having loaded it while we were processing mempool
+                // transactions; consider these as valid, instead of failed, but
+                // mark them as 'already there'
+                if (pool.exists(tx->GetId())) {
+                    ++already_there;
                 } else {
-                    // mempool may contain the transaction already, e.g. from
-                    // wallet(s) having loaded it while we were processing
-                    // mempool transactions; consider these as valid, instead of
-                    // failed, but mark them as 'already there'
-                    if (pool.exists(tx->GetId())) {
-                        ++already_there;
-                    } else {
-                        ++failed;
-                    }
+                    ++failed;
                 }
+                return false;
+            };
+            if (fTxPreVerify) {
+                PreVerifyTransactions(config, pool, txs, accept);
             } else {
-                ++expired;
+                for (size_t i = 0; i < txs.size(); ++i) {
+                    accept(i, nullptr);
+                }
             }
 
             if (ShutdownRequested()) {
@@ -13,8 +13,10 @@
 #include <amount.h>
 #include <blockfileinfo.h>
 #include <chain.h>
+#include <checkqueue.h>
 #include <coins.h>
 #include <consensus/consensus.h>
+#include <consensus/validation.h>
 #include <flatfile.h>
 #include <fs.h>
 #include <policy/policy.h>
@@ -30,6 +32,7 @@
 #include <atomic>
 #include <cstdint>
 #include <exception>
+#include <functional>
 #include <memory>
 #include <set>
 #include <string>
@@ -44,11 +47,13 @@ class CBlockUndo;
 class CChainParams;
 class CChain;
 class CCoinsViewDB;
+class CCoinsViewFlusher;
 class Config;
 class CScriptCheck;
 class CTxMemPool;
+class SchnorrSigBatch;
 class CTxUndo;
-class CValidationState;
+class CUTXOStats;
 
 struct FlatFilePos;
 struct ChainTxData;
@@ -90,11 +95,28 @@ static constexpr unsigned int MAX_BLOCKFILE_SIZE = 0x8000000; // 128 MiB
 static constexpr unsigned int BLOCKFILE_CHUNK_SIZE = 0x1000000; // 16 MiB
 /** The pre-allocation chunk size for rev?????.dat files (since 0.8) */
 static constexpr unsigned int UNDOFILE_CHUNK_SIZE = 0x100000; // 1 MiB
+/**
+ * Default for -blockmapfiles: none where files can't be mapped or where the
+ * address space is too small for them.
+ */
+#ifdef WIN32
+static constexpr int DEFAULT_BLOCK_MAP_FILES = 0;
+#else
+static constexpr int DEFAULT_BLOCK_MAP_FILES = sizeof(void *) >= 8 ? 64 : 0;
+#endif
 
 /** Maximum number of dedicated script-checking threads allowed */
 static constexpr int MAX_SCRIPTCHECK_THREADS = 15;
+/**
+ * Maximum number of dedicated script-checking threads allowed with
+ * -parengine=workstealing, which does not funnel all workers through one lock
+ * and therefore keeps scaling past MAX_SCRIPTCHECK_THREADS.
+ */
+static constexpr int MAX_SCRIPTCHECK_THREADS_WORKSTEALING = 63;
 /** -par default (number of script-checking threads, 0 = auto) */
 static constexpr int DEFAULT_SCRIPTCHECK_THREADS = 0;
+/** -parengine default (script-check queue implementation) */
+static constexpr CheckQueueEngine DEFAULT_SCRIPTCHECK_ENGINE = CheckQueueEngine::LEGACY;
 /**
  * Number of blocks that can be requested at any given time from a single peer.
  */
@@ -156,6 +178,8 @@ static constexpr unsigned int DEFAULT_BANSCORE_THRESHOLD = 100;
 
 /** Default for -persistmempool */
 static constexpr bool DEFAULT_PERSIST_MEMPOOL = true;
+/** Default for -txpreverify */
+static constexpr bool DEFAULT_TX_PREVERIFY = true;
 /** Default for using fee filter */
 static constexpr bool DEFAULT_FEEFILTER = true;
 
@@ -206,6 +230,8 @@ extern bool fRequireStandard;
 extern bool fCheckBlockIndex;
 extern bool fCheckBlockReads;
 extern bool fCheckpointsEnabled;
+//! Whether to verify the scripts of relayed transactions, and of those loaded from mempool.dat, with PreVerifyTransactions()
+extern bool fTxPreVerify;
 extern size_t nCoinCacheUsage;
 
 /**
@@ -374,6 +400,16 @@ void LoadExternalBlockFile(const Config &config, FILE *fileIn,
  */
 bool LoadGenesisBlock(const CChainParams &chainparams);
 
+/**
+ * Mark the blocks from height 1 up to pindexBase, whose transaction counts are
+ * txCounts, as pruned and assumed valid (BlockStatus::isAssumedValid()), but
+ * not as validated: the chain of a chainstate that has been loaded from a UTXO
+ * snapshot of pindexBase.
+ */
+bool LoadSnapshotChain(CBlockIndex *pindexBase,
+                       const std::vector<uint32_t> &txCounts)
+    EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
 /**
  * Load the block tree and coins database from disk, initializing state if we're
  * running with -reindex.
@@ -385,16 +421,44 @@ bool LoadBlockIndex(const Config &config) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
  */
 bool LoadChainTip(const Config &config) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+/**
+ * Start maintaining the statistics of the UTXO set of the chain tip: read them
+ * from the coins database, or compute them if they are missing or out of date.
+ */
+bool InitUTXOStats();
+
 /**
  * Unload database information.
  */
 void UnloadBlockIndex();
 
-/** Run instances of script checking worker threads */
-void StartScriptCheckWorkerThreads(int threads_num);
-/** Stop all of the script checking worker threads */
+/** Run instances of script checking worker threads using the given engine */
+void StartScriptCheckWorkerThreads(int threads_num,
+                                   CheckQueueEngine engine = DEFAULT_SCRIPTCHECK_ENGINE);
+/** Stop all of the script checking worker threads, of every engine */
 void StopScriptCheckWorkerThreads();
 
+/**
+ * Start the threads reading up to depth blocks ahead of the tip while
+ * connecting blocks (see CBlockPrefetcher)
+ */
+void StartBlockPrefetchThreads(int depth);
+/** Stop the block prefetch threads */
+void StopBlockPrefetchThreads();
+
+/**
+ * Start the threads fetching the coins spent by a block from the database in
+ * parallel before connecting it (see CCoinsPrefetcher)
+ */
+void StartCoinsPrefetchThreads(int threads_num);
+/** Stop the coins prefetch threads */
+void StopCoinsPrefetchThreads();
+
+/** Start the threads verifying transactions for PreVerifyTransactions() */
+void StartTxPreVerifyThreads(int threads_num);
+/** Stop the transaction pre-verification threads */
+void StopTxPreVerifyThreads();
+
 /**
  * Check whether we are doing an initial block download (synchronizing from disk
  * or network)
@@ -452,10 +516,36 @@ void PruneBlockFilesManual(int nManualPruneHeight);
 /**
  * (try to) add transaction to memory pool
  */
+/**
+ * What PreVerifyTransactions() found of the input scripts of a transaction,
+ * for AcceptToMemoryPool() not to verify them again.
+ */
+struct PreVerifiedTx {
+    TxId txid;
+    //! The flags the scripts were verified with: the result only stands for
+    //! as long as they are those of the mempool.
+    uint32_t scriptVerifyFlags = 0;
+    uint32_t nextBlockScriptVerifyFlags = 0;
+    //! Whether the scripts passed with both sets of flags, and if not, why
+    //! they failed, as CheckInputs() reports it.
+    bool valid = false;
+    CValidationState state;
+    //! The sigchecks count of the scripts, the same with both sets of flags.
+    int nSigChecks = 0;
+};
+
+/**
+ * (try to) add transaction to memory pool
+ *
+ * With preverified, the result PreVerifyTransactions() got for tx, the scripts
+ * are not verified again if the script flags did not change since then: only
+ * the inputs and the conflicts with the mempool are checked again.
+ */
 bool AcceptToMemoryPool(const Config &config, CTxMemPool &pool,
                         CValidationState &state, const CTransactionRef &tx,
                         bool *pfMissingInputs, bool bypass_limits,
-                        const Amount nAbsurdFee, bool test_accept = false)
+                        const Amount nAbsurdFee, bool test_accept = false,
+                        const PreVerifiedTx *preverified = nullptr)
     EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
 /**
@@ -467,9 +557,30 @@ AcceptToMemoryPoolWithTime(const Config &config, CTxMemPool &pool,
                            CValidationState &state, const CTransactionRef &tx,
                            bool *pfMissingInputs, int64_t nAcceptTime,
                            bool bypass_limits, const Amount nAbsurdFee,
-                           bool test_accept = false)
+                           bool test_accept = false,
+                           const PreVerifiedTx *preverified = nullptr)
     EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+/**
+ * Verify the input scripts of a batch of txs in parallel, without holding
+ * cs_main or pool.cs, and then call accept for each of them in order, with
+ * what was found of its scripts, to pass both to AcceptToMemoryPool().
+ *
+ * The locks are only held to look up the coins spent by txs, in the UTXO set,
+ * the mempool or the earlier transactions of txs, and for the cheap checks
+ * which AcceptToMemoryPool() makes before the scripts: transactions which are
+ * already known, conflict with the mempool, miss inputs, are non-standard or
+ * pay too low a fee are not verified, and accept gets no PreVerifiedTx for
+ * them. The valid signatures are stored in the signature cache; they are
+ * flagged to be evicted first if accept returns false.
+ *
+ * Nothing more is verified once shutdown is requested.
+ */
+void PreVerifyTransactions(const Config &config, const CTxMemPool &pool,
+                           const std::vector<CTransactionRef> &txs,
+                           const std::function<bool(size_t i, const PreVerifiedTx *preverified)> &accept)
+    LOCKS_EXCLUDED(cs_main);
+
 /** Convert CValidationState to a human-readable message for logging */
 std::string FormatStateMessage(const CValidationState &state);
 
@@ -616,6 +727,8 @@ private:
     TxSigCheckLimiter *pTxLimitSigChecks{};
     CheckInputsLimiter *pBlockLimitSigChecks{};
 
+    bool Run(SchnorrSigBatch *batch, size_t tag);
+
 public:
     CScriptCheck() = default;
 
@@ -631,6 +744,13 @@ public:
 
     bool operator()();
 
+    /**
+     * Run several checks, verifying the Schnorr signatures of all of them
+     * together as one batch. Returns false if any check fails, in which case
+     * the failing check's script error is set.
+     */
+    static bool RunBatch(std::vector<CScriptCheck> &checks);
+
     void swap(CScriptCheck &check) {
         context.swap(check.context);
         std::swap(nFlags, check.nFlags);
@@ -658,9 +778,19 @@ bool ReadBlockFromDisk(CBlock &block, const CBlockIndex *pindex,
  * `nType` and `nVersion` parameters are used for `-checkblockreads` sanity checking of the serialized data. */
 bool ReadRawBlockFromDisk(std::vector<uint8_t> &rawBlock, const CBlockIndex *pindex, const CChainParams &chainParams,
                           int nType, int nVersion);
+/** Like the above, but without copying the block data out of the memory mapping of the block file if it is mapped:
+ * `rawBlock` spans the block data, which remains valid as long as `owner` is held on to. */
+bool ReadRawBlockFromDisk(Span<const uint8_t> &rawBlock, std::shared_ptr<const void> &owner, const CBlockIndex *pindex,
+                          const CChainParams &chainParams, int nType, int nVersion);
 
 bool UndoReadFromDisk(CBlockUndo &blockundo, const CBlockIndex *pindex);
 
+/**
+ * Set the number of block files, and of undo files, to keep memory-mapped for
+ * reading blocks and undo data from them, 0 to read them with stdio instead.
+ */
+void SetBlockMapFiles(size_t max_files);
+
 /** Functions for validating blocks and updating the block tree */
 
 /**
@@ -770,11 +900,24 @@ CChain &ChainActive();
  */
 extern std::unique_ptr<CCoinsViewDB> pcoinsdbview;
 
+/**
+ * Global variable that points to the layer writing the coins flushed from
+ * pcoinsTip to pcoinsdbview, possibly in the background (protected by
+ * cs_main). May be null, in which case flushes are written synchronously.
+ */
+extern std::unique_ptr<CCoinsViewFlusher> pcoinsflusher;
+
 /**
  * Global variable that points to the active CCoinsView (protected by cs_main)
  */
 extern std::unique_ptr<CCoinsViewCache> pcoinsTip;
 
+/**
+ * Global variable that holds the statistics of the UTXO set of pcoinsTip, if
+ * they are maintained (-utxostats) (protected by cs_main)
+ */
+extern std::unique_ptr<CUTXOStats> g_utxo_stats;
+
 /**
  * Global variable that points to the active block tree (protected by cs_main)
  */
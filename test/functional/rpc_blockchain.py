@@ -241,6 +241,29 @@ class BlockchainTest(FittexxcoinTestFramework):
         assert_equal(res['bestblock'], res3['bestblock'])
         assert_equal(res['hash_serialized'], res3['hash_serialized'])
 
+        self.log.info("Test gettxoutsetinfo() with hash_type ecmultiset")
+        res4 = node.gettxoutsetinfo('ecmultiset')
+        for key in ['height', 'bestblock', 'txouts', 'bogosize', 'total_amount']:
+            assert_equal(res[key], res4[key])
+        assert 'transactions' not in res4
+        assert 'hash_serialized' not in res4
+        assert_is_hash_string(res4['utxo_commitment'])
+        assert_equal(res4['token_amounts'], {})
+        assert_raises_rpc_error(-8, "Unknown hash_type foo",
+                                node.gettxoutsetinfo, 'foo')
+
+        self.log.info(
+            "Test that -utxostats only changes how the ecmultiset statistics are computed")
+        self.restart_node(0, ['-stopatheight=207', '-prune=1', '-utxostats'])
+        res5 = node.gettxoutsetinfo()
+        res6 = node.gettxoutsetinfo(hash_type='ecmultiset')
+        # Only the size of the chainstate on disk may have changed.
+        for r in [res, res4, res5, res6]:
+            del r['disk_size']
+        assert_equal(res5, res)
+        assert_equal(res6, res4)
+        self.restart_node(0, ['-stopatheight=207', '-prune=1'])
+
     def _test_getblockheader(self):
         node = self.nodes[0]
 